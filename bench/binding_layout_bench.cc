@@ -0,0 +1,126 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// a material system that binds every constant buffer and texture of a shared material block
+// before every draw, submitted through a surface shader without a binding layout and through one
+// that declares the slots each stage reads. The check makes sure the declared layout draws the
+// same and binds only the slots it declares.
+
+#include <memory>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumLayoutDraws     = 100000,
+    kNumConstantBuffers = 4,  // bound per draw, slots 0..3
+    kNumTextures        = 8   // bound per draw, slots 0..7
+};
+
+// the scene's shaders linked again with a binding layout
+struct LayoutPipeline final
+{
+    sgfx::SurfaceShaderHandle   surfaceShader;
+    sgfx::PipelineStateHandle   pipelineState;
+    sgfx::DrawQueueHandle       drawQueue;
+};
+
+static void createLayoutPipeline(LayoutPipeline& layoutPipeline, const Pipeline& pipeline)
+{
+    // the vertex shader reads the camera and object buffers, the pixel shader the object and
+    // material buffers and four of the eight textures
+    sgfx::SurfaceBindingLayout layout;
+    layout.vs.constantBuffers    = 0x3;
+    layout.ps.constantBuffers    = 0x6;
+    layout.ps.samplers           = 0x1;
+    layout.ps.shaderResources[0] = 0xF;
+
+    layoutPipeline.surfaceShader = sgfx::linkSurfaceShader(pipeline.vs, sgfx::HullShaderHandle(), sgfx::DomainShaderHandle(), sgfx::GeometryShaderHandle(), pipeline.ps, &layout);
+
+    sgfx::PipelineStateDescriptor desc;
+    desc.shader       = layoutPipeline.surfaceShader;
+    desc.vertexFormat = pipeline.vertexFormat;
+    layoutPipeline.pipelineState = sgfx::createPipelineState(desc);
+    layoutPipeline.drawQueue     = sgfx::createDrawQueue(layoutPipeline.pipelineState);
+}
+
+static void releaseLayoutPipeline(LayoutPipeline& layoutPipeline)
+{
+    sgfx::releaseDrawQueue(layoutPipeline.drawQueue);
+    sgfx::releasePipelineState(layoutPipeline.pipelineState);
+    sgfx::releaseSurfaceShader(layoutPipeline.surfaceShader);
+}
+
+// the whole material block before every draw, a new material every draw
+static void recordMaterialDraws(const Scene& scene, sgfx::DrawQueueHandle queue)
+{
+    for (uint32_t i = 0; i < kNumLayoutDraws; ++i) {
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[0]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+
+        for (uint32_t slot = 0; slot < kNumConstantBuffers; ++slot)
+            sgfx::setConstantBuffer(queue, slot, scene.constantBuffers[(i + slot) % kNumChurnResources]);
+        for (uint32_t slot = 0; slot < kNumTextures; ++slot)
+            sgfx::setResource(queue, slot, scene.textures[(i + slot) % kNumChurnResources]);
+
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+void benchBindingLayout(const Scene& scene)
+{
+    std::shared_ptr<LayoutPipeline> layoutPipeline = std::make_shared<LayoutPipeline>();
+    createLayoutPipeline(*layoutPipeline, scene.pipeline);
+    addCleanup([layoutPipeline]() { releaseLayoutPipeline(*layoutPipeline); });
+
+    addCheck("binding_layout/declared_slots_only", [&scene, layoutPipeline]() {
+        recordMaterialDraws(scene, scene.drawQueue);
+        sgfx::null::DeviceStats all = submitAndCount(scene.drawQueue);
+
+        recordMaterialDraws(scene, layoutPipeline->drawQueue);
+        sgfx::null::DeviceStats declared = submitAndCount(layoutPipeline->drawQueue);
+
+        // four constant buffers and four textures change every draw over both stages, the textures
+        // are unbound once at the end of the queue
+        return checkEqual("draws", declared.numDrawCalls, all.numDrawCalls)
+            && checkEqual("constant buffer binds", declared.numConstantBufferBinds, kNumLayoutDraws * 4)
+            && checkEqual("resource binds", declared.numResourceBinds, kNumLayoutDraws * 4 + 4);
+    });
+
+    for (bool declareLayout : { false, true }) {
+        sgfx::DrawQueueHandle queue = declareLayout ? layoutPipeline->drawQueue : scene.drawQueue;
+
+        addBenchmark(declareLayout ? "binding_layout/submit/declared" : "binding_layout/submit/none", "draw", kNumLayoutDraws, 0, [&scene, queue]() {
+            recordMaterialDraws(scene, queue);
+
+            auto start = Clock::now();
+            sgfx::submit(queue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,271 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// kNumSlots meshes stay resident in one structured buffer and every frame kStreamPerFrame of them
+// are dropped and replaced by new ones of a random size. "rebuild" re-creates the buffer and
+// copies every mesh into it whenever the set changes, like demo_grass did, "heap" allocates and
+// frees blocks of a buffer heap and "heap_compact" also moves up to kCompactionStep bytes per
+// frame with compactBufferHeap(). The check streams kNumStreamedFrames frames in every mode,
+// compacts the whole heap and compares the contents of every resident mesh.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumSlots           = 1024,
+    kStreamPerFrame     = 16,
+    kStride             = 32,
+    kMinMeshSize        = 1024,
+    kMaxMeshSize        = 65536,
+    kHeapSize           = 48 * 1024 * 1024,
+    kCompactionStep     = 256 * 1024,
+    kNumStreamedFrames  = 240
+};
+
+enum Mode
+{
+    Rebuild,
+    Heap,
+    HeapCompact,
+    NumModes
+};
+
+struct Mesh final
+{
+    uint32_t          seed = 0;
+    uint32_t          size = 0; // bytes, 0 while the slot is empty
+    sgfx::BufferBlock block;
+};
+
+struct Streamer final
+{
+    Mode                    mode;
+    std::vector<Mesh>       meshes;
+    std::vector<uint8_t>    scratch;
+    uint32_t                random = 12345;
+
+    sgfx::BufferHeapHandle  heap;
+    sgfx::BufferHandle      buffer; // rebuild mode
+    bool                    isDirty = false;
+
+    uint32_t                numFailures = 0;
+};
+
+static uint32_t nextRandom(Streamer& streamer)
+{
+    streamer.random = streamer.random * 1664525u + 1013904223u;
+    return streamer.random >> 8;
+}
+
+static const uint8_t* fillMesh(Streamer& streamer, const Mesh& mesh)
+{
+    streamer.scratch.resize(mesh.size);
+    for (uint32_t i = 0; i < mesh.size; ++i)
+        streamer.scratch[i] = static_cast<uint8_t>(mesh.seed + i * 7);
+    return streamer.scratch.data();
+}
+
+static void loadMesh(Streamer& streamer, Mesh& mesh)
+{
+    uint32_t range = (kMaxMeshSize - kMinMeshSize) / kStride;
+    mesh.seed = nextRandom(streamer);
+    mesh.size = kMinMeshSize + (nextRandom(streamer) % range) * kStride;
+
+    if (streamer.mode == Rebuild) {
+        streamer.isDirty = true;
+        return;
+    }
+
+    mesh.block = sgfx::allocateBufferBlock(streamer.heap, fillMesh(streamer, mesh), mesh.size);
+    if (mesh.block.buffer == sgfx::BufferHandle::invalidHandle()) {
+        mesh.size = 0;
+        streamer.numFailures++;
+    }
+}
+
+static void dropMesh(Streamer& streamer, Mesh& mesh)
+{
+    if (mesh.size == 0)
+        return;
+
+    if (streamer.mode == Rebuild)
+        streamer.isDirty = true;
+    else
+        sgfx::freeBufferBlock(streamer.heap, mesh.block);
+    mesh.size = 0;
+}
+
+// what PhysicalMeshBuffer::rebuildPages() did
+static void rebuildBuffer(Streamer& streamer)
+{
+    if (!streamer.isDirty)
+        return;
+
+    size_t totalSize = 0;
+    for (const Mesh& mesh : streamer.meshes)
+        totalSize += mesh.size;
+
+    sgfx::releaseBuffer(streamer.buffer);
+    streamer.buffer = sgfx::createBuffer(sgfx::BufferFlags::CPUWrite | sgfx::BufferFlags::StructuredBuffer, nullptr, totalSize, kStride);
+
+    uint8_t* dataPtr = reinterpret_cast<uint8_t*>(sgfx::mapBuffer(streamer.buffer, sgfx::MapType::Write));
+    if (dataPtr != nullptr) {
+        uint32_t offset = 0;
+        for (Mesh& mesh : streamer.meshes) {
+            if (mesh.size == 0)
+                continue;
+
+            std::memcpy(dataPtr + offset, fillMesh(streamer, mesh), mesh.size);
+            mesh.block.buffer = streamer.buffer;
+            mesh.block.offset = offset;
+            offset += mesh.size;
+        }
+        sgfx::unmapBuffer(streamer.buffer);
+    }
+
+    streamer.isDirty = false;
+}
+
+static void runFrame(Streamer& streamer)
+{
+    for (uint32_t i = 0; i < kStreamPerFrame; ++i) {
+        Mesh& mesh = streamer.meshes[nextRandom(streamer) % kNumSlots];
+        dropMesh(streamer, mesh);
+        loadMesh(streamer, mesh);
+    }
+
+    if (streamer.mode == Rebuild) {
+        rebuildBuffer(streamer);
+    } else if (streamer.mode == HeapCompact) {
+        sgfx::compactBufferHeap(streamer.heap, kCompactionStep);
+    }
+}
+
+static bool verifyMeshes(Streamer& streamer)
+{
+    for (Mesh& mesh : streamer.meshes) {
+        if (mesh.size == 0)
+            continue;
+
+        sgfx::BufferBlock block = mesh.block;
+        if (streamer.mode != Rebuild)
+            block = sgfx::getBufferBlock(streamer.heap, mesh.block.id);
+
+        const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(sgfx::mapBuffer(block.buffer, sgfx::MapType::Read));
+        bool isValid = dataPtr != nullptr && std::memcmp(dataPtr + block.offset, fillMesh(streamer, mesh), mesh.size) == 0;
+        sgfx::unmapBuffer(block.buffer);
+
+        if (!isValid)
+            return false;
+    }
+    return true;
+}
+
+// every slot filled, the heap or the buffer created
+static void startStreamer(Streamer& streamer, Mode mode)
+{
+    streamer.mode = mode;
+    streamer.meshes.resize(kNumSlots);
+
+    if (mode != Rebuild)
+        streamer.heap = sgfx::createBufferHeap(sgfx::BufferFlags::StructuredBuffer, kHeapSize, kStride);
+
+    for (Mesh& mesh : streamer.meshes)
+        loadMesh(streamer, mesh);
+    if (mode == Rebuild)
+        rebuildBuffer(streamer);
+}
+
+static void stopStreamer(Streamer& streamer)
+{
+    if (streamer.mode != Rebuild)
+        sgfx::releaseBufferHeap(streamer.heap);
+    else
+        sgfx::releaseBuffer(streamer.buffer);
+    streamer.meshes.clear();
+}
+
+static const char* const kModeNames[NumModes] = {
+    "buffer_heap/rebuild",
+    "buffer_heap/heap",
+    "buffer_heap/heap_compact"
+};
+
+void benchBufferHeap()
+{
+    addCheck("buffer_heap/contents_after_streaming", []() {
+        for (uint32_t i = 0; i < NumModes; ++i) {
+            Streamer streamer;
+            startStreamer(streamer, static_cast<Mode>(i));
+
+            for (uint32_t frame = 0; frame < kNumStreamedFrames; ++frame) {
+                runFrame(streamer);
+                sgfx::present(0);
+            }
+
+            if (streamer.mode == HeapCompact)
+                sgfx::compactBufferHeap(streamer.heap, kHeapSize);
+
+            bool isValid = verifyMeshes(streamer);
+            uint32_t numFreeBlocks = (streamer.mode == HeapCompact) ? sgfx::getBufferHeapStats(streamer.heap).numFreeBlocks : 0;
+            uint32_t numFailures   = streamer.numFailures;
+            stopStreamer(streamer);
+
+            if (!isValid)
+                return checkFailed("%s: a resident mesh holds different data", kModeNames[i]);
+            if (!checkEqual("failed allocations", numFailures, 0))
+                return false;
+
+            // everything moved to the front, one free range is left at the end
+            if (numFreeBlocks > 1)
+                return checkFailed("%s: %u free ranges after compacting the whole heap", kModeNames[i], numFreeBlocks);
+        }
+        return true;
+    });
+
+    for (uint32_t i = 0; i < NumModes; ++i) {
+        std::shared_ptr<Streamer> streamer = std::make_shared<Streamer>();
+        addCleanup([streamer]() {
+            if (!streamer->meshes.empty())
+                stopStreamer(*streamer);
+        });
+
+        Mode mode = static_cast<Mode>(i);
+        addBenchmark(kModeNames[i], "frame", 1, 0, [streamer, mode]() {
+            if (streamer->meshes.empty())
+                startStreamer(*streamer, mode);
+
+            auto start = Clock::now();
+            runFrame(*streamer);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,166 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// Culling: a static scene is culled on the CPU every frame and the visible draws are either
+// recorded into a draw queue again, or played from a bundle recorded once with the visibility
+// bitset as the submit mask. The check compares the masked bundle against recording the same
+// visible draws over a few culling results.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumBundleDraws     = 50000,
+    kVisiblePercent     = 30,
+    kNumCullingResults  = 8     // the runs cycle through these
+};
+
+// objects are sorted by material, every object has its own primitive count so that dropping or
+// repeating the wrong draw shows up in the primitive count
+static void recordBundleDraw(const Scene& scene, sgfx::DrawQueueHandle queue, uint32_t i)
+{
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+    sgfx::setVertexBuffer(queue, scene.vertexBuffers[i % kNumChurnResources]);
+    sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+    sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[(i / 64) % 8]);
+    sgfx::setResource(queue, 0, scene.textures[(i / 256) % 16]);
+    sgfx::drawIndexed(queue, 3 * (1 + i % 7), 0, 0);
+}
+
+// stands in for the culling results, a different random set of objects every frame
+static std::vector<uint64_t> cullScene(uint32_t frame)
+{
+    std::vector<uint64_t> visibility((kNumBundleDraws + 63) / 64, 0);
+
+    uint32_t seed = 12345 + frame * 7919;
+    for (uint32_t i = 0; i < kNumBundleDraws; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        if ((seed >> 8) % 100 < kVisiblePercent)
+            visibility[i / 64] |= 1ull << (i % 64);
+    }
+    return visibility;
+}
+
+static inline bool isVisible(const std::vector<uint64_t>& visibility, uint32_t i)
+{
+    return ((visibility[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+struct CulledScene final
+{
+    sgfx::DrawQueueHandle              queue;  // the bundle was baked from it
+    sgfx::BundleHandle                 bundle;
+    std::vector<std::vector<uint64_t>> visibility;
+    uint32_t                           frame = 0;
+
+    const std::vector<uint64_t>& cull() { return visibility[frame++ % kNumCullingResults]; }
+};
+
+static void recordVisible(const Scene& scene, const std::vector<uint64_t>& visibility)
+{
+    for (uint32_t i = 0; i < kNumBundleDraws; ++i) {
+        if (isVisible(visibility, i))
+            recordBundleDraw(scene, scene.drawQueue, i);
+    }
+}
+
+static sgfx::null::DeviceStats submitAndCount(sgfx::BundleHandle bundle, const uint64_t* visibility)
+{
+    sgfx::null::resetDeviceStats();
+    if (visibility != nullptr)
+        sgfx::submit(bundle, visibility);
+    else
+        sgfx::submit(bundle);
+    sgfx::present(0);
+    return sgfx::null::getDeviceStats();
+}
+
+void benchBundleVisibility(const Scene& scene)
+{
+    std::shared_ptr<CulledScene> culled = std::make_shared<CulledScene>();
+
+    culled->queue = sgfx::createDrawQueue(scene.pipeline.pipelineState);
+    for (uint32_t i = 0; i < kNumBundleDraws; ++i)
+        recordBundleDraw(scene, culled->queue, i);
+    culled->bundle = sgfx::createBundle(culled->queue);
+
+    for (uint32_t frame = 0; frame < kNumCullingResults; ++frame)
+        culled->visibility.push_back(cullScene(frame));
+
+    addCleanup([culled]() {
+        sgfx::releaseBundle(culled->bundle);
+        sgfx::releaseDrawQueue(culled->queue);
+    });
+
+    addCheck("bundle/masked_matches_recorded", [&scene, culled]() {
+        for (const std::vector<uint64_t>& visibility : culled->visibility) {
+            recordVisible(scene, visibility);
+            sgfx::null::DeviceStats recorded = submitAndCount(scene.drawQueue);
+            sgfx::null::DeviceStats masked   = submitAndCount(culled->bundle, visibility.data());
+
+            if (!checkEqual("masked bundle draws", masked.numDrawCalls, recorded.numDrawCalls)
+                || !checkEqual("masked bundle indices", masked.numPrimitives, recorded.numPrimitives))
+                return false;
+        }
+        return checkEqual("bundle draws", submitAndCount(culled->bundle, nullptr).numDrawCalls, kNumBundleDraws);
+    });
+
+    // everything after culling counts, an operation is an object of the scene
+    addBenchmark("bundle/culled/record_and_submit", "object", kNumBundleDraws, 0, [&scene, culled]() {
+        const std::vector<uint64_t>& visibility = culled->cull();
+
+        auto start = Clock::now();
+        recordVisible(scene, visibility);
+        sgfx::submit(scene.drawQueue);
+        double ns = getNanoseconds(start, Clock::now());
+
+        sgfx::present(0);
+        return ns;
+    });
+
+    addBenchmark("bundle/culled/submit_masked", "object", kNumBundleDraws, 0, [culled]() {
+        const std::vector<uint64_t>& visibility = culled->cull();
+
+        auto start = Clock::now();
+        sgfx::submit(culled->bundle, visibility.data());
+        double ns = getNanoseconds(start, Clock::now());
+
+        sgfx::present(0);
+        return ns;
+    });
+
+    // without culling, for reference
+    addBenchmark("bundle/submit_all", "object", kNumBundleDraws, 0, [culled]() {
+        auto start = Clock::now();
+        sgfx::submit(culled->bundle);
+        double ns = getNanoseconds(start, Clock::now());
+
+        sgfx::present(0);
+        return ns;
+    });
+}
@@ -0,0 +1,215 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// the time of a frame of kNumCapturedQueues x kNumCapturedDraws draws with the capture stopped and
+// running. The check captures kNumCapturedFrames frames from scratch to capture_trace.sgfx, reads
+// the records back and fails unless every draw, present and unmap is there; play the trace with
+// sgfx_replay.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <stdio.h>
+
+#define SGFX_CAPTURE_FORMAT 1
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumCapturedQueues   = 4,
+    kNumCapturedDraws    = 5000,
+    kNumCapturedVertices = 64,
+    kNumCapturedFrames   = 16,
+    kNumCallsPerDraw     = 5  // setPrimitiveTopology, two setVertexBuffer, setConstantBuffer and draw
+};
+
+struct CapturedScene final
+{
+    Pipeline                    pipeline;
+    sgfx::DrawQueueHandle       drawQueues[kNumCapturedQueues];
+    sgfx::BufferHandle          vertexBuffer;
+    sgfx::BufferHandle          instanceBuffer; // mapped and rewritten every frame
+    sgfx::ConstantBufferHandle  constantBuffer;
+    uint32_t                    frame = 0;
+};
+
+static void createCapturedScene(CapturedScene& scene)
+{
+    sgfx::VertexElementDescriptor elements[] = {
+        { "POSITION", 0, sgfx::DataFormat::RGB32F,  0, 0, false },
+        { "TEXCOORD", 0, sgfx::DataFormat::RGBA32F, 1, 0, true  }
+    };
+    createPipeline(scene.pipeline, sgfx::PipelineStateDescriptor(), elements, 2);
+
+    for (sgfx::DrawQueueHandle& queue : scene.drawQueues)
+        queue = sgfx::createDrawQueue(scene.pipeline.pipelineState);
+
+    float vertices[kNumCapturedVertices * 3] = { 0.0F };
+    scene.vertexBuffer   = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, vertices, sizeof(vertices), 12);
+    scene.instanceBuffer = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer | sgfx::BufferFlags::CPUWrite, nullptr, 4096, 16);
+    scene.constantBuffer = sgfx::createConstantBuffer(nullptr, 256);
+}
+
+static void releaseCapturedScene(CapturedScene& scene)
+{
+    sgfx::releaseConstantBuffer(scene.constantBuffer);
+    sgfx::releaseBuffer(scene.instanceBuffer);
+    sgfx::releaseBuffer(scene.vertexBuffer);
+    for (sgfx::DrawQueueHandle& queue : scene.drawQueues)
+        sgfx::releaseDrawQueue(queue);
+    releasePipeline(scene.pipeline);
+}
+
+// per queue a constant update, a transient upload and kNumCapturedDraws draws, the instance
+// buffer is rewritten through a map once per frame
+static void renderCapturedFrame(CapturedScene& scene)
+{
+    uint32_t frame = scene.frame++;
+
+    float* instances = static_cast<float*>(sgfx::mapBuffer(scene.instanceBuffer, sgfx::MapType::WriteDiscard));
+    if (instances != nullptr) {
+        for (uint32_t i = 0; i < 1024; ++i)
+            instances[i] = static_cast<float>(frame + i);
+    }
+    sgfx::unmapBuffer(scene.instanceBuffer);
+
+    for (uint32_t i = 0; i < kNumCapturedQueues; ++i) {
+        float constants[64] = { static_cast<float>(frame) };
+        sgfx::updateConstantBuffer(scene.constantBuffer, constants);
+
+        sgfx::TransientAllocation transient = sgfx::allocateTransient(kNumCapturedVertices * 12);
+        std::memset(transient.cpuPtr, static_cast<int>(frame), kNumCapturedVertices * 12);
+
+        sgfx::DrawQueueHandle queue = scene.drawQueues[i];
+        for (uint32_t draw = 0; draw < kNumCapturedDraws; ++draw) {
+            sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+            if (draw % 16 == 0)
+                sgfx::setVertexBuffer(queue, transient.buffer, 0, transient.offset);
+            else
+                sgfx::setVertexBuffer(queue, scene.vertexBuffer);
+            sgfx::setVertexBuffer(queue, scene.instanceBuffer, 1);
+            sgfx::setConstantBuffer(queue, 0, scene.constantBuffer);
+            sgfx::draw(queue, 3, draw % kNumCapturedVertices);
+        }
+        sgfx::submit(queue);
+    }
+
+    sgfx::present(0);
+}
+
+// records of the trace by op, false if it doesn't parse
+static bool countRecords(const char* path, std::vector<uint32_t>& numRecords)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    std::vector<uint8_t> trace;
+    uint8_t chunk[65536];
+    for (size_t size; (size = fread(chunk, 1, sizeof(chunk), file)) != 0;)
+        trace.insert(trace.end(), chunk, chunk + size);
+    fclose(file);
+
+    numRecords.assign(0x10000, 0);
+
+    sgfx::capture::FileHeader header;
+    if (trace.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, trace.data(), sizeof(header));
+    if (std::memcmp(header.magic, sgfx::capture::kMagic, sizeof(header.magic)) != 0 || header.version != sgfx::capture::kVersion)
+        return false;
+
+    for (size_t position = header.headerSize; position < trace.size();) {
+        sgfx::capture::RecordHeader record;
+        if (trace.size() - position < sizeof(record))
+            return false;
+        std::memcpy(&record, trace.data() + position, sizeof(record));
+
+        position += sizeof(record) + record.size;
+        if (position > trace.size() || record.size % 8 != 0)
+            return false;
+        numRecords[record.op]++;
+    }
+    return true;
+}
+
+static uint32_t getNumRecords(const std::vector<uint32_t>& numRecords, sgfx::capture::Op op)
+{
+    return numRecords[static_cast<uint16_t>(op)];
+}
+
+void benchCapture()
+{
+    // a captured run from scratch, the capture starts before the scene is created so the trace
+    // has every object its calls use
+    addCheck("capture/trace_complete", []() {
+        const char* path = "capture_trace.sgfx";
+        if (!sgfx::startCapture(path))
+            return checkFailed("can't start the capture to %s", path);
+
+        CapturedScene scene;
+        createCapturedScene(scene);
+        for (uint32_t frame = 0; frame < kNumCapturedFrames; ++frame)
+            renderCapturedFrame(scene);
+        releaseCapturedScene(scene);
+        sgfx::stopCapture();
+
+        std::vector<uint32_t> numRecords;
+        if (!countRecords(path, numRecords))
+            return checkFailed("%s doesn't parse", path);
+
+        return checkEqual("draws", getNumRecords(numRecords, sgfx::capture::Op::Draw), kNumCapturedFrames * kNumCapturedQueues * kNumCapturedDraws)
+            && checkEqual("presents", getNumRecords(numRecords, sgfx::capture::Op::Present), kNumCapturedFrames)
+            && checkEqual("unmaps", getNumRecords(numRecords, sgfx::capture::Op::UnmapBuffer), kNumCapturedFrames)
+            && checkEqual("transient uploads", getNumRecords(numRecords, sgfx::capture::Op::TransientData), kNumCapturedFrames * kNumCapturedQueues);
+    });
+
+    std::shared_ptr<CapturedScene> scene = std::make_shared<CapturedScene>();
+    createCapturedScene(*scene);
+    addCleanup([scene]() { releaseCapturedScene(*scene); });
+
+    const uint64_t numCalls = kNumCapturedQueues * kNumCapturedDraws * kNumCallsPerDraw;
+
+    addBenchmark("capture/frame/stopped", "call", numCalls, 0, [scene]() {
+        auto start = Clock::now();
+        renderCapturedFrame(*scene);
+        return getNanoseconds(start, Clock::now());
+    });
+
+    // every run writes a trace of its frame to a scratch file, opening and closing it is left out
+    const char* scratchPath = "capture_bench.sgfx";
+    addCleanup([scratchPath]() { remove(scratchPath); });
+
+    addBenchmark("capture/frame/running", "call", numCalls, 0, [scene, scratchPath]() {
+        if (!sgfx::startCapture(scratchPath))
+            return 0.0;
+
+        auto start = Clock::now();
+        renderCapturedFrame(*scene);
+        double ns = getNanoseconds(start, Clock::now());
+
+        sgfx::stopCapture();
+        return ns;
+    });
+}
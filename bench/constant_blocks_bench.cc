@@ -0,0 +1,202 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// kNumBlockObjects objects with 64 bytes of constants each, once with a constant buffer per
+// object and once with blocks of a constant allocator bound with setConstantBufferRange(). The
+// create benchmarks make and release every object's constants, the frames update every object's
+// constants and draw it. The check counts the buffers the allocator creates and makes sure the
+// blocks bind and upload what the buffers do.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumBlockObjects    = 40000,
+    kPageSize           = 65536
+};
+
+struct BlockConstants final
+{
+    float transform[16];
+};
+
+// the object constants, either a buffer per object or blocks of one allocator
+struct Objects final
+{
+    bool                                    useBlocks = false;
+    std::vector<sgfx::ConstantBufferHandle> buffers;
+    sgfx::ConstantAllocatorHandle           allocator;
+    std::vector<sgfx::ConstantBlock>        blocks;
+    uint32_t                                frame = 0;
+};
+
+static void createObjects(Objects& objects)
+{
+    BlockConstants constants;
+    std::memset(&constants, 0, sizeof(constants));
+
+    if (objects.useBlocks) {
+        objects.allocator = sgfx::createConstantAllocator(kPageSize);
+        objects.blocks.resize(kNumBlockObjects);
+        for (sgfx::ConstantBlock& block : objects.blocks)
+            block = sgfx::allocateConstantBlock(objects.allocator, &constants, sizeof(constants));
+    } else {
+        objects.buffers.resize(kNumBlockObjects);
+        for (sgfx::ConstantBufferHandle& buffer : objects.buffers)
+            buffer = sgfx::createConstantBuffer(&constants, sizeof(constants));
+    }
+}
+
+static void releaseObjects(Objects& objects)
+{
+    if (objects.useBlocks) {
+        for (const sgfx::ConstantBlock& block : objects.blocks)
+            sgfx::freeConstantBlock(objects.allocator, block);
+        sgfx::releaseConstantAllocator(objects.allocator);
+        objects.blocks.clear();
+    } else {
+        for (sgfx::ConstantBufferHandle& buffer : objects.buffers)
+            sgfx::releaseConstantBuffer(buffer);
+        objects.buffers.clear();
+    }
+}
+
+static void recordObjectDraws(const Scene& scene, Objects& objects)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+    uint32_t              frame = objects.frame++;
+
+    BlockConstants constants;
+    std::memset(&constants, 0, sizeof(constants));
+
+    for (uint32_t i = 0; i < kNumBlockObjects; ++i) {
+        constants.transform[0]  = 1.0F;
+        constants.transform[5]  = 1.0F;
+        constants.transform[10] = 1.0F;
+        constants.transform[12] = static_cast<float>(i);
+        constants.transform[13] = static_cast<float>(frame);
+        constants.transform[15] = 1.0F;
+
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[0]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[0]);
+
+        if (objects.useBlocks) {
+            const sgfx::ConstantBlock& block = objects.blocks[i];
+            sgfx::updateConstantBuffer(block.buffer, &constants, block.offset, sizeof(constants));
+            sgfx::setConstantBufferRange(queue, 1, block.buffer, block.offset, block.size);
+        } else {
+            sgfx::updateConstantBuffer(objects.buffers[i], &constants);
+            sgfx::setConstantBuffer(queue, 1, objects.buffers[i]);
+        }
+
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+// the buffers creating the objects' constants takes, and what a frame of them submits
+static void countObjects(const Scene& scene, Objects& objects, uint64_t& numBuffersCreated, sgfx::null::DeviceStats& stats)
+{
+    sgfx::null::resetDeviceStats();
+    createObjects(objects);
+    numBuffersCreated = sgfx::null::getDeviceStats().numBuffersCreated;
+
+    sgfx::null::resetDeviceStats();
+    recordObjectDraws(scene, objects);
+    stats = submitAndCount(scene.drawQueue);
+
+    releaseObjects(objects);
+}
+
+void benchConstantBlocks(const Scene& scene)
+{
+    addCheck("constant_blocks/matches_buffers", [&scene]() {
+        Objects buffers;
+        Objects blocks;
+        blocks.useBlocks = true;
+
+        uint64_t                numBuffers      = 0;
+        uint64_t                numBlockBuffers = 0;
+        sgfx::null::DeviceStats expected;
+        sgfx::null::DeviceStats stats;
+        countObjects(scene, buffers, numBuffers, expected);
+        countObjects(scene, blocks, numBlockBuffers, stats);
+
+        // every block takes 256 bytes of a page
+        uint64_t numPages = (static_cast<uint64_t>(kNumBlockObjects) * 256 + kPageSize - 1) / kPageSize;
+
+        return checkEqual("buffers created per object", numBuffers, kNumBlockObjects)
+            && checkEqual("pages created for the blocks", numBlockBuffers, numPages)
+            && checkEqual("draws", stats.numDrawCalls, expected.numDrawCalls)
+            && checkEqual("constant buffer binds", stats.numConstantBufferBinds, expected.numConstantBufferBinds);
+    });
+
+    for (bool useBlocks : { false, true }) {
+        std::shared_ptr<Objects> objects = std::make_shared<Objects>();
+        objects->useBlocks = useBlocks;
+
+        addBenchmark(useBlocks ? "constant_blocks/create/blocks" : "constant_blocks/create/buffers", "object", kNumBlockObjects, 0, [objects]() {
+            auto start = Clock::now();
+            createObjects(*objects);
+            releaseObjects(*objects);
+            return getNanoseconds(start, Clock::now());
+        });
+
+        // the objects live from the first frame benchmark to the end of the run
+        auto frameObjects = [objects]() -> Objects& {
+            if (objects->buffers.empty() && objects->blocks.empty())
+                createObjects(*objects);
+            return *objects;
+        };
+        addCleanup([objects]() { releaseObjects(*objects); });
+
+        addBenchmark(useBlocks ? "constant_blocks/record/blocks" : "constant_blocks/record/buffers", "draw", kNumBlockObjects, 0, [&scene, frameObjects]() {
+            Objects& frame = frameObjects();
+
+            auto start = Clock::now();
+            recordObjectDraws(scene, frame);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(scene.drawQueue);
+            sgfx::present(0);
+            return ns;
+        });
+
+        addBenchmark(useBlocks ? "constant_blocks/submit/blocks" : "constant_blocks/submit/buffers", "draw", kNumBlockObjects, 0, [&scene, frameObjects]() {
+            recordObjectDraws(scene, frameObjects());
+
+            auto start = Clock::now();
+            sgfx::submit(scene.drawQueue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
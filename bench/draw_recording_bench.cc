@@ -0,0 +1,237 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// Parallel draw recording: one queue's draws split across 1-16 worker threads, each recording into
+// its own DrawRecorder and frame arena, then submitted on the main thread. The check submits a
+// frame per thread count and compares what reached the device with the single threaded one.
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+// runs a job on every worker thread and waits for all of them to finish
+class WorkerPool final
+{
+    std::vector<std::thread>        threads;
+    std::mutex                      mutex;
+    std::condition_variable         startSignal;
+    std::condition_variable         doneSignal;
+    std::function<void(uint32_t)>   job;
+    uint64_t                        generation = 0;
+    uint32_t                        numPending = 0;
+    bool                            quit       = false;
+
+    void threadMain(uint32_t index)
+    {
+        uint64_t seenGeneration = 0;
+
+        for (;;) {
+            std::function<void(uint32_t)> currentJob;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startSignal.wait(lock, [&] { return quit || generation != seenGeneration; });
+                if (quit)
+                    return;
+
+                seenGeneration = generation;
+                currentJob     = job;
+            }
+
+            currentJob(index);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--numPending == 0)
+                doneSignal.notify_one();
+        }
+    }
+
+public:
+
+    explicit WorkerPool(uint32_t numThreads)
+    {
+        for (uint32_t i = 0; i < numThreads; ++i)
+            threads.emplace_back(&WorkerPool::threadMain, this, i);
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        startSignal.notify_all();
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    void run(const std::function<void(uint32_t)>& newJob)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        job        = newJob;
+        numPending = static_cast<uint32_t>(threads.size());
+        generation++;
+        startSignal.notify_all();
+
+        doneSignal.wait(lock, [&] { return numPending == 0; });
+    }
+};
+
+//=============================================================================
+enum
+{
+    kNumRecorderDraws = 100000
+};
+
+// the queue, the recorders and arenas and the workers of one thread count, kept from run to run
+// so the arenas have grown to a frame's size like they would in a game
+struct RecordingSetup final
+{
+    uint32_t                              numThreads;
+    WorkerPool                            pool;
+    sgfx::DrawQueueHandle                 queue;
+    std::vector<sgfx::DrawRecorderHandle> recorders;
+    std::vector<sgfx::FrameArenaHandle>   arenas;
+
+    RecordingSetup(const Scene& scene, uint32_t newNumThreads)
+        : numThreads(newNumThreads)
+        , pool(newNumThreads)
+        , queue(sgfx::createDrawQueue(scene.pipeline.pipelineState))
+        , recorders(newNumThreads)
+        , arenas(newNumThreads)
+    {
+        for (uint32_t i = 0; i < numThreads; ++i) {
+            recorders[i] = sgfx::createDrawRecorder(queue);
+            arenas[i]    = sgfx::createFrameArena(0);
+        }
+
+        // every worker records into its own arena
+        pool.run([this](uint32_t index) { sgfx::setThreadFrameArena(arenas[index]); });
+    }
+
+    ~RecordingSetup()
+    {
+        pool.run([](uint32_t) { sgfx::setThreadFrameArena(sgfx::FrameArenaHandle::invalidHandle()); });
+
+        for (uint32_t i = 0; i < numThreads; ++i) {
+            sgfx::releaseDrawRecorder(recorders[i]);
+            sgfx::releaseFrameArena(arenas[i]);
+        }
+        sgfx::releaseDrawQueue(queue);
+    }
+};
+
+static std::vector<std::unique_ptr<RecordingSetup>> g_recordingSetups;
+
+// objects are drawn sorted by material, so neighbouring draws share most of their bindings
+static void recordDraws(const Scene& scene, sgfx::DrawRecorderHandle recorder, uint32_t first, uint32_t last)
+{
+    for (uint32_t i = first; i < last; ++i) {
+        sgfx::setPrimitiveTopology(recorder, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(recorder, scene.vertexBuffers[i % kNumChurnResources]);
+        sgfx::setIndexBuffer(recorder, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(recorder, 0, scene.constantBuffers[(i / 64) % 8]);
+        sgfx::setResource(recorder, 0, scene.textures[(i / 256) % 16]);
+        sgfx::drawIndexed(recorder, 3, 0, 0);
+    }
+}
+
+static void recordFrame(const Scene& scene, RecordingSetup& setup)
+{
+    setup.pool.run([&scene, &setup](uint32_t index) {
+        uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(kNumRecorderDraws) * index / setup.numThreads);
+        uint32_t last  = static_cast<uint32_t>(static_cast<uint64_t>(kNumRecorderDraws) * (index + 1) / setup.numThreads);
+        recordDraws(scene, setup.recorders[index], first, last);
+    });
+}
+
+void benchDrawRecorders(const Scene& scene)
+{
+    const uint32_t threadCounts[] = { 1, 2, 4, 8, 16 };
+
+    // the workers only start when a benchmark or the check of the area runs
+    auto getSetup = [&scene](uint32_t numThreads) -> RecordingSetup& {
+        for (const std::unique_ptr<RecordingSetup>& setup : g_recordingSetups)
+            if (setup->numThreads == numThreads)
+                return *setup;
+        g_recordingSetups.emplace_back(new RecordingSetup(scene, numThreads));
+        return *g_recordingSetups.back();
+    };
+    addCleanup([]() { g_recordingSetups.clear(); });
+
+    // the recorders' segments are merged in order, the device sees the draws and binds of a
+    // single threaded recording
+    addCheck("draw_recorder/matches_one_thread", [&scene, threadCounts, getSetup]() {
+        sgfx::null::DeviceStats expected = sgfx::null::DeviceStats();
+        for (uint32_t numThreads : threadCounts) {
+            RecordingSetup& setup = getSetup(numThreads);
+            recordFrame(scene, setup);
+            sgfx::null::DeviceStats stats = submitAndCount(setup.queue);
+
+            if (numThreads == 1)
+                expected = stats;
+            else if (std::memcmp(&stats, &expected, sizeof(stats)) != 0)
+                return checkFailed("%u threads: %llu draws and %llu input binds, one thread %llu and %llu", numThreads,
+                    static_cast<unsigned long long>(stats.numDrawCalls), static_cast<unsigned long long>(stats.numInputBinds),
+                    static_cast<unsigned long long>(expected.numDrawCalls), static_cast<unsigned long long>(expected.numInputBinds));
+        }
+        return checkEqual("draws", expected.numDrawCalls, kNumRecorderDraws);
+    });
+
+    for (uint32_t numThreads : threadCounts) {
+        char name[64];
+        snprintf(name, sizeof(name), "draw_recorder/record/%u_threads", numThreads);
+        addBenchmark(name, "draw", kNumRecorderDraws, 0, [&scene, numThreads, getSetup]() {
+            RecordingSetup& setup = getSetup(numThreads);
+
+            auto start = Clock::now();
+            recordFrame(scene, setup);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(setup.queue);
+            sgfx::present(0);
+            return ns;
+        });
+
+        // submit() walks the recorders' segments in order
+        snprintf(name, sizeof(name), "draw_recorder/submit/%u_threads", numThreads);
+        addBenchmark(name, "draw", kNumRecorderDraws, 0, [&scene, numThreads, getSetup]() {
+            RecordingSetup& setup = getSetup(numThreads);
+            recordFrame(scene, setup);
+
+            auto start = Clock::now();
+            sgfx::submit(setup.queue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,153 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// Sort keys: a scene whose draws are recorded in random material order is submitted as is, with
+// sort keys but unsorted, and sorted by key. The check makes sure SortByKey really groups the
+// draws, a sorted frame binds every texture once.
+
+#include <memory>
+#include <vector>
+#include <stdio.h>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumSortedDraws     = 100000,
+    kNumSortTextures    = 16,
+    kNumSortConstants   = 8
+};
+
+struct Object final
+{
+    uint32_t vertexBuffer;
+    uint32_t constantBuffer;
+    uint32_t texture;
+};
+
+// objects come in random material order, like a scene traversal would produce them
+static std::vector<Object> createObjects()
+{
+    uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    std::vector<Object> objects(kNumSortedDraws);
+    for (Object& object : objects) {
+        object.texture        = random() % kNumSortTextures;
+        object.vertexBuffer   = random() % kNumChurnResources;
+        object.constantBuffer = random() % kNumSortConstants;
+    }
+    return objects;
+}
+
+// texture changes cost the most, then vertex buffers, then constant buffers
+static uint64_t makeSortKey(const Object& object)
+{
+    return (static_cast<uint64_t>(object.texture) << 40) | (static_cast<uint64_t>(object.vertexBuffer) << 20) | object.constantBuffer;
+}
+
+static void recordObjects(const Scene& scene, const std::vector<Object>& objects, bool useSortKeys)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+    for (const Object& object : objects) {
+        if (useSortKeys)
+            sgfx::setSortKey(queue, makeSortKey(object));
+
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[object.vertexBuffer]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[object.constantBuffer]);
+        sgfx::setResource(queue, 0, scene.textures[object.texture]);
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+void benchDrawSort(const Scene& scene)
+{
+    std::shared_ptr<const std::vector<Object>> objects = std::make_shared<const std::vector<Object>>(createObjects());
+
+    // every mode submits every draw, the sorted one a texture bind per texture and the unbind at
+    // the end of the queue, for the vertex and the pixel shader
+    addCheck("draw_sort/sorted_by_texture", [&scene, objects]() {
+        recordObjects(scene, *objects, false);
+        sgfx::null::DeviceStats unsorted = submitAndCount(scene.drawQueue);
+
+        recordObjects(scene, *objects, true);
+        sgfx::null::DeviceStats sorted = submitAndCount(scene.drawQueue, sgfx::SubmitFlags::SortByKey);
+
+        return checkEqual("unsorted draws", unsorted.numDrawCalls, kNumSortedDraws)
+            && checkEqual("sorted draws", sorted.numDrawCalls, kNumSortedDraws)
+            && checkEqual("sorted indices", sorted.numPrimitives, unsorted.numPrimitives)
+            && checkEqual("sorted texture binds", sorted.numResourceBinds, 2 * (kNumSortTextures + 1));
+    });
+
+    struct Mode
+    {
+        const char* name;
+        bool        useSortKeys;
+        uint32_t    submitFlags;
+    };
+
+    const Mode modes[] = {
+        { "no_keys",       false, 0 },
+        { "keys_unsorted", true,  0 },
+        { "keys_sorted",   true,  sgfx::SubmitFlags::SortByKey }
+    };
+
+    // recording with keys costs the same sorted or not
+    for (bool useSortKeys : { false, true }) {
+        char name[64];
+        snprintf(name, sizeof(name), "draw_sort/record/%s", useSortKeys ? "keys" : "no_keys");
+        addBenchmark(name, "draw", kNumSortedDraws, 0, [&scene, objects, useSortKeys]() {
+            auto start = Clock::now();
+            recordObjects(scene, *objects, useSortKeys);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(scene.drawQueue);
+            sgfx::present(0);
+            return ns;
+        });
+    }
+
+    for (const Mode& mode : modes) {
+        bool     useSortKeys = mode.useSortKeys;
+        uint32_t submitFlags = mode.submitFlags;
+
+        char name[64];
+        snprintf(name, sizeof(name), "draw_sort/submit/%s", mode.name);
+        addBenchmark(name, "draw", kNumSortedDraws, 0, [&scene, objects, useSortKeys, submitFlags]() {
+            recordObjects(scene, *objects, useSortKeys);
+
+            auto start = Clock::now();
+            sgfx::submit(scene.drawQueue, submitFlags);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,223 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// SGFX_NS_INTERNAL::DynamicArray against std::vector: appends of trivially copyable and
+// non-trivial elements, ordered removal and swap-removal from the middle. The check runs the same
+// operations on both containers and compares what they hold after every step.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifndef SGFX_NS_INTERNAL
+#define SGFX_NS_INTERNAL sgfx_ns_null_internal
+#endif
+
+#ifndef SGFX_INTERNAL_IMPLEMENTATION
+#define SGFX_INTERNAL_IMPLEMENTATION 1
+#endif
+
+#ifdef _MSC_VER
+#   ifndef SGFX_FORCE_INLINE
+#   define SGFX_FORCE_INLINE __forceinline
+#   endif
+#else
+#   ifndef SGFX_FORCE_INLINE
+#   define SGFX_FORCE_INLINE inline __attribute__((always_inline))
+#   endif
+#endif
+
+#include "sgfx_bench.hh"
+
+using sgfx::SGFX_NS_INTERNAL::DynamicArray;
+
+//=============================================================================
+struct Payload64 final
+{
+    uint64_t data[8];
+
+    bool operator==(const Payload64& other) const { return std::equal(data, data + 8, other.data); }
+};
+
+// element i of the arrays, function objects so the appends inline them
+struct MakeUint32 final
+{
+    uint32_t operator()(size_t i) const { return static_cast<uint32_t>(i); }
+};
+
+struct MakePayload final
+{
+    Payload64 operator()(size_t i) const
+    {
+        Payload64 payload;
+        for (size_t k = 0; k < 8; ++k)
+            payload.data[k] = i + k;
+        return payload;
+    }
+};
+
+// longer than the small string buffer, every element owns memory
+struct MakeString final
+{
+    std::string operator()(size_t i) const { return std::string(24, static_cast<char>('a' + i % 26)); }
+};
+
+// the two containers behind one set of calls
+template <typename T> static void   addElement(DynamicArray<T>& array, T&& element) { array.Add(std::move(element)); }
+template <typename T> static void   addElement(std::vector<T>&  array, T&& element) { array.push_back(std::move(element)); }
+template <typename T> static size_t getSize(const DynamicArray<T>& array)           { return array.GetSize(); }
+template <typename T> static size_t getSize(const std::vector<T>&  array)           { return array.size(); }
+
+template <typename T> static void removeOrdered(DynamicArray<T>& array, size_t index) { array.Remove(index); }
+template <typename T> static void removeOrdered(std::vector<T>&  array, size_t index) { array.erase(array.begin() + index); }
+template <typename T> static void removeSwap(DynamicArray<T>& array, size_t index)    { array.RemoveSwap(index); }
+
+template <typename T>
+static void removeSwap(std::vector<T>& array, size_t index)
+{
+    array[index] = std::move(array.back());
+    array.pop_back();
+}
+
+//=============================================================================
+// the element counts are template arguments, the compiler unrolls the uint32 appends for a known
+// count like it would in the code the benchmark stands for
+template <typename Array, uint64_t kNumElements, typename Make>
+static void addAppendBenchmark(const char* name, Make make)
+{
+    addBenchmark(name, "element", kNumElements, 0, [make]() {
+        auto start = Clock::now();
+        Array array;
+        for (uint64_t i = 0; i < kNumElements; ++i)
+            addElement(array, make(i));
+        g_sink += getSize(array);
+        return getNanoseconds(start, Clock::now());
+    });
+}
+
+// removals hit the middle element, the array is refilled outside of the timed part
+template <typename Array, uint64_t kNumElements, typename Make>
+static void addRemoveBenchmark(const char* name, bool swapRemove, Make make)
+{
+    addBenchmark(name, "element", kNumElements, 0, [swapRemove, make]() {
+        Array array;
+        for (uint64_t i = 0; i < kNumElements; ++i)
+            addElement(array, make(i));
+
+        auto start = Clock::now();
+        for (size_t size = getSize(array); size != 0; --size) {
+            if (swapRemove)
+                removeSwap(array, size / 2);
+            else
+                removeOrdered(array, size / 2);
+        }
+        return getNanoseconds(start, Clock::now());
+    });
+}
+
+//=============================================================================
+template <typename T>
+static bool isSame(const char* step, const DynamicArray<T>& array, const std::vector<T>& vector)
+{
+    if (array.GetSize() == vector.size() && std::equal(vector.begin(), vector.end(), array.begin()))
+        return true;
+    return checkFailed("%s: DynamicArray holds %zu elements, std::vector %zu, or they differ", step, array.GetSize(), vector.size());
+}
+
+// appends past the inplace storage and a few growths, removals of both kinds, copies and moves
+template <typename T, typename Make>
+static bool checkAgainstVector(const Make& make)
+{
+    DynamicArray<T> array;
+    std::vector<T>  vector;
+
+    for (size_t i = 0; i < 1000; ++i) {
+        addElement(array, make(i));
+        addElement(vector, make(i));
+    }
+    if (!isSame("add", array, vector))
+        return false;
+
+    for (size_t i = 0; i < 300; ++i) {
+        size_t index = (i * 7919) % vector.size();
+        removeOrdered(array, index);
+        removeOrdered(vector, index);
+    }
+    if (!isSame("remove", array, vector))
+        return false;
+
+    for (size_t i = 0; i < 300; ++i) {
+        size_t index = (i * 104729) % vector.size();
+        removeSwap(array, index);
+        removeSwap(vector, index);
+    }
+    if (!isSame("remove swap", array, vector))
+        return false;
+
+    DynamicArray<T> copy(array);
+    if (!isSame("copy", copy, vector))
+        return false;
+
+    DynamicArray<T> moved(std::move(copy));
+    if (!isSame("move", moved, vector))
+        return false;
+    if (!copy.IsEmpty())
+        return checkFailed("move: the moved from array still holds %zu elements", copy.GetSize());
+
+    array = moved;
+    array.Resize(10);
+    vector.resize(10);
+    return isSame("resize", array, vector);
+}
+
+void benchDynamicArray()
+{
+    addCheck("dynamic_array/matches_std_vector", []() {
+        return checkAgainstVector<uint32_t>(MakeUint32())
+            && checkAgainstVector<Payload64>(MakePayload())
+            && checkAgainstVector<std::string>(MakeString());
+    });
+
+    const uint64_t kNumAppends        = 1000000;
+    const uint64_t kNumPodAppends     = 250000;
+    const uint64_t kNumStringAppends  = 100000;
+    const uint64_t kNumOrderedRemoves = 20000;
+    const uint64_t kNumPodRemoves     = 4000;  // every removal moves half the array
+    const uint64_t kNumSwapRemoves    = 1000000;
+
+    addAppendBenchmark<DynamicArray<uint32_t>,    kNumAppends>      ("dynamic_array/add_uint32", MakeUint32());
+    addAppendBenchmark<std::vector<uint32_t>,     kNumAppends>      ("std_vector/add_uint32",    MakeUint32());
+    addAppendBenchmark<DynamicArray<Payload64>,   kNumPodAppends>   ("dynamic_array/add_pod64",  MakePayload());
+    addAppendBenchmark<std::vector<Payload64>,    kNumPodAppends>   ("std_vector/add_pod64",     MakePayload());
+    addAppendBenchmark<DynamicArray<std::string>, kNumStringAppends>("dynamic_array/add_string", MakeString());
+    addAppendBenchmark<std::vector<std::string>,  kNumStringAppends>("std_vector/add_string",    MakeString());
+
+    addRemoveBenchmark<DynamicArray<uint32_t>,  kNumOrderedRemoves>("dynamic_array/remove_ordered_uint32", false, MakeUint32());
+    addRemoveBenchmark<std::vector<uint32_t>,   kNumOrderedRemoves>("std_vector/remove_ordered_uint32",    false, MakeUint32());
+    addRemoveBenchmark<DynamicArray<Payload64>, kNumPodRemoves>    ("dynamic_array/remove_ordered_pod64",  false, MakePayload());
+    addRemoveBenchmark<std::vector<Payload64>,  kNumPodRemoves>    ("std_vector/remove_ordered_pod64",     false, MakePayload());
+    addRemoveBenchmark<DynamicArray<uint32_t>,  kNumSwapRemoves>   ("dynamic_array/remove_swap_uint32",    true,  MakeUint32());
+    addRemoveBenchmark<std::vector<uint32_t>,   kNumSwapRemoves>   ("std_vector/remove_swap_uint32",       true,  MakeUint32());
+    addRemoveBenchmark<DynamicArray<Payload64>, kNumPodAppends>    ("dynamic_array/remove_swap_pod64",     true,  MakePayload());
+    addRemoveBenchmark<std::vector<Payload64>,  kNumPodAppends>    ("std_vector/remove_swap_pod64",        true,  MakePayload());
+}
@@ -0,0 +1,163 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// kNumStatsQueues queues with their own pipeline state draw kNumStatsDraws meshes each, with a
+// constant buffer update per queue and a texture update per frame. The benchmark times the
+// submits, sgfx_bench_nostats runs it on a library built with SGFX_ENABLE_STATS=0. The check
+// compares the counters getFrameStats() reports with the null device stats, which count the same
+// events on their own, and makes sure they stay zero when the stats are compiled out.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumStatsQueues     = 4,
+    kNumStatsDraws      = 25000,
+    kNumStatsTextures   = 16,
+    kStatsTextureSize   = 64
+};
+
+struct StatsScene final
+{
+    sgfx::PipelineStateHandle   pipelineStates[kNumStatsQueues];
+    sgfx::DrawQueueHandle       drawQueues[kNumStatsQueues];
+    sgfx::TextureHandle         textures[kNumStatsTextures];
+
+    std::vector<uint8_t>        texels;
+    uint32_t                    frame = 0;
+};
+
+static void createStatsScene(StatsScene& stats, const Scene& scene)
+{
+    // the passes only differ in their state
+    for (uint32_t i = 0; i < kNumStatsQueues; ++i) {
+        sgfx::PipelineStateDescriptor desc;
+        desc.shader       = scene.pipeline.surfaceShader;
+        desc.vertexFormat = scene.pipeline.vertexFormat;
+        desc.rasterizerState.cullMode = (i % 2 == 0) ? sgfx::CullMode::Back : sgfx::CullMode::None;
+
+        stats.pipelineStates[i] = sgfx::createPipelineState(desc);
+        stats.drawQueues[i]     = sgfx::createDrawQueue(stats.pipelineStates[i]);
+    }
+
+    for (sgfx::TextureHandle& texture : stats.textures)
+        texture = sgfx::createTexture2D(kStatsTextureSize, kStatsTextureSize, sgfx::DataFormat::RGBA8, 1, 0);
+
+    stats.texels.resize(kStatsTextureSize * kStatsTextureSize * 4, 0x80);
+}
+
+static void releaseStatsScene(StatsScene& stats)
+{
+    for (sgfx::TextureHandle& texture : stats.textures)
+        sgfx::releaseTexture(texture);
+
+    for (uint32_t i = 0; i < kNumStatsQueues; ++i) {
+        sgfx::releaseDrawQueue(stats.drawQueues[i]);
+        sgfx::releasePipelineState(stats.pipelineStates[i]);
+    }
+}
+
+// bindings change at different rates, most constant buffer and texture binds are redundant
+static void recordStatsQueue(const Scene& scene, const StatsScene& stats, uint32_t queueIndex)
+{
+    sgfx::DrawQueueHandle queue = stats.drawQueues[queueIndex];
+
+    for (uint32_t i = 0; i < kNumStatsDraws; ++i) {
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[(i / 4) % kNumChurnResources]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[(i / 64) % 8]);
+        sgfx::setResource(queue, 0, stats.textures[(i / 256) % kNumStatsTextures]);
+        sgfx::drawIndexedInstanced(queue, 1 + queueIndex, 3, 0, 0, 0);
+    }
+}
+
+// the submits and updates of a frame, the device stats are read before present() starts the next
+static double submitStatsFrame(const Scene& scene, StatsScene& stats, sgfx::null::DeviceStats* deviceStats)
+{
+    uint32_t frame = stats.frame++;
+
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < kNumStatsQueues; ++i) {
+        float constants[64] = { static_cast<float>(frame) };
+        sgfx::updateConstantBuffer(scene.constantBuffers[i], constants);
+        sgfx::submit(stats.drawQueues[i]);
+    }
+    double ns = getNanoseconds(start, Clock::now());
+
+    sgfx::updateTexture(stats.textures[frame % kNumStatsTextures], stats.texels.data(), 0, 0, kStatsTextureSize, 0, kStatsTextureSize, 0, 1, kStatsTextureSize * 4, 0);
+
+    if (deviceStats != nullptr)
+        *deviceStats = sgfx::null::getDeviceStats();
+    sgfx::present(0);
+    return ns;
+}
+
+void benchFrameStats(const Scene& scene)
+{
+    std::shared_ptr<StatsScene> stats = std::make_shared<StatsScene>();
+    createStatsScene(*stats, scene);
+    addCleanup([stats]() { releaseStatsScene(*stats); });
+
+    addCheck("frame_stats/matches_device_stats", [&scene, stats]() {
+        // the areas created their resources in the frame running now, the check counts one of its own
+        sgfx::present(0);
+        sgfx::null::resetDeviceStats();
+        for (uint32_t i = 0; i < kNumStatsQueues; ++i)
+            recordStatsQueue(scene, *stats, i);
+
+        sgfx::null::DeviceStats device;
+        submitStatsFrame(scene, *stats, &device);
+
+        const sgfx::FrameStats& frame = sgfx::getFrameStats();
+#if SGFX_ENABLE_STATS
+        uint64_t numQueueDraws = 0;
+        for (uint32_t i = 0; i < kNumStatsQueues; ++i)
+            numQueueDraws += sgfx::getQueueStats(stats->drawQueues[i]).numDrawCalls;
+
+        return checkEqual("draws", frame.numDrawCalls, device.numDrawCalls)
+            && checkEqual("draws of the queues", numQueueDraws, device.numDrawCalls)
+            && checkEqual("primitives", frame.numPrimitives, device.numPrimitives)
+            && checkEqual("pipeline state changes", frame.numPipelineStateChanges, device.numPipelineStateChanges)
+            && checkEqual("input binds", frame.numInputBinds, device.numInputBinds)
+            && checkEqual("bytes uploaded", frame.numBytesUploaded, device.numBytesUploaded);
+#else
+        sgfx::FrameStats zero;
+        std::memset(&zero, 0, sizeof(zero));
+        if (std::memcmp(&frame, &zero, sizeof(zero)) != 0)
+            return checkFailed("the frame stats count %u draws with the stats compiled out", frame.numDrawCalls);
+        return checkEqual("device draws", device.numDrawCalls, kNumStatsQueues * kNumStatsDraws);
+#endif
+    });
+
+    addBenchmark("frame_stats/submit", "draw", kNumStatsQueues * kNumStatsDraws, 0, [&scene, stats]() {
+        for (uint32_t i = 0; i < kNumStatsQueues; ++i)
+            recordStatsQueue(scene, *stats, i);
+        return submitStatsFrame(scene, *stats, nullptr);
+    });
+}
@@ -0,0 +1,202 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// kNumIndexedMeshes meshes of kNumMeshVertices vertices, small enough for 16-bit indices, stored
+// and drawn four ways:
+//   separate_32         a vertex and a 32-bit index buffer per mesh
+//   separate_16         a vertex and a 16-bit index buffer per mesh
+//   shared_offsets      every mesh suballocated from one vertex and one index buffer, bound by offset
+//   shared_base_vertex  the same buffers bound once, the meshes drawn with startIndex/startVertex
+// The benchmarks record and submit a frame. The check counts the buffers every layout creates and
+// makes sure all of them draw the same primitives.
+
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumIndexedMeshes   = 2000,
+    kNumMeshVertices    = 4000,
+    kNumMeshIndices     = 18000
+};
+
+enum class MeshLayout
+{
+    Separate32,
+    Separate16,
+    SharedOffsets,
+    SharedBaseVertex
+};
+
+struct Meshes final
+{
+    MeshLayout                      layout;
+    std::vector<sgfx::BufferHandle> vertexBuffers;
+    std::vector<sgfx::BufferHandle> indexBuffers;
+};
+
+static void createMeshes(Meshes& meshes, MeshLayout layout)
+{
+    meshes.layout = layout;
+
+    const size_t vertexSize = 3 * sizeof(float);
+    const size_t indexSize  = (layout == MeshLayout::Separate32) ? sizeof(uint32_t) : sizeof(uint16_t);
+
+    std::vector<float>    vertices(kNumMeshVertices * 3, 0.0F);
+    std::vector<uint32_t> indices32(kNumMeshIndices);
+    std::vector<uint16_t> indices16(kNumMeshIndices);
+    for (uint32_t i = 0; i < kNumMeshIndices; ++i) {
+        indices32[i] = i % kNumMeshVertices;
+        indices16[i] = static_cast<uint16_t>(i % kNumMeshVertices);
+    }
+
+    const void* indexData = (indexSize == sizeof(uint32_t)) ? static_cast<const void*>(indices32.data()) : indices16.data();
+
+    if (layout == MeshLayout::Separate32 || layout == MeshLayout::Separate16) {
+        for (uint32_t i = 0; i < kNumIndexedMeshes; ++i) {
+            meshes.vertexBuffers.push_back(sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, vertices.data(), vertexSize * kNumMeshVertices, vertexSize));
+            meshes.indexBuffers.push_back(sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, indexData, indexSize * kNumMeshIndices, indexSize));
+        }
+        return;
+    }
+
+    // one buffer each, the meshes are copied in one after the other
+    sgfx::BufferHandle vertexBuffer = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, nullptr, vertexSize * kNumMeshVertices * kNumIndexedMeshes, vertexSize);
+    sgfx::BufferHandle indexBuffer  = sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, nullptr, indexSize * kNumMeshIndices * kNumIndexedMeshes, indexSize);
+
+    for (uint32_t i = 0; i < kNumIndexedMeshes; ++i) {
+        sgfx::copyBufferData(vertexBuffer, vertexSize * kNumMeshVertices * i, vertexSize * kNumMeshVertices, vertices.data());
+        sgfx::copyBufferData(indexBuffer, indexSize * kNumMeshIndices * i, indexSize * kNumMeshIndices, indexData);
+    }
+
+    meshes.vertexBuffers.push_back(vertexBuffer);
+    meshes.indexBuffers.push_back(indexBuffer);
+}
+
+static void releaseMeshes(Meshes& meshes)
+{
+    for (sgfx::BufferHandle buffer : meshes.vertexBuffers)
+        sgfx::releaseBuffer(buffer);
+    for (sgfx::BufferHandle buffer : meshes.indexBuffers)
+        sgfx::releaseBuffer(buffer);
+    meshes.vertexBuffers.clear();
+    meshes.indexBuffers.clear();
+}
+
+static void recordMeshDraws(const Meshes& meshes, sgfx::DrawQueueHandle queue)
+{
+    const uint32_t vertexSize = 3 * sizeof(float);
+
+    for (uint32_t i = 0; i < kNumIndexedMeshes; ++i) {
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+
+        switch (meshes.layout) {
+        case MeshLayout::Separate32: {
+            sgfx::setVertexBuffer(queue, meshes.vertexBuffers[i]);
+            sgfx::setIndexBuffer(queue, meshes.indexBuffers[i]);
+            sgfx::drawIndexed(queue, kNumMeshIndices, 0, 0);
+        } break;
+
+        case MeshLayout::Separate16: {
+            sgfx::setVertexBuffer(queue, meshes.vertexBuffers[i]);
+            sgfx::setIndexBuffer(queue, meshes.indexBuffers[i], 0, sgfx::IndexFormat::UInt16);
+            sgfx::drawIndexed(queue, kNumMeshIndices, 0, 0);
+        } break;
+
+        case MeshLayout::SharedOffsets: {
+            sgfx::setVertexBuffer(queue, meshes.vertexBuffers[0], 0, vertexSize * kNumMeshVertices * i);
+            sgfx::setIndexBuffer(queue, meshes.indexBuffers[0], sizeof(uint16_t) * kNumMeshIndices * i, sgfx::IndexFormat::UInt16);
+            sgfx::drawIndexed(queue, kNumMeshIndices, 0, 0);
+        } break;
+
+        case MeshLayout::SharedBaseVertex: {
+            sgfx::setVertexBuffer(queue, meshes.vertexBuffers[0]);
+            sgfx::setIndexBuffer(queue, meshes.indexBuffers[0], 0, sgfx::IndexFormat::UInt16);
+            sgfx::drawIndexed(queue, kNumMeshIndices, kNumMeshIndices * i, kNumMeshVertices * i);
+        } break;
+        }
+    }
+}
+
+struct MeshLayoutName final
+{
+    MeshLayout  layout;
+    const char* name;
+    uint64_t    numBuffers; // created for the meshes
+};
+
+static const MeshLayoutName kMeshLayouts[] = {
+    { MeshLayout::Separate32,       "index_format/separate_32",        2 * kNumIndexedMeshes },
+    { MeshLayout::Separate16,       "index_format/separate_16",        2 * kNumIndexedMeshes },
+    { MeshLayout::SharedOffsets,    "index_format/shared_offsets",     2 },
+    { MeshLayout::SharedBaseVertex, "index_format/shared_base_vertex", 2 }
+};
+
+void benchIndexFormats(const Scene& scene)
+{
+    addCheck("index_format/same_primitives", [&scene]() {
+        for (const MeshLayoutName& layout : kMeshLayouts) {
+            Meshes meshes;
+
+            sgfx::null::resetDeviceStats();
+            createMeshes(meshes, layout.layout);
+            uint64_t numBuffers = sgfx::null::getDeviceStats().numBuffersCreated;
+
+            recordMeshDraws(meshes, scene.drawQueue);
+            sgfx::null::DeviceStats stats = submitAndCount(scene.drawQueue);
+            releaseMeshes(meshes);
+
+            if (!checkEqual(layout.name, numBuffers, layout.numBuffers)
+                || !checkEqual("draws", stats.numDrawCalls, kNumIndexedMeshes)
+                || !checkEqual("primitives", stats.numPrimitives, static_cast<uint64_t>(kNumIndexedMeshes) * kNumMeshIndices))
+                return false;
+        }
+        return true;
+    });
+
+    // a layout takes a few hundred MB, only the one being measured is kept
+    std::shared_ptr<Meshes> meshes = std::make_shared<Meshes>();
+    addCleanup([meshes]() { releaseMeshes(*meshes); });
+
+    for (const MeshLayoutName& layout : kMeshLayouts) {
+        MeshLayout meshLayout = layout.layout;
+
+        addBenchmark(layout.name, "draw", kNumIndexedMeshes, 0, [&scene, meshes, meshLayout]() {
+            if (meshes->vertexBuffers.empty() || meshes->layout != meshLayout) {
+                releaseMeshes(*meshes);
+                createMeshes(*meshes, meshLayout);
+            }
+
+            auto start = Clock::now();
+            recordMeshDraws(*meshes, scene.drawQueue);
+            sgfx::submit(scene.drawQueue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
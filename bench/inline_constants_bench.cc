@@ -0,0 +1,147 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// every draw gets its own 64 bytes of object constants, written into a constant buffer per object
+// with updateConstantBuffer(), and recorded straight into the queue with setInlineConstants() and
+// streamed into the ring at submit. The check makes sure the inline constants bind and upload
+// what the constant buffers do.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumInlineDraws = 100000
+};
+
+struct ObjectConstants final
+{
+    float transform[16];
+};
+
+struct ObjectBuffers final
+{
+    sgfx::ConstantBufferHandle              frameConstants;
+    std::vector<sgfx::ConstantBufferHandle> objectConstants; // one per draw
+    uint32_t                                frame = 0;
+};
+
+static void createObjectBuffers(ObjectBuffers& buffers)
+{
+    buffers.frameConstants = sgfx::createConstantBuffer(nullptr, 256);
+
+    buffers.objectConstants.resize(kNumInlineDraws);
+    for (sgfx::ConstantBufferHandle& buffer : buffers.objectConstants)
+        buffer = sgfx::createConstantBuffer(nullptr, sizeof(ObjectConstants));
+}
+
+static void releaseObjectBuffers(ObjectBuffers& buffers)
+{
+    for (sgfx::ConstantBufferHandle& buffer : buffers.objectConstants)
+        sgfx::releaseConstantBuffer(buffer);
+    sgfx::releaseConstantBuffer(buffers.frameConstants);
+}
+
+static void recordObjectDraws(const Scene& scene, ObjectBuffers& buffers, bool useInlineConstants)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+    uint32_t              frame = buffers.frame++;
+
+    ObjectConstants constants;
+    std::memset(&constants, 0, sizeof(constants));
+
+    for (uint32_t i = 0; i < kNumInlineDraws; ++i) {
+        constants.transform[0]  = 1.0F;
+        constants.transform[5]  = 1.0F;
+        constants.transform[10] = 1.0F;
+        constants.transform[12] = static_cast<float>(i);
+        constants.transform[13] = static_cast<float>(frame);
+        constants.transform[15] = 1.0F;
+
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[0]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(queue, 0, buffers.frameConstants);
+
+        if (useInlineConstants) {
+            sgfx::setInlineConstants(queue, 1, &constants, sizeof(constants));
+        } else {
+            sgfx::updateConstantBuffer(buffers.objectConstants[i], &constants);
+            sgfx::setConstantBuffer(queue, 1, buffers.objectConstants[i]);
+        }
+
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+void benchInlineConstants(const Scene& scene)
+{
+    std::shared_ptr<ObjectBuffers> buffers = std::make_shared<ObjectBuffers>();
+    createObjectBuffers(*buffers);
+    addCleanup([buffers]() { releaseObjectBuffers(*buffers); });
+
+    addCheck("inline_constants/matches_constant_buffers", [&scene, buffers]() {
+        recordObjectDraws(scene, *buffers, false);
+        sgfx::null::DeviceStats expected = submitAndCount(scene.drawQueue);
+
+        recordObjectDraws(scene, *buffers, true);
+        sgfx::null::DeviceStats inlined = submitAndCount(scene.drawQueue);
+
+        // the ring takes every draw's constants, a range split where the ring wraps counts twice
+        uint64_t numBytes = static_cast<uint64_t>(kNumInlineDraws) * sizeof(ObjectConstants);
+        if (inlined.numInlineConstantUploads < kNumInlineDraws || inlined.numBytesUploaded < numBytes)
+            return checkFailed("%llu bytes in %llu ranges streamed, at least %llu in %u expected",
+                static_cast<unsigned long long>(inlined.numBytesUploaded), static_cast<unsigned long long>(inlined.numInlineConstantUploads),
+                static_cast<unsigned long long>(numBytes), static_cast<uint32_t>(kNumInlineDraws));
+
+        return checkEqual("draws", inlined.numDrawCalls, expected.numDrawCalls)
+            && checkEqual("constant buffer binds", inlined.numConstantBufferBinds, expected.numConstantBufferBinds);
+    });
+
+    for (bool useInlineConstants : { false, true }) {
+        addBenchmark(useInlineConstants ? "inline_constants/record/inline" : "inline_constants/record/buffers", "draw", kNumInlineDraws, 0, [&scene, buffers, useInlineConstants]() {
+            auto start = Clock::now();
+            recordObjectDraws(scene, *buffers, useInlineConstants);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(scene.drawQueue);
+            sgfx::present(0);
+            return ns;
+        });
+
+        addBenchmark(useInlineConstants ? "inline_constants/submit/inline" : "inline_constants/submit/buffers", "draw", kNumInlineDraws, 0, [&scene, buffers, useInlineConstants]() {
+            recordObjectDraws(scene, *buffers, useInlineConstants);
+
+            auto start = Clock::now();
+            sgfx::submit(scene.drawQueue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
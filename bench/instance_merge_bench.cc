@@ -0,0 +1,289 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// Instance merging: a foliage-like scene draws every object with its own drawIndexedInstanced
+// call, the per-object data lives in one instance buffer indexed by startInstance. The queue is
+// submitted as is, with MergeInstances, and recorded in random order with sort keys so that
+// SortByKey brings the mergeable draws back together. The draw_indexed modes draw every object
+// on its own and pass its data as inline constants, the pipeline reads them from an instance
+// buffer so MergeInstances turns the runs into instanced draws.
+//
+// the checks count the merged draws and read the packed per-instance data back from the
+// transient ring, every object's constants have to be there exactly once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <stdio.h>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumObjects         = 100000,
+    kNumMeshes          = 16,
+    kNumIndicesPerMesh  = 36,
+    kNumPackedObjects   = 2000  // the packed data check reads back this many
+};
+
+struct InstancedScene final
+{
+    Pipeline                    pipeline;
+    Pipeline                    inlinePipeline; // inline constants at slot 1 read per instance
+
+    sgfx::BufferHandle          vertexBuffer;
+    sgfx::BufferHandle          instanceBuffer;
+    sgfx::BufferHandle          indexBuffer;
+
+    std::vector<uint32_t>       sequential;
+    std::vector<uint32_t>       shuffled;
+};
+
+static void createInstancedScene(InstancedScene& scene)
+{
+    sgfx::VertexElementDescriptor elements[] = {
+        { "POSITION", 0, sgfx::DataFormat::RGB32F,  0, 0, false },
+        { "OFFSET",   0, sgfx::DataFormat::RGBA32F, 1, 0, true  }
+    };
+    createPipeline(scene.pipeline, sgfx::PipelineStateDescriptor(), elements, 2);
+
+    sgfx::PipelineStateDescriptor desc;
+    desc.instanceConstantsSlot = 1;
+    desc.instanceVertexSlot    = 1;
+    createPipeline(scene.inlinePipeline, desc, elements, 2);
+
+    std::vector<float>    vertices(kNumMeshes * kNumIndicesPerMesh * 3, 0.0F);
+    std::vector<float>    instances(kNumObjects * 4, 0.0F);
+    std::vector<uint32_t> indices(kNumMeshes * kNumIndicesPerMesh);
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = static_cast<uint32_t>(i);
+
+    scene.vertexBuffer   = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, vertices.data(), vertices.size() * sizeof(float), 12);
+    scene.instanceBuffer = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, instances.data(), instances.size() * sizeof(float), 16);
+    scene.indexBuffer    = sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, indices.data(), indices.size() * sizeof(uint32_t), 4);
+
+    scene.sequential.resize(kNumObjects);
+    for (uint32_t i = 0; i < kNumObjects; ++i)
+        scene.sequential[i] = i;
+
+    scene.shuffled = scene.sequential;
+    uint32_t seed = 12345;
+    for (uint32_t i = kNumObjects - 1; i > 0; --i) {
+        seed = seed * 1664525u + 1013904223u;
+        std::swap(scene.shuffled[i], scene.shuffled[(seed >> 8) % (i + 1)]);
+    }
+}
+
+static void releaseInstancedScene(InstancedScene& scene)
+{
+    sgfx::releaseBuffer(scene.vertexBuffer);
+    sgfx::releaseBuffer(scene.instanceBuffer);
+    sgfx::releaseBuffer(scene.indexBuffer);
+
+    releasePipeline(scene.inlinePipeline);
+    releasePipeline(scene.pipeline);
+}
+
+// objects are laid out in the instance buffer grouped by mesh
+static inline uint32_t getMesh(uint32_t object)
+{
+    return std::min<uint32_t>(object / (kNumObjects / kNumMeshes), kNumMeshes - 1);
+}
+
+static void recordObject(const Scene& scene, const InstancedScene& instanced, sgfx::DrawQueueHandle queue, uint32_t object)
+{
+    uint32_t mesh = getMesh(object);
+
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+    sgfx::setVertexBuffer(queue, instanced.vertexBuffer);
+    sgfx::setIndexBuffer(queue, instanced.indexBuffer);
+    sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[0]);
+    sgfx::setResource(queue, 0, scene.textures[mesh]);
+    sgfx::drawIndexedInstanced(queue, 1, kNumIndicesPerMesh, mesh * kNumIndicesPerMesh, 0, object);
+}
+
+static void recordObjectInline(const Scene& scene, const InstancedScene& instanced, sgfx::DrawQueueHandle queue, uint32_t object)
+{
+    uint32_t mesh = getMesh(object);
+    float    offset[4] = { static_cast<float>(object), 0.0F, 0.0F, 1.0F };
+
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+    sgfx::setVertexBuffer(queue, instanced.vertexBuffer);
+    sgfx::setIndexBuffer(queue, instanced.indexBuffer);
+    sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[0]);
+    sgfx::setResource(queue, 0, scene.textures[mesh]);
+    sgfx::setInlineConstants(queue, 1, offset, sizeof(offset));
+    sgfx::drawIndexed(queue, kNumIndicesPerMesh, mesh * kNumIndicesPerMesh, 0);
+}
+
+struct MergeMode final
+{
+    const char* name;
+    bool        shuffled;         // recorded in random order with sort keys
+    bool        inlineConstants;  // drawIndexed with inline constants instead of instanced draws
+    uint32_t    submitFlags;
+    uint32_t    numMergedDraws;   // what reaches the device
+};
+
+static void recordObjects(const Scene& scene, const InstancedScene& instanced, sgfx::DrawQueueHandle queue, const MergeMode& mode, size_t numObjects)
+{
+    const std::vector<uint32_t>& order = mode.shuffled ? instanced.shuffled : instanced.sequential;
+    for (size_t i = 0; i < numObjects; ++i) {
+        uint32_t object = order[i];
+        if (mode.shuffled)
+            sgfx::setSortKey(queue, object);
+
+        if (mode.inlineConstants)
+            recordObjectInline(scene, instanced, queue, object);
+        else
+            recordObject(scene, instanced, queue, object);
+    }
+}
+
+// the merged runs' inline constants between two allocations of the transient ring, the null
+// backend keeps its buffers in host memory; false if the ring started a new buffer in between
+static bool readPackedObjects(const sgfx::TransientAllocation& before, const sgfx::TransientAllocation& after, std::vector<uint32_t>& numPacked)
+{
+    if (before.buffer.value != after.buffer.value || after.offset < before.offset)
+        return false;
+
+    const uint8_t* data = static_cast<const uint8_t*>(sgfx::mapBuffer(after.buffer, sgfx::MapType::Read));
+    for (uint32_t offset = before.offset; offset + 16 <= after.offset; offset += 16) {
+        float offsetData[4];
+        std::memcpy(offsetData, data + offset, sizeof(offsetData));
+
+        uint32_t object = static_cast<uint32_t>(offsetData[0]);
+        if (offsetData[1] == 0.0F && offsetData[2] == 0.0F && offsetData[3] == 1.0F && object < numPacked.size())
+            numPacked[object]++;
+    }
+    sgfx::unmapBuffer(after.buffer);
+    return true;
+}
+
+void benchInstanceMerge(const Scene& scene)
+{
+    std::shared_ptr<InstancedScene> instanced = std::make_shared<InstancedScene>();
+    createInstancedScene(*instanced);
+    addCleanup([instanced]() { releaseInstancedScene(*instanced); });
+
+    // merged draws take up to 256 draws, the core's DrawCallStream::kMaxMergedDraws
+    const uint32_t kObjectsPerMesh   = kNumObjects / kNumMeshes;
+    const uint32_t kInlineMergeDraws = kNumMeshes * ((kObjectsPerMesh + 255) / 256);
+    const uint32_t kSortByKey        = sgfx::SubmitFlags::SortByKey;
+    const uint32_t kMerge            = sgfx::SubmitFlags::MergeInstances;
+
+    // shuffled objects are sorted back by their sort keys
+    static const MergeMode modes[] = {
+        { "instanced",                  false, false, 0,                   kNumObjects       },
+        { "instanced_merged",           false, false, kMerge,              kNumMeshes        },
+        { "instanced_sorted",           true,  false, kSortByKey,          kNumObjects       },
+        { "instanced_sorted_merged",    true,  false, kSortByKey | kMerge, kNumMeshes        },
+        { "draw_indexed",               false, true,  0,                   kNumObjects       },
+        { "draw_indexed_merged",        false, true,  kMerge,              kInlineMergeDraws },
+        { "draw_indexed_sorted_merged", true,  true,  kSortByKey | kMerge, kInlineMergeDraws }
+    };
+
+    // merging changes the number of draws, never what they draw
+    addCheck("instance_merge/merged_draws", [&scene, instanced]() {
+        for (const MergeMode& mode : modes) {
+            sgfx::PipelineStateHandle state = mode.inlineConstants ? instanced->inlinePipeline.pipelineState : instanced->pipeline.pipelineState;
+            sgfx::DrawQueueHandle     queue = sgfx::createDrawQueue(state);
+
+            recordObjects(scene, *instanced, queue, mode, kNumObjects);
+            sgfx::null::DeviceStats stats = submitAndCount(queue, mode.submitFlags);
+            sgfx::releaseDrawQueue(queue);
+
+            if (!checkEqual(mode.name, stats.numDrawCalls, mode.numMergedDraws)
+                || !checkEqual("indices", stats.numPrimitives, static_cast<uint64_t>(kNumObjects) * kNumIndicesPerMesh))
+                return false;
+        }
+        return true;
+    });
+
+    // every object's inline constants reach the instance data exactly once, in order or sorted
+    addCheck("instance_merge/packed_constants", [&scene, instanced]() {
+        sgfx::DrawQueueHandle queue = sgfx::createDrawQueue(instanced->inlinePipeline.pipelineState);
+
+        bool passed = true;
+        for (const MergeMode& mode : modes) {
+            if (!mode.inlineConstants || mode.submitFlags == 0)
+                continue;
+
+            std::vector<uint32_t> numPacked(kNumObjects, 0);
+            bool                  isRead = false;
+
+            // a frame that wrapped the ring or made it grow is tried again
+            for (uint32_t attempt = 0; attempt < 2 && !isRead; ++attempt) {
+                std::fill(numPacked.begin(), numPacked.end(), 0);
+                recordObjects(scene, *instanced, queue, mode, kNumPackedObjects);
+
+                sgfx::TransientAllocation before = sgfx::allocateTransient(16, 16);
+                sgfx::submit(queue, mode.submitFlags);
+                sgfx::TransientAllocation after = sgfx::allocateTransient(16, 16);
+
+                isRead = readPackedObjects(before, after, numPacked);
+                sgfx::present(0);
+            }
+
+            if (!isRead) {
+                passed = checkFailed("%s: the transient ring moved on during the frame", mode.name);
+                break;
+            }
+
+            const std::vector<uint32_t>& order = mode.shuffled ? instanced->shuffled : instanced->sequential;
+            std::vector<uint32_t>        expected(kNumObjects, 0);
+            for (uint32_t i = 0; i < kNumPackedObjects; ++i)
+                expected[order[i]] = 1;
+
+            for (uint32_t i = 0; i < kNumObjects && passed; ++i) {
+                if (numPacked[i] != expected[i])
+                    passed = checkFailed("%s: object %u packed %u times instead of %u", mode.name, i, numPacked[i], expected[i]);
+            }
+        }
+
+        sgfx::releaseDrawQueue(queue);
+        return passed;
+    });
+
+    for (const MergeMode& mode : modes) {
+        char name[64];
+        snprintf(name, sizeof(name), "instance_merge/%s", mode.name);
+
+        const MergeMode* modePtr = &mode;
+        addBenchmark(name, "object", kNumObjects, 0, [&scene, instanced, modePtr]() {
+            sgfx::PipelineStateHandle state = modePtr->inlineConstants ? instanced->inlinePipeline.pipelineState : instanced->pipeline.pipelineState;
+            sgfx::DrawQueueHandle     queue = sgfx::createDrawQueue(state);
+            recordObjects(scene, *instanced, queue, *modePtr, kNumObjects);
+
+            auto start = Clock::now();
+            sgfx::submit(queue, modePtr->submitFlags);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            sgfx::releaseDrawQueue(queue);
+            return ns;
+        });
+    }
+}
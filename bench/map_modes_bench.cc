@@ -0,0 +1,242 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// kNumEmitters particle emitters write kNumParticles particles each frame and draw them. "write"
+// and "discard" map a buffer per emitter with MapType::Write and MapType::WriteDiscard,
+// "no_overwrite_ring" appends every emitter to one shared buffer with MapType::WriteNoOverwrite
+// and only discards when the ring starts over. The null backend never stalls, a Write map would
+// wait for the GPU on a real device, so the renames matter as much as the timings, each one is a
+// copy of the buffer the driver has to keep alive for the frames in flight. The check counts them
+// and reads the last emitter's particles back.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumEmitters        = 64,
+    kNumParticles       = 1024,
+    kRingFrames         = 4  // frames of particles the ring holds, more than the frames in flight
+};
+
+enum MapMode
+{
+    MapWrite,
+    MapDiscard,
+    MapNoOverwriteRing,
+    NumMapModes
+};
+
+struct Particle final
+{
+    float position[3];
+    float velocity[3];
+    float age;
+    float size;
+};
+
+struct ParticleScene final
+{
+    Pipeline                    pipeline;
+    sgfx::DrawQueueHandle       drawQueue;
+
+    std::vector<Particle>       particles;
+};
+
+struct EmitterBuffers final
+{
+    std::vector<sgfx::BufferHandle> emitterBuffers;
+    sgfx::BufferHandle              ringBuffer;
+    size_t                          ringSize = 0;
+    size_t                          ringHead = 0;
+    uint32_t                        frame    = 0;
+};
+
+static void createParticleScene(ParticleScene& scene)
+{
+    sgfx::VertexElementDescriptor elements[] = {
+        { "POSITION", 0, sgfx::DataFormat::RGB32F, 0, 0,                 false },
+        { "TEXCOORD", 0, sgfx::DataFormat::RGB32F, 0, 3 * sizeof(float), false },
+        { "TEXCOORD", 1, sgfx::DataFormat::RG32F,  0, 6 * sizeof(float), false }
+    };
+    createPipeline(scene.pipeline, sgfx::PipelineStateDescriptor(), elements, 3);
+    scene.drawQueue = sgfx::createDrawQueue(scene.pipeline.pipelineState);
+
+    scene.particles.resize(kNumParticles);
+    std::memset(scene.particles.data(), 0, scene.particles.size() * sizeof(Particle));
+}
+
+static void releaseParticleScene(ParticleScene& scene)
+{
+    sgfx::releaseDrawQueue(scene.drawQueue);
+    releasePipeline(scene.pipeline);
+}
+
+static void createEmitterBuffers(EmitterBuffers& buffers, MapMode mode)
+{
+    size_t emitterSize = kNumParticles * sizeof(Particle);
+    uint32_t flags     = sgfx::BufferFlags::VertexBuffer | sgfx::BufferFlags::CPUWrite;
+
+    if (mode == MapNoOverwriteRing) {
+        buffers.ringSize   = emitterSize * kNumEmitters * kRingFrames;
+        buffers.ringBuffer = sgfx::createBuffer(flags, nullptr, buffers.ringSize, sizeof(Particle));
+    } else {
+        buffers.emitterBuffers.resize(kNumEmitters);
+        for (sgfx::BufferHandle& buffer : buffers.emitterBuffers)
+            buffer = sgfx::createBuffer(flags, nullptr, emitterSize, sizeof(Particle));
+    }
+}
+
+static void releaseEmitterBuffers(EmitterBuffers& buffers)
+{
+    for (sgfx::BufferHandle& buffer : buffers.emitterBuffers)
+        sgfx::releaseBuffer(buffer);
+    sgfx::releaseBuffer(buffers.ringBuffer);
+    buffers = EmitterBuffers();
+}
+
+// the emitters move their particles, every frame writes different data
+static void simulate(ParticleScene& scene, uint32_t emitter, uint32_t frame)
+{
+    for (uint32_t i = 0; i < kNumParticles; ++i) {
+        Particle& particle = scene.particles[i];
+        particle.position[0] = static_cast<float>(emitter);
+        particle.position[1] = static_cast<float>(i) * 0.01F + static_cast<float>(frame) * 0.1F;
+        particle.age         = static_cast<float>(frame);
+    }
+}
+
+static void renderParticles(ParticleScene& scene, EmitterBuffers& buffers, MapMode mode)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+    uint32_t              frame = buffers.frame++;
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::PointList);
+
+    size_t emitterSize = kNumParticles * sizeof(Particle);
+
+    for (uint32_t emitter = 0; emitter < kNumEmitters; ++emitter) {
+        simulate(scene, emitter, frame);
+
+        if (mode == MapNoOverwriteRing) {
+            // append, start over with a discard once the ring is full
+            sgfx::MapType mapType = sgfx::MapType::WriteNoOverwrite;
+            if (buffers.ringHead + emitterSize > buffers.ringSize) {
+                buffers.ringHead = 0;
+                mapType = sgfx::MapType::WriteDiscard;
+            }
+
+            uint8_t* data = static_cast<uint8_t*>(sgfx::mapBuffer(buffers.ringBuffer, mapType));
+            if (data != nullptr) {
+                std::memcpy(data + buffers.ringHead, scene.particles.data(), emitterSize);
+                sgfx::unmapBuffer(buffers.ringBuffer);
+            }
+
+            sgfx::setVertexBuffer(queue, buffers.ringBuffer);
+            sgfx::draw(queue, kNumParticles, static_cast<uint32_t>(buffers.ringHead / sizeof(Particle)));
+
+            buffers.ringHead += emitterSize;
+        } else {
+            sgfx::BufferHandle buffer = buffers.emitterBuffers[emitter];
+
+            void* data = sgfx::mapBuffer(buffer, (mode == MapDiscard) ? sgfx::MapType::WriteDiscard : sgfx::MapType::Write);
+            if (data != nullptr) {
+                std::memcpy(data, scene.particles.data(), emitterSize);
+                sgfx::unmapBuffer(buffer);
+            }
+
+            sgfx::setVertexBuffer(queue, buffer);
+            sgfx::draw(queue, kNumParticles, 0);
+        }
+    }
+
+    sgfx::submit(queue);
+    sgfx::present(0);
+}
+
+struct MapModeName final
+{
+    const char* name;
+    uint64_t    numRenames; // in the kRingFrames * 2 frames the check runs
+};
+
+static const MapModeName kMapModes[NumMapModes] = {
+    { "map_modes/write",             0 },
+    { "map_modes/discard",           kNumEmitters * kRingFrames * 2 },
+    { "map_modes/no_overwrite_ring", 1 } // the ring starts over once, at frame kRingFrames
+};
+
+void benchMapModes()
+{
+    std::shared_ptr<ParticleScene> scene = std::make_shared<ParticleScene>();
+    createParticleScene(*scene);
+    addCleanup([scene]() { releaseParticleScene(*scene); });
+
+    addCheck("map_modes/renames_and_contents", [scene]() {
+        size_t emitterSize = kNumParticles * sizeof(Particle);
+
+        for (uint32_t i = 0; i < NumMapModes; ++i) {
+            MapMode        mode = static_cast<MapMode>(i);
+            EmitterBuffers buffers;
+            createEmitterBuffers(buffers, mode);
+
+            sgfx::null::resetDeviceStats();
+            for (uint32_t frame = 0; frame < kRingFrames * 2; ++frame)
+                renderParticles(*scene, buffers, mode);
+            sgfx::null::DeviceStats stats = sgfx::null::getDeviceStats();
+
+            // what the last emitter wrote is still in the scene's particles
+            sgfx::BufferHandle buffer = (mode == MapNoOverwriteRing) ? buffers.ringBuffer : buffers.emitterBuffers.back();
+            size_t             offset = (mode == MapNoOverwriteRing) ? buffers.ringHead - emitterSize : 0;
+
+            const uint8_t* data = static_cast<const uint8_t*>(sgfx::mapBuffer(buffer, sgfx::MapType::Read));
+            bool isValid = data != nullptr && std::memcmp(data + offset, scene->particles.data(), emitterSize) == 0;
+            sgfx::unmapBuffer(buffer);
+            releaseEmitterBuffers(buffers);
+
+            if (!isValid)
+                return checkFailed("%s: the last emitter's particles differ", kMapModes[i].name);
+            if (!checkEqual("draws", stats.numDrawCalls, kNumEmitters * kRingFrames * 2)
+                || !checkEqual(kMapModes[i].name, stats.numBufferRenames, kMapModes[i].numRenames))
+                return false;
+        }
+        return true;
+    });
+
+    for (uint32_t i = 0; i < NumMapModes; ++i) {
+        MapMode mode = static_cast<MapMode>(i);
+
+        std::shared_ptr<EmitterBuffers> buffers = std::make_shared<EmitterBuffers>();
+        createEmitterBuffers(*buffers, mode);
+        addCleanup([buffers]() { releaseEmitterBuffers(*buffers); });
+
+        addBenchmark(kMapModes[i].name, "particle", kNumEmitters * kNumParticles, sizeof(Particle), [scene, buffers, mode]() {
+            auto start = Clock::now();
+            renderParticles(*scene, *buffers, mode);
+            return getNanoseconds(start, Clock::now());
+        });
+    }
+}
@@ -0,0 +1,222 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// the cost of a beginPerfEvent/endPerfEvent pair with the profiler stopped and running, on one
+// thread and on kNumProfiledThreads threads at once. The check profiles kNumProfiledFrames frames,
+// writes the trace to profiler_trace.json for chrome://tracing or Perfetto and counts its zones.
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumZones           = 100000, // per thread and run
+    kNumProfiledThreads = 4,
+    kNumProfiledQueues  = 4,
+    kNumProfiledDraws   = 5000,
+    kNumProfiledFrames  = 60
+};
+
+// CPU time of the calling thread where there is a clock for it, threads sharing a core would
+// count each other's time otherwise
+static double getThreadNanoseconds()
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) * 1e9 + static_cast<double>(time.tv_nsec);
+#else
+    return getNanoseconds(Clock::time_point(), Clock::now());
+#endif
+}
+
+// nested four deep like a frame, pass and draw, the pairs are what is timed
+static void recordZones(uint32_t numZones)
+{
+    for (uint32_t i = 0; i < numZones / 4; ++i) {
+        sgfx::beginPerfEvent(L"Frame");
+        sgfx::beginPerfEvent(L"Pass");
+        sgfx::beginPerfEvent(L"Draw");
+        sgfx::beginPerfEvent(L"Upload");
+        sgfx::endPerfEvent();
+        sgfx::endPerfEvent();
+        sgfx::endPerfEvent();
+        sgfx::endPerfEvent();
+    }
+}
+
+// nanoseconds of the slowest of numThreads threads recording at once
+static double measureZones(uint32_t numThreads)
+{
+    std::vector<double>      threadTimes(numThreads);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&threadTimes, i]() {
+            double start = getThreadNanoseconds();
+            recordZones(kNumZones);
+            threadTimes[i] = getThreadNanoseconds() - start;
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return *std::max_element(threadTimes.begin(), threadTimes.end());
+}
+
+//=============================================================================
+struct ProfiledScene final
+{
+    Pipeline                    pipeline;
+    sgfx::DrawQueueHandle       drawQueues[kNumProfiledQueues];
+    sgfx::BufferHandle          vertexBuffer;
+    sgfx::ConstantBufferHandle  constantBuffer;
+};
+
+// shader compilation and pipeline creation are zones of their own
+static void createProfiledScene(ProfiledScene& scene)
+{
+    createPipeline(scene.pipeline);
+
+    for (sgfx::DrawQueueHandle& queue : scene.drawQueues)
+        queue = sgfx::createDrawQueue(scene.pipeline.pipelineState);
+
+    float vertices[9] = { 0.0F };
+    scene.vertexBuffer   = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, vertices, sizeof(vertices), 12);
+    scene.constantBuffer = sgfx::createConstantBuffer(nullptr, 256);
+}
+
+static void releaseProfiledScene(ProfiledScene& scene)
+{
+    sgfx::releaseConstantBuffer(scene.constantBuffer);
+    sgfx::releaseBuffer(scene.vertexBuffer);
+    for (sgfx::DrawQueueHandle& queue : scene.drawQueues)
+        sgfx::releaseDrawQueue(queue);
+    releasePipeline(scene.pipeline);
+}
+
+static void renderProfiledFrame(const ProfiledScene& scene, uint32_t frame)
+{
+    sgfx::beginPerfEvent(L"Frame");
+
+    const wchar_t* passNames[kNumProfiledQueues] = { L"Shadows", L"Opaque", L"Transparent", L"Post" };
+    for (uint32_t i = 0; i < kNumProfiledQueues; ++i) {
+        sgfx::beginPerfEvent(passNames[i]);
+
+        float constants[64] = { static_cast<float>(frame) };
+        sgfx::updateConstantBuffer(scene.constantBuffer, constants);
+
+        sgfx::DrawQueueHandle queue = scene.drawQueues[i];
+        for (uint32_t draw = 0; draw < kNumProfiledDraws; ++draw) {
+            sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+            sgfx::setVertexBuffer(queue, scene.vertexBuffer);
+            sgfx::setConstantBuffer(queue, 0, scene.constantBuffer);
+            sgfx::draw(queue, 3, 0);
+        }
+        sgfx::submit(queue);
+
+        sgfx::endPerfEvent();
+    }
+
+    sgfx::endPerfEvent();
+    sgfx::present(0);
+}
+
+// events in the written trace, or -1 if it can't be read back
+static long countTraceEvents(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return -1;
+
+    std::vector<char> text;
+    char chunk[4096];
+    for (size_t size; (size = fread(chunk, 1, sizeof(chunk), file)) != 0;)
+        text.insert(text.end(), chunk, chunk + size);
+    fclose(file);
+    text.push_back(0);
+
+    long numEvents = 0;
+    for (const char* c = text.data(); (c = strstr(c, "\"ph\":\"X\"")) != nullptr; ++c)
+        numEvents++;
+    return numEvents;
+}
+
+void benchProfiler()
+{
+    // a profiled run, the trace holds the last zones of every thread
+    addCheck("profiler/trace_zones", []() {
+        sgfx::startProfiler();
+
+        ProfiledScene scene;
+        createProfiledScene(scene);
+        for (uint32_t frame = 0; frame < kNumProfiledFrames; ++frame)
+            renderProfiledFrame(scene, frame);
+
+        sgfx::stopProfiler();
+        releaseProfiledScene(scene);
+
+        const char* path = "profiler_trace.json";
+        if (!sgfx::writeProfilerTrace(path))
+            return checkFailed("can't write %s", path);
+
+        // per frame: a frame, four passes, four constant buffer updates and four submits, and the
+        // shader compilation and pipeline creation
+        return checkEqual("zones in the trace", static_cast<uint64_t>(countTraceEvents(path)), kNumProfiledFrames * (1 + 3 * kNumProfiledQueues) + 2);
+    });
+
+    struct ZoneMode final
+    {
+        const char* name;
+        bool        isRunning;
+        uint32_t    numThreads;
+    };
+    static const ZoneMode kZoneModes[] = {
+        { "profiler/zone/stopped",           false, 1                   },
+        { "profiler/zone/running",           true,  1                   },
+        { "profiler/zone/running_4_threads", true,  kNumProfiledThreads }
+    };
+
+    for (const ZoneMode& mode : kZoneModes) {
+        bool     isRunning  = mode.isRunning;
+        uint32_t numThreads = mode.numThreads;
+
+        addBenchmark(mode.name, "zone", kNumZones, 0, [isRunning, numThreads]() {
+            if (isRunning)
+                sgfx::startProfiler();
+            double ns = measureZones(numThreads);
+            if (isRunning)
+                sgfx::stopProfiler();
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,141 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// materials of eight textures are bound before every draw one setResource() at a time, and as
+// prebuilt resource tables with one setResourceTable(). The check makes sure the tables submit
+// the same state as the single binds.
+
+#include <cstring>
+#include <memory>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumTableDraws      = 100000,
+    kNumMaterials       = 256,
+    kNumMaterialSlots   = 8,
+    kNumTableTextures   = 512,
+    kDrawsPerMaterial   = 16
+};
+
+struct MaterialSet final
+{
+    sgfx::TextureHandle         textures[kNumTableTextures];
+    sgfx::TextureHandle         materials[kNumMaterials][kNumMaterialSlots];
+    sgfx::ResourceTableHandle   materialTables[kNumMaterials];
+};
+
+static void createMaterials(MaterialSet& set)
+{
+    for (sgfx::TextureHandle& texture : set.textures)
+        texture = sgfx::createTexture2D(16, 16, sgfx::DataFormat::RGBA8, 1, 0);
+
+    // materials share textures, so neighbouring draws differ in some slots only
+    for (uint32_t material = 0; material < kNumMaterials; ++material) {
+        sgfx::ResourceTableEntry entries[kNumMaterialSlots];
+
+        for (uint32_t slot = 0; slot < kNumMaterialSlots; ++slot) {
+            sgfx::TextureHandle texture = set.textures[(material * 3 + slot * 61) % kNumTableTextures];
+            set.materials[material][slot] = texture;
+            entries[slot].texture = texture;
+        }
+
+        set.materialTables[material] = sgfx::createResourceTable(entries, kNumMaterialSlots);
+    }
+}
+
+static void releaseMaterials(MaterialSet& set)
+{
+    for (sgfx::ResourceTableHandle& table : set.materialTables)
+        sgfx::releaseResourceTable(table);
+    for (sgfx::TextureHandle& texture : set.textures)
+        sgfx::releaseTexture(texture);
+}
+
+static void recordMaterialDraws(const Scene& scene, const MaterialSet& set, bool useTables)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+
+    for (uint32_t i = 0; i < kNumTableDraws; ++i) {
+        uint32_t material = (i / kDrawsPerMaterial) % kNumMaterials;
+
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[0]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+
+        if (useTables) {
+            sgfx::setResourceTable(queue, 0, set.materialTables[material]);
+        } else {
+            for (uint32_t slot = 0; slot < kNumMaterialSlots; ++slot)
+                sgfx::setResource(queue, slot, set.materials[material][slot]);
+        }
+
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+void benchResourceTables(const Scene& scene)
+{
+    std::shared_ptr<MaterialSet> set = std::make_shared<MaterialSet>();
+    createMaterials(*set);
+    addCleanup([set]() { releaseMaterials(*set); });
+
+    addCheck("resource_table/matches_set_resource", [&scene, set]() {
+        recordMaterialDraws(scene, *set, false);
+        sgfx::null::DeviceStats expected = submitAndCount(scene.drawQueue);
+
+        recordMaterialDraws(scene, *set, true);
+        sgfx::null::DeviceStats tables = submitAndCount(scene.drawQueue);
+
+        if (std::memcmp(&tables, &expected, sizeof(tables)) != 0)
+            return checkFailed("the tables bound %llu resources in %llu calls instead of %llu in %llu",
+                static_cast<unsigned long long>(tables.numResourceBinds), static_cast<unsigned long long>(tables.numResourceBindCalls),
+                static_cast<unsigned long long>(expected.numResourceBinds), static_cast<unsigned long long>(expected.numResourceBindCalls));
+        return checkEqual("draws", tables.numDrawCalls, kNumTableDraws);
+    });
+
+    for (bool useTables : { false, true }) {
+        addBenchmark(useTables ? "resource_table/record/tables" : "resource_table/record/set_resource", "draw", kNumTableDraws, 0, [&scene, set, useTables]() {
+            auto start = Clock::now();
+            recordMaterialDraws(scene, *set, useTables);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(scene.drawQueue);
+            sgfx::present(0);
+            return ns;
+        });
+
+        addBenchmark(useTables ? "resource_table/submit/tables" : "resource_table/submit/set_resource", "draw", kNumTableDraws, 0, [&scene, set, useTables]() {
+            recordMaterialDraws(scene, *set, useTables);
+
+            auto start = Clock::now();
+            sgfx::submit(scene.drawQueue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
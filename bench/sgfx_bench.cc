@@ -0,0 +1,892 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// sgfx_bench, the hot paths in one run on the null backend with a JSON report:
+// draw recording per draw type, submit() with 1k/10k/100k draws at three rates of binding churn,
+// compute dispatch setup, MeshData::read and loadDDS on the data/ assets, handle create/release
+// churn, and the areas of the other bench/*_bench.cc:
+//
+//   dynamic_array_bench.cc      DynamicArray appends and removals against std::vector
+//   draw_recording_bench.cc     one queue recorded from 1-16 threads through DrawRecorders
+//   draw_sort_bench.cc          draws in random material order submitted with and without SortByKey
+//   bundle_visibility_bench.cc  culled draws recorded every frame against a bundle with a mask
+//   instance_merge_bench.cc     MergeInstances on instanced draws and on drawIndexed with inline constants
+//   sticky_bindings_bench.cc    every binding per draw against DrawQueueFlags::StickyBindings
+//   binding_layout_bench.cc     surface shaders with and without a SurfaceBindingLayout
+//   resource_table_bench.cc     setResource() per slot against setResourceTable()
+//   inline_constants_bench.cc   a constant buffer per object against setInlineConstants()
+//   constant_blocks_bench.cc    a constant buffer per object against constant allocator blocks
+//   transient_upload_bench.cc   re-created and mapped buffers against allocateTransient()
+//   index_format_bench.cc       32 and 16-bit indices, a buffer per mesh against shared buffers
+//   buffer_heap_bench.cc        streaming meshes through a rebuilt buffer against a buffer heap
+//   map_modes_bench.cc          Write, WriteDiscard and a WriteNoOverwrite ring for particles
+//   frame_stats_bench.cc        getFrameStats() against the null device stats, the cost of counting
+//   profiler_bench.cc           perf event zones with the profiler stopped and running, the trace
+//   capture_bench.cc            frames with the API capture stopped and running, the trace
+//
+//   sgfx_bench [-out results.json] [-baseline baseline.json] [-threshold percent]
+//              [-filter substring] [-repeats N] [-data dir]
+//
+// every benchmark runs once to warm up and then takes -repeats samples of at least 2ms each, the
+// report has the median and the fastest sample per operation; with -baseline the fastest sample
+// is compared against the one of the same benchmark in an earlier report, the least noisy number
+// on a shared machine, and the run fails if any got slower by more than its tolerance and still
+// is on two reruns. The tolerance is the threshold (15% by default) plus the spread of the noisier
+// of the two runs, how far its median sits above its fastest sample, and a change of less than
+// 0.5ns per operation is only reported: sub-ns benchmarks move by more than 15% with code layout.
+// bench/sgfx_bench_baseline.json is the stored baseline, write a new one with -out on the perf
+// machine when a change is meant to move the numbers.
+//
+// the checks run first, they compare what the null backend was asked to do against what the
+// workload should produce (draw counts, binds, uploaded data) so a benchmark can't get faster by
+// doing less; sgfx_bench exits with 1 if a check fails or a benchmark regressed.
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "sgfx_bench.hh"
+
+#include "../demo/common/app.hh"
+#include "../demo/common/meshloader.hh"
+#include "../demo/common/textureloader.hh"
+
+#ifndef SGFX_BENCH_DATA_DIR
+#define SGFX_BENCH_DATA_DIR "data"
+#endif
+
+//=============================================================================
+enum
+{
+    kNumRecordedDraws  = 10000,
+    kNumDispatches     = 10000,
+    kNumHandles        = 10000,
+    kNumHandleBatch    = 256    // created before the batch is released
+};
+
+static const double   kMinSampleNs      = 2e6; // a sample repeats the workload for at least this long
+static const double   kNoiseFloorNs     = 0.5; // per op, a smaller change never fails the run
+static const uint32_t kNumConfirmations = 2;   // reruns of a benchmark that looks regressed
+
+struct Benchmark final
+{
+    std::string             name;
+    std::string             unit;        // what an operation is
+    uint64_t                numOps;      // per run
+    uint64_t                bytesPerOp;  // 0 unless the benchmark moves data
+    std::function<double()> run;
+};
+
+struct Result final
+{
+    std::string name;
+    std::string unit;        // what an operation is
+    uint64_t    numOps;      // per run
+    uint64_t    bytesPerOp;  // 0 unless the benchmark moves data
+    double      nsPerOp;     // median sample
+    double      minNsPerOp;  // fastest sample, what the baseline comparison uses
+};
+
+struct Check final
+{
+    std::string           name;
+    std::function<bool()> run;
+};
+
+struct Options final
+{
+    const char* outPath      = nullptr;
+    const char* baselinePath = nullptr;
+    const char* filter       = nullptr;
+    std::string dataDir      = SGFX_BENCH_DATA_DIR;
+    double      threshold    = 15.0; // percent
+    uint32_t    numRepeats   = 9;
+};
+
+static Options                            g_options;
+static std::vector<Benchmark>             g_benchmarks;
+static std::vector<Check>                 g_checks;
+static std::vector<std::function<void()>> g_cleanups;
+volatile uint64_t                         g_sink = 0;
+
+double getNanoseconds(Clock::time_point start, Clock::time_point stop)
+{
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+bool isSelected(const char* name)
+{
+    return g_options.filter == nullptr || std::strstr(name, g_options.filter) != nullptr;
+}
+
+void addBenchmark(const char* name, const char* unit, uint64_t numOps, uint64_t bytesPerOp, const std::function<double()>& run)
+{
+    if (!isSelected(name))
+        return;
+
+    Benchmark benchmark;
+    benchmark.name       = name;
+    benchmark.unit       = unit;
+    benchmark.numOps     = numOps;
+    benchmark.bytesPerOp = bytesPerOp;
+    benchmark.run        = run;
+    g_benchmarks.push_back(benchmark);
+}
+
+void addCheck(const char* name, const std::function<bool()>& check)
+{
+    if (!isSelected(name))
+        return;
+
+    Check entry;
+    entry.name = name;
+    entry.run  = check;
+    g_checks.push_back(entry);
+}
+
+void addCleanup(const std::function<void()>& cleanup)
+{
+    g_cleanups.push_back(cleanup);
+}
+
+bool checkEqual(const char* what, uint64_t value, uint64_t expected)
+{
+    if (value == expected)
+        return true;
+    return checkFailed("%s is %llu instead of %llu", what, static_cast<unsigned long long>(value), static_cast<unsigned long long>(expected));
+}
+
+bool checkFailed(const char* format, ...)
+{
+    printf("%-50s ", "");
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    printf("\n");
+    return false;
+}
+
+const std::string& getDataDir()
+{
+    return g_options.dataDir;
+}
+
+// every check runs even after one failed, the report lists all of them
+static uint32_t runChecks()
+{
+    uint32_t numFailed = 0;
+    for (const Check& check : g_checks) {
+        bool passed = check.run();
+        printf("%-50s %s\n", check.name.c_str(), passed ? "ok" : "FAILED");
+        if (!passed)
+            numFailed++;
+    }
+    return numFailed;
+}
+
+// a sample runs the workload until kMinSampleNs were measured, so the 1k draw submit isn't timed
+// on a handful of microseconds
+static Result measure(const Benchmark& benchmark)
+{
+    benchmark.run(); // warm-up, caches, allocator pools and frame arenas
+
+    std::vector<double> times;
+    for (uint32_t i = 0; i < g_options.numRepeats; ++i) {
+        double   ns      = 0.0;
+        uint64_t numRuns = 0;
+        for (; ns < kMinSampleNs; ++numRuns)
+            ns += benchmark.run();
+        times.push_back(ns / static_cast<double>(benchmark.numOps * numRuns));
+    }
+    std::sort(times.begin(), times.end());
+
+    Result result;
+    result.name       = benchmark.name;
+    result.unit       = benchmark.unit;
+    result.numOps     = benchmark.numOps;
+    result.bytesPerOp = benchmark.bytesPerOp;
+    result.nsPerOp    = times[times.size() / 2];
+    result.minNsPerOp = times.front();
+    return result;
+}
+
+static void printResult(const Result& result)
+{
+    if (result.bytesPerOp != 0) {
+        double mbPerSecond = static_cast<double>(result.bytesPerOp) / result.nsPerOp * 1e9 / (1024.0 * 1024.0);
+        printf("%-50s %12.1f ns/%-9s %10.1f MB/s\n", result.name.c_str(), result.nsPerOp, result.unit.c_str(), mbPerSecond);
+    } else {
+        printf("%-50s %12.1f ns/%-9s\n", result.name.c_str(), result.nsPerOp, result.unit.c_str());
+    }
+}
+
+//=============================================================================
+static void compileBenchShader(void*& bytecode, size_t& bytecodeSize)
+{
+    sgfx::compileShader("bench", 5, sgfx::ShaderCompileVersion::v5_0, sgfx::ShaderCompileTarget::VS, nullptr, 0, 0, nullptr, bytecode, bytecodeSize);
+}
+
+void createPipeline(Pipeline& pipeline, sgfx::PipelineStateDescriptor desc, sgfx::VertexElementDescriptor* elements, size_t numElements)
+{
+    void*  bytecode     = nullptr;
+    size_t bytecodeSize = 0;
+    compileBenchShader(bytecode, bytecodeSize);
+
+    pipeline.vs = sgfx::createVertexShader(bytecode, bytecodeSize);
+    pipeline.ps = sgfx::createPixelShader(bytecode, bytecodeSize);
+    pipeline.surfaceShader = sgfx::linkSurfaceShader(pipeline.vs, sgfx::HullShaderHandle(), sgfx::DomainShaderHandle(), sgfx::GeometryShaderHandle(), pipeline.ps);
+
+    sgfx::VertexElementDescriptor position[] = {
+        { "POSITION", 0, sgfx::DataFormat::RGB32F, 0, 0, false }
+    };
+    if (elements == nullptr) {
+        elements    = position;
+        numElements = 1;
+    }
+    pipeline.vertexFormat = sgfx::createVertexFormat(elements, numElements, bytecode, bytecodeSize, nullptr);
+    sgfx::deallocate(bytecode);
+
+    desc.shader       = pipeline.surfaceShader;
+    desc.vertexFormat = pipeline.vertexFormat;
+    pipeline.pipelineState = sgfx::createPipelineState(desc);
+}
+
+void releasePipeline(Pipeline& pipeline)
+{
+    sgfx::releasePipelineState(pipeline.pipelineState);
+    sgfx::releaseVertexFormat(pipeline.vertexFormat);
+    sgfx::releaseSurfaceShader(pipeline.surfaceShader);
+    sgfx::releaseVertexShader(pipeline.vs);
+    sgfx::releasePixelShader(pipeline.ps);
+}
+
+sgfx::null::DeviceStats submitAndCount(sgfx::DrawQueueHandle queue, uint32_t submitFlags)
+{
+    sgfx::null::resetDeviceStats();
+    sgfx::submit(queue, submitFlags);
+    sgfx::present(0);
+    return sgfx::null::getDeviceStats();
+}
+
+static void createScene(Scene& scene)
+{
+    createPipeline(scene.pipeline);
+
+    void*  bytecode     = nullptr;
+    size_t bytecodeSize = 0;
+    compileBenchShader(bytecode, bytecodeSize);
+    scene.cs = sgfx::createComputeShader(bytecode, bytecodeSize);
+    sgfx::deallocate(bytecode);
+
+    scene.drawQueue    = sgfx::createDrawQueue(scene.pipeline.pipelineState);
+    scene.computeQueue = sgfx::createComputeQueue(scene.cs);
+
+    uint32_t args[5] = { 3, 1, 0, 0, 0 };
+    scene.indirectArgs = sgfx::createBuffer(sgfx::BufferFlags::IndirectArgs, args, sizeof(args), 0);
+    scene.rwBuffer     = sgfx::createBuffer(sgfx::BufferFlags::StructuredBuffer | sgfx::BufferFlags::GPUWrite, nullptr, 4096, 16);
+
+    float    vertices[9] = { 0.0F };
+    uint32_t indices[3]  = { 0, 1, 2 };
+    for (uint32_t i = 0; i < kNumChurnResources; ++i) {
+        scene.vertexBuffers[i]   = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, vertices, sizeof(vertices), 12);
+        scene.indexBuffers[i]    = sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, indices, sizeof(indices), 4);
+        scene.constantBuffers[i] = sgfx::createConstantBuffer(nullptr, 256);
+        scene.textures[i]        = sgfx::createTexture2D(4, 4, sgfx::DataFormat::RGBA8, 1, 0);
+    }
+}
+
+static void releaseScene(Scene& scene)
+{
+    for (uint32_t i = 0; i < kNumChurnResources; ++i) {
+        sgfx::releaseTexture(scene.textures[i]);
+        sgfx::releaseConstantBuffer(scene.constantBuffers[i]);
+        sgfx::releaseBuffer(scene.indexBuffers[i]);
+        sgfx::releaseBuffer(scene.vertexBuffers[i]);
+    }
+    sgfx::releaseBuffer(scene.rwBuffer);
+    sgfx::releaseBuffer(scene.indirectArgs);
+    sgfx::releaseComputeQueue(scene.computeQueue);
+    sgfx::releaseDrawQueue(scene.drawQueue);
+    sgfx::releaseComputeShader(scene.cs);
+    releasePipeline(scene.pipeline);
+}
+
+// the queue is submitted and the frame presented after the timed part, so every run records
+// into an empty queue and fresh frame memory
+static void finishFrame(const Scene& scene)
+{
+    sgfx::submit(scene.drawQueue);
+    sgfx::present(0);
+}
+
+//=============================================================================
+// draw recording, a vertex buffer, a constant buffer and the draw per operation
+enum class DrawType
+{
+    Draw,
+    DrawIndexed,
+    DrawInstanced,
+    DrawIndexedInstanced,
+    DrawInstancedIndirect,
+    DrawIndexedInstancedIndirect
+};
+
+static void recordDraw(const Scene& scene, DrawType type, uint32_t i)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+
+    sgfx::setVertexBuffer(queue, scene.vertexBuffers[i % kNumChurnResources]);
+    sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[i % kNumChurnResources]);
+
+    switch (type) {
+    case DrawType::Draw:                         { sgfx::draw(queue, 3, 0); } break;
+    case DrawType::DrawIndexed:                  { sgfx::setIndexBuffer(queue, scene.indexBuffers[i % kNumChurnResources]); sgfx::drawIndexed(queue, 3, 0, 0); } break;
+    case DrawType::DrawInstanced:                { sgfx::drawInstanced(queue, 4, 3, 0, i); } break;
+    case DrawType::DrawIndexedInstanced:         { sgfx::setIndexBuffer(queue, scene.indexBuffers[i % kNumChurnResources]); sgfx::drawIndexedInstanced(queue, 4, 3, 0, 0, i); } break;
+    case DrawType::DrawInstancedIndirect:        { sgfx::drawInstancedIndirect(queue, scene.indirectArgs, 0); } break;
+    case DrawType::DrawIndexedInstancedIndirect: { sgfx::setIndexBuffer(queue, scene.indexBuffers[i % kNumChurnResources]); sgfx::drawIndexedInstancedIndirect(queue, scene.indirectArgs, 0); } break;
+    }
+}
+
+static void benchRecording(const Scene& scene)
+{
+    struct DrawBench { const char* name; DrawType type; };
+    const DrawBench benches[] = {
+        { "draw_queue/record_draw",                            DrawType::Draw                         },
+        { "draw_queue/record_draw_indexed",                    DrawType::DrawIndexed                  },
+        { "draw_queue/record_draw_instanced",                  DrawType::DrawInstanced                },
+        { "draw_queue/record_draw_indexed_instanced",          DrawType::DrawIndexedInstanced         },
+        { "draw_queue/record_draw_instanced_indirect",         DrawType::DrawInstancedIndirect        },
+        { "draw_queue/record_draw_indexed_instanced_indirect", DrawType::DrawIndexedInstancedIndirect }
+    };
+
+    for (const DrawBench& bench : benches) {
+        DrawType type = bench.type;
+        addBenchmark(bench.name, "draw", kNumRecordedDraws, 0, [&scene, type]() {
+            auto start = Clock::now();
+            for (uint32_t i = 0; i < kNumRecordedDraws; ++i)
+                recordDraw(scene, type, i);
+            double ns = getNanoseconds(start, Clock::now());
+
+            finishFrame(scene);
+            return ns;
+        });
+    }
+}
+
+//=============================================================================
+// submit translation, the draws bind a vertex buffer, an index buffer, a constant buffer and a
+// texture; churn is how often those change: never, every 16th draw, every draw
+static void recordChurningDraws(const Scene& scene, uint32_t count, uint32_t rate)
+{
+    sgfx::DrawQueueHandle queue = scene.drawQueue;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t slot = (rate != 0) ? (i / rate) % kNumChurnResources : 0;
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[slot]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[slot]);
+        sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[slot]);
+        sgfx::setResource(queue, 0, scene.textures[slot]);
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+static void benchSubmit(const Scene& scene)
+{
+    const uint32_t numDraws[]   = { 1000, 10000, 100000 };
+    const uint32_t churnRates[] = { 0, 16, 1 };
+    const char*    churnNames[] = { "none", "low", "high" };
+
+    // every draw reaches the device, a texture bind per change of the churning slot and the unbind
+    // at the end of the queue, counted for the vertex and the pixel shader
+    addCheck("submit/draws_and_binds", [&scene]() {
+        recordChurningDraws(scene, 1000, 16);
+        sgfx::null::DeviceStats stats = submitAndCount(scene.drawQueue);
+        return checkEqual("draws", stats.numDrawCalls, 1000)
+            && checkEqual("indices", stats.numPrimitives, 3000)
+            && checkEqual("texture binds", stats.numResourceBinds, 2 * ((1000 + 15) / 16 + 1));
+    });
+
+    for (uint32_t drawsIndex = 0; drawsIndex < 3; ++drawsIndex) {
+        for (uint32_t churnIndex = 0; churnIndex < 3; ++churnIndex) {
+            uint32_t count = numDraws[drawsIndex];
+            uint32_t rate  = churnRates[churnIndex];
+
+            char name[64];
+            snprintf(name, sizeof(name), "submit/%uk_draws/churn_%s", count / 1000, churnNames[churnIndex]);
+
+            addBenchmark(name, "draw", count, 0, [&scene, count, rate]() {
+                recordChurningDraws(scene, count, rate);
+
+                auto start = Clock::now();
+                sgfx::submit(scene.drawQueue);
+                double ns = getNanoseconds(start, Clock::now());
+
+                sgfx::present(0);
+                return ns;
+            });
+        }
+    }
+}
+
+//=============================================================================
+// compute dispatch setup, the bindings and the dispatch per operation
+static void benchCompute(const Scene& scene)
+{
+    addBenchmark("compute_queue/dispatch", "dispatch", kNumDispatches, 0, [&scene]() {
+        sgfx::ComputeQueueHandle queue = scene.computeQueue;
+
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < kNumDispatches; ++i) {
+            sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[i % kNumChurnResources]);
+            sgfx::setResource(queue, 0, scene.vertexBuffers[i % kNumChurnResources]);
+            sgfx::setResourceRW(queue, 0, scene.rwBuffer);
+            sgfx::submit(queue, 64, 1, 1);
+        }
+        double ns = getNanoseconds(start, Clock::now());
+
+        sgfx::present(0);
+        return ns;
+    });
+}
+
+//=============================================================================
+// asset loading, every file of a data/ directory per run
+static std::vector<std::string> listFiles(const std::string& dir, const char* extension)
+{
+    std::vector<std::string> files;
+    size_t extensionLength = std::strlen(extension);
+
+#if defined(_WIN32)
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((dir + "/*").c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE)
+        return files;
+    do {
+        std::string name = entry.cFileName;
+#else
+    DIR* directory = opendir(dir.c_str());
+    if (directory == nullptr)
+        return files;
+    while (dirent* entry = readdir(directory)) {
+        std::string name = entry->d_name;
+#endif
+        if (name.size() > extensionLength && name.compare(name.size() - extensionLength, extensionLength, extension) == 0)
+            files.push_back(dir + "/" + name);
+#if defined(_WIN32)
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    }
+    closedir(directory);
+#endif
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static uint64_t getTotalSize(const std::vector<std::string>& files)
+{
+    uint64_t size = 0;
+    for (const std::string& path : files) {
+        if (FILE* file = fopen(path.c_str(), "rb")) {
+            fseek(file, 0, SEEK_END);
+            size += static_cast<uint64_t>(ftell(file));
+            fclose(file);
+        }
+    }
+    return size;
+}
+
+// the loaders log every file, they're muted while they run; OutputDebugString costs nothing on
+// Windows without a debugger attached
+static void setLoaderOutput(bool enabled)
+{
+#ifndef APP_WIN32
+    util::debugOutputEnabled = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+static void benchAssets()
+{
+    std::vector<std::string> meshes = listFiles(g_options.dataDir + "/meshes", ".mesh");
+    std::vector<std::string> cattail = listFiles(g_options.dataDir + "/meshes/cattail", ".mesh");
+    std::vector<std::string> ak      = listFiles(g_options.dataDir + "/ak", ".mesh");
+    meshes.insert(meshes.end(), cattail.begin(), cattail.end());
+    meshes.insert(meshes.end(), ak.begin(), ak.end());
+
+    if (!meshes.empty()) {
+        addBenchmark("assets/mesh_read", "file", meshes.size(), getTotalSize(meshes) / meshes.size(), [meshes]() {
+            setLoaderOutput(false);
+            auto start = Clock::now();
+            for (const std::string& path : meshes) {
+                MeshData mesh;
+                mesh.read(path);
+                g_sink += mesh.getVertices().size() + mesh.getIndices().size();
+            }
+            double ns = getNanoseconds(start, Clock::now());
+            setLoaderOutput(true);
+            return ns;
+        });
+    } else if (isSelected("assets/mesh_read")) {
+        printf("%-50s no meshes in %s\n", "assets/mesh_read", g_options.dataDir.c_str());
+    }
+
+    std::vector<std::string> textures = listFiles(g_options.dataDir + "/textures", ".dds");
+    if (!textures.empty()) {
+        addBenchmark("assets/load_dds", "file", textures.size(), getTotalSize(textures) / textures.size(), [textures]() {
+            setLoaderOutput(false);
+            auto start = Clock::now();
+            for (const std::string& path : textures) {
+                sgfx::Texture2DHandle texture = loadDDS(path);
+                g_sink += texture.value;
+                sgfx::releaseTexture(texture);
+            }
+            double ns = getNanoseconds(start, Clock::now());
+            setLoaderOutput(true);
+            return ns;
+        });
+    } else if (isSelected("assets/load_dds")) {
+        printf("%-50s no textures in %s\n", "assets/load_dds", g_options.dataDir.c_str());
+    }
+}
+
+//=============================================================================
+// handle churn, batches of objects created and released in the opposite order, a create and
+// its release per operation
+template <typename Handle, typename Create, typename Release>
+static double churnHandles(const Create& create, const Release& release)
+{
+    Handle handles[kNumHandleBatch];
+
+    auto start = Clock::now();
+    for (uint32_t batch = 0; batch < kNumHandles / kNumHandleBatch; ++batch) {
+        for (uint32_t i = 0; i < kNumHandleBatch; ++i)
+            handles[i] = create(i);
+        for (uint32_t i = kNumHandleBatch; i-- > 0;)
+            release(handles[i]);
+    }
+    return getNanoseconds(start, Clock::now());
+}
+
+static void benchHandles(const Scene& scene)
+{
+    const uint64_t numOps = (kNumHandles / kNumHandleBatch) * kNumHandleBatch;
+
+    addBenchmark("handles/buffer", "handle", numOps, 0, []() {
+        static const uint8_t data[1024] = { 0 };
+        return churnHandles<sgfx::BufferHandle>(
+            [](uint32_t) { return sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, data, sizeof(data), 16); },
+            [](sgfx::BufferHandle handle) { sgfx::releaseBuffer(handle); }
+        );
+    });
+
+    addBenchmark("handles/constant_buffer", "handle", numOps, 0, []() {
+        return churnHandles<sgfx::ConstantBufferHandle>(
+            [](uint32_t) { return sgfx::createConstantBuffer(nullptr, 256); },
+            [](sgfx::ConstantBufferHandle handle) { sgfx::releaseConstantBuffer(handle); }
+        );
+    });
+
+    addBenchmark("handles/texture2d", "handle", numOps, 0, []() {
+        return churnHandles<sgfx::Texture2DHandle>(
+            [](uint32_t) { return sgfx::createTexture2D(64, 64, sgfx::DataFormat::RGBA8, 1, 0); },
+            [](sgfx::Texture2DHandle handle) { sgfx::releaseTexture(handle); }
+        );
+    });
+
+    addBenchmark("handles/draw_queue", "handle", numOps, 0, [&scene]() {
+        sgfx::PipelineStateHandle state = scene.pipeline.pipelineState;
+        return churnHandles<sgfx::DrawQueueHandle>(
+            [state](uint32_t) { return sgfx::createDrawQueue(state); },
+            [](sgfx::DrawQueueHandle handle) { sgfx::releaseDrawQueue(handle); }
+        );
+    });
+}
+
+//=============================================================================
+// the report, one benchmark per line so reports diff well
+static bool writeReport(const char* path, const std::vector<Result>& results)
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+        return false;
+
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"unit\": \"%s\", \"ops\": %llu, \"bytes_per_op\": %llu, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f }%s\n",
+            result.name.c_str(), result.unit.c_str(),
+            static_cast<unsigned long long>(result.numOps),
+            static_cast<unsigned long long>(result.bytesPerOp),
+            result.nsPerOp, result.minNsPerOp,
+            (i + 1 < results.size()) ? "," : ""
+        );
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+// name, ns_per_op and min_ns_per_op of every benchmark of a report this tool wrote
+static bool readReport(const char* path, std::vector<Result>& results)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    std::string text;
+    char chunk[4096];
+    for (size_t size; (size = fread(chunk, 1, sizeof(chunk), file)) != 0;)
+        text.append(chunk, size);
+    fclose(file);
+
+    const char* kName    = "\"name\": \"";
+    const char* kNsPerOp    = "\"ns_per_op\": ";
+    const char* kMinNsPerOp = "\"min_ns_per_op\": ";
+
+    for (size_t position = text.find(kName); position != std::string::npos; position = text.find(kName, position)) {
+        position += std::strlen(kName);
+        size_t nameEnd = text.find('"', position);
+        size_t next    = text.find(kName, position);
+        size_t value   = text.find(kNsPerOp, position);
+        size_t minimum = text.find(kMinNsPerOp, position);
+        if (nameEnd == std::string::npos || value == std::string::npos || minimum == std::string::npos)
+            return false;
+        if (next != std::string::npos && (value > next || minimum > next))
+            return false;
+
+        Result result;
+        result.name       = text.substr(position, nameEnd - position);
+        result.nsPerOp    = strtod(text.c_str() + value + std::strlen(kNsPerOp), nullptr);
+        result.minNsPerOp = strtod(text.c_str() + minimum + std::strlen(kMinNsPerOp), nullptr);
+        results.push_back(result);
+    }
+    return true;
+}
+
+static const Result* findResult(const std::vector<Result>& results, const std::string& name)
+{
+    auto it = std::find_if(results.begin(), results.end(), [&name](const Result& result) { return result.name == name; });
+    return (it != results.end()) ? &(*it) : nullptr;
+}
+
+// percent the fastest sample moved, positive is slower
+static double getChange(const Result& baseline, const Result& result)
+{
+    return (baseline.minNsPerOp > 0.0) ? (result.minNsPerOp - baseline.minNsPerOp) / baseline.minNsPerOp * 100.0 : 0.0;
+}
+
+// percent the median sits above the fastest sample, how much the samples of a run scatter
+static double getSpread(const Result& result)
+{
+    return (result.minNsPerOp > 0.0) ? (result.nsPerOp - result.minNsPerOp) / result.minNsPerOp * 100.0 : 0.0;
+}
+
+// percent a benchmark may get slower, the samples of either run scattering that far say nothing
+static double getTolerance(const Result& baseline, const Result& result)
+{
+    return g_options.threshold + std::max(getSpread(baseline), getSpread(result));
+}
+
+static bool isRegressed(const Result& baseline, const Result& result)
+{
+    return getChange(baseline, result) > getTolerance(baseline, result)
+        && result.minNsPerOp - baseline.minNsPerOp > kNoiseFloorNs;
+}
+
+// false if a benchmark got slower than its tolerance allows
+static bool compareWithBaseline(const std::vector<Result>& baseline, const std::vector<Result>& results)
+{
+    uint32_t numRegressions = 0;
+
+    printf("\nagainst %s, threshold %.1f%% plus the spread of the samples, %.1fns noise floor\n",
+        g_options.baselinePath, g_options.threshold, kNoiseFloorNs);
+    printf("%-50s %12s %12s %9s %9s\n", "fastest ns per op", "baseline", "now", "change", "allowed");
+
+    for (const Result& result : results) {
+        const Result* it = findResult(baseline, result.name);
+        if (it == nullptr) {
+            printf("%-50s %12s %12.1f %9s\n", result.name.c_str(), "-", result.minNsPerOp, "new");
+            continue;
+        }
+
+        double change    = getChange(*it, result);
+        double tolerance = getTolerance(*it, result);
+        const char* verdict = "";
+        if (isRegressed(*it, result)) {
+            verdict = "  REGRESSED";
+            numRegressions++;
+        } else if (change > tolerance) {
+            verdict = "  slower, below the noise floor";
+        } else if (change < -tolerance) {
+            verdict = "  improved";
+        }
+        printf("%-50s %12.1f %12.1f %+8.1f%% %8.1f%%%s\n", result.name.c_str(), it->minNsPerOp, result.minNsPerOp, change, tolerance, verdict);
+    }
+
+    if (numRegressions != 0)
+        printf("\n%u benchmarks regressed\n", numRegressions);
+    return numRegressions == 0;
+}
+
+static void printUsage()
+{
+    printf("usage: sgfx_bench [-out results.json] [-baseline baseline.json] [-threshold percent]\n");
+    printf("                  [-filter substring] [-repeats N] [-data dir]\n");
+}
+
+//=============================================================================
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-out") == 0 && hasValue) {
+            g_options.outPath = argv[++i];
+        } else if (std::strcmp(argv[i], "-baseline") == 0 && hasValue) {
+            g_options.baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "-threshold") == 0 && hasValue) {
+            g_options.threshold = atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "-filter") == 0 && hasValue) {
+            g_options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "-repeats") == 0 && hasValue) {
+            g_options.numRepeats = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "-data") == 0 && hasValue) {
+            g_options.dataDir = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // read up front, a missing baseline shouldn't cost a whole run
+    std::vector<Result> baseline;
+    if (g_options.baselinePath != nullptr && !readReport(g_options.baselinePath, baseline)) {
+        printf("can't read the baseline %s\n", g_options.baselinePath);
+        return 1;
+    }
+
+    // freeing a large block raises glibc's mmap and trim thresholds for the rest of the run, done
+    // up front the texture and asset benchmarks don't page fault their memory back in on every
+    // run or not depending on what ran before them, a -filter run measures what a full run does
+    if (void* block = malloc(16 << 20)) {
+        std::memset(block, 0, 16 << 20);
+        free(block);
+    }
+
+    sgfx::initNull(1280, 720);
+
+#if SGFX_ENABLE_STATS
+    printf("sgfx_bench, null backend, median of %u samples\n\n", g_options.numRepeats);
+#else
+    printf("sgfx_bench, null backend with the stats compiled out, median of %u samples\n\n", g_options.numRepeats);
+#endif
+
+    Scene scene;
+    createScene(scene);
+
+    benchDynamicArray();
+    benchRecording(scene);
+    benchDrawRecorders(scene);
+    benchDrawSort(scene);
+    benchBundleVisibility(scene);
+    benchInstanceMerge(scene);
+    benchStickyBindings(scene);
+    benchBindingLayout(scene);
+    benchResourceTables(scene);
+    benchInlineConstants(scene);
+    benchConstantBlocks(scene);
+    benchTransientUploads();
+    benchIndexFormats(scene);
+    benchBufferHeap();
+    benchMapModes();
+    benchFrameStats(scene);
+    benchProfiler();
+    benchCapture();
+    benchSubmit(scene);
+    benchCompute(scene);
+    benchAssets();
+    benchHandles(scene);
+
+    uint32_t numFailedChecks = runChecks();
+    if (!g_checks.empty())
+        printf("\n");
+
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : g_benchmarks) {
+        results.push_back(measure(benchmark));
+        printResult(results.back());
+    }
+
+    // a regression has to survive reruns to count, on a shared machine a hiccup can cost a
+    // benchmark every sample of a run; the faster result is kept
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result* previous = findResult(baseline, results[i].name);
+        for (uint32_t k = 0; previous != nullptr && k < kNumConfirmations && isRegressed(*previous, results[i]); ++k) {
+            Result rerun = measure(g_benchmarks[i]);
+            printf("%-50s %12.1f ns/%-9s rerun\n", rerun.name.c_str(), rerun.nsPerOp, rerun.unit.c_str());
+            if (rerun.minNsPerOp < results[i].minNsPerOp)
+                results[i] = rerun;
+        }
+    }
+
+    for (const std::function<void()>& cleanup : g_cleanups)
+        cleanup();
+
+    releaseScene(scene);
+    sgfx::shutdown();
+
+    if (g_options.outPath != nullptr) {
+        if (!writeReport(g_options.outPath, results)) {
+            printf("can't write %s\n", g_options.outPath);
+            return 1;
+        }
+        printf("\nreport written to %s\n", g_options.outPath);
+    }
+
+    bool passed = true;
+    if (g_options.baselinePath != nullptr)
+        passed = compareWithBaseline(baseline, results);
+
+    if (numFailedChecks != 0) {
+        printf("\n%u checks failed\n", numFailedChecks);
+        passed = false;
+    }
+
+    return passed ? 0 : 1;
+}
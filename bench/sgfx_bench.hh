@@ -0,0 +1,129 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// what the parts of sgfx_bench share: the benchmark and check registry, the clock and a scene of
+// resources to draw with; every bench/*_bench.cc adds the benchmarks of one area from a bench*()
+// function main() calls (see bench/sgfx_bench.cc)
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+// the library's default, sgfx_bench_nostats is built against one with the stats compiled out
+#ifndef SGFX_ENABLE_STATS
+#define SGFX_ENABLE_STATS 1
+#endif
+
+#define SGFX_NULL_INTEROP 1
+#include "sigrlinn.hh"
+
+//=============================================================================
+enum
+{
+    kNumChurnResources = 64 // buffers and textures of each kind in the Scene
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double getNanoseconds(Clock::time_point start, Clock::time_point stop);
+
+// false if -filter leaves the benchmark or check of that name out
+bool isSelected(const char* name);
+
+// run executes the workload once and returns the nanoseconds of its measured part, so per-run
+// setup (recording before a timed submit, refilling arrays) stays out of the numbers
+void addBenchmark(const char* name, const char* unit, uint64_t numOps, uint64_t bytesPerOp, const std::function<double()>& run);
+
+// a check runs once before the benchmarks and fails the run when it returns false, whatever the
+// timings; it prints what went wrong with checkFailed()
+void addCheck(const char* name, const std::function<bool()>& check);
+
+// runs after the benchmarks, before the scene is released and the backend shut down, for what an
+// area keeps between runs
+void addCleanup(const std::function<void()>& cleanup);
+
+// prints the mismatch and returns false unless value is what was expected
+bool checkEqual(const char* what, uint64_t value, uint64_t expected);
+bool checkFailed(const char* format, ...);
+
+// the directory the asset benchmarks load from, -data
+const std::string& getDataDir();
+
+// results the compiler can't drop go here
+extern volatile uint64_t g_sink;
+
+//=============================================================================
+// shaders, vertex format and pipeline state; the null backend takes any bytecode, every part of
+// the suite draws with the same one
+struct Pipeline final
+{
+    sgfx::VertexShaderHandle    vs;
+    sgfx::PixelShaderHandle     ps;
+    sgfx::SurfaceShaderHandle   surfaceShader;
+    sgfx::VertexFormatHandle    vertexFormat;
+    sgfx::PipelineStateHandle   pipelineState;
+};
+
+// desc.shader and desc.vertexFormat are filled in, the elements default to a float3 position
+void createPipeline(Pipeline& pipeline, sgfx::PipelineStateDescriptor desc = sgfx::PipelineStateDescriptor(), sgfx::VertexElementDescriptor* elements = nullptr, size_t numElements = 0);
+void releasePipeline(Pipeline& pipeline);
+
+// a pipeline and the resources the draws bind, a triangle in every vertex and index buffer
+struct Scene final
+{
+    Pipeline                    pipeline;
+    sgfx::ComputeShaderHandle   cs;
+    sgfx::DrawQueueHandle       drawQueue;
+    sgfx::ComputeQueueHandle    computeQueue;
+    sgfx::BufferHandle          indirectArgs;
+    sgfx::BufferHandle          rwBuffer;
+    sgfx::BufferHandle          vertexBuffers[kNumChurnResources];
+    sgfx::BufferHandle          indexBuffers[kNumChurnResources];
+    sgfx::ConstantBufferHandle  constantBuffers[kNumChurnResources];
+    sgfx::TextureHandle         textures[kNumChurnResources];
+};
+
+// submits the queue, presents and returns what the null backend counted for it
+sgfx::null::DeviceStats submitAndCount(sgfx::DrawQueueHandle queue, uint32_t submitFlags = 0);
+
+//=============================================================================
+// the areas, each adds its benchmarks and checks
+void benchDynamicArray();
+void benchDrawRecorders(const Scene& scene);
+void benchDrawSort(const Scene& scene);
+void benchBundleVisibility(const Scene& scene);
+void benchInstanceMerge(const Scene& scene);
+void benchStickyBindings(const Scene& scene);
+void benchBindingLayout(const Scene& scene);
+void benchResourceTables(const Scene& scene);
+void benchInlineConstants(const Scene& scene);
+void benchConstantBlocks(const Scene& scene);
+void benchTransientUploads();
+void benchIndexFormats(const Scene& scene);
+void benchBufferHeap();
+void benchMapModes();
+void benchFrameStats(const Scene& scene);
+void benchProfiler();
+void benchCapture();
@@ -0,0 +1,125 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// the same material-sorted scene is recorded into a regular queue, setting every
+// binding before every draw, and into a queue created with DrawQueueFlags::StickyBindings,
+// setting only the bindings that change. The check compares what both submit.
+
+#include <cstring>
+#include <stdio.h>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kNumStickyDraws = 100000
+};
+
+// every binding before every draw
+static void recordDraws(const Scene& scene, sgfx::DrawQueueHandle queue)
+{
+    for (uint32_t i = 0; i < kNumStickyDraws; ++i) {
+        sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+        sgfx::setVertexBuffer(queue, scene.vertexBuffers[(i / 4) % kNumChurnResources]);
+        sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+        sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[(i / 64) % 8]);
+        sgfx::setResource(queue, 0, scene.textures[(i / 256) % 16]);
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+// only the bindings that differ from the previous draw
+static void recordStickyDraws(const Scene& scene, sgfx::DrawQueueHandle queue)
+{
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+    sgfx::setIndexBuffer(queue, scene.indexBuffers[0]);
+
+    for (uint32_t i = 0; i < kNumStickyDraws; ++i) {
+        if (i % 4 == 0)
+            sgfx::setVertexBuffer(queue, scene.vertexBuffers[(i / 4) % kNumChurnResources]);
+        if (i % 64 == 0)
+            sgfx::setConstantBuffer(queue, 0, scene.constantBuffers[(i / 64) % 8]);
+        if (i % 256 == 0)
+            sgfx::setResource(queue, 0, scene.textures[(i / 256) % 16]);
+        sgfx::drawIndexed(queue, 3, 0, 0);
+    }
+}
+
+static void recordFrame(const Scene& scene, sgfx::DrawQueueHandle queue, bool useStickyBindings)
+{
+    if (useStickyBindings)
+        recordStickyDraws(scene, queue);
+    else
+        recordDraws(scene, queue);
+}
+
+void benchStickyBindings(const Scene& scene)
+{
+    sgfx::DrawQueueHandle stickyQueue = sgfx::createDrawQueue(scene.pipeline.pipelineState, sgfx::DrawQueueFlags::StickyBindings);
+    addCleanup([stickyQueue]() { sgfx::releaseDrawQueue(stickyQueue); });
+
+    // the sticky queue fills in the bindings the draws didn't set, the device can't tell
+    addCheck("sticky_bindings/same_state", [&scene, stickyQueue]() {
+        recordDraws(scene, scene.drawQueue);
+        sgfx::null::DeviceStats expected = submitAndCount(scene.drawQueue);
+
+        recordStickyDraws(scene, stickyQueue);
+        sgfx::null::DeviceStats sticky = submitAndCount(stickyQueue);
+
+        if (std::memcmp(&sticky, &expected, sizeof(sticky)) != 0)
+            return checkFailed("the sticky queue submitted %llu draws and %llu input binds instead of %llu and %llu",
+                static_cast<unsigned long long>(sticky.numDrawCalls), static_cast<unsigned long long>(sticky.numInputBinds),
+                static_cast<unsigned long long>(expected.numDrawCalls), static_cast<unsigned long long>(expected.numInputBinds));
+        return checkEqual("draws", sticky.numDrawCalls, kNumStickyDraws);
+    });
+
+    for (bool useStickyBindings : { false, true }) {
+        sgfx::DrawQueueHandle queue = useStickyBindings ? stickyQueue : scene.drawQueue;
+        const char*           mode  = useStickyBindings ? "changes_only" : "every_binding";
+
+        char name[64];
+        snprintf(name, sizeof(name), "sticky_bindings/record/%s", mode);
+        addBenchmark(name, "draw", kNumStickyDraws, 0, [&scene, queue, useStickyBindings]() {
+            auto start = Clock::now();
+            recordFrame(scene, queue, useStickyBindings);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::submit(queue);
+            sgfx::present(0);
+            return ns;
+        });
+
+        snprintf(name, sizeof(name), "sticky_bindings/submit/%s", mode);
+        addBenchmark(name, "draw", kNumStickyDraws, 0, [&scene, queue, useStickyBindings]() {
+            recordFrame(scene, queue, useStickyBindings);
+
+            auto start = Clock::now();
+            sgfx::submit(queue);
+            double ns = getNanoseconds(start, Clock::now());
+
+            sgfx::present(0);
+            return ns;
+        });
+    }
+}
@@ -0,0 +1,255 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// the dynamic geometry of two demos with and without allocateTransient():
+//   cmrs  re-tessellated indices every frame, the old path re-creates the index buffer whenever
+//         it grows and maps it, the new one streams the indices through the transient ring
+//   ffd   a deformed mesh, the old path releases and re-creates the vertex and index buffer on
+//         every deformation (here every frame), the new one streams the vertices and keeps the
+//         index buffer
+// The benchmarks time a frame, update and submit. The null backend has no driver to stall on a
+// mapped buffer still in use, the numbers are the CPU side only. The check makes sure the
+// transient paths draw the same and create no buffers once running.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sgfx_bench.hh"
+
+//=============================================================================
+enum
+{
+    kMinSurfaceIndices  = 60000,  // cmrs, the index count moves within this range
+    kMaxSurfaceIndices  = 180000,
+
+    kNumMeshVertices    = 20000,  // ffd
+    kNumMeshIndices     = 120000,
+
+    kNumCheckedFrames   = 120     // a whole tessellation cycle
+};
+
+enum class UploadMode
+{
+    CmrsRecreate,
+    CmrsTransient,
+    FfdRecreate,
+    FfdTransient
+};
+
+struct MeshVertex final
+{
+    float position[3];
+    float normal[3];
+};
+
+struct DynamicGeometry final
+{
+    Pipeline                    pipeline;
+    sgfx::DrawQueueHandle       drawQueue;
+
+    std::vector<uint32_t>       indices;
+    std::vector<MeshVertex>     vertices;
+};
+
+// buffers the old paths keep from frame to frame
+struct Buffers final
+{
+    sgfx::BufferHandle vertexBuffer;
+    sgfx::BufferHandle indexBuffer;
+    size_t             indexBufferSize = 0; // indices
+    uint32_t           frame           = 0;
+};
+
+static void createGeometry(DynamicGeometry& geometry)
+{
+    sgfx::VertexElementDescriptor elements[] = {
+        { "POSITION", 0, sgfx::DataFormat::RGB32F, 0, 0,                 false },
+        { "NORMAL",   0, sgfx::DataFormat::RGB32F, 0, 3 * sizeof(float), false }
+    };
+    createPipeline(geometry.pipeline, sgfx::PipelineStateDescriptor(), elements, 2);
+    geometry.drawQueue = sgfx::createDrawQueue(geometry.pipeline.pipelineState);
+
+    geometry.indices.resize(kMaxSurfaceIndices);
+    for (size_t i = 0; i < geometry.indices.size(); ++i)
+        geometry.indices[i] = static_cast<uint32_t>(i % kNumMeshVertices);
+
+    geometry.vertices.resize(kNumMeshVertices);
+    std::memset(geometry.vertices.data(), 0, geometry.vertices.size() * sizeof(MeshVertex));
+}
+
+static void releaseGeometry(DynamicGeometry& geometry)
+{
+    sgfx::releaseDrawQueue(geometry.drawQueue);
+    releasePipeline(geometry.pipeline);
+}
+
+static void releaseBuffers(Buffers& buffers)
+{
+    sgfx::releaseBuffer(buffers.vertexBuffer);
+    sgfx::releaseBuffer(buffers.indexBuffer);
+    buffers.vertexBuffer    = sgfx::BufferHandle::invalidHandle();
+    buffers.indexBuffer     = sgfx::BufferHandle::invalidHandle();
+    buffers.indexBufferSize = 0;
+}
+
+// the tessellation level follows the camera, the index count drifts up and down
+static size_t getSurfaceIndices(uint32_t frame)
+{
+    uint32_t phase = frame % 120;
+    uint32_t step  = (phase < 60) ? phase : 120 - phase;
+    return kMinSurfaceIndices + (kMaxSurfaceIndices - kMinSurfaceIndices) * step / 60 / 3 * 3;
+}
+
+static void renderFrame(DynamicGeometry& geometry, Buffers& buffers, UploadMode mode)
+{
+    sgfx::DrawQueueHandle queue = geometry.drawQueue;
+    uint32_t              frame = buffers.frame++;
+    sgfx::setPrimitiveTopology(queue, sgfx::PrimitiveTopology::TriangleList);
+
+    switch (mode) {
+    case UploadMode::CmrsRecreate: {
+        size_t numIndices = getSurfaceIndices(frame);
+
+        // demo_cmrs.cc before: grow the index buffer, then map and fill it
+        if (numIndices > buffers.indexBufferSize) {
+            sgfx::releaseBuffer(buffers.indexBuffer);
+            buffers.indexBufferSize = numIndices;
+            buffers.indexBuffer = sgfx::createBuffer(
+                sgfx::BufferFlags::IndexBuffer | sgfx::BufferFlags::CPUWrite,
+                nullptr, sizeof(uint32_t) * numIndices, sizeof(uint32_t));
+        }
+
+        void* data = sgfx::mapBuffer(buffers.indexBuffer, sgfx::MapType::Write);
+        if (data != nullptr) {
+            std::memcpy(data, geometry.indices.data(), numIndices * sizeof(uint32_t));
+            sgfx::unmapBuffer(buffers.indexBuffer);
+        }
+
+        sgfx::setIndexBuffer(queue, buffers.indexBuffer);
+        sgfx::drawIndexed(queue, static_cast<uint32_t>(numIndices), 0, 0);
+    } break;
+
+    case UploadMode::CmrsTransient: {
+        size_t numIndices = getSurfaceIndices(frame);
+
+        sgfx::TransientAllocation indices = sgfx::allocateTransient(numIndices * sizeof(uint32_t), sizeof(uint32_t));
+        std::memcpy(indices.cpuPtr, geometry.indices.data(), numIndices * sizeof(uint32_t));
+
+        sgfx::setIndexBuffer(queue, indices.buffer, indices.offset);
+        sgfx::drawIndexed(queue, static_cast<uint32_t>(numIndices), 0, 0);
+    } break;
+
+    case UploadMode::FfdRecreate: {
+        // demo_ffd.cc before: updateModel() re-creates both buffers
+        releaseBuffers(buffers);
+        buffers.vertexBuffer = sgfx::createBuffer(
+            sgfx::BufferFlags::VertexBuffer, geometry.vertices.data(), sizeof(MeshVertex) * kNumMeshVertices, sizeof(MeshVertex));
+        buffers.indexBuffer = sgfx::createBuffer(
+            sgfx::BufferFlags::IndexBuffer, geometry.indices.data(), sizeof(uint32_t) * kNumMeshIndices, sizeof(uint32_t));
+
+        sgfx::setVertexBuffer(queue, buffers.vertexBuffer);
+        sgfx::setIndexBuffer(queue, buffers.indexBuffer);
+        sgfx::drawIndexed(queue, kNumMeshIndices, 0, 0);
+    } break;
+
+    case UploadMode::FfdTransient: {
+        if (buffers.indexBuffer == sgfx::BufferHandle::invalidHandle()) {
+            buffers.indexBuffer = sgfx::createBuffer(
+                sgfx::BufferFlags::IndexBuffer, geometry.indices.data(), sizeof(uint32_t) * kNumMeshIndices, sizeof(uint32_t));
+        }
+
+        sgfx::TransientAllocation vertices = sgfx::allocateTransient(sizeof(MeshVertex) * kNumMeshVertices, sizeof(float));
+        std::memcpy(vertices.cpuPtr, geometry.vertices.data(), sizeof(MeshVertex) * kNumMeshVertices);
+
+        sgfx::setVertexBuffer(queue, vertices.buffer, 0, vertices.offset);
+        sgfx::setIndexBuffer(queue, buffers.indexBuffer);
+        sgfx::drawIndexed(queue, kNumMeshIndices, 0, 0);
+    } break;
+    }
+
+    sgfx::submit(queue);
+    sgfx::present(0);
+}
+
+// the second cycle of kNumCheckedFrames frames, the first creates what the mode keeps and grows
+// the transient ring to the largest frame
+static sgfx::null::DeviceStats countFrames(DynamicGeometry& geometry, UploadMode mode)
+{
+    Buffers buffers;
+    for (uint32_t frame = 0; frame < kNumCheckedFrames; ++frame)
+        renderFrame(geometry, buffers, mode);
+
+    sgfx::null::resetDeviceStats();
+    for (uint32_t frame = 0; frame < kNumCheckedFrames; ++frame)
+        renderFrame(geometry, buffers, mode);
+    sgfx::null::DeviceStats stats = sgfx::null::getDeviceStats();
+
+    releaseBuffers(buffers);
+    return stats;
+}
+
+void benchTransientUploads()
+{
+    std::shared_ptr<DynamicGeometry> geometry = std::make_shared<DynamicGeometry>();
+    createGeometry(*geometry);
+    addCleanup([geometry]() { releaseGeometry(*geometry); });
+
+    addCheck("transient_upload/no_buffers_created", [geometry]() {
+        sgfx::null::DeviceStats cmrsRecreate  = countFrames(*geometry, UploadMode::CmrsRecreate);
+        sgfx::null::DeviceStats cmrsTransient = countFrames(*geometry, UploadMode::CmrsTransient);
+        sgfx::null::DeviceStats ffdRecreate   = countFrames(*geometry, UploadMode::FfdRecreate);
+        sgfx::null::DeviceStats ffdTransient  = countFrames(*geometry, UploadMode::FfdTransient);
+
+        return checkEqual("cmrs draws", cmrsTransient.numDrawCalls, kNumCheckedFrames)
+            && checkEqual("cmrs primitives", cmrsTransient.numPrimitives, cmrsRecreate.numPrimitives)
+            && checkEqual("cmrs buffers created", cmrsTransient.numBuffersCreated, 0)
+            && checkEqual("ffd draws", ffdTransient.numDrawCalls, kNumCheckedFrames)
+            && checkEqual("ffd primitives", ffdTransient.numPrimitives, ffdRecreate.numPrimitives)
+            && checkEqual("ffd buffers created", ffdTransient.numBuffersCreated, 0);
+    });
+
+    struct ModeName final
+    {
+        UploadMode  mode;
+        const char* name;
+    };
+    static const ModeName kModes[] = {
+        { UploadMode::CmrsRecreate,  "transient_upload/cmrs/recreate"  },
+        { UploadMode::CmrsTransient, "transient_upload/cmrs/transient" },
+        { UploadMode::FfdRecreate,   "transient_upload/ffd/recreate"   },
+        { UploadMode::FfdTransient,  "transient_upload/ffd/transient"  }
+    };
+
+    for (const ModeName& mode : kModes) {
+        std::shared_ptr<Buffers> buffers = std::make_shared<Buffers>();
+        addCleanup([buffers]() { releaseBuffers(*buffers); });
+
+        UploadMode uploadMode = mode.mode;
+        addBenchmark(mode.name, "frame", 1, 0, [geometry, buffers, uploadMode]() {
+            auto start = Clock::now();
+            renderFrame(*geometry, *buffers, uploadMode);
+            return getNanoseconds(start, Clock::now());
+        });
+    }
+}
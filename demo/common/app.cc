@@ -22,11 +22,23 @@
 /// THE SOFTWARE.
 #include "app.hh"
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <stdio.h>
 
 Application* ApplicationInstance = nullptr;
 
+#ifndef APP_WIN32
+namespace util { bool debugOutputEnabled = true; }
+
+void OutputDebugString(const char* str)
+{
+    if (util::debugOutputEnabled)
+        fputs(str, stderr);
+}
+#endif
+
 void Application::genericErrorReporter(const char* msg)
 {
     OutputDebugString(msg);
@@ -28,14 +28,41 @@
 
 #include <vector>
 
+#if defined(_WIN32)
 #define APP_WIN32
+#endif
 
 #ifdef APP_WIN32
 #define NOMINMAX
 #include <windows.h>
 #include <d3d11.h>
+#else
+#include <xmmintrin.h> // _mm_malloc, the demos allocate their applications aligned
+
+// debug output goes to stderr without a debugger, tools that load assets in a loop mute it
+namespace util { extern bool debugOutputEnabled; }
+void OutputDebugString(const char* str);
 #endif
 
+// keys the demos read, the platform layer maps them to its keyboard or a script
+enum class Key : uint32_t
+{
+    Shift,
+    Control,
+    Left,
+    Right,
+    Up,
+    Down,
+    Home,
+    End,
+    Insert,
+    Delete,
+    Space,
+    F1,
+
+    Count
+};
+
 namespace util
 {
     inline void releaseHandle(sgfx::VertexShaderHandle obj)   { sgfx::releaseVertexShader(obj); }
@@ -51,9 +78,11 @@ namespace util
     inline void releaseHandle(sgfx::TextureHandle obj)        { sgfx::releaseTexture(obj); }
     inline void releaseHandle(sgfx::RenderTargetHandle obj)   { sgfx::releaseRenderTarget(obj); }
     inline void releaseHandle(sgfx::DrawQueueHandle obj)      { sgfx::releaseDrawQueue(obj); }
+    inline void releaseHandle(sgfx::BundleHandle obj)         { sgfx::releaseBundle(obj); }
     inline void releaseHandle(sgfx::ComputeQueueHandle obj)   { sgfx::releaseComputeQueue(obj); }
     inline void releaseHandle(sgfx::ComputeShaderHandle obj)  { sgfx::releaseComputeShader(obj); }
     inline void releaseHandle(sgfx::VertexFormatHandle obj)   { sgfx::releaseVertexFormat(obj); }
+    inline void releaseHandle(sgfx::BufferHeapHandle obj)     { sgfx::releaseBufferHeap(obj); }
 
     ///////////////////////////////////////////////////////////////////////
     // Graphics object handle
@@ -95,9 +124,11 @@ namespace util
     typedef GraphicsObjectHandle<sgfx::TextureHandle>        TextureHandle;
     typedef GraphicsObjectHandle<sgfx::RenderTargetHandle>   RenderTargetHandle;
     typedef GraphicsObjectHandle<sgfx::DrawQueueHandle>      DrawQueueHandle;
+    typedef GraphicsObjectHandle<sgfx::BundleHandle>         BundleHandle;
     typedef GraphicsObjectHandle<sgfx::ComputeQueueHandle>   ComputeQueueHandle;
     typedef GraphicsObjectHandle<sgfx::ComputeShaderHandle>  ComputeShaderHandle;
     typedef GraphicsObjectHandle<sgfx::VertexFormatHandle>   VertexFormatHandle;
+    typedef GraphicsObjectHandle<sgfx::BufferHeapHandle>     BufferHeapHandle;
 }
 
 class Application
@@ -117,6 +148,19 @@ protected:
     uint32_t width = 1024;
     uint32_t height = 768;
 
+    uint32_t keysDown       = 0; // a bit per Key, sampled at the start of a frame
+    uint32_t keysDownBefore = 0;
+
+    inline void updateKeys()
+    {
+        keysDownBefore = keysDown;
+        keysDown       = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(Key::Count); ++i) {
+            if (isKeyDown(static_cast<Key>(i)))
+                keysDown |= 1U << i;
+        }
+    }
+
     static void genericErrorReporter(const char* msg);
 
 public:
@@ -145,8 +189,24 @@ public:
     virtual void releaseSampleData() = 0;
     virtual void renderSample() = 0;
 
+    // platform layer, demo/win32_app.cc runs a window on D3D11, demo/headless_app.cc the null
+    // backend offscreen for a number of frames with a scripted camera and a fixed timestep
+    bool     initBackend();                 // sgfx init, the first thing loadSampleData does
+    bool     isKeyDown(Key key) const;
+    uint64_t getTimeMs() const;             // milliseconds from an arbitrary start, never 0
+
+    // went down since the previous frame, for toggles and one-shot actions
+    inline bool wasKeyPressed(Key key) const
+    {
+        uint32_t bit = 1U << static_cast<uint32_t>(key);
+        return (keysDown & bit) != 0 && (keysDownBefore & bit) == 0;
+    }
+
     void render();
     void setWindowTitle(const char* str);
+
+    // before loadSampleData, the window takes its size from the demo
+    inline void setBackBufferSize(uint32_t newWidth, uint32_t newHeight) { width = newWidth; height = newHeight; }
 };
 
 extern Application* ApplicationInstance;
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <cstring>
 #include <memory>
 #include <vector>
 #include <string>
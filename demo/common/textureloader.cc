@@ -25,6 +25,7 @@
 #include "sigrlinn.hh"
 #include "app.hh"
 
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <algorithm>
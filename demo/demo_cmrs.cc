@@ -216,7 +216,6 @@ public:
     sgfx::SurfaceShaderHandle   ssHandle;
 
     sgfx::BufferHandle          vertexBuffer;
-    sgfx::BufferHandle          indexBuffer;
     sgfx::ConstantBufferHandle  constantBuffer;
     sgfx::VertexFormatHandle    vertexFormat;
 
@@ -228,7 +227,6 @@ public:
     sgfx::RenderTargetHandle    renderTarget;
 
     std::vector<uint32_t>       surfaceIndexBuffer;
-    size_t                      surfaceIndexBufferSize = 0;
     Surface<CommonVertex>       surface;
 
 public:
@@ -246,7 +244,7 @@ public:
     virtual void loadSampleData() override
     {
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         // create render target
         colorBuffer        = sgfx::getBackBuffer();
@@ -347,7 +345,6 @@ public:
     {
         OutputDebugString("Cleanup\n");
         sgfx::releaseBuffer(vertexBuffer);
-        sgfx::releaseBuffer(indexBuffer);
         sgfx::releaseConstantBuffer(constantBuffer);
         sgfx::releaseVertexFormat(vertexFormat);
         sgfx::releaseVertexShader(vsHandle);
@@ -368,8 +365,8 @@ public:
         // Update our time
         static float t = 0.0f;
 
-        static ULONGLONG dwTimeStart = 0;
-        ULONGLONG dwTimeCur = GetTickCount64();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = getTimeMs();
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
@@ -380,25 +377,25 @@ public:
         static float cameraAngle = 0.0F;
 
         float cameraSpeed = 2.0F;
-        if (GetAsyncKeyState(VK_SHIFT)) cameraSpeed = 10.0F;
+        if (isKeyDown(Key::Shift)) cameraSpeed = 10.0F;
 
-        if (GetAsyncKeyState(VK_CONTROL)) {
-            if (GetAsyncKeyState(VK_LEFT))      cameraAngle += t * 0.5F;
-            if (GetAsyncKeyState(VK_RIGHT))     cameraAngle -= t * 0.5F;
+        if (isKeyDown(Key::Control)) {
+            if (isKeyDown(Key::Left))      cameraAngle += t * 0.5F;
+            if (isKeyDown(Key::Right))     cameraAngle -= t * 0.5F;
         } else {
-            if (GetAsyncKeyState(VK_UP))        cameraPosition.z += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_DOWN))      cameraPosition.z -= t * cameraSpeed;
-            if (GetAsyncKeyState(VK_LEFT))      cameraPosition.x += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_RIGHT))     cameraPosition.x -= t * cameraSpeed;
-            if (GetAsyncKeyState(VK_HOME))      cameraPosition.y += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_END))       cameraPosition.y -= t * cameraSpeed;
+            if (isKeyDown(Key::Up))        cameraPosition.z += t * cameraSpeed;
+            if (isKeyDown(Key::Down))      cameraPosition.z -= t * cameraSpeed;
+            if (isKeyDown(Key::Left))      cameraPosition.x += t * cameraSpeed;
+            if (isKeyDown(Key::Right))     cameraPosition.x -= t * cameraSpeed;
+            if (isKeyDown(Key::Home))      cameraPosition.y += t * cameraSpeed;
+            if (isKeyDown(Key::End))       cameraPosition.y -= t * cameraSpeed;
         }
 
         static float distFactor = 100.0F;
-        if (GetAsyncKeyState(VK_INSERT)) distFactor += 1.0F;
-        if (GetAsyncKeyState(VK_DELETE)) distFactor -= 1.0F;
+        if (isKeyDown(Key::Insert)) distFactor += 1.0F;
+        if (isKeyDown(Key::Delete)) distFactor -= 1.0F;
 
-        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.1f, 50000.0f);
+        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.1f, 50000.0f);
         glm::mat4 view       = glm::lookAt(cameraPosition, cameraPosition + glm::vec3(sin(cameraAngle), -1.0F, cos(cameraAngle)), glm::vec3(0.0F, 1.0F, 0.0F));
         //glm::mat4 world      = glm::rotate(glm::mat4(1.0F), 0.0F, glm::vec3(0.0F, 1.0F, 0.0F));
 
@@ -408,30 +405,15 @@ public:
         std::memcpy(constants.mvp, glm::value_ptr(mvp), sizeof(constants.mvp));
         sgfx::updateConstantBuffer(constantBuffer, &constants);
 
-        // tessellate shape and fill IB
-        //if (surfaceIndexBufferSize == 0)
+        // tessellate shape and stream the indices, they only live for this frame
+        sgfx::TransientAllocation indices;
         {
             surfaceIndexBuffer.clear();
             surface.tessellate(cameraPosition, distFactor, surfaceIndexBuffer);
 
-            // recreate buffer if needed
-            if (surfaceIndexBuffer.size() > surfaceIndexBufferSize) {
-                sgfx::releaseBuffer(indexBuffer);
-                surfaceIndexBufferSize = surfaceIndexBuffer.size();
-
-                indexBuffer = sgfx::createBuffer(
-                    sgfx::BufferFlags::IndexBuffer | sgfx::BufferFlags::CPUWrite,
-                    nullptr, sizeof(uint32_t) * surfaceIndexBufferSize,
-                    sizeof(uint32_t));
-            }
-
-            // map and update
-            void* data = sgfx::mapBuffer(indexBuffer, sgfx::MapType::Write);
-            if (data != nullptr) {
-                std::memcpy(data, surfaceIndexBuffer.data(), surfaceIndexBuffer.size() * sizeof(uint32_t));
-
-                sgfx::unmapBuffer(indexBuffer);
-            }
+            indices = sgfx::allocateTransient(surfaceIndexBuffer.size() * sizeof(uint32_t), sizeof(uint32_t));
+            if (indices.cpuPtr != nullptr)
+                std::memcpy(indices.cpuPtr, surfaceIndexBuffer.data(), surfaceIndexBuffer.size() * sizeof(uint32_t));
 
             // display stats
             std::ostringstream oss;
@@ -449,7 +431,7 @@ public:
             sgfx::setPrimitiveTopology(drawQueue, sgfx::PrimitiveTopology::TriangleList);
             sgfx::setConstantBuffer(drawQueue, 0, constantBuffer);
             sgfx::setVertexBuffer(drawQueue, vertexBuffer);
-            sgfx::setIndexBuffer(drawQueue, indexBuffer);
+            sgfx::setIndexBuffer(drawQueue, indices.buffer, indices.offset);
             sgfx::drawIndexed(drawQueue, static_cast<uint32_t>(surfaceIndexBuffer.size()), 0, 0);
 
             sgfx::submit(drawQueue);
@@ -81,7 +81,7 @@ public:
 	virtual void loadSampleData() override
 	{
 		// setup Sigrlinn
-		sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+		initBackend();
 
 		// create render target
 		colorBuffer        = sgfx::getBackBuffer();
@@ -270,11 +270,11 @@ public:
 		};
 		size_t verticesSize = sizeof(cubeVertices) / sizeof(CommonVertex);
 
-		static uint32_t cubeIndices[] = { 0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4, 8, 9, 10, 10, 11, 8, 12, 13, 14, 14, 15, 12, 16, 17, 18, 18, 19, 16, 20, 21, 22, 22, 23, 20 };
-		size_t indicesSize = sizeof(cubeIndices) / sizeof(uint32_t);
+		static uint16_t cubeIndices[] = { 0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4, 8, 9, 10, 10, 11, 8, 12, 13, 14, 14, 15, 12, 16, 17, 18, 18, 19, 16, 20, 21, 22, 22, 23, 20 };
+		size_t indicesSize = sizeof(cubeIndices) / sizeof(uint16_t);
 
 		cubeVertexBuffer = sgfx::createBuffer(sgfx::BufferFlags::VertexBuffer, cubeVertices, sizeof(CommonVertex) * verticesSize, sizeof(CommonVertex));
-		cubeIndexBuffer  = sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, cubeIndices, sizeof(uint32_t) * indicesSize, sizeof(uint32_t));
+		cubeIndexBuffer  = sgfx::createBuffer(sgfx::BufferFlags::IndexBuffer, cubeIndices, sizeof(uint16_t) * indicesSize, sizeof(uint16_t));
 
 		vsHandle = loadVS("shaders/sample0.hlsl");
 		psHandle = loadPS("shaders/sample0.hlsl");
@@ -366,15 +366,15 @@ public:
 		// Update our time
 		static float t = 0.0f;
 
-		static ULONGLONG dwTimeStart = 0;
-		ULONGLONG dwTimeCur = GetTickCount64();
+		static uint64_t dwTimeStart = 0;
+		uint64_t dwTimeCur = getTimeMs();
 		if (dwTimeStart == 0)
 		{
 			dwTimeStart = dwTimeCur;
 		}
 		t = (dwTimeCur - dwTimeStart) / 1000.0f;
 
-		glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.01f, 100.0f);
+		glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.01f, 100.0f);
 		glm::mat4 view       = glm::lookAt(glm::vec3(0.0F, 1.0F, -5.0F), glm::vec3(0.0F, 1.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
 		glm::mat4 world      = glm::rotate(glm::mat4(1.0F), t, glm::vec3(0.0F, 1.0F, 0.0F));
 
@@ -394,7 +394,7 @@ public:
 			sgfx::setPrimitiveTopology(drawQueue, sgfx::PrimitiveTopology::TriangleList);
 			sgfx::setConstantBuffer(drawQueue, 0, constantBuffer);
 			sgfx::setVertexBuffer(drawQueue, cubeVertexBuffer);
-			sgfx::setIndexBuffer(drawQueue, cubeIndexBuffer);
+			sgfx::setIndexBuffer(drawQueue, cubeIndexBuffer, 0, sgfx::IndexFormat::UInt16);
 			sgfx::drawIndexed(drawQueue, 36, 0, 0);
 
 			sgfx::submit(drawQueue);
@@ -110,22 +110,24 @@ public:
             meshData.getVertices()[i].position = spline->GetPosition(splineParameters[i]);
         }
 
-        sgfx::releaseBuffer(modelVertexBuffer);
-        sgfx::releaseBuffer(modelIndexBuffer);
+        // the topology never changes, the buffers are created once and the vertices rewritten
+        if (modelVertexBuffer == sgfx::BufferHandle::invalidHandle()) {
+            modelVertexBuffer = sgfx::createBuffer(
+                sgfx::BufferFlags::VertexBuffer,
+                nullptr,
+                sizeof(MeshData::Vertex) * meshData.getVertices().size(),
+                sizeof(MeshData::Vertex)
+            );
 
-        modelVertexBuffer = sgfx::createBuffer(
-            sgfx::BufferFlags::VertexBuffer, 
-            meshData.getVertices().data(),
-            sizeof(MeshData::Vertex) * meshData.getVertices().size(),
-            sizeof(MeshData::Vertex)
-        );
+            modelIndexBuffer = sgfx::createBuffer(
+                sgfx::BufferFlags::IndexBuffer,
+                meshData.getIndices().data(),
+                sizeof(uint32_t) * meshData.getIndices().size(),
+                sizeof(uint32_t)
+            );
+        }
 
-        modelIndexBuffer = sgfx::createBuffer(
-            sgfx::BufferFlags::IndexBuffer,
-            meshData.getIndices().data(),
-            sizeof(uint32_t) * meshData.getIndices().size(),
-            sizeof(uint32_t)
-        );
+        sgfx::copyBufferData(modelVertexBuffer, 0, sizeof(MeshData::Vertex) * meshData.getVertices().size(), meshData.getVertices().data());
     }
 
     virtual void loadSampleData() override
@@ -133,7 +135,7 @@ public:
         setWindowTitle("FreeFormDeformation - press space to randomly deform the mesh");
 
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         // create render target
         colorBuffer        = sgfx::getBackBuffer();
@@ -350,23 +352,21 @@ public:
     {
         // randomize mesh if necessary
         static bool doRandomize = false;
-        if (GetAsyncKeyState(VK_SPACE)) {
+        if (wasKeyPressed(Key::Space)) {
             randomizeSpline();
             updateModel();
-
-            Sleep(500);
         }
 
         // Update our time
         static float t = 0.0f;
 
-        static ULONGLONG dwTimeStart = 0;
-        ULONGLONG dwTimeCur = GetTickCount64();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = getTimeMs();
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
 
-        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.01f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.01f, 100.0f);
         glm::mat4 view       = glm::lookAt(glm::vec3(0.0F, 0.0F, -3.0F), glm::vec3(0.0F, 0.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
         glm::mat4 world      = glm::scale(glm::mat4(1.0F), glm::vec3(2.5F)) * glm::rotate(glm::mat4(1.0F), t, glm::vec3(0.0F, 1.0F, 0.0F));
 
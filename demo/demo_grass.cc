@@ -34,6 +34,13 @@
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
+#ifndef APP_WIN32
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef APP_WIN32
 bool listFiles(std::string path, std::string mask, std::vector<std::string>& files) {
     HANDLE hFind = INVALID_HANDLE_VALUE;
     WIN32_FIND_DATAA ffd;
@@ -74,6 +81,46 @@ bool listFiles(std::string path, std::string mask, std::vector<std::string>& fil
 
     return true;
 }
+#else
+bool listFiles(std::string path, std::string mask, std::vector<std::string>& files) {
+    std::stack<std::string> directories;
+
+    directories.push(path);
+    files.clear();
+
+    while (!directories.empty()) {
+        path = directories.top();
+        directories.pop();
+
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            return false;
+        }
+
+        while (dirent* entry = readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+                continue;
+            if (fnmatch(mask.c_str(), entry->d_name, 0) != 0)
+                continue;
+
+            std::string entryPath = path + "/" + entry->d_name;
+
+            struct stat entryStat;
+            if (stat(entryPath.c_str(), &entryStat) == 0 && S_ISDIR(entryStat.st_mode)) {
+                directories.push(entryPath);
+            } else {
+                files.push_back(entryPath);
+            }
+        }
+
+        closedir(dir);
+    }
+
+    // readdir has no order, sorted like NTFS lists them so the field is laid out the same
+    std::sort(files.begin(), files.end());
+    return true;
+}
+#endif
 
 struct BoundingBox final
 {
@@ -87,6 +134,7 @@ struct LogicalMeshBuffer final
     uint32_t dataSize         = 0;
     uint32_t dataFormatStride = 0;
     uint32_t physicalAddress  = 0;
+    uint32_t physicalBlock    = 0; // id of the heap block
 };
 
 struct LogicalMesh final
@@ -110,57 +158,61 @@ struct LogicalMesh final
     }
 };
 
+// all pages share one buffer heap, so loading or dropping a mesh never re-creates the buffer
 struct PhysicalMeshBuffer final
 {
-    util::BufferHandle physicalBuffer;
-    size_t             physicalDataSize;
-    bool               isDirty = false;
+    enum : uint32_t
+    {
+        kHeapSize       = 64 * 1024 * 1024, // bytes
+        kCompactionStep = 1024 * 1024       // bytes moved per frame at most
+    };
+
+    util::BufferHeapHandle physicalHeap;
+    sgfx::BufferHandle     physicalBuffer; // the heap's buffer, set by the first allocation
 
     typedef std::vector<LogicalMeshBuffer*> PageArray;
     PageArray allPages;
 
-    inline void allocate(LogicalMeshBuffer* logicalBuffer)
+    inline void create(size_t vfStride)
     {
-        allPages.push_back(logicalBuffer);
-        isDirty = true;
+        physicalHeap = sgfx::createBufferHeap(sgfx::BufferFlags::StructuredBuffer, kHeapSize, vfStride);
     }
 
-    inline void rebuildPages()
+    inline bool allocate(LogicalMeshBuffer* logicalBuffer)
     {
-        if (!isDirty) return;
+        sgfx::BufferBlock block = sgfx::allocateBufferBlock(physicalHeap, logicalBuffer->data, logicalBuffer->dataSize);
+        if (block.buffer == sgfx::BufferHandle::invalidHandle())
+            return false;
 
-        size_t vfStride = allPages[0]->dataFormatStride;
-        physicalDataSize = 0;
-        for (LogicalMeshBuffer* logicalBuffer: allPages) // calculate total size
-            physicalDataSize += logicalBuffer->dataSize; // TODO: find a better place for this
+        physicalBuffer = block.buffer;
 
-        size_t numElements = physicalDataSize / vfStride;
+        logicalBuffer->physicalBlock   = block.id;
+        logicalBuffer->physicalAddress = block.offset / logicalBuffer->dataFormatStride;
+        allPages.push_back(logicalBuffer);
+        return true;
+    }
 
-        sgfx::releaseBuffer(physicalBuffer);
-        physicalBuffer = sgfx::createBuffer(
-            sgfx::BufferFlags::CPUWrite | sgfx::BufferFlags::StructuredBuffer,
-            nullptr,
-            physicalDataSize,
-            vfStride
-        );
+    inline void free(LogicalMeshBuffer* logicalBuffer)
+    {
+        PageArray::iterator it = std::find(allPages.begin(), allPages.end(), logicalBuffer);
+        if (it != allPages.end()) {
+            sgfx::freeBufferBlock(physicalHeap, sgfx::getBufferBlock(physicalHeap, logicalBuffer->physicalBlock));
+            allPages.erase(it);
+        }
+    }
 
-        uint8_t* dataPtr = reinterpret_cast<uint8_t*>(sgfx::mapBuffer(physicalBuffer, sgfx::MapType::Write));
-        if (dataPtr != nullptr) {
-            uint32_t pageOffset = 0;
-            for (size_t i = 0; i < allPages.size(); ++i) {
-                LogicalMeshBuffer* logicalBuffer = allPages[i];
-                // copy logical data to the mapped physical data
-                std::memcpy(dataPtr + pageOffset, logicalBuffer->data, logicalBuffer->dataSize);
-                // calculate physical address
-                logicalBuffer->physicalAddress = pageOffset / logicalBuffer->dataFormatStride;
-                // calculate offset
-                pageOffset += logicalBuffer->dataSize;
-            }
+    // moves a few pages down over the space freed by dropped meshes, returns true if
+    // physical addresses changed
+    inline bool compactPages()
+    {
+        if (sgfx::compactBufferHeap(physicalHeap, kCompactionStep) == 0)
+            return false;
 
-            sgfx::unmapBuffer(physicalBuffer);
+        for (LogicalMeshBuffer* logicalBuffer: allPages) {
+            sgfx::BufferBlock block = sgfx::getBufferBlock(physicalHeap, logicalBuffer->physicalBlock);
+            logicalBuffer->physicalAddress = block.offset / logicalBuffer->dataFormatStride;
         }
-
-        isDirty = false;
+        return true;
     }
 };
 
@@ -237,6 +289,8 @@ struct DVPGrassManager final
     util::BufferHandle          occlusionDataBuffer;
     util::BufferHandle          indirectRenderBuffer;
     util::BufferHandle          indirectRenderBufferCPU;
+
+    util::BundleHandle          occlusionBundle;
     
     uint32_t                    numInstances = 0;
     uint32_t                    maxDrawCallCount = 0;
@@ -275,6 +329,9 @@ struct DVPGrassManager final
         samplerDesc.maxLod         = 3.402823466e+38F;
 
         samplerState = sgfx::createSamplerState(samplerDesc);
+
+        physicalVertexBuffer.create(sizeof(MeshData::Vertex));
+        physicalIndexBuffer.create(sizeof(MeshData::Index));
     }
 
     ~DVPGrassManager()
@@ -291,7 +348,7 @@ struct DVPGrassManager final
         grassTexture = loadDDS(path);
     }
 
-    void loadDataSet(const std::string& path)
+    void loadDataSet(const std::string& path, uint32_t seed)
     {
         std::vector<std::string> files;
         if (listFiles(path, "*.mesh", files)) {
@@ -307,7 +364,7 @@ struct DVPGrassManager final
                 logicalMeshes.push_back(logicalMesh);
             }
 
-            srand(GetTickCount());
+            srand(seed);
             size_t meshCounter = 0;
             for (int i = -kObjectSizeSquared; i < kObjectSizeSquared; ++i) {
                 for (int j = -kObjectSizeSquared; j < kObjectSizeSquared; ++j) {
@@ -330,10 +387,46 @@ struct DVPGrassManager final
         }
     }
 
+    void uploadInstanceData()
+    {
+        uint8_t* dataPtr = reinterpret_cast<uint8_t*>(sgfx::mapBuffer(initialInstanceBuffer, sgfx::MapType::WriteDiscard));
+        if (dataPtr != nullptr) {
+
+            for (size_t i = 0; i < numInstances; ++i) {
+                size_t offset = i * GrassObject::kDVPBufferSize;
+                const GrassObject& obj = grassObjects[i];
+
+                glm::mat4 matrix = glm::translate(obj.position);
+                matrix = glm::transpose(matrix);
+
+                //glm::vec4 boundingBoxMin = obj.boundingBox.min * matrix;
+                //glm::vec4 boundingBoxMax = obj.boundingBox.max * matrix;
+
+                GrassObject::DVPBuffer dvpData;
+                // fill internal data structure
+                dvpData.drawCallData[0] = obj.vertexBuffer->physicalAddress;
+                dvpData.drawCallData[1] = obj.indexBuffer->physicalAddress;
+
+                dvpData.drawCallData[2] = 1; // draw indexed
+                dvpData.drawCallData[3] = obj.count;
+
+                // copy matrix
+                std::memcpy(dvpData.modelview,      glm::value_ptr(matrix),         sizeof(dvpData.modelview));
+
+                std::memcpy(dataPtr + offset, &dvpData, GrassObject::kDVPBufferSize);
+
+                maxDrawCallCount = std::max(maxDrawCallCount, obj.count);
+            }
+
+            sgfx::unmapBuffer(initialInstanceBuffer);
+        }
+    }
+
     void render(sgfx::DrawQueueHandle drawQueue, sgfx::DrawQueueHandle occlusionQueue, sgfx::ComputeQueueHandle computeQueue, const glm::mat4& mvp)
     {
-        physicalVertexBuffer.rebuildPages();
-        physicalIndexBuffer.rebuildPages();
+        // instances hold physical addresses, upload them again if pages moved
+        bool pagesMoved = physicalVertexBuffer.compactPages();
+        pagesMoved = physicalIndexBuffer.compactPages() || pagesMoved;
 
         // rebuild buffers if needed
         if (grassObjects.size() != numInstances) {
@@ -377,43 +470,14 @@ struct DVPGrassManager final
             cullCSConstantBuffer = sgfx::createConstantBuffer(&cullCSConstantData, sizeof(CullCSConstantBuffer));
             renderConstantBuffer = sgfx::createConstantBuffer(&renderConstantData, sizeof(renderConstantData));
 
-            // update data
-            uint8_t* dataPtr = reinterpret_cast<uint8_t*>(sgfx::mapBuffer(initialInstanceBuffer, sgfx::MapType::Write));
-            if (dataPtr != nullptr) {
-
-                for (size_t i = 0; i < numInstances; ++i) {
-                    size_t offset = i * GrassObject::kDVPBufferSize;
-                    const GrassObject& obj = grassObjects[i];
-
-                    glm::mat4 matrix = glm::translate(obj.position);
-                    matrix = glm::transpose(matrix);
-
-                    //glm::vec4 boundingBoxMin = obj.boundingBox.min * matrix;
-                    //glm::vec4 boundingBoxMax = obj.boundingBox.max * matrix;
-
-                    GrassObject::DVPBuffer dvpData;
-                    // fill internal data structure
-                    dvpData.drawCallData[0] = obj.vertexBuffer->physicalAddress;
-                    dvpData.drawCallData[1] = obj.indexBuffer->physicalAddress;
-
-                    dvpData.drawCallData[2] = 1; // draw indexed
-                    dvpData.drawCallData[3] = obj.count;
-
-                    // copy matrix
-                    std::memcpy(dvpData.modelview,      glm::value_ptr(matrix),         sizeof(dvpData.modelview));
-
-                    std::memcpy(dataPtr + offset, &dvpData, GrassObject::kDVPBufferSize);
-
-                    maxDrawCallCount = std::max(maxDrawCallCount, obj.count);
-                }
-
-                sgfx::unmapBuffer(initialInstanceBuffer);
-            }
+            uploadInstanceData();
 
             // update const buffer
             cullCSConstantData.numItems         = static_cast<float>(numInstances);
             cullCSConstantData.maxDrawCallCount = maxDrawCallCount;
             sgfx::updateConstantBuffer(cullCSConstantBuffer, &cullCSConstantData);
+        } else if (pagesMoved) {
+            uploadInstanceData();
         }
 
         // update const buffer
@@ -432,7 +496,7 @@ struct DVPGrassManager final
             sgfx::setResourceRW(computeQueue, 0, finalInstanceBuffer);
             sgfx::setResourceRW(computeQueue, 1, indirectRenderBuffer);
 
-            //uint32_t groupCount = static_cast<uint32_t>(std::ceilf(numInstancesF / 128.0F));
+            //uint32_t groupCount = static_cast<uint32_t>(std::ceil(numInstancesF / 128.0F));
             sgfx::submit(computeQueue, 1, 1, 1);
 
             sgfx::endPerfEvent();
@@ -453,8 +517,8 @@ struct DVPGrassManager final
             //sgfx::submit(drawQueue);
         }
 
-        // render occluders
-        {
+        // render occluders, they never change so they are recorded once into a bundle
+        if (!sgfx::isBundleValid(occlusionBundle)) {
             sgfx::setPrimitiveTopology(occlusionQueue, sgfx::PrimitiveTopology::TriangleList);
             sgfx::setConstantBuffer(occlusionQueue, 0, renderConstantBuffer);
             sgfx::setResource(occlusionQueue, 0, physicalVertexBuffer.physicalBuffer);
@@ -462,8 +526,10 @@ struct DVPGrassManager final
             sgfx::setResource(occlusionQueue, 2, initialInstanceBuffer);
             sgfx::drawInstanced(occlusionQueue, numInstances, maxDrawCallCount, 0, 0);
 
-            // queue submit is done later
-            //sgfx::submit(occlusionQueue);
+            occlusionBundle = sgfx::createBundle(occlusionQueue);
+
+            // bundle submit is done later
+            //sgfx::submit(occlusionBundle);
         }
     }
 
@@ -560,11 +626,11 @@ public:
     virtual void loadSampleData() override
     {
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         // mesh data
         grassManager = new DVPGrassManager;
-        grassManager->loadDataSet("data/meshes/cattail/");
+        grassManager->loadDataSet("data/meshes/cattail/", static_cast<uint32_t>(getTimeMs()));
         grassManager->loadTexture("data/textures/CattailBlades.dds");
 
         // create render target
@@ -706,43 +772,43 @@ public:
         static uint32_t frameCounter = 0;
         frameCounter ++;
 
-        static ULONGLONG dwTimeStart = 0;
-        ULONGLONG dwTimeCur = GetTickCount64();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = getTimeMs();
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
         dwTimeStart = dwTimeCur;
 
         static bool dtReport = false;
-        if (GetAsyncKeyState(VK_F1)) dtReport = !dtReport;
+        if (wasKeyPressed(Key::F1)) dtReport = !dtReport;
 
         if (dtReport) {
             char buf[64];
-            sprintf_s(buf, "DT: %f\n", t);
+            snprintf(buf, sizeof(buf), "DT: %f\n", t);
             OutputDebugString(buf);
         }
 
         static float cameraAngle = 0.0F;
 
         float cameraSpeed = 2.0F;
-        if (GetAsyncKeyState(VK_SHIFT)) cameraSpeed = 20.0F;
+        if (isKeyDown(Key::Shift)) cameraSpeed = 20.0F;
 
-        if (GetAsyncKeyState(VK_CONTROL)) {
-            if (GetAsyncKeyState(VK_LEFT))      cameraAngle += t * 5.0F;
-            if (GetAsyncKeyState(VK_RIGHT))     cameraAngle -= t * 5.0F;
+        if (isKeyDown(Key::Control)) {
+            if (isKeyDown(Key::Left))      cameraAngle += t * 5.0F;
+            if (isKeyDown(Key::Right))     cameraAngle -= t * 5.0F;
         } else {
-            if (GetAsyncKeyState(VK_UP))        cameraPosition.z += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_DOWN))      cameraPosition.z -= t * cameraSpeed;
-            if (GetAsyncKeyState(VK_LEFT))      cameraPosition.x += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_RIGHT))     cameraPosition.x -= t * cameraSpeed;
-            if (GetAsyncKeyState(VK_HOME))      cameraPosition.y += t * cameraSpeed;
-            if (GetAsyncKeyState(VK_END))       cameraPosition.y -= t * cameraSpeed;
+            if (isKeyDown(Key::Up))        cameraPosition.z += t * cameraSpeed;
+            if (isKeyDown(Key::Down))      cameraPosition.z -= t * cameraSpeed;
+            if (isKeyDown(Key::Left))      cameraPosition.x += t * cameraSpeed;
+            if (isKeyDown(Key::Right))     cameraPosition.x -= t * cameraSpeed;
+            if (isKeyDown(Key::Home))      cameraPosition.y += t * cameraSpeed;
+            if (isKeyDown(Key::End))       cameraPosition.y -= t * cameraSpeed;
         }
 
         if ((frameCounter % 10) == 0)
             grassManager->displayOcclusionCullingStats(this);
 
-        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.1f, 50000.0f);
+        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.1f, 50000.0f);
         glm::mat4 view       = glm::lookAt(cameraPosition, cameraPosition + glm::vec3(sin(cameraAngle), 0.0F, cos(cameraAngle)), glm::vec3(0.0F, 1.0F, 0.0F));
 
         prevMVP = MVP;
@@ -805,8 +871,8 @@ public:
 
                 sgfx::submit(
                     downscaleQueue,
-                    static_cast<uint32_t>(std::ceilf(width / 16.0F)),
-                    static_cast<uint32_t>(std::ceilf(height / 16.0F)),
+                    static_cast<uint32_t>(std::ceil(width / 16.0F)),
+                    static_cast<uint32_t>(std::ceil(height / 16.0F)),
                     1
                 );
 
@@ -824,7 +890,7 @@ public:
                 sgfx::setRenderTarget(occlusionRT);
                 sgfx::setViewport(width, height, 0.0F, 1.0F);
 
-                sgfx::submit(occlusionQueue);
+                sgfx::submit(grassManager->occlusionBundle);
 
                 sgfx::endPerfEvent();
             }
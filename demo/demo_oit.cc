@@ -97,7 +97,7 @@ public:
     virtual void loadSampleData() override
     {
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         // create render target
         colorBuffer        = sgfx::getBackBuffer();
@@ -340,13 +340,13 @@ public:
         // Update our time
         static float t = 0.0f;
 
-        static ULONGLONG dwTimeStart = 0;
-        ULONGLONG dwTimeCur = GetTickCount64();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = getTimeMs();
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
 
-        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.01f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.01f, 100.0f);
         glm::mat4 view       = glm::lookAt(glm::vec3(0.0F, 0.0F, -3.0F), glm::vec3(0.0F, 0.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
         glm::mat4 world      = glm::scale(glm::mat4(1.0F), glm::vec3(2.5F)) * glm::rotate(glm::mat4(1.0F), t, glm::vec3(0.0F, 1.0F, 0.0F));
 
@@ -144,7 +144,7 @@ public:
     virtual void loadSampleData() override
     {
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         // create sampler state
         sgfx::SamplerStateDescriptor samplerDesc;
@@ -370,8 +370,8 @@ public:
         // Update our time
         static float t = 0.0f;
 
-        static ULONGLONG dwTimeStart = 0;
-        ULONGLONG dwTimeCur = GetTickCount64();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = getTimeMs();
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
@@ -380,7 +380,7 @@ public:
         static glm::vec3 cameraPosition = glm::vec3(0.0F, 0.3F, -3.0F);
         //cameraPosition.z -= t * 0.5F;
 
-        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.001f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.001f, 100.0f);
         glm::mat4 view       = glm::lookAt(cameraPosition, cameraPosition + glm::vec3(0.0F, 0.0F, 1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
         //glm::mat4 world      = glm::rotate(glm::mat4(1.0F), t, glm::vec3(0.0F, 1.0F, 0.0F));
 
@@ -319,13 +319,13 @@ public:
         renderTargetDS = sgfx::createRenderTarget(renderTargetDesc);
     }
 
-    void render(uint32_t width, uint32_t height)
+    void render(uint32_t width, uint32_t height, uint64_t timeMs)
     {
         // update our time
         static float t = 0.0f;
 
-        static DWORD dwTimeStart = 0;
-        DWORD dwTimeCur = GetTickCount();
+        static uint64_t dwTimeStart = 0;
+        uint64_t dwTimeCur = timeMs;
         if (dwTimeStart == 0)
             dwTimeStart = dwTimeCur;
         t = (dwTimeCur - dwTimeStart) / 1000.0f;
@@ -336,7 +336,7 @@ public:
         sgfx::setRenderTarget(renderTargetGB);
         sgfx::setViewport(width, height, 0.0F, 1.0F);
         {
-            glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (FLOAT)height, 0.01f, 100.0f);
+            glm::mat4 projection = glm::perspective(glm::pi<float>() / 2.0F, width / (float)height, 0.01f, 100.0f);
             glm::mat4 view = glm::lookAt(glm::vec3(0.0F, 1.0F, -25.0F), glm::vec3(0.0F, 1.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
             glm::mat4 world = glm::rotate(glm::mat4(1.0F), t, glm::vec3(0.0F, 1.0F, 0.0F));
 
@@ -402,7 +402,7 @@ public:
     virtual void loadSampleData() override
     {
         // setup Sigrlinn
-        sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+        initBackend();
 
         scene = new DeferredScene;
         scene->load(width, height, this);
@@ -417,7 +417,7 @@ public:
 
     virtual void renderSample() override
     {
-        scene->render(width, height);
+        scene->render(width, height, getTimeMs());
     }
 };
 
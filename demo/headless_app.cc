@@ -0,0 +1,299 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// headless platform layer, runs a demo offscreen on the null backend for a number of frames and
+// prints the CPU time renderSample() takes per frame
+//
+//   <demo>Headless [-frames N] [-warmup N] [-size WxH] [-dt ms] [-camera script] [-root dir] [-frametimes]
+//
+// the clock advances -dt milliseconds per frame and the keys come from the camera script, so
+// every run renders the same frames whatever the machine; the script is a list of steps of keys
+// held for a number of frames that loops, "Up:120,Control+Left:60,:30" walks forward for 120
+// frames, turns for 60 and stands still for 30. shaders/ and data/ are loaded from -root, the
+// source tree by default.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#define chdir _chdir
+#else
+#include <unistd.h>
+#endif
+
+#include "common/app.hh"
+
+#ifndef SGFX_DEMO_ROOT
+#define SGFX_DEMO_ROOT "."
+#endif
+
+// the demos take a time of 0 for not started yet
+static const uint64_t kStartTimeMs = 1000;
+
+// walks forward, turns, runs, strafes, rises and sinks, presses space once (FFD deforms its mesh)
+// and backs off, 420 frames per loop
+static const char* kDefaultCamera = "Up:120,Control+Left:60,Shift+Up:60,Right:60,Home:30,End:30,Space:1,Down:59";
+
+struct CameraStep final
+{
+    uint32_t keys;      // a bit per Key
+    uint32_t numFrames;
+};
+
+struct Headless final
+{
+    std::vector<CameraStep> camera;
+    uint32_t                cameraLength = 0; // frames per loop
+    uint64_t                frame        = 0;
+    double                  frameTimeMs  = 1000.0 / 60.0;
+
+    std::vector<double>     renderTimes;      // ms per frame
+    bool                    recordTimes  = false;
+};
+
+static Headless g_headless;
+
+struct KeyName final
+{
+    const char* name;
+    Key         key;
+};
+
+static const KeyName kKeyNames[] = {
+    { "Shift",   Key::Shift   },
+    { "Control", Key::Control },
+    { "Left",    Key::Left    },
+    { "Right",   Key::Right   },
+    { "Up",      Key::Up      },
+    { "Down",    Key::Down    },
+    { "Home",    Key::Home    },
+    { "End",     Key::End     },
+    { "Insert",  Key::Insert  },
+    { "Delete",  Key::Delete  },
+    { "Space",   Key::Space   },
+    { "F1",      Key::F1      }
+};
+
+// "keys:frames,keys:frames", keys are names joined with + or nothing for a pause
+static bool parseCamera(const char* script, std::vector<CameraStep>& steps)
+{
+    std::string text = script;
+    size_t      position = 0;
+
+    while (position < text.size()) {
+        size_t end = text.find(',', position);
+        if (end == std::string::npos)
+            end = text.size();
+
+        std::string step  = text.substr(position, end - position);
+        size_t      colon = step.rfind(':');
+        if (colon == std::string::npos)
+            return false;
+
+        CameraStep cameraStep;
+        cameraStep.keys      = 0;
+        cameraStep.numFrames = static_cast<uint32_t>(atoi(step.c_str() + colon + 1));
+        if (cameraStep.numFrames == 0)
+            return false;
+
+        for (size_t name = 0; name < colon;) {
+            size_t nameEnd = std::min(step.find('+', name), colon);
+            std::string keyName = step.substr(name, nameEnd - name);
+
+            auto it = std::find_if(std::begin(kKeyNames), std::end(kKeyNames), [&keyName](const KeyName& other) { return keyName == other.name; });
+            if (it == std::end(kKeyNames)) {
+                fprintf(stderr, "unknown key %s\n", keyName.c_str());
+                return false;
+            }
+            cameraStep.keys |= 1U << static_cast<uint32_t>(it->key);
+            name = nameEnd + 1;
+        }
+
+        steps.push_back(cameraStep);
+        position = end + 1;
+    }
+
+    return !steps.empty();
+}
+
+static double getPercentile(const std::vector<double>& sortedTimes, double percentile)
+{
+    size_t index = static_cast<size_t>(percentile * static_cast<double>(sortedTimes.size() - 1) + 0.5);
+    return sortedTimes[std::min(index, sortedTimes.size() - 1)];
+}
+
+static void printUsage()
+{
+    printf("usage: <demo>Headless [-frames N] [-warmup N] [-size WxH] [-dt ms] [-camera script] [-root dir] [-frametimes]\n");
+    printf("       the camera script is keys:frames steps, keys are + joined names of\n      ");
+    for (const KeyName& keyName : kKeyNames)
+        printf(" %s", keyName.name);
+    printf("\n       default %s\n", kDefaultCamera);
+}
+
+//=============================================================================
+bool Application::initBackend()
+{
+    return sgfx::initNull(width, height);
+}
+
+bool Application::isKeyDown(Key key) const
+{
+    if (g_headless.cameraLength == 0)
+        return false;
+
+    uint32_t frame = static_cast<uint32_t>(g_headless.frame % g_headless.cameraLength);
+    for (const CameraStep& step : g_headless.camera) {
+        if (frame < step.numFrames)
+            return (step.keys & (1U << static_cast<uint32_t>(key))) != 0;
+        frame -= step.numFrames;
+    }
+    return false;
+}
+
+uint64_t Application::getTimeMs() const
+{
+    return kStartTimeMs + static_cast<uint64_t>(static_cast<double>(g_headless.frame) * g_headless.frameTimeMs);
+}
+
+void Application::render()
+{
+    updateKeys();
+
+    auto start = std::chrono::steady_clock::now();
+    renderSample();
+    auto stop = std::chrono::steady_clock::now();
+
+    if (g_headless.recordTimes)
+        g_headless.renderTimes.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    g_headless.frame++;
+}
+
+void Application::setWindowTitle(const char*)
+{
+    // no window to put the stats of the demos in
+}
+
+//=============================================================================
+int main(int argc, char** argv)
+{
+    uint32_t    numFrames     = 600;
+    uint32_t    numWarmup     = 30;
+    uint32_t    newWidth      = 0;
+    uint32_t    newHeight     = 0;
+    const char* camera        = kDefaultCamera;
+    const char* root          = SGFX_DEMO_ROOT;
+    bool        printFrames   = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-frames") == 0 && hasValue) {
+            numFrames = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "-warmup") == 0 && hasValue) {
+            numWarmup = static_cast<uint32_t>(std::max(0, atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "-size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%ux%u", &newWidth, &newHeight) != 2 || newWidth == 0 || newHeight == 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "-dt") == 0 && hasValue) {
+            g_headless.frameTimeMs = std::max(0.0, atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "-camera") == 0 && hasValue) {
+            camera = argv[++i];
+        } else if (std::strcmp(argv[i], "-root") == 0 && hasValue) {
+            root = argv[++i];
+        } else if (std::strcmp(argv[i], "-frametimes") == 0) {
+            printFrames = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!parseCamera(camera, g_headless.camera)) {
+        fprintf(stderr, "can't parse the camera script %s\n", camera);
+        return 1;
+    }
+    for (const CameraStep& step : g_headless.camera)
+        g_headless.cameraLength += step.numFrames;
+
+    if (chdir(root) != 0) {
+        fprintf(stderr, "can't change to %s\n", root);
+        return 1;
+    }
+
+    sampleApplicationMain();
+    if (ApplicationInstance == nullptr)
+        return 0;
+
+    if (newWidth != 0)
+        ApplicationInstance->setBackBufferSize(newWidth, newHeight);
+
+    // the demos init sgfx themselves, loadSampleData calls initBackend
+    auto loadStart = std::chrono::steady_clock::now();
+    ApplicationInstance->loadSampleData();
+    double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+    for (uint32_t frame = 0; frame < numWarmup + numFrames; ++frame) {
+        g_headless.recordTimes = frame >= numWarmup;
+        ApplicationInstance->render();
+    }
+
+    ApplicationInstance->releaseSampleData();
+    delete ApplicationInstance;
+    ApplicationInstance = nullptr;
+
+    std::vector<double>& times = g_headless.renderTimes;
+
+    if (printFrames) {
+        printf("%8s %10s\n", "frame", "ms");
+        for (size_t i = 0; i < times.size(); ++i)
+            printf("%8zu %10.3f\n", numWarmup + i, times[i]);
+        printf("\n");
+    }
+
+    double total = 0.0;
+    for (double time : times)
+        total += time;
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+
+    printf("load %.1f ms, %u frames after %u warm-up, renderSample() ms per frame\n", loadTime, numFrames, numWarmup);
+    printf("%10s %10s %10s %10s %10s\n", "min", "avg", "median", "p99", "max");
+    printf("%10.3f %10.3f %10.3f %10.3f %10.3f\n",
+        sorted.front(),
+        total / static_cast<double>(sorted.size()),
+        getPercentile(sorted, 0.5),
+        getPercentile(sorted, 0.99),
+        sorted.back()
+    );
+
+    return 0;
+}
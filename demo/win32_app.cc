@@ -212,8 +212,29 @@ HRESULT Application::initDevice()
     return S_OK;
 }
 
+bool Application::initBackend()
+{
+    return sgfx::initD3D11(g_pd3dDevice, g_pImmediateContext, g_pSwapChain);
+}
+
+bool Application::isKeyDown(Key key) const
+{
+    static const int kVirtualKeys[] = {
+        VK_SHIFT, VK_CONTROL, VK_LEFT, VK_RIGHT, VK_UP, VK_DOWN, VK_HOME, VK_END, VK_INSERT, VK_DELETE, VK_SPACE, VK_F1
+    };
+    static_assert(sizeof(kVirtualKeys) / sizeof(kVirtualKeys[0]) == static_cast<size_t>(Key::Count), "a virtual key per Key");
+
+    return GetAsyncKeyState(kVirtualKeys[static_cast<uint32_t>(key)]) != 0;
+}
+
+uint64_t Application::getTimeMs() const
+{
+    return GetTickCount64();
+}
+
 void Application::render()
 {
+    updateKeys();
     renderSample();
 }
 
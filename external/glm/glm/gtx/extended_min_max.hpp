@@ -0,0 +1,133 @@
+/// @ref gtx_extended_min_max
+/// @file glm/gtx/extended_min_max.hpp
+///
+/// @see core (dependence)
+/// @see gtx_half_float (dependence)
+///
+/// @defgroup gtx_extented_min_max GLM_GTX_extented_min_max
+/// @ingroup gtx
+///
+/// Min and max functions for 3 to 4 parameters.
+///
+/// <glm/gtx/extented_min_max.hpp> need to be included to use these functionalities.
+
+#pragma once
+
+// Dependency:
+#include "../glm.hpp"
+
+#if GLM_MESSAGES == GLM_MESSAGES_ENABLED && !defined(GLM_EXT_INCLUDED)
+#	pragma message("GLM: GLM_GTX_extented_min_max extension included")
+#endif
+
+namespace glm
+{
+	/// @addtogroup gtx_extented_min_max
+	/// @{
+
+	/// Return the minimum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T>
+	GLM_FUNC_DECL T min(
+		T const & x,
+		T const & y,
+		T const & z);
+
+	/// Return the minimum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> min(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z);
+
+	/// Return the minimum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> min(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z);
+
+	/// Return the minimum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T>
+	GLM_FUNC_DECL T min(
+		T const & x,
+		T const & y,
+		T const & z,
+		T const & w);
+
+	/// Return the minimum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> min(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z,
+		typename C<T, P>::value_type const & w);
+
+	/// Return the minimum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> min(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z,
+		C<T, P> const & w);
+
+	/// Return the maximum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T>
+	GLM_FUNC_DECL T max(
+		T const & x,
+		T const & y,
+		T const & z);
+
+	/// Return the maximum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> max(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z);
+
+	/// Return the maximum component-wise values of 3 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> max(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z);
+
+	/// Return the maximum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T>
+	GLM_FUNC_DECL T max(
+		T const & x,
+		T const & y,
+		T const & z,
+		T const & w);
+
+	/// Return the maximum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> max(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z,
+		typename C<T, P>::value_type const & w);
+
+	/// Return the maximum component-wise values of 4 inputs
+	/// @see gtx_extented_min_max
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_DECL C<T, P> max(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z,
+		C<T, P> const & w);
+
+	/// @}
+}//namespace glm
+
+#include "extended_min_max.inl"
@@ -0,0 +1,139 @@
+/// @ref gtx_extended_min_max
+/// @file glm/gtx/extended_min_max.inl
+
+namespace glm
+{
+	template <typename T>
+	GLM_FUNC_QUALIFIER T min(
+		T const & x,
+		T const & y,
+		T const & z)
+	{
+		return glm::min(glm::min(x, y), z);
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> min
+	(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z
+	)
+	{
+		return glm::min(glm::min(x, y), z);
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> min
+	(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z
+	)
+	{
+		return glm::min(glm::min(x, y), z);
+	}
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER T min
+	(
+		T const & x,
+		T const & y,
+		T const & z,
+		T const & w
+	)
+	{
+		return glm::min(glm::min(x, y), glm::min(z, w));
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> min
+	(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z,
+		typename C<T, P>::value_type const & w
+	)
+	{
+		return glm::min(glm::min(x, y), glm::min(z, w));
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> min
+	(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z,
+		C<T, P> const & w
+	)
+	{
+		return glm::min(glm::min(x, y), glm::min(z, w));
+	}
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER T max(
+		T const & x,
+		T const & y,
+		T const & z)
+	{
+		return glm::max(glm::max(x, y), z);
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> max
+	(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z
+	)
+	{
+		return glm::max(glm::max(x, y), z);
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> max
+	(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z
+	)
+	{
+		return glm::max(glm::max(x, y), z);
+	}
+
+	template <typename T>
+	GLM_FUNC_QUALIFIER T max
+	(
+		T const & x,
+		T const & y,
+		T const & z,
+		T const & w
+	)
+	{
+		return glm::max(glm::max(x, y), glm::max(z, w));
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> max
+	(
+		C<T, P> const & x,
+		typename C<T, P>::value_type const & y,
+		typename C<T, P>::value_type const & z,
+		typename C<T, P>::value_type const & w
+	)
+	{
+		return glm::max(glm::max(x, y), glm::max(z, w));
+	}
+
+	template <typename T, precision P, template <typename, precision> class C>
+	GLM_FUNC_QUALIFIER C<T, P> max
+	(
+		C<T, P> const & x,
+		C<T, P> const & y,
+		C<T, P> const & z,
+		C<T, P> const & w
+	)
+	{
+		return glm::max(glm::max(x, y), glm::max(z, w));
+	}
+}//namespace glm
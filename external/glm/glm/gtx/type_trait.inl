@@ -0,0 +1,138 @@
+/// @ref gtx_type_trait
+/// @file glm/gtx/type_trait.inl
+
+namespace glm
+{
+	template <template <typename, precision> class genType, typename T, precision P>
+	bool const type<genType, T, P>::is_vec;
+	template <template <typename, precision> class genType, typename T, precision P>
+	bool const type<genType, T, P>::is_mat;
+	template <template <typename, precision> class genType, typename T, precision P>
+	bool const type<genType, T, P>::is_quat;
+	template <template <typename, precision> class genType, typename T, precision P>
+	length_t const type<genType, T, P>::components;
+	template <template <typename, precision> class genType, typename T, precision P>
+	length_t const type<genType, T, P>::cols;
+	template <template <typename, precision> class genType, typename T, precision P>
+	length_t const type<genType, T, P>::rows;
+
+	// tvec1
+	template <typename T, precision P>
+	bool const type<tvec1, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tvec1, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tvec1, T, P>::is_quat;
+
+	// tvec2
+	template <typename T, precision P>
+	bool const type<tvec2, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tvec2, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tvec2, T, P>::is_quat;
+
+	// tvec3
+	template <typename T, precision P>
+	bool const type<tvec3, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tvec3, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tvec3, T, P>::is_quat;
+
+	// tvec4
+	template <typename T, precision P>
+	bool const type<tvec4, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tvec4, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tvec4, T, P>::is_quat;
+
+	// tmat2x2
+	template <typename T, precision P>
+	bool const type<tmat2x2, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat2x2, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat2x2, T, P>::is_quat;
+
+	// tmat2x3
+	template <typename T, precision P>
+	bool const type<tmat2x3, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat2x3, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat2x3, T, P>::is_quat;
+
+	// tmat2x4
+	template <typename T, precision P>
+	bool const type<tmat2x4, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat2x4, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat2x4, T, P>::is_quat;
+
+	// tmat3x2
+	template <typename T, precision P>
+	bool const type<tmat3x2, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat3x2, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat3x2, T, P>::is_quat;
+
+	// tmat3x3
+	template <typename T, precision P>
+	bool const type<tmat3x3, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat3x3, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat3x3, T, P>::is_quat;
+
+	// tmat3x4
+	template <typename T, precision P>
+	bool const type<tmat3x4, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat3x4, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat3x4, T, P>::is_quat;
+
+	// tmat4x2
+	template <typename T, precision P>
+	bool const type<tmat4x2, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat4x2, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat4x2, T, P>::is_quat;
+
+	// tmat4x3
+	template <typename T, precision P>
+	bool const type<tmat4x3, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat4x3, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat4x3, T, P>::is_quat;
+
+	// tmat4x4
+	template <typename T, precision P>
+	bool const type<tmat4x4, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tmat4x4, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tmat4x4, T, P>::is_quat;
+
+	// tquat
+	template <typename T, precision P>
+	bool const type<tquat, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tquat, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tquat, T, P>::is_quat;
+
+	// tdualquat
+	template <typename T, precision P>
+	bool const type<tdualquat, T, P>::is_vec;
+	template <typename T, precision P>
+	bool const type<tdualquat, T, P>::is_mat;
+	template <typename T, precision P>
+	bool const type<tdualquat, T, P>::is_quat;
+}//namespace glm
@@ -25,17 +25,71 @@
 #include <stdint.h>
 #include <wchar.h>
 
+// internal implementation dependencies
+#ifdef SGFX_INTERNAL_IMPLEMENTATION
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// stale handle detection, on by default in debug builds only
+#ifndef SGFX_VALIDATE_HANDLES
+#   ifdef NDEBUG
+#   define SGFX_VALIDATE_HANDLES 0
+#   else
+#   define SGFX_VALIDATE_HANDLES 1
+#   endif
+#endif
+
+// checks draws against the binding layout of their pipeline, follows SGFX_VALIDATE_HANDLES by default
+#ifndef SGFX_VALIDATE_BINDINGS
+#define SGFX_VALIDATE_BINDINGS SGFX_VALIDATE_HANDLES
+#endif
+
+// frame and queue statistics, shipping builds can compile the counters out
+#ifndef SGFX_ENABLE_STATS
+#define SGFX_ENABLE_STATS 1
+#endif
+
+// CPU profiler zones sgfx opens around its own work, perf events are recorded either way
+#ifndef SGFX_ENABLE_PROFILER
+#define SGFX_ENABLE_PROFILER 1
+#endif
+
+// API capture hooks in every public call, shipping builds can compile them out
+#ifndef SGFX_ENABLE_CAPTURE
+#define SGFX_ENABLE_CAPTURE 1
+#endif
+
+#if defined(_MSC_VER)
+#   define SGFX_TRAP() __debugbreak()
+#else
+#   define SGFX_TRAP() __builtin_trap()
+#endif
+#endif
+
 namespace sgfx
 {
 
+// backends hand out 32-bit handle values (slot index + generation), 0 is the invalid handle
 template <typename T, int tag>
 struct Handle
 {
     T value = static_cast<T>(0);
     inline explicit Handle(const T& newValue) : value(newValue) {}
     inline Handle() {}
-    inline Handle(const Handle& d) : value(d.value) {}
-    inline Handle& operator=(const Handle& d)    { value = d.value; return *this; }
+    inline Handle(const Handle& d) = default;
+    inline Handle& operator=(const Handle& d)    = default;
     inline Handle& operator=(const T& d)         { value = d; return *this;       }
     inline bool operator==(const Handle& handle) { return value == handle.value; }
     inline bool operator!=(const Handle& handle) { return value != handle.value; }
@@ -44,38 +98,72 @@ struct Handle
     inline friend bool operator==(const Handle& h0, const Handle& h1) { return h0.value == h1.value; }
 };
 
-typedef Handle<void*,  1> VertexShaderHandle;
-typedef Handle<void*,  2> HullShaderHandle;
-typedef Handle<void*,  3> DomainShaderHandle;
-typedef Handle<void*,  4> GeometryShaderHandle;
-typedef Handle<void*,  5> PixelShaderHandle;
-typedef Handle<void*,  6> SurfaceShaderHandle; // VS+HS+DS+GS+PS
-typedef Handle<void*,  7> ComputeShaderHandle;
-typedef Handle<void*,  8> PipelineStateHandle;
+typedef Handle<uint32_t,  1> VertexShaderHandle;
+typedef Handle<uint32_t,  2> HullShaderHandle;
+typedef Handle<uint32_t,  3> DomainShaderHandle;
+typedef Handle<uint32_t,  4> GeometryShaderHandle;
+typedef Handle<uint32_t,  5> PixelShaderHandle;
+typedef Handle<uint32_t,  6> SurfaceShaderHandle; // VS+HS+DS+GS+PS
+typedef Handle<uint32_t,  7> ComputeShaderHandle;
+typedef Handle<uint32_t,  8> PipelineStateHandle;
 
-typedef Handle<void*,  9> VertexFormatHandle;
+typedef Handle<uint32_t,  9> VertexFormatHandle;
 
-typedef Handle<void*, 10> SamplerStateHandle;
+typedef Handle<uint32_t, 10> SamplerStateHandle;
 
 // same tag for textures is intended
-typedef Handle<void*, 11> TextureHandle;
-typedef Handle<void*, 11> Texture1DHandle;
-typedef Handle<void*, 11> Texture2DHandle;
-typedef Handle<void*, 11> Texture3DHandle;
-typedef Handle<void*, 11> CubemapHandle;
+typedef Handle<uint32_t, 11> TextureHandle;
+typedef Handle<uint32_t, 11> Texture1DHandle;
+typedef Handle<uint32_t, 11> Texture2DHandle;
+typedef Handle<uint32_t, 11> Texture3DHandle;
+typedef Handle<uint32_t, 11> CubemapHandle;
 
 // render target
-typedef Handle<void*, 12> RenderTargetHandle;
+typedef Handle<uint32_t, 12> RenderTargetHandle;
 
 // different tag for buffers is intended
-typedef Handle<void*, 13> BufferHandle;
-typedef Handle<void*, 14> ConstantBufferHandle;
+typedef Handle<uint32_t, 13> BufferHandle;
+typedef Handle<uint32_t, 14> ConstantBufferHandle;
 
 // draw queue
-typedef Handle<void*, 15> DrawQueueHandle;
+typedef Handle<uint32_t, 15> DrawQueueHandle;
 
 // compute queue
-typedef Handle<void*, 16> ComputeQueueHandle;
+typedef Handle<uint32_t, 16> ComputeQueueHandle;
+
+// frame arena
+typedef Handle<uint32_t, 17> FrameArenaHandle;
+
+// draw recorder, records a part of a draw queue
+typedef Handle<uint32_t, 18> DrawRecorderHandle;
+
+// bundle, draws recorded once and replayed every frame
+typedef Handle<uint32_t, 19> BundleHandle;
+
+// resource table, buffers and textures bound to consecutive slots together
+typedef Handle<uint32_t, 20> ResourceTableHandle;
+
+// constant allocator, packs small constant blocks into a few large constant buffers
+typedef Handle<uint32_t, 21> ConstantAllocatorHandle;
+
+// buffer heap, one large buffer suballocated into blocks for many meshes
+typedef Handle<uint32_t, 22> BufferHeapHandle;
+
+// draw queue submission
+namespace SubmitFlags {
+enum : uint32_t {
+    SortByKey      = (1U << 0), // reorder the draws by their sort keys (see setSortKey)
+    MergeInstances = (1U << 1), // merge runs of instanced draws with contiguous instances, and runs of
+                                // drawIndexed calls into instanced draws (see PipelineStateDescriptor)
+};
+}
+
+// draw queue creation
+namespace DrawQueueFlags {
+enum : uint32_t {
+    StickyBindings = (1U << 0), // bindings carry over to the following draws (see resetBindings)
+};
+}
 
 // buffers
 namespace BufferFlags {
@@ -93,10 +181,26 @@ enum : uint32_t {
 };
 }
 
+// Write waits until the GPU is done with the buffer, D3D11 maps CPUWrite buffers as dynamic
+// resources which only take discards, so it keeps the previous contents on the other backends only
+// WriteDiscard drops the contents instead, the GPU keeps reading the old copy while the CPU
+// fills a new one, WriteNoOverwrite neither waits nor copies, the caller promises to only write
+// ranges that no frame in flight reads (see TransientRing::kFramesInFlight), like the next part
+// of a ring that starts over with a WriteDiscard
 enum class MapType : size_t
 {
-    Read  = 0,
-    Write = 1,
+    Read             = 0,
+    Write            = 1,
+    WriteDiscard     = 2,
+    WriteNoOverwrite = 3,
+
+    Count
+};
+
+enum class IndexFormat : size_t
+{
+    UInt32 = 0,
+    UInt16 = 1,
 
     Count
 };
@@ -364,11 +468,25 @@ struct DepthStencilState
 
 struct PipelineStateDescriptor
 {
+    enum : uint32_t
+    {
+        kNoInstancing = 0xFFFFFFFF
+    };
+
     RasterizerState     rasterizerState;
     BlendState          blendState;
     DepthStencilState   depthStencilState;
     SurfaceShaderHandle shader;
     VertexFormatHandle  vertexFormat;
+
+    // automatic instancing: submitted with SubmitFlags::MergeInstances, runs of drawIndexed calls
+    // that share every binding and index range and differ only in the inline constants of
+    // instanceConstantsSlot are drawn as one drawIndexedInstanced; the constants of the draws are
+    // packed back to back into transient memory bound at instanceVertexSlot, which the vertex
+    // format reads as per-instance elements covering the whole (16 byte padded) constants
+    // bind the slot right after the mesh's vertex buffers, the backends stop at the first empty one
+    uint32_t            instanceConstantsSlot = kNoInstancing;
+    uint32_t            instanceVertexSlot    = 0;
 };
 
 // vertex stage
@@ -378,7 +496,7 @@ struct VertexElementDescriptor // TODO: rework to make it more compatible with G
     const char*       semanticName;  // not used on GL
     uint32_t          semanticIndex; // not used on GL
     DataFormat        format;
-    uint32_t          slot;          // not used on GL
+    uint32_t          slot;          // vertex buffer the element is read from
     uint64_t          offset;
     bool              perInstanceData;
 };
@@ -427,7 +545,10 @@ enum : uint64_t {
 
     // texture format support
     TextureFormatInteger  = (1UL << 14),
-    TextureFormatFloat    = (1UL << 15)
+    TextureFormatFloat    = (1UL << 15),
+
+    // constant buffers can be bound at an offset (setConstantBufferRange), D3D11 needs 11.1 for it
+    ConstantBufferOffsets = (1UL << 16)
 };
 }
 
@@ -438,6 +559,7 @@ typedef void(*ErrorReportFunc)(const char*);
 bool initD3D11(void* d3dDevice, void* d3dContext, void* d3dSwapChain);
 bool initD3D12(void* d3dDevice);
 bool initOpenGL();
+bool initNull(uint32_t backBufferWidth, uint32_t backBufferHeight);
 #ifdef NDA_CODE_AMD_MANTLE
 // NDACodeStripper v0.17: 1 line removed
 #endif
@@ -519,17 +641,40 @@ void                    releaseGeometryShader(GeometryShaderHandle handle);
 PixelShaderHandle       createPixelShader(const void* data, size_t dataSize);
 void                    releasePixelShader(PixelShaderHandle handle);
 
+// binding layouts, bit i of a mask is set when the stage reads slot i of that class
+// backends only translate, bind and unbind the slots a layout lists
+struct StageBindingLayout
+{
+    uint64_t constantBuffers    = 0;
+    uint64_t samplers           = 0;
+    uint64_t shaderResources[2] = { 0, 0 };
+};
+
+struct SurfaceBindingLayout
+{
+    StageBindingLayout vs;
+    StageBindingLayout hs;
+    StageBindingLayout ds;
+    StageBindingLayout gs;
+    StageBindingLayout ps;
+};
+
+// layout == nullptr: the shader may read any slot
 SurfaceShaderHandle     linkSurfaceShader(
-    VertexShaderHandle   vs,
-    HullShaderHandle     hs,
-    DomainShaderHandle   ds,
-    GeometryShaderHandle gs,
-    PixelShaderHandle    ps
+    VertexShaderHandle          vs,
+    HullShaderHandle            hs,
+    DomainShaderHandle          ds,
+    GeometryShaderHandle        gs,
+    PixelShaderHandle           ps,
+    const SurfaceBindingLayout* layout = nullptr
 );
 void                    releaseSurfaceShader(SurfaceShaderHandle handle);
 
+// binds to slots the pipeline's layout does not read are reported here (SGFX_VALIDATE_BINDINGS builds only)
+void                    setBindingValidationFunc(ErrorReportFunc func);
+
 // compute shader stuff
-ComputeQueueHandle      createComputeQueue(ComputeShaderHandle shader);
+ComputeQueueHandle      createComputeQueue(ComputeShaderHandle shader, const StageBindingLayout* layout = nullptr);
 void                    releaseComputeQueue(ComputeQueueHandle handle);
 
 void                    setConstantBuffer(ComputeQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer);
@@ -565,10 +710,84 @@ void                    copyBufferData(BufferHandle handle, size_t offset, size_
 void                    clearBufferRW(BufferHandle handle, uint32_t value);
 void                    clearBufferRW(BufferHandle handle, float    value);
 
+// the ranged update leaves the bytes outside of [offset, offset + size) as they were on every backend,
+// without GPUCaps::ConstantBufferOffsets it uploads the whole buffer from a CPU copy though
 ConstantBufferHandle    createConstantBuffer(const void* mem, size_t size);
 void                    updateConstantBuffer(ConstantBufferHandle handle, const void* mem);
+void                    updateConstantBuffer(ConstantBufferHandle handle, const void* mem, size_t offset, size_t size);
 void                    releaseConstantBuffer(ConstantBufferHandle handle);
 
+// constant blocks, 256 byte aligned ranges of a few large constant buffers (pages) handed out to
+// many small constant blocks (per-object constants) that would otherwise need a buffer each
+// bind a block with setConstantBufferRange() and update it with updateConstantBuffer(), pages are
+// released with the allocator; without GPUCaps::ConstantBufferOffsets every block gets its own page
+struct ConstantBlock
+{
+    ConstantBufferHandle buffer;
+    uint32_t             offset = 0; // bytes
+    uint32_t             size   = 0; // bytes, a multiple of 256
+};
+
+ConstantAllocatorHandle createConstantAllocator(size_t pageSize);
+void                    releaseConstantAllocator(ConstantAllocatorHandle handle);
+
+// mem may be nullptr, size must not exceed 64 KB, an invalid buffer means out of memory
+ConstantBlock           allocateConstantBlock(ConstantAllocatorHandle handle, const void* mem, size_t size);
+void                    freeConstantBlock(ConstantAllocatorHandle handle, const ConstantBlock& block);
+
+// transient memory, data the CPU writes for a single frame (dynamic vertices and indices) carved
+// out of a mapped ring buffer instead of buffers created and released every frame; write it before
+// the draws reading it are submitted, submit() unmaps the buffer, and the memory is handed out
+// again once TransientRing::kFramesInFlight more frames were presented
+// the buffer has no stride, vertices in it are read with the stride of the vertex format
+// (elements of a slot packed back to back); small constants go through setInlineConstants()
+struct TransientAllocation
+{
+    BufferHandle buffer;            // invalid for size 0
+    uint32_t     offset = 0;        // bytes, bind the buffer at this offset
+    void*        cpuPtr = nullptr;  // write only, valid until the next submit() or present()
+};
+
+// alignment must be a power of two
+TransientAllocation     allocateTransient(size_t size, size_t alignment = 16);
+
+// buffer heaps, blocks of one large buffer (see BufferHeapAllocator) for meshes that come and go,
+// so streaming one in or out never re-creates the buffer; the heap does not grow, size it for
+// the peak, allocation fails when no free range is large enough
+// compactBufferHeap() moves blocks with GPU copies to merge the free ranges, a block keeps its id
+// and getBufferBlock() tells where it went: call it between frames, before recording the draws
+// that bind the heap, and record bundles reading moved blocks again
+struct BufferBlock
+{
+    BufferHandle buffer;     // the heap's buffer, invalid if the allocation failed
+    uint32_t     offset = 0; // bytes, a multiple of the heap's stride
+    uint32_t     size   = 0; // bytes, rounded up to the stride (16 bytes without one)
+    uint32_t     id     = 0; // stays the same while the block is allocated
+};
+
+struct BufferHeapStats
+{
+    size_t   capacity;        // bytes
+    size_t   usedSize;        // bytes in allocated blocks
+    size_t   largestFreeSize; // bytes, the largest free range
+    uint32_t numBlocks;       // allocated
+    uint32_t numFreeBlocks;   // free ranges, many small ones mean the heap is fragmented
+};
+
+// flags and stride are the ones of the heap's buffer, CPU access flags are dropped, blocks are
+// written with copyBufferData()
+BufferHeapHandle        createBufferHeap(uint32_t flags, size_t size, size_t stride);
+void                    releaseBufferHeap(BufferHeapHandle handle);
+
+// mem may be nullptr
+BufferBlock             allocateBufferBlock(BufferHeapHandle handle, const void* mem, size_t size);
+void                    freeBufferBlock(BufferHeapHandle handle, const BufferBlock& block);
+BufferBlock             getBufferBlock(BufferHeapHandle handle, uint32_t id);
+
+// returns the bytes moved, stops once maxBytes were moved
+size_t                  compactBufferHeap(BufferHeapHandle handle, size_t maxBytes);
+BufferHeapStats         getBufferHeapStats(BufferHeapHandle handle);
+
 // textures
 SamplerStateHandle      createSamplerState(const SamplerStateDescriptor& desc);
 void                    releaseSamplerState(SamplerStateHandle handle);
@@ -593,11 +812,25 @@ void                    updateTexture(
 );
 void                    releaseTexture(TextureHandle handle);
 
+// resource tables, immutable lists of up to 32 buffers and textures (materials) that are bound to
+// consecutive shader resource slots with a single call; the resources must outlive the table
+struct ResourceTableEntry
+{
+    BufferHandle  buffer;  // either a buffer
+    TextureHandle texture; // or a texture, the other handle stays invalid
+};
+
+ResourceTableHandle     createResourceTable(const ResourceTableEntry* entries, uint32_t numEntries);
+void                    releaseResourceTable(ResourceTableHandle handle);
+
 // async buffer copying
 void                    copyResource(TextureHandle        src, TextureHandle        dst);
 void                    copyResource(BufferHandle         src, BufferHandle         dst);
 void                    copyResource(ConstantBufferHandle src, ConstantBufferHandle dst);
 
+// copies size bytes between two different buffers
+void                    copyBufferRegion(BufferHandle dst, size_t dstOffset, BufferHandle src, size_t srcOffset, size_t size);
+
 // render targets
 Texture2DHandle         getBackBuffer();
 
@@ -615,22 +848,53 @@ void                    clearRenderTarget(RenderTargetHandle handle, uint32_t sl
 void                    clearDepthStencil(RenderTargetHandle handle, float depth, uint8_t stencil);
 void                    present(uint32_t swapInterval);
 
+// frame arenas, draw queues record into them and present() recycles them
+// draws recorded but not submitted before present() are discarded
+FrameArenaHandle        createFrameArena(size_t blockSize);
+void                    releaseFrameArena(FrameArenaHandle handle);
+void                    setThreadFrameArena(FrameArenaHandle handle); // invalid handle selects the shared arena
+
 // drawing
-DrawQueueHandle         createDrawQueue(PipelineStateHandle state);
+DrawQueueHandle         createDrawQueue(PipelineStateHandle state, uint32_t flags = 0); // DrawQueueFlags
 void                    releaseDrawQueue(DrawQueueHandle handle);
 
 // per queue
 void                    setSamplerState(DrawQueueHandle handle, uint32_t idx, SamplerStateHandle sampler);
 
-// per draw call
+// per draw call, unless the queue was created with DrawQueueFlags::StickyBindings: then bindings
+// last until they are changed, resetBindings() is called or the queue is submitted, the queue's
+// recorders inherit the flag and keep their own bindings
+void                    resetBindings(DrawQueueHandle dq);
 void                    setPrimitiveTopology(DrawQueueHandle qd, PrimitiveTopology topology);
 void                    setVertexBuffer(DrawQueueHandle dq, BufferHandle vb, uint32_t idx = 0);
 void                    setIndexBuffer(DrawQueueHandle dq, BufferHandle ib);
 
+// binds the buffer starting at offset bytes (a TransientAllocation's or a suballocated mesh's),
+// index buffer offsets must be a multiple of the index size
+void                    setVertexBuffer(DrawQueueHandle dq, BufferHandle vb, uint32_t idx, uint32_t offset);
+void                    setIndexBuffer(DrawQueueHandle dq, BufferHandle ib, uint32_t offset);
+
+// the index format is part of the bind, so one buffer can hold 16-bit and 32-bit meshes,
+// the other overloads bind 32-bit indices; startIndex counts indices of the bound format
+void                    setIndexBuffer(DrawQueueHandle dq, BufferHandle ib, uint32_t offset, IndexFormat format);
+
 void                    setConstantBuffer(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer);
+
+// binds size bytes of the buffer starting at offset, both multiples of 256 (any ConstantBlock
+// is), size 0 binds the whole buffer like setConstantBuffer()
+void                    setConstantBufferRange(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size);
 void                    setResource(DrawQueueHandle handle, uint32_t idx, BufferHandle resource);
 void                    setResource(DrawQueueHandle handle, uint32_t idx, TextureHandle resource);
 
+// binds the table to slots firstSlot and up, one table per draw; slots that also get a resource
+// from setResource() use that resource instead of the table's
+void                    setResourceTable(DrawQueueHandle handle, uint32_t firstSlot, ResourceTableHandle table);
+
+// inline constants, up to 256 bytes copied into the queue and read as constant buffer idx, instead
+// of a ConstantBufferHandle set on the same slot; at submit they are streamed into a ring buffer
+// shared by all queues and bound by offset, so small per-draw data needs no buffer of its own
+void                    setInlineConstants(DrawQueueHandle handle, uint32_t idx, const void* data, size_t size);
+
 void                    draw(DrawQueueHandle dq, uint32_t count, uint32_t startVertex);
 void                    drawIndexed(DrawQueueHandle dq, uint32_t count, uint32_t startIndex, uint32_t startVertex);
 
@@ -640,13 +904,117 @@ void                    drawIndexedInstanced(DrawQueueHandle dq, uint32_t instan
 void                    drawInstancedIndirect(DrawQueueHandle dq, BufferHandle indirectArgs, size_t argsOffset);
 void                    drawIndexedInstancedIndirect(DrawQueueHandle dq, BufferHandle indirectArgs, size_t argsOffset);
 
-void                    submit(DrawQueueHandle handle);
+// sort keys, submit() with SubmitFlags::SortByKey plays the draws in ascending key order
+// the key applies to the next draw only, draws without a key sort as key 0, equal keys keep
+// their submission order; once a key is set every draw of the frame is recorded self-contained
+void                    setSortKey(DrawQueueHandle dq, uint64_t key);
+void                    setSortKey(DrawRecorderHandle dr, uint64_t key);
+
+// parallel recording
+// recorders are created and released on the submitting thread while no recording is in flight,
+// in between each recorder can be recorded from one thread at a time without locking, as long as
+// that thread records into its own frame arena (see setThreadFrameArena)
+// submit() plays the queue's own draws first, then its recorders ordered by key, recorders with
+// equal keys in creation order; recording must be finished on all threads before submit()
+DrawRecorderHandle      createDrawRecorder(DrawQueueHandle queue);
+void                    releaseDrawRecorder(DrawRecorderHandle handle);
+void                    setDrawRecorderKey(DrawRecorderHandle handle, uint32_t key);
+
+void                    resetBindings(DrawRecorderHandle dr);
+
+void                    setPrimitiveTopology(DrawRecorderHandle dr, PrimitiveTopology topology);
+void                    setVertexBuffer(DrawRecorderHandle dr, BufferHandle vb, uint32_t idx = 0);
+void                    setIndexBuffer(DrawRecorderHandle dr, BufferHandle ib);
+void                    setVertexBuffer(DrawRecorderHandle dr, BufferHandle vb, uint32_t idx, uint32_t offset);
+void                    setIndexBuffer(DrawRecorderHandle dr, BufferHandle ib, uint32_t offset);
+void                    setIndexBuffer(DrawRecorderHandle dr, BufferHandle ib, uint32_t offset, IndexFormat format);
+
+void                    setConstantBuffer(DrawRecorderHandle dr, uint32_t idx, ConstantBufferHandle buffer);
+void                    setConstantBufferRange(DrawRecorderHandle dr, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size);
+void                    setResource(DrawRecorderHandle dr, uint32_t idx, BufferHandle resource);
+void                    setResource(DrawRecorderHandle dr, uint32_t idx, TextureHandle resource);
+void                    setResourceTable(DrawRecorderHandle dr, uint32_t firstSlot, ResourceTableHandle table);
+void                    setInlineConstants(DrawRecorderHandle dr, uint32_t idx, const void* data, size_t size);
+
+void                    draw(DrawRecorderHandle dr, uint32_t count, uint32_t startVertex);
+void                    drawIndexed(DrawRecorderHandle dr, uint32_t count, uint32_t startIndex, uint32_t startVertex);
+
+void                    drawInstanced(DrawRecorderHandle dr, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance);
+void                    drawIndexedInstanced(DrawRecorderHandle dr, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance);
+
+void                    drawInstancedIndirect(DrawRecorderHandle dr, BufferHandle indirectArgs, size_t argsOffset);
+void                    drawIndexedInstancedIndirect(DrawRecorderHandle dr, BufferHandle indirectArgs, size_t argsOffset);
+
+void                    submit(DrawQueueHandle handle, uint32_t flags = 0); // SubmitFlags
+
+// bundles, static draws that are recorded once and then replayed any number of times
+// createBundle() takes the draws recorded into the queue so far (the queue is cleared) together
+// with its pipeline and sampler states, resolved to native objects; releasing any object the
+// bundle uses invalidates it, submit() skips invalid bundles until they are created again
+BundleHandle            createBundle(DrawQueueHandle queue);
+void                    releaseBundle(BundleHandle handle);
+bool                    isBundleValid(BundleHandle handle);
+uint32_t                getNumDrawCalls(BundleHandle handle);
+
+// visibilityMask culls draws without re-recording: bit i of visibilityMask[i / 64] enables draw i
+// in recording order, the mask covers getNumDrawCalls() bits, nullptr draws everything
+void                    submit(BundleHandle handle, const uint64_t* visibilityMask = nullptr);
 void                    flush();
 
-// performance markers
+// statistics, counted by the thread that submits and creates resources, every counter stays zero
+// in a library built with SGFX_ENABLE_STATS=0
+// binds of constant buffers, resources and samplers go through the backend's shadow copy of the
+// device state: numBoundSlots are the slots it changed with numBindCalls device calls, once per
+// binding class (not per shader stage), numRedundantBinds the slots it skipped as unchanged
+struct FrameStats
+{
+    uint32_t numDrawCalls;
+    uint32_t numDispatches;
+    uint64_t numPrimitives;           // vertices or indices times instances, indirect draws excluded
+
+    uint32_t numPipelineStateChanges;
+    uint32_t numRenderTargetChanges;
+    uint32_t numInputBinds;           // vertex/index buffers and topology
+    uint32_t numBindCalls;
+    uint32_t numBoundSlots;
+    uint32_t numRedundantBinds;
+
+    uint32_t numBufferMaps;
+    uint64_t numBytesUploaded;        // constant buffer updates, buffer and texture data, inline constants
+    uint64_t numBytesCopied;          // buffer to buffer copies
+
+    uint32_t numBuffersCreated;       // constant buffers included
+    uint32_t numTexturesCreated;
+};
+
+// the counters one submit() changed
+typedef FrameStats QueueStats;
+
+const FrameStats&       getFrameStats(); // the frame the last present() ended
+QueueStats              getQueueStats(DrawQueueHandle handle); // the last submit of the queue
+
+// performance markers, forwarded to the native GPU markers where there are any
 void                    beginPerfEvent(const wchar_t* name);
 void                    endPerfEvent();
 
+// CPU profiler, times perf events and the zones sgfx opens around submits, pipeline and shader
+// creation and uploads on every thread, nested zones included
+// names are kept by pointer and have to outlive writeProfilerTrace, start and stop it between
+// frames, outside of any perf event
+void                    startProfiler();
+void                    stopProfiler();
+bool                    writeProfilerTrace(const char* path); // Chrome trace_event JSON, false on I/O errors
+
+// API capture, every call made after startCapture() is written to a binary trace together with
+// the data it passes (shader bytecode, buffer, constant and texture contents, what the CPU wrote
+// into mapped buffers and transient memory) and a background thread streams the trace to the
+// file; start it right after init, before the first object is created, so the trace has every
+// object its calls use, sgfx_replay (tools/replay.cc) plays it back on any backend
+// startCapture fails if the file cannot be created or a capture is running, a library built with
+// SGFX_ENABLE_CAPTURE=0 writes traces without calls
+bool                    startCapture(const char* path);
+void                    stopCapture();
+
 // optional interop with D3D11
 #ifdef SGFX_D3D11_INTEROP
 namespace d3d11
@@ -670,6 +1038,242 @@ ID3D11DepthStencilView*     getNativeDSV(RenderTargetHandle handle);
 }
 #endif
 
+// optional access to the null backend device emulation
+#ifdef SGFX_NULL_INTEROP
+namespace null
+{
+
+struct DeviceStats
+{
+    uint64_t numFrames;
+    uint64_t numDrawCalls;
+    uint64_t numPrimitives;
+    uint64_t numDispatches;
+    uint64_t numThreadGroups;
+
+    uint64_t numPipelineStateChanges;
+    uint64_t numRenderTargetChanges;
+    uint64_t numInputBinds;          // vertex/index buffers and topology
+    uint64_t numConstantBufferBinds; // slots changed, counted once per shader stage
+    uint64_t numResourceBinds;
+    uint64_t numSamplerBinds;
+
+    uint64_t numConstantBufferBindCalls; // device calls binding a range of slots, per shader stage
+    uint64_t numResourceBindCalls;
+    uint64_t numSamplerBindCalls;
+
+    uint64_t numBuffersCreated;
+    uint64_t numTexturesCreated;
+    uint64_t numBytesUploaded;
+    uint64_t numBytesCopied;         // buffer to buffer copies
+    uint64_t numBufferRenames;       // WriteDiscard maps that gave a buffer new storage
+
+    uint64_t numInlineConstantUploads; // ranges streamed into the inline constant ring
+    uint64_t numInlineConstantWraps;   // times the ring started over
+};
+
+const DeviceStats&          getDeviceStats();
+void                        resetDeviceStats();
+
+}
+#endif
+
+// API capture trace format, for tools that read traces
+#if defined(SGFX_CAPTURE_FORMAT) || defined(SGFX_INTERNAL_IMPLEMENTATION)
+namespace capture
+{
+
+// a trace is a FileHeader followed by one record per call: a RecordHeader, the arguments in the
+// order the function declares them and the result, padded to a multiple of 8 bytes
+//   handles              uint32_t value, the replay maps them to the objects it created
+//   numbers and enums    their bytes, size_t and enums are 8 bytes (traces are 64-bit only)
+//   data and descriptors uint64_t size and the bytes, kNullData for nullptr; descriptors are
+//                        raw structs, the handles in them are mapped like the others
+//   strings              uint32_t length and the characters, wide ones as uint32_t each
+//   vertex elements      uint64_t count, then per element the semantic name as a string and
+//                        the other members in declaration order, perInstanceData as uint8_t
+// functions returning a pointer record a uint8_t that tells whether it was nullptr, calls
+// without a result (and compileShader, the queries and the allocator) record nothing
+struct FileHeader
+{
+    char     magic[8];         // kMagic
+    uint32_t version;          // kVersion
+    uint32_t headerSize;       // records start here
+    uint32_t backBufferWidth;
+    uint32_t backBufferHeight;
+};
+
+struct RecordHeader
+{
+    uint16_t op;    // Op
+    uint16_t flags; // unused
+    uint32_t size;  // bytes following the header
+};
+
+static const char kMagic[8] = "SGFXCAP";
+
+enum : uint32_t { kVersion  = 1 };
+enum : uint64_t { kNullData = ~0ULL };
+
+// the calls, named after the functions; overloads that differ in the handle type are told apart
+// by a suffix, recording calls on a draw recorder are the draw queue ones plus kRecorderOps
+enum class Op : uint16_t
+{
+    // shaders and pipelines
+    CreateVertexShader = 0x0001,
+    ReleaseVertexShader,
+    CreateHullShader,
+    ReleaseHullShader,
+    CreateDomainShader,
+    ReleaseDomainShader,
+    CreateGeometryShader,
+    ReleaseGeometryShader,
+    CreatePixelShader,
+    ReleasePixelShader,
+    LinkSurfaceShader,
+    ReleaseSurfaceShader,
+    CreateComputeShader,
+    ReleaseComputeShader,
+    CreateVertexFormat,
+    ReleaseVertexFormat,
+    CreatePipelineState,
+    ReleasePipelineState,
+
+    // compute
+    CreateComputeQueue = 0x0040,
+    ReleaseComputeQueue,
+    SetConstantBufferCompute,
+    SetResourceBufferCompute,
+    SetResourceTextureCompute,
+    SetResourceRWBufferCompute,
+    SetResourceRWTextureCompute,
+    SubmitCompute,
+
+    // buffers
+    CreateBuffer = 0x0060,
+    ReleaseBuffer,
+    MapBuffer,
+    UnmapBuffer,                 // followed by the buffer contents written through the map
+    CopyBufferData,
+    ClearBufferRWUInt,
+    ClearBufferRWFloat,
+    CreateConstantBuffer,
+    UpdateConstantBuffer,
+    UpdateConstantBufferRange,
+    ReleaseConstantBuffer,
+    CreateConstantAllocator,
+    ReleaseConstantAllocator,
+    AllocateConstantBlock,
+    FreeConstantBlock,
+    AllocateTransient,
+    TransientData,               // transient memory submit() uploaded: buffer, offset, data
+    CreateBufferHeap,
+    ReleaseBufferHeap,
+    AllocateBufferBlock,
+    FreeBufferBlock,
+    CompactBufferHeap,
+    CopyBufferRegion,
+    CopyResourceBuffer,
+    CopyResourceConstantBuffer,
+
+    // textures
+    CreateSamplerState = 0x00A0,
+    ReleaseSamplerState,
+    CreateTexture1D,
+    CreateTexture2D,
+    CreateTexture3D,
+    ClearTextureRWUInt,
+    ClearTextureRWFloat,
+    MapTexture,
+    UnmapTexture,                // the contents are not captured, the data is kNullData
+    UpdateTexture,
+    ReleaseTexture,
+    CopyResourceTexture,
+    CreateResourceTable,
+    ReleaseResourceTable,
+
+    // render targets and frames
+    GetBackBuffer = 0x00C0,
+    CreateRenderTarget,
+    ReleaseRenderTarget,
+    SetViewport,
+    SetResourceRWBufferRenderTarget,
+    SetResourceRWTextureRenderTarget,
+    SetRenderTarget,
+    ClearRenderTarget,
+    ClearRenderTargetSlot,
+    ClearDepthStencil,
+    Present,
+    CreateFrameArena,
+    ReleaseFrameArena,
+    SetThreadFrameArena,
+    BeginPerfEvent,
+    EndPerfEvent,
+
+    // draw queues
+    CreateDrawQueue = 0x0100,
+    ReleaseDrawQueue,
+    SetSamplerState,
+    Submit,
+    CreateDrawRecorder,
+    ReleaseDrawRecorder,
+    SetDrawRecorderKey,
+    CreateBundle,
+    ReleaseBundle,
+    SubmitBundle,                // the visibility mask is data of getNumDrawCalls() bits
+    Flush,
+
+    // recording, on a draw queue
+    ResetBindings = 0x0200,
+    SetPrimitiveTopology,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetVertexBufferOffset,
+    SetIndexBufferOffset,
+    SetIndexBufferFormat,
+    SetConstantBuffer,
+    SetConstantBufferRange,
+    SetResourceBuffer,
+    SetResourceTexture,
+    SetResourceTable,
+    SetInlineConstants,
+    Draw,
+    DrawIndexed,
+    DrawInstanced,
+    DrawIndexedInstanced,
+    DrawInstancedIndirect,
+    DrawIndexedInstancedIndirect,
+    SetSortKey,
+    LastRecordingOp = SetSortKey,
+
+    // recording, on a draw recorder
+    RecorderResetBindings = 0x0300,
+    RecorderSetPrimitiveTopology,
+    RecorderSetVertexBuffer,
+    RecorderSetIndexBuffer,
+    RecorderSetVertexBufferOffset,
+    RecorderSetIndexBufferOffset,
+    RecorderSetIndexBufferFormat,
+    RecorderSetConstantBuffer,
+    RecorderSetConstantBufferRange,
+    RecorderSetResourceBuffer,
+    RecorderSetResourceTexture,
+    RecorderSetResourceTable,
+    RecorderSetInlineConstants,
+    RecorderDraw,
+    RecorderDrawIndexed,
+    RecorderDrawInstanced,
+    RecorderDrawIndexedInstanced,
+    RecorderDrawInstancedIndirect,
+    RecorderDrawIndexedInstancedIndirect,
+    RecorderSetSortKey
+};
+
+enum : uint16_t { kRecorderOps = static_cast<uint16_t>(Op::RecorderResetBindings) - static_cast<uint16_t>(Op::ResetBindings) };
+
+}
+#endif
+
 // internal classes and data
 #ifdef SGFX_INTERNAL_IMPLEMENTATION
 
@@ -752,12 +1356,14 @@ public:
 /// Internally, DynamicArray uses a dynamically allocated array to store its elements. This array
 /// may need to be reallocated in order to grow in size when new elements are inserted, which
 /// implies allocating a new array and moving all elements to it. This is a relatively expensive
-/// task in terms of processing time, and thus, dynamic arrays do not reallocate each time an
-/// element is added to the container, instead DynamicArray::kGrowAmount is used to control growing
-/// size.
+/// task in terms of processing time, and thus, dynamic arrays grow geometrically: the capacity is
+/// at least doubled on every reallocation, DynamicArray::kGrowAmount is the smallest step.
+///
+/// Trivially copyable elements are relocated, copied and shifted with memcpy/memmove instead of
+/// per-element construction.
 ///
-/// DynamicArray is very efficient with random access pattern, while adding and removing elements
-/// is less effective compared to List.
+/// DynamicArray is very efficient with random access pattern, while removing elements from the
+/// middle is linear. Use RemoveSwap when the order of elements does not matter.
 ///
 template <typename T, size_t I = 32, size_t G = 64, typename A = DefaultAllocator>
 class DynamicArray final : public ImmutableArray<T>
@@ -776,20 +1382,74 @@ private:
         kGrowAmount         = G
     };
 
-    uint8_t _inplaceStorage[kInplaceStorageSize * sizeof(T)];
+    enum : bool
+    {
+        kTriviallyCopyable = std::is_trivially_copyable<T>::value
+    };
+
+    alignas(T) uint8_t _inplaceStorage[kInplaceStorageSize * sizeof(T)];
+
+    SGFX_FORCE_INLINE bool IsInplace() const
+    {
+        return reinterpret_cast<const uint8_t*>(pointer) == _inplaceStorage;
+    }
 
     SGFX_FORCE_INLINE void DeleteContents()
     {
-        uint8_t* ptr = reinterpret_cast<uint8_t*>(pointer);
-        if (ptr != _inplaceStorage) {
-            A::Free(ptr);
+        if (!IsInplace()) {
+            A::Free(reinterpret_cast<uint8_t*>(pointer));
             pointer = reinterpret_cast<T*>(_inplaceStorage);
         }
     }
 
+    // constructs copies of [src, src + count) in uninitialized storage
+    static SGFX_FORCE_INLINE void CopyConstruct(T* dst, const T* src, size_t count)
+    {
+        if (kTriviallyCopyable) {
+            if (count != 0)
+                std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i)
+                ::new (&dst[i]) T(src[i]);
+        }
+    }
+
+    // moves [src, src + count) to uninitialized storage and destroys the source
+    static SGFX_FORCE_INLINE void Relocate(T* dst, T* src, size_t count)
+    {
+        if (kTriviallyCopyable) {
+            if (count != 0)
+                std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                ::new (&dst[i]) T(static_cast<T&&>(src[i]));
+                src[i].~T();
+            }
+        }
+    }
+
+    // takes the contents of other, leaving it empty
+    SGFX_FORCE_INLINE void Steal(DynamicArray& other)
+    {
+        if (other.IsInplace()) {
+            Reserve(other.size);
+            Relocate(pointer, other.pointer, other.size);
+            size = other.size;
+        } else {
+            pointer  = other.pointer;
+            capacity = other.capacity;
+            size     = other.size;
+
+            other.pointer  = reinterpret_cast<T*>(other._inplaceStorage);
+            other.capacity = kInplaceStorageSize;
+        }
+        other.size = 0;
+    }
+
 public:
 
     using ImmutableArray<T>::GetData;
+    using ImmutableArray<T>::GetSize;
     using ImmutableArray<T>::IsEmpty;
     using ImmutableArray<T>::Find;
 
@@ -804,24 +1464,47 @@ public:
         capacity = kInplaceStorageSize;
         pointer  = reinterpret_cast<T*>(_inplaceStorage);
 
-        Resize(other.GetSize());
-        for (size_t i = 0; i < size; ++i)
-            ::new (&pointer[i]) T(other[i]);
+        Reserve(other.GetSize());
+        CopyConstruct(pointer, other.GetData(), other.GetSize());
+        size = other.GetSize();
+    }
+
+    SGFX_FORCE_INLINE DynamicArray(DynamicArray&& other)
+    {
+        capacity = kInplaceStorageSize;
+        pointer  = reinterpret_cast<T*>(_inplaceStorage);
+
+        Steal(other);
     }
 
     SGFX_FORCE_INLINE DynamicArray& operator=(const DynamicArray& other)
     {
-        Resize(other.GetSize());
-        for (size_t i = 0; i < size; ++i)
-            ::new (&pointer[i]) T(other[i]);
+        if (this != &other) {
+            Clear();
+            Reserve(other.GetSize());
+            CopyConstruct(pointer, other.GetData(), other.GetSize());
+            size = other.GetSize();
+        }
+        return *this;
+    }
+
+    SGFX_FORCE_INLINE DynamicArray& operator=(DynamicArray&& other)
+    {
+        if (this != &other) {
+            Purge();
+            Steal(other);
+        }
         return *this;
     }
 
     SGFX_FORCE_INLINE DynamicArray& operator=(const ImmutableArray<T>& other)
     {
-        Resize(other.GetSize());
-        for (size_t i = 0; i < size; ++i)
-            ::new (&pointer[i]) T(other[i]);
+        if (this != &other) {
+            Clear();
+            Reserve(other.GetSize());
+            CopyConstruct(pointer, other.GetData(), other.GetSize());
+            size = other.GetSize();
+        }
         return *this;
     }
 
@@ -832,8 +1515,10 @@ public:
 
     SGFX_FORCE_INLINE void Clear()
     {
-        for (size_t i = 0; i < size; ++i)
-            pointer[i].~T();
+        if (!kTriviallyCopyable) {
+            for (size_t i = 0; i < size; ++i)
+                pointer[i].~T();
+        }
         size = 0;
     }
 
@@ -867,42 +1552,58 @@ public:
     SGFX_FORCE_INLINE void Reserve(size_t numElements)
     {
         if (numElements > capacity)
-            Grow(numElements - capacity);
+            Grow(numElements - size);
     }
 
-    SGFX_FORCE_INLINE void Grow(size_t numElements)
+    // makes room for at least numElements more elements
+    inline void Grow(size_t numElements)
     {
-        size_t newCapacity = size + numElements;
-        capacity = newCapacity;
+        size_t newCapacity = capacity * 2;
+        if (newCapacity < capacity + kGrowAmount)
+            newCapacity = capacity + kGrowAmount;
+        if (newCapacity < size + numElements)
+            newCapacity = size + numElements;
 
-        if (newCapacity > kInplaceStorageSize) {
-            T* ptr = reinterpret_cast<T*>(A::Allocate(newCapacity * sizeof(T)));
-
-            for (size_t i = 0; i < size; ++i)
-                ::new (&ptr[i]) T(static_cast<T&&>(pointer[i]));
+        T* ptr = reinterpret_cast<T*>(A::Allocate(newCapacity * sizeof(T)));
+        Relocate(ptr, pointer, size);
 
-            DeleteContents();
+        DeleteContents();
 
-            pointer = ptr;
-        }
+        pointer  = ptr;
+        capacity = newCapacity;
     }
 
     SGFX_FORCE_INLINE void Merge(const DynamicArray& other)
     {
         if (!other.IsEmpty()) {
             Reserve(GetSize() + other.GetSize());
-            for (const T& element : other)
-                Add(element);
+            CopyConstruct(pointer + size, other.GetData(), other.GetSize());
+            size += other.GetSize();
         }
     }
 
     SGFX_FORCE_INLINE void Add(const T& element)
     {
-        if (size >= capacity)
-            Grow(kGrowAmount);
+        if (size >= capacity) {
+            // element may live in the storage being reallocated
+            T copy(element);
+            Grow(1);
+            ::new (pointer + size) T(static_cast<T&&>(copy));
+        } else {
+            ::new (pointer + size) T(element);
+        }
+        size++;
+    }
 
-        T* ptr = pointer + size;
-        ::new (ptr)T(element);
+    SGFX_FORCE_INLINE void Add(T&& element)
+    {
+        if (size >= capacity) {
+            T temp(static_cast<T&&>(element));
+            Grow(1);
+            ::new (pointer + size) T(static_cast<T&&>(temp));
+        } else {
+            ::new (pointer + size) T(static_cast<T&&>(element));
+        }
         size++;
     }
 
@@ -910,23 +1611,23 @@ public:
     SGFX_FORCE_INLINE void EmplaceAdd(Args&&... args)
     {
         if (size >= capacity)
-            Grow(kGrowAmount);
+            Grow(1);
 
         T* ptr = pointer + size;
         ::new (ptr)T(static_cast<Args&&>(args)...);
         size++;
     }
 
+    // removes the element keeping the order of the others, linear in the number of elements after it
     SGFX_FORCE_INLINE void Remove(size_t index)
     {
         if (index < size) {
-            pointer[index].~T();
-
-            T* ptr = pointer + index;
-            for (size_t i = index + 1; i < size; ++i) {
-                ::new (ptr)T(static_cast<T&&>(pointer[i]));
-                ptr++;
-                ptr->~T();
+            if (kTriviallyCopyable) {
+                std::memmove(static_cast<void*>(pointer + index), pointer + index + 1, (size - index - 1) * sizeof(T));
+            } else {
+                for (size_t i = index + 1; i < size; ++i)
+                    pointer[i - 1] = static_cast<T&&>(pointer[i]);
+                pointer[size - 1].~T();
             }
 
             size--;
@@ -939,173 +1640,4213 @@ public:
         if (index != -1)
             Remove(index);
     }
-};
-
-// emulated draw queues for pre-DX12 APIs (DX11 and GL4)
-struct ShaderResource final
-{
-    bool  isTexture = false;
-    void* value     = nullptr;
-
-    inline ShaderResource() {}
-    inline ShaderResource(bool texture, void* newHandle)
-        : isTexture(texture), value(newHandle)
-    {}
-};
 
-struct DrawCall final
-{
-    enum Type : uint32_t
+    // removes the element by moving the last one into its place, constant time
+    SGFX_FORCE_INLINE void RemoveSwap(size_t index)
     {
-        Draw                            = 0,
-        DrawIndexed                     = 1,
-        DrawInstanced                   = 2,
-        DrawIndexedInstanced            = 3,
+        if (index < size) {
+            size_t last = size - 1;
+            if (index != last)
+                pointer[index] = static_cast<T&&>(pointer[last]);
+            pointer[last].~T();
 
-        DrawInstancedIndirect           = 4,
-        DrawIndexedInstancedIndirect    = 5
-    };
+            size--;
+        }
+    }
 
-    enum
+    SGFX_FORCE_INLINE void RemoveSwap(const T& element)
     {
-        kMaxConstantBuffers     = 8,
-        kMaxShaderResources     = 128,
-        kMaxVertexBuffers       = 16
-    };
-
-    ConstantBufferHandle    constantBuffers[kMaxConstantBuffers];
-    ShaderResource          shaderResources[kMaxShaderResources];
-
-    BufferHandle      vertexBuffers[kMaxVertexBuffers];
-    BufferHandle      indexBuffer;
-    BufferHandle      indirectArgsBuffer;
-    size_t            indirectArgsOffset;
-    PrimitiveTopology primitiveTopology;
-
-    uint32_t instanceCount;
-    uint32_t count;
-    uint32_t startVertex;
-    uint32_t startIndex;
-    uint32_t startInstance;
-    Type     type;
+        ptrdiff_t index = Find(element);
+        if (index != -1)
+            RemoveSwap(index);
+    }
 };
 
-class DrawQueue final
+///
+/// HandleTable owns the objects behind a handle type and hands out 32-bit handle values.
+///
+/// A handle value packs the slot index in its low kIndexBits and the generation of the slot in
+/// the remaining bits. Objects are stored in fixed-size chunks, so they sit next to each other in
+/// memory and never move, while generations and free list links live in separate arrays.
+///
+/// Releasing an object bumps the generation of its slot, so a stale handle no longer matches.
+/// Get() checks that only when SGFX_VALIDATE_HANDLES is enabled (debug builds by default), in
+/// release builds a lookup is a shift, a mask and two loads. Generations start at 1, so a valid
+/// handle value is never 0 and Get(0) returns nullptr.
+///
+template <typename T, typename A = DefaultAllocator>
+class HandleTable final
 {
+    static constexpr uint32_t ChunkBits(uint32_t bits)
+    {
+        return (bits == 0 || (sizeof(T) << bits) <= 16384) ? bits : ChunkBits(bits - 1);
+    }
+
 public:
 
-    typedef DynamicArray<DrawCall, 4096, 4096> DrawCallArray;
+    enum : uint32_t
+    {
+        kIndexBits      = 20,
+        kIndexMask      = (1u << kIndexBits) - 1,
+        kGenerationMask = (1u << (32 - kIndexBits)) - 1,
+        kMaxObjects     = 1u << kIndexBits,
+
+        // about 16 KB of objects per chunk, at most 256 objects
+        kChunkBits      = ChunkBits(8),
+        kChunkSize      = 1u << kChunkBits,
+        kChunkMask      = kChunkSize - 1
+    };
 
 private:
-    PipelineStateHandle state;
-    DrawCall            currentDrawCall;
-    DrawCallArray       drawCalls;
-
-public:
 
-    enum
+    enum : uint32_t
     {
-        kMaxSamplerStates = 8
+        kNoFreeSlot = 0xFFFFFFFF,
+        kAliveSlot  = 0xFFFFFFFE
     };
-    SamplerStateHandle samplerStates[kMaxSamplerStates];
 
-    DrawQueue(PipelineStateHandle _state) : state(_state) {}
+    struct Chunk
+    {
+        alignas(T) uint8_t objects[kChunkSize * sizeof(T)];
+        uint16_t           generations[kChunkSize];
+        uint32_t           nextFree[kChunkSize];
+    };
 
-    SGFX_FORCE_INLINE PipelineStateHandle  getState() const     { return state; }
-    SGFX_FORCE_INLINE const DrawCallArray& getDrawCalls() const { return drawCalls; }
+    DynamicArray<Chunk*, 16, 16, A> chunks;
 
-    SGFX_FORCE_INLINE void clear()
-    {
-        drawCalls.Clear();
-    }
+    uint32_t freeSlot    = kNoFreeSlot;
+    uint32_t numSlots    = 0;
+    uint32_t numObjects  = 0;
+    uint32_t numReleases = 0;
 
-    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)     { currentDrawCall.primitiveTopology = topology; }
-    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle)   { currentDrawCall.vertexBuffers[idx] = handle; }
-    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle)                  { currentDrawCall.indexBuffer  = handle; }
+    HandleTable(const HandleTable& other) = delete;
+    HandleTable& operator=(const HandleTable& other) = delete;
 
-    SGFX_FORCE_INLINE void setSamplerState(uint32_t idx, SamplerStateHandle handle)
+    SGFX_FORCE_INLINE Chunk* GetChunk(uint32_t index) const
     {
-        samplerStates[idx] = handle;
+        return chunks.GetData()[index >> kChunkBits];
     }
 
-    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle resource)
+    SGFX_FORCE_INLINE T* GetSlot(uint32_t index) const
     {
-        currentDrawCall.constantBuffers[idx] = resource;
+        return reinterpret_cast<T*>(GetChunk(index)->objects) + (index & kChunkMask);
     }
 
-    SGFX_FORCE_INLINE void setResource(uint32_t idx, BufferHandle resource)
+    SGFX_FORCE_INLINE uint16_t& GetGeneration(uint32_t index) const { return GetChunk(index)->generations[index & kChunkMask]; }
+    SGFX_FORCE_INLINE uint32_t& GetNextFree(uint32_t index) const   { return GetChunk(index)->nextFree[index & kChunkMask]; }
+
+public:
+
+    SGFX_FORCE_INLINE HandleTable() {}
+
+    SGFX_FORCE_INLINE ~HandleTable()
     {
-        currentDrawCall.shaderResources[idx] = ShaderResource(false, resource.value);
+        Purge();
     }
 
-    SGFX_FORCE_INLINE void setResource(uint32_t idx, TextureHandle resource)
+    // constructs a new object, returns its handle value or 0 if the table is full
+    template <typename ...Args>
+    inline uint32_t Create(Args&&... args)
     {
-        currentDrawCall.shaderResources[idx] = ShaderResource(true, resource.value);
+        uint32_t index = 0;
+
+        if (freeSlot != kNoFreeSlot) {
+            index    = freeSlot;
+            freeSlot = GetNextFree(index);
+        } else {
+            if (numSlots >= kMaxObjects)
+                return 0;
+
+            if ((numSlots & kChunkMask) == 0)
+                chunks.Add(reinterpret_cast<Chunk*>(A::Allocate(sizeof(Chunk))));
+
+            index = numSlots++;
+            GetGeneration(index) = 1;
+        }
+
+        GetNextFree(index) = kAliveSlot;
+        ::new (GetSlot(index)) T(static_cast<Args&&>(args)...);
+        numObjects++;
+
+        return (static_cast<uint32_t>(GetGeneration(index)) << kIndexBits) | index;
     }
 
-    SGFX_FORCE_INLINE void draw(uint32_t count, uint32_t startVertex)
+    SGFX_FORCE_INLINE bool IsValid(uint32_t handle) const
     {
-        currentDrawCall.count       = count;
-        currentDrawCall.startVertex = startVertex;
-        currentDrawCall.startIndex  = 0;
-        currentDrawCall.type        = DrawCall::Draw;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        uint32_t index = handle & kIndexMask;
+        return handle != 0 && index < numSlots
+            && GetNextFree(index) == kAliveSlot
+            && GetGeneration(index) == (handle >> kIndexBits);
     }
 
-    SGFX_FORCE_INLINE void drawIndexed(uint32_t count, uint32_t startIndex, uint32_t startVertex)
+    // object behind the handle, nullptr for the invalid handle
+    SGFX_FORCE_INLINE T* Get(uint32_t handle) const
     {
-        currentDrawCall.count       = count;
-        currentDrawCall.startVertex = startVertex;
-        currentDrawCall.startIndex  = startIndex;
-        currentDrawCall.type        = DrawCall::DrawIndexed;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        if (handle == 0)
+            return nullptr;
+
+#if SGFX_VALIDATE_HANDLES
+        if (!IsValid(handle))
+            SGFX_TRAP(); // stale or foreign handle
+#endif
+
+        return GetSlot(handle & kIndexMask);
     }
 
-    SGFX_FORCE_INLINE void drawInstanced(uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+    // stored value for tables of native pointers, value-initialized T for the invalid handle
+    SGFX_FORCE_INLINE T GetValue(uint32_t handle) const
     {
-        currentDrawCall.instanceCount = instanceCount;
-        currentDrawCall.count         = count;
-        currentDrawCall.startVertex   = startVertex;
-        currentDrawCall.startIndex    = 0;
-        currentDrawCall.startInstance = startInstance;
-        currentDrawCall.type          = DrawCall::DrawInstanced;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        T* object = Get(handle);
+        return (object != nullptr) ? *object : T();
+    }
+
+    inline void Release(uint32_t handle)
+    {
+        // releases are rare, stale ones are always ignored to keep the free list intact
+        if (!IsValid(handle)) {
+#if SGFX_VALIDATE_HANDLES
+            if (handle != 0)
+                SGFX_TRAP();
+#endif
+            return;
+        }
+
+        uint32_t index = handle & kIndexMask;
+        GetSlot(index)->~T();
+
+        uint16_t& generation = GetGeneration(index);
+        generation = (generation == kGenerationMask) ? 1 : static_cast<uint16_t>(generation + 1);
+
+        GetNextFree(index) = freeSlot;
+        freeSlot = index;
+        numObjects--;
+        numReleases++;
+    }
+
+    // destroys all live objects and frees the storage
+    inline void Purge()
+    {
+        for (uint32_t index = 0; index < numSlots; ++index) {
+            if (GetNextFree(index) == kAliveSlot)
+                GetSlot(index)->~T();
+        }
+
+        for (Chunk* chunk : chunks)
+            A::Free(reinterpret_cast<uint8_t*>(chunk));
+        chunks.Purge();
+
+        freeSlot   = kNoFreeSlot;
+        numSlots   = 0;
+        numObjects = 0;
+    }
+
+    SGFX_FORCE_INLINE uint32_t GetNumObjects() const  { return numObjects; }
+
+    // advanced by every Release(), lets holders of resolved objects notice releases cheaply
+    SGFX_FORCE_INLINE uint32_t GetNumReleases() const { return numReleases; }
+};
+
+///
+/// FrameArena is a linear allocator for data that only lives until the end of the frame.
+///
+/// Memory is carved out of a chain of blocks. Reset() rewinds the arena but keeps its blocks,
+/// so a steady workload stops touching the system allocator after the first few frames.
+/// Backends reset all frame arenas in present().
+///
+class FrameArena final
+{
+    struct Block
+    {
+        Block*  next;
+        size_t  capacity;
+    };
+
+    Block*  firstBlock   = nullptr;
+    Block*  currentBlock = nullptr;
+    size_t  blockOffset  = 0;
+    size_t  blockSize    = 0;
+
+    size_t  usedSize     = 0;
+    size_t  reservedSize = 0;
+
+    FrameArena(const FrameArena& other) = delete;
+    FrameArena& operator=(const FrameArena& other) = delete;
+
+public:
+
+    enum
+    {
+        kDefaultBlockSize = 1024 * 1024
+    };
+
+    // backends chain their arenas to reset them together
+    FrameArena* nextArena = nullptr;
+
+    SGFX_FORCE_INLINE explicit FrameArena(size_t newBlockSize = kDefaultBlockSize)
+        : blockSize(newBlockSize)
+    {}
+
+    SGFX_FORCE_INLINE ~FrameArena()
+    {
+        Purge();
+    }
+
+    // alignment must be a power of two
+    inline void* Allocate(size_t size, size_t alignment = 16)
+    {
+        while (currentBlock != nullptr) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(currentBlock);
+            uintptr_t ptr  = (base + blockOffset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+
+            if (ptr + size <= base + currentBlock->capacity) {
+                usedSize   += ptr + size - (base + blockOffset);
+                blockOffset = ptr + size - base;
+                return reinterpret_cast<void*>(ptr);
+            }
+
+            // blocks kept from previous frames are reused before allocating new ones
+            if (currentBlock->next == nullptr)
+                break;
+
+            currentBlock = currentBlock->next;
+            blockOffset  = sizeof(Block);
+        }
+
+        size_t capacity = sizeof(Block) + size + alignment;
+        if (capacity < blockSize)
+            capacity = blockSize;
+
+        Block* block = reinterpret_cast<Block*>(DefaultAllocator::Allocate(capacity));
+        block->next     = nullptr;
+        block->capacity = capacity;
+
+        if (currentBlock != nullptr)
+            currentBlock->next = block;
+        else
+            firstBlock = block;
+
+        currentBlock  = block;
+        blockOffset   = sizeof(Block);
+        reservedSize += capacity;
+
+        return Allocate(size, alignment);
+    }
+
+    SGFX_FORCE_INLINE void Reset()
+    {
+        currentBlock = firstBlock;
+        blockOffset  = sizeof(Block);
+        usedSize     = 0;
+    }
+
+    SGFX_FORCE_INLINE void Purge()
+    {
+        Block* block = firstBlock;
+        while (block != nullptr) {
+            Block* next = block->next;
+            DefaultAllocator::Free(reinterpret_cast<uint8_t*>(block));
+            block = next;
+        }
+
+        firstBlock   = nullptr;
+        currentBlock = nullptr;
+        blockOffset  = 0;
+        usedSize     = 0;
+        reservedSize = 0;
+    }
+
+    SGFX_FORCE_INLINE size_t GetUsedSize() const     { return usedSize; }
+    SGFX_FORCE_INLINE size_t GetReservedSize() const { return reservedSize; }
+};
+
+// implemented by every backend that uses DrawQueue
+FrameArena* getFrameArena(); // arena selected by the calling thread
+uint32_t    getFrameIndex(); // advanced by present(), frame arena memory of older frames is gone
+FrameStats& getStatCounters(); // the frame being counted
+class Profiler;
+Profiler&   getProfiler();
+class CaptureWriter;
+CaptureWriter& getCaptureWriter();
+
+#if SGFX_ENABLE_STATS
+#   define SGFX_STAT(counter, n) (SGFX_NS_INTERNAL::getStatCounters().counter += (n))
+#else
+#   define SGFX_STAT(counter, n) ((void)0)
+#endif
+
+// stores what the counters of the current frame gained while it lives in the stats of one submit
+class QueueStatsScope final
+{
+#if SGFX_ENABLE_STATS
+    QueueStats& stats;
+    FrameStats  before;
+
+public:
+
+    inline explicit QueueStatsScope(QueueStats& queueStats)
+        : stats(queueStats)
+        , before(getStatCounters())
+    {}
+
+    inline ~QueueStatsScope()
+    {
+        const FrameStats& after = getStatCounters();
+
+        stats.numDrawCalls            = after.numDrawCalls            - before.numDrawCalls;
+        stats.numDispatches           = after.numDispatches           - before.numDispatches;
+        stats.numPrimitives           = after.numPrimitives           - before.numPrimitives;
+        stats.numPipelineStateChanges = after.numPipelineStateChanges - before.numPipelineStateChanges;
+        stats.numRenderTargetChanges  = after.numRenderTargetChanges  - before.numRenderTargetChanges;
+        stats.numInputBinds           = after.numInputBinds           - before.numInputBinds;
+        stats.numBindCalls            = after.numBindCalls            - before.numBindCalls;
+        stats.numBoundSlots           = after.numBoundSlots           - before.numBoundSlots;
+        stats.numRedundantBinds       = after.numRedundantBinds       - before.numRedundantBinds;
+        stats.numBufferMaps           = after.numBufferMaps           - before.numBufferMaps;
+        stats.numBytesUploaded        = after.numBytesUploaded        - before.numBytesUploaded;
+        stats.numBytesCopied          = after.numBytesCopied          - before.numBytesCopied;
+        stats.numBuffersCreated       = after.numBuffersCreated       - before.numBuffersCreated;
+        stats.numTexturesCreated      = after.numTexturesCreated      - before.numTexturesCreated;
+    }
+#else
+public:
+
+    inline explicit QueueStatsScope(QueueStats&) {}
+#endif
+};
+
+// CPU profiler behind startProfiler, every thread closes zones into a ring of its own
+// recording takes no locks: a thread registers itself once with a compare and swap and is the
+// only writer of its ring, readers see the zones up to the ring's head
+// timestamps are TSC ticks where there is one, converted to time with the steady clock when
+// the trace is written
+class Profiler final
+{
+public:
+
+    enum : uint32_t
+    {
+        kRingSize = 16384, // zones kept per thread, older ones are overwritten
+        kMaxDepth = 64     // deeper zones are not recorded, their parents are
+    };
+
+    struct Zone final
+    {
+        uint64_t    begin;
+        uint64_t    end;
+        const void* name;
+        uint32_t    depth;
+        uint32_t    isWide; // perf event name, wchar_t
+    };
+
+    struct Thread final
+    {
+        Zone                  ring[kRingSize];
+        Zone                  stack[kMaxDepth]; // open zones
+        std::atomic<uint64_t> head;             // zones ever written
+        uint32_t              depth;
+        uint32_t              session;
+        uint32_t              id;
+        Thread*               next;
+    };
+
+private:
+
+    struct ThreadSlot final
+    {
+        Thread*  thread;
+        uint32_t epoch;
+    };
+
+    std::atomic<Thread*>  threads;
+    std::atomic<uint32_t> numThreads;
+    std::atomic<uint32_t> session;   // 0 while stopped
+    uint32_t              lastSession = 0;
+    uint32_t              epoch       = 1; // invalidates the threads' slots on release
+
+    uint64_t startTicks  = 0;
+    uint64_t startNanos  = 0;
+    uint64_t stopTicks   = 0;
+    uint64_t stopNanos   = 0;
+
+    static SGFX_FORCE_INLINE ThreadSlot& getThreadSlot()
+    {
+        static thread_local ThreadSlot slot = { nullptr, 0 };
+        return slot;
+    }
+
+    static inline uint64_t getNanos()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+    }
+
+    Thread* registerThread()
+    {
+        Thread* thread = new (allocate(sizeof(Thread))) Thread();
+        thread->head.store(0, std::memory_order_relaxed);
+        thread->depth   = 0;
+        thread->session = 0;
+        thread->id      = numThreads.fetch_add(1, std::memory_order_relaxed);
+        thread->next    = threads.load(std::memory_order_relaxed);
+        while (!threads.compare_exchange_weak(thread->next, thread, std::memory_order_release, std::memory_order_relaxed)) {}
+
+        ThreadSlot& slot = getThreadSlot();
+        slot.thread = thread;
+        slot.epoch  = epoch;
+        return thread;
+    }
+
+    // writes a name as a JSON string, wide names are converted to UTF-8
+    static void writeName(FILE* file, const Zone& zone)
+    {
+        fputc('"', file);
+
+        if (zone.isWide != 0) {
+            for (const wchar_t* c = static_cast<const wchar_t*>(zone.name); *c != 0; ++c) {
+                uint32_t code = static_cast<uint32_t>(*c);
+                if (sizeof(wchar_t) == 2 && code >= 0xD800 && code < 0xDC00 && c[1] >= 0xDC00 && c[1] < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (static_cast<uint32_t>(c[1]) - 0xDC00);
+                    ++c;
+                }
+
+                if (code == '"' || code == '\\')      { fputc('\\', file); fputc(static_cast<int>(code), file); }
+                else if (code < 0x20)                 { fprintf(file, "\\u%04x", code); }
+                else if (code < 0x80)                 { fputc(static_cast<int>(code), file); }
+                else if (code < 0x800)                { fputc(0xC0 | (code >> 6), file); fputc(0x80 | (code & 0x3F), file); }
+                else if (code < 0x10000)              { fputc(0xE0 | (code >> 12), file); fputc(0x80 | ((code >> 6) & 0x3F), file); fputc(0x80 | (code & 0x3F), file); }
+                else {
+                    fputc(0xF0 | (code >> 18), file);
+                    fputc(0x80 | ((code >> 12) & 0x3F), file);
+                    fputc(0x80 | ((code >> 6) & 0x3F), file);
+                    fputc(0x80 | (code & 0x3F), file);
+                }
+            }
+        } else {
+            for (const char* c = static_cast<const char*>(zone.name); *c != 0; ++c) {
+                uint8_t code = static_cast<uint8_t>(*c);
+                if (code == '"' || code == '\\') { fputc('\\', file); fputc(code, file); }
+                else if (code < 0x20)            { fprintf(file, "\\u%04x", code); }
+                else                             { fputc(code, file); }
+            }
+        }
+
+        fputc('"', file);
+    }
+
+public:
+
+    Profiler()
+    {
+        threads.store(nullptr, std::memory_order_relaxed);
+        numThreads.store(0, std::memory_order_relaxed);
+        session.store(0, std::memory_order_relaxed);
+    }
+
+    static SGFX_FORCE_INLINE uint64_t getTicks()
+    {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return getNanos();
+#endif
+    }
+
+    SGFX_FORCE_INLINE void begin(const void* name, bool isWide)
+    {
+        uint32_t current = session.load(std::memory_order_relaxed);
+        if (current == 0)
+            return;
+
+        ThreadSlot& slot   = getThreadSlot();
+        Thread*     thread = (slot.epoch == epoch) ? slot.thread : registerThread();
+
+        // zones left open by an earlier session are forgotten
+        if (thread->session != current) {
+            thread->session = current;
+            thread->depth   = 0;
+        }
+
+        if (thread->depth < kMaxDepth) {
+            Zone& zone  = thread->stack[thread->depth];
+            zone.name   = name;
+            zone.depth  = thread->depth;
+            zone.isWide = isWide ? 1 : 0;
+            zone.begin  = getTicks();
+        }
+        thread->depth++;
+    }
+
+    SGFX_FORCE_INLINE void end()
+    {
+        uint32_t current = session.load(std::memory_order_relaxed);
+        if (current == 0)
+            return;
+
+        ThreadSlot& slot   = getThreadSlot();
+        Thread*     thread = slot.thread;
+        if (slot.epoch != epoch || thread->session != current || thread->depth == 0)
+            return;
+
+        thread->depth--;
+        if (thread->depth < kMaxDepth) {
+            uint64_t head = thread->head.load(std::memory_order_relaxed);
+
+            Zone& zone = thread->ring[head % kRingSize];
+            zone     = thread->stack[thread->depth];
+            zone.end = getTicks();
+
+            thread->head.store(head + 1, std::memory_order_release);
+        }
+    }
+
+    void start()
+    {
+        if (session.load(std::memory_order_relaxed) != 0)
+            return;
+
+        startTicks = getTicks();
+        startNanos = getNanos();
+        stopTicks  = 0;
+        stopNanos  = 0;
+
+        // zero means stopped
+        if (++lastSession == 0)
+            ++lastSession;
+        session.store(lastSession, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        if (session.load(std::memory_order_relaxed) == 0)
+            return;
+
+        session.store(0, std::memory_order_release);
+        stopTicks = getTicks();
+        stopNanos = getNanos();
+    }
+
+    // the zones of the last session, threads still recording may overwrite what is being written
+    bool writeTrace(const char* path) const
+    {
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr)
+            return false;
+
+        uint64_t endTicks = stopTicks;
+        uint64_t endNanos = stopNanos;
+        if (session.load(std::memory_order_acquire) != 0) {
+            endTicks = getTicks();
+            endNanos = getNanos();
+        }
+
+        double microsPerTick = 0.0;
+        if (endTicks > startTicks)
+            microsPerTick = static_cast<double>(endNanos - startNanos) / static_cast<double>(endTicks - startTicks) / 1000.0;
+
+        fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+
+        bool isFirst = true;
+        for (const Thread* thread = threads.load(std::memory_order_acquire); thread != nullptr; thread = thread->next) {
+            uint64_t head   = thread->head.load(std::memory_order_acquire);
+            uint64_t oldest = (head > kRingSize) ? head - kRingSize : 0;
+
+            for (uint64_t i = oldest; i < head; ++i) {
+                const Zone& zone = thread->ring[i % kRingSize];
+                if (zone.begin < startTicks || (endTicks != 0 && zone.end > endTicks))
+                    continue;
+
+                fputs(isFirst ? "{\"name\":" : ",\n{\"name\":", file);
+                writeName(file, zone);
+                fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    zone.isWide ? "perf" : "sgfx",
+                    static_cast<double>(zone.begin - startTicks) * microsPerTick,
+                    static_cast<double>(zone.end - zone.begin) * microsPerTick,
+                    thread->id
+                );
+                isFirst = false;
+            }
+        }
+
+        fputs("\n]}\n", file);
+        return (fclose(file) == 0);
+    }
+
+    // frees the rings of all threads, the profiler is stopped and no thread may be recording
+    void release()
+    {
+        session.store(0, std::memory_order_release);
+
+        Thread* thread = threads.exchange(nullptr, std::memory_order_acquire);
+        while (thread != nullptr) {
+            Thread* next = thread->next;
+            thread->~Thread();
+            deallocate(thread);
+            thread = next;
+        }
+        numThreads.store(0, std::memory_order_relaxed);
+        epoch++;
+    }
+};
+
+// a zone around sgfx's own work, compiled out with SGFX_ENABLE_PROFILER=0
+class ProfileZone final
+{
+public:
+
+    SGFX_FORCE_INLINE explicit ProfileZone(const char* name) { getProfiler().begin(name, false); }
+    SGFX_FORCE_INLINE ~ProfileZone()                         { getProfiler().end(); }
+};
+
+#if SGFX_ENABLE_PROFILER
+#   define SGFX_PROFILE_ZONE_NAME2(line) profileZone##line
+#   define SGFX_PROFILE_ZONE_NAME(line)  SGFX_PROFILE_ZONE_NAME2(line)
+#   define SGFX_PROFILE_ZONE(name)       SGFX_NS_INTERNAL::ProfileZone SGFX_PROFILE_ZONE_NAME(__LINE__)(name)
+#else
+#   define SGFX_PROFILE_ZONE(name)       ((void)0)
+#endif
+
+// texture layouts, the null backend stores textures this way and the capture sizes texture data
+SGFX_FORCE_INLINE size_t getFormatBitsPerPixel(DataFormat format)
+{
+    switch (format) {
+    case DataFormat::BC1:        { return 4;   } break;
+    case DataFormat::BC2:        { return 8;   } break;
+    case DataFormat::BC3:        { return 8;   } break;
+    case DataFormat::BC4:        { return 4;   } break;
+    case DataFormat::BC5:        { return 8;   } break;
+    case DataFormat::BC6H:       { return 8;   } break;
+    case DataFormat::BC7:        { return 8;   } break;
+    case DataFormat::ETC1:       { return 4;   } break;
+    case DataFormat::ETC2:       { return 4;   } break;
+    case DataFormat::ETC2A:      { return 8;   } break;
+    case DataFormat::ETC2A1:     { return 4;   } break;
+    case DataFormat::PTC12:      { return 2;   } break;
+    case DataFormat::PTC14:      { return 4;   } break;
+    case DataFormat::PTC12A:     { return 2;   } break;
+    case DataFormat::PTC14A:     { return 4;   } break;
+    case DataFormat::PTC22:      { return 2;   } break;
+    case DataFormat::PTC24:      { return 4;   } break;
+    case DataFormat::R1:         { return 1;   } break;
+    case DataFormat::R8:         { return 8;   } break;
+    case DataFormat::R16:        { return 16;  } break;
+    case DataFormat::R16F:       { return 16;  } break;
+    case DataFormat::R32I:       { return 32;  } break;
+    case DataFormat::R32U:       { return 32;  } break;
+    case DataFormat::R32F:       { return 32;  } break;
+    case DataFormat::RG8:        { return 16;  } break;
+    case DataFormat::RG16:       { return 32;  } break;
+    case DataFormat::RG16F:      { return 32;  } break;
+    case DataFormat::RG32I:      { return 64;  } break;
+    case DataFormat::RG32U:      { return 64;  } break;
+    case DataFormat::RG32F:      { return 64;  } break;
+    case DataFormat::RGB32I:     { return 96;  } break;
+    case DataFormat::RGB32U:     { return 96;  } break;
+    case DataFormat::RGB32F:     { return 96;  } break;
+    case DataFormat::RGBA8:      { return 32;  } break;
+    case DataFormat::RGBA16:     { return 64;  } break;
+    case DataFormat::RGBA16F:    { return 64;  } break;
+    case DataFormat::RGBA32I:    { return 128; } break;
+    case DataFormat::RGBA32U:    { return 128; } break;
+    case DataFormat::RGBA32F:    { return 128; } break;
+    case DataFormat::R11G11B10F: { return 32;  } break;
+    case DataFormat::D16:        { return 16;  } break;
+    case DataFormat::D24S8:      { return 32;  } break;
+    case DataFormat::D32F:       { return 32;  } break;
+
+    default: { return 0; } break; // unsupported
+    }
+}
+
+// compressed formats are stored as 4x4 blocks, everything else as single pixels
+SGFX_FORCE_INLINE uint32_t getFormatBlockSize(DataFormat format)
+{
+    return isCompressedFormat(format) ? 4 : 1;
+}
+
+SGFX_FORCE_INLINE size_t getFormatRowPitch(DataFormat format, uint32_t width)
+{
+    uint32_t blockSize = getFormatBlockSize(format);
+    size_t   numBlocks = (width + blockSize - 1) / blockSize;
+    return (numBlocks * blockSize * blockSize * getFormatBitsPerPixel(format) + 7) / 8;
+}
+
+// data a captured call passes by pointer, written with its size (see capture::FileHeader)
+struct CaptureData final
+{
+    const void* data;
+    size_t      size;
+};
+
+// the rows and slices updateTexture() reads, sized with the format of the texture
+struct CaptureTextureData final
+{
+    const void* data;
+    size_t      sizeX, sizeY, sizeZ;
+    size_t      rowPitch, depthPitch;
+};
+
+// as much data as the constant buffer of the call holds
+struct CaptureConstantData final
+{
+    const void* data;
+};
+
+// a visibility mask of getNumDrawCalls() bits
+struct CaptureBundleMask final
+{
+    BundleHandle    bundle;
+    const uint64_t* mask;
+};
+
+struct CaptureWideString final
+{
+    const wchar_t* string;
+};
+
+struct CaptureVertexElements final
+{
+    const VertexElementDescriptor* elements;
+    size_t                         count;
+};
+
+template <typename T>
+SGFX_FORCE_INLINE CaptureData capturePod(const T* pod) { CaptureData data = { pod, sizeof(T) }; return data; }
+
+template <typename T>
+SGFX_FORCE_INLINE CaptureData capturePod(const T& pod) { return capturePod(&pod); }
+
+// API capture behind startCapture, a call is staged in a buffer of the calling thread and appended
+// to the pending records under a lock, a writer thread drains them to the file once kFlushSize
+// bytes piled up or kFlushInterval passed; callers wait while kMaxPendingSize bytes are pending
+// buffers, constant buffers and textures are tracked by handle slot for the calls that pass data
+// without its size (mapped buffers, whole constant buffers, texture rows)
+class CaptureWriter final
+{
+public:
+
+    enum : size_t
+    {
+        kFlushSize      = 1 << 20,
+        kMaxPendingSize = 64 << 20
+    };
+
+    enum : uint32_t
+    {
+        kFlushInterval  = 50 // ms
+    };
+
+    enum ResourceType : uint32_t
+    {
+        Buffer,
+        ConstantBuffer,
+        Texture,
+
+        kNumResourceTypes
+    };
+
+    // what a thread is capturing, nested records are the ones sgfx writes inside a call
+    struct Thread final
+    {
+        DynamicArray<uint8_t, 1> record;
+        DynamicArray<uint8_t, 1> nestedRecord;
+        uint32_t                 depth = 0; // calls entered, only the outermost one is recorded
+    };
+
+private:
+
+    struct Resource final
+    {
+        uint32_t   value   = 0;
+        DataFormat format  = DataFormat::RGBA8;
+        size_t     size    = 0;
+        void*      mapped  = nullptr; // written to the trace by the unmap
+        MapType    mapType = MapType::Read;
+    };
+
+    std::atomic<bool>        active;
+    std::mutex               mutex;
+    std::condition_variable  writerWake;
+    std::condition_variable  callerWake;
+    std::thread              writer;
+
+    DynamicArray<uint8_t, 1> pending;
+    FILE*                    file     = nullptr;
+    bool                     stopping = false;
+
+    DynamicArray<Resource, 1> resources[kNumResourceTypes];
+
+    SGFX_FORCE_INLINE Resource* findResource(ResourceType type, uint32_t value)
+    {
+        size_t index = value & HandleTable<uint32_t>::kIndexMask;
+        if (value == 0 || index >= resources[type].GetSize() || resources[type][index].value != value)
+            return nullptr;
+        return &resources[type][index];
+    }
+
+    void run()
+    {
+        DynamicArray<uint8_t, 1> chunk;
+        bool                     failed = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            writerWake.wait_for(lock, std::chrono::milliseconds(kFlushInterval), [this] {
+                return stopping || pending.GetSize() >= kFlushSize;
+            });
+
+            if (pending.IsEmpty()) {
+                if (stopping)
+                    break;
+                continue;
+            }
+
+            chunk = static_cast<DynamicArray<uint8_t, 1>&&>(pending);
+            lock.unlock();
+            callerWake.notify_all();
+
+            // the rest of the capture is dropped after an I/O error, the trace ends at a record
+            if (!failed && fwrite(chunk.GetData(), 1, chunk.GetSize(), file) != chunk.GetSize())
+                failed = true;
+            chunk.Clear();
+
+            lock.lock();
+        }
+    }
+
+public:
+
+    CaptureWriter()
+    {
+        active.store(false, std::memory_order_relaxed);
+    }
+
+    static SGFX_FORCE_INLINE Thread& getThread()
+    {
+        static thread_local Thread thread;
+        return thread;
+    }
+
+    SGFX_FORCE_INLINE bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    bool start(const char* path, uint32_t backBufferWidth, uint32_t backBufferHeight)
+    {
+        if (isActive())
+            return false;
+
+        file = fopen(path, "wb");
+        if (file == nullptr)
+            return false;
+
+        capture::FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, capture::kMagic, sizeof(header.magic));
+        header.version          = capture::kVersion;
+        header.headerSize       = sizeof(header);
+        header.backBufferWidth  = backBufferWidth;
+        header.backBufferHeight = backBufferHeight;
+
+        if (fwrite(&header, sizeof(header), 1, file) != 1) {
+            fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        stopping = false;
+        writer   = std::thread(&CaptureWriter::run, this);
+        active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // calls still in flight on other threads are dropped
+    void stop()
+    {
+        if (!isActive())
+            return;
+
+        active.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        writerWake.notify_one();
+        callerWake.notify_all();
+        writer.join();
+
+        fclose(file);
+        file = nullptr;
+
+        pending.Purge();
+        for (uint32_t i = 0; i < kNumResourceTypes; ++i)
+            resources[i].Purge();
+    }
+
+    // record is a RecordHeader and its data, padded to 8 bytes
+    void commit(const DynamicArray<uint8_t, 1>& record)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        callerWake.wait(lock, [this] { return stopping || pending.GetSize() < kMaxPendingSize; });
+        if (stopping)
+            return;
+
+        size_t offset = pending.GetSize();
+        pending.Resize(offset + record.GetSize());
+        std::memcpy(pending.GetData() + offset, record.GetData(), record.GetSize());
+
+        if (offset < kFlushSize && pending.GetSize() >= kFlushSize)
+            writerWake.notify_one();
+    }
+
+    void trackResource(ResourceType type, uint32_t value, size_t size, DataFormat format)
+    {
+        if (value == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t index = value & HandleTable<uint32_t>::kIndexMask;
+        if (index >= resources[type].GetSize())
+            resources[type].Resize(index + 1);
+
+        Resource& resource = resources[type][index];
+        resource        = Resource();
+        resource.value  = value;
+        resource.size   = size;
+        resource.format = format;
+    }
+
+    void trackMap(ResourceType type, uint32_t value, void* mapped, MapType mapType)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Resource* resource = findResource(type, value)) {
+            resource->mapped  = mapped;
+            resource->mapType = mapType;
+        }
+    }
+
+    // what the CPU wrote into a buffer since it was mapped, nothing for reads and textures
+    CaptureData takeMapped(ResourceType type, uint32_t value)
+    {
+        CaptureData data = { nullptr, 0 };
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Resource* resource = findResource(type, value)) {
+            if (type == Buffer && resource->mapped != nullptr && resource->mapType != MapType::Read) {
+                data.data = resource->mapped;
+                data.size = resource->size;
+            }
+            resource->mapped = nullptr;
+        }
+        return data;
+    }
+
+    // 0 for resources created before the capture started
+    size_t getSize(ResourceType type, uint32_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Resource* resource = findResource(type, value);
+        return (resource != nullptr) ? resource->size : 0;
+    }
+
+    DataFormat getFormat(ResourceType type, uint32_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Resource* resource = findResource(type, value);
+        return (resource != nullptr) ? resource->format : DataFormat::RGBA8;
+    }
+};
+
+// records the call it is declared in, see SGFX_CAPTURE
+// the first handle argument is the object the call works on, the first data argument tells the
+// size of a buffer it creates
+class CaptureScope final
+{
+    CaptureWriter*            writer   = nullptr; // nullptr while nothing is captured
+    CaptureWriter::Thread*    thread   = nullptr;
+    DynamicArray<uint8_t, 1>* record   = nullptr; // nullptr for calls that are not recorded
+    bool                      isNested = false;
+
+    capture::Op               op         = capture::Op::Flush;
+    uint32_t                  subject    = 0;
+    size_t                    dataSize   = 0;
+    DataFormat                format     = DataFormat::RGBA8;
+    MapType                   mapType    = MapType::Read;
+    bool                      hasSubject = false;
+    bool                      hasData    = false;
+
+    SGFX_FORCE_INLINE void append(const void* data, size_t size)
+    {
+        size_t offset = record->GetSize();
+        record->Resize(offset + size);
+        std::memcpy(record->GetData() + offset, data, size);
+    }
+
+    inline void appendData(const void* data, size_t size)
+    {
+        uint64_t recordedSize = (data != nullptr) ? static_cast<uint64_t>(size) : capture::kNullData;
+        append(&recordedSize, sizeof(recordedSize));
+        if (data != nullptr)
+            append(data, size);
+    }
+
+    inline void appendString(const char* string)
+    {
+        uint32_t length = (string != nullptr) ? static_cast<uint32_t>(std::strlen(string)) : 0;
+        append(&length, sizeof(length));
+        append(string, length);
+    }
+
+    template <typename T>
+    SGFX_FORCE_INLINE void put(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "captured arguments are numbers, enums, handles or data");
+        if (record != nullptr)
+            append(&value, sizeof(value));
+    }
+
+    SGFX_FORCE_INLINE void put(DataFormat value)
+    {
+        format = value;
+        if (record != nullptr)
+            append(&value, sizeof(value));
+    }
+
+    SGFX_FORCE_INLINE void put(MapType value)
+    {
+        mapType = value;
+        if (record != nullptr)
+            append(&value, sizeof(value));
+    }
+
+    template <typename T, int tag>
+    SGFX_FORCE_INLINE void put(const Handle<T, tag>& handle)
+    {
+        if (!hasSubject) {
+            subject    = handle.value;
+            hasSubject = true;
+        }
+        if (record != nullptr)
+            append(&handle.value, sizeof(handle.value));
+    }
+
+    SGFX_FORCE_INLINE void put(const CaptureData& data)
+    {
+        if (!hasData) {
+            dataSize = data.size;
+            hasData  = true;
+        }
+        if (record != nullptr)
+            appendData(data.data, data.size);
+    }
+
+    inline void put(const CaptureTextureData& texture)
+    {
+        if (record == nullptr)
+            return;
+
+        size_t size = 0;
+        if (texture.data != nullptr && texture.sizeX > 0 && texture.sizeY > 0 && texture.sizeZ > 0) {
+            DataFormat textureFormat = writer->getFormat(CaptureWriter::Texture, subject);
+            uint32_t   blockSize     = getFormatBlockSize(textureFormat);
+
+            // the layout updateTexture() reads, 0 pitches are the tightly packed ones
+            size_t rowSize    = getFormatRowPitch(textureFormat, static_cast<uint32_t>(texture.sizeX));
+            size_t numRows    = (texture.sizeY + blockSize - 1) / blockSize;
+            size_t rowPitch   = (texture.rowPitch != 0) ? texture.rowPitch : rowSize;
+            size_t depthPitch = (texture.depthPitch != 0) ? texture.depthPitch : rowPitch * numRows;
+
+            size = (texture.sizeZ - 1) * depthPitch + (numRows - 1) * rowPitch + rowSize;
+        }
+        appendData(texture.data, size);
+    }
+
+    inline void put(const CaptureConstantData& constants)
+    {
+        if (record == nullptr)
+            return;
+
+        // constant buffers created before the capture started have no known size
+        size_t size = writer->getSize(CaptureWriter::ConstantBuffer, subject);
+        appendData((size != 0) ? constants.data : nullptr, size);
+    }
+
+    inline void put(const CaptureBundleMask& mask)
+    {
+        if (record == nullptr)
+            return;
+
+        size_t size = (static_cast<size_t>(getNumDrawCalls(mask.bundle)) + 63) / 64 * sizeof(uint64_t);
+        appendData(mask.mask, size);
+    }
+
+    inline void put(const CaptureWideString& string)
+    {
+        if (record == nullptr)
+            return;
+
+        uint32_t length = (string.string != nullptr) ? static_cast<uint32_t>(wcslen(string.string)) : 0;
+        append(&length, sizeof(length));
+        for (uint32_t i = 0; i < length; ++i) {
+            uint32_t code = static_cast<uint32_t>(string.string[i]);
+            append(&code, sizeof(code));
+        }
+    }
+
+    inline void put(const CaptureVertexElements& elements)
+    {
+        if (record == nullptr)
+            return;
+
+        uint64_t count = (elements.elements != nullptr) ? static_cast<uint64_t>(elements.count) : 0;
+        append(&count, sizeof(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            const VertexElementDescriptor& element = elements.elements[i];
+            uint8_t perInstanceData = element.perInstanceData ? 1 : 0;
+
+            appendString(element.semanticName);
+            append(&element.semanticIndex, sizeof(element.semanticIndex));
+            append(&element.format,        sizeof(element.format));
+            append(&element.slot,          sizeof(element.slot));
+            append(&element.offset,        sizeof(element.offset));
+            append(&perInstanceData,       sizeof(perInstanceData));
+        }
+    }
+
+    template <typename T, int tag>
+    inline void putResult(const Handle<T, tag>& handle)
+    {
+        if (record != nullptr)
+            append(&handle.value, sizeof(handle.value));
+
+        // nested calls are tracked as well, transient rings, heaps and constant pages create buffers
+        switch (op) {
+        case capture::Op::CreateBuffer:         { writer->trackResource(CaptureWriter::Buffer,         handle.value, dataSize, format); } break;
+        case capture::Op::CreateConstantBuffer: { writer->trackResource(CaptureWriter::ConstantBuffer, handle.value, dataSize, format); } break;
+        case capture::Op::CreateTexture1D:
+        case capture::Op::CreateTexture2D:
+        case capture::Op::CreateTexture3D:      { writer->trackResource(CaptureWriter::Texture,        handle.value, 0,        format); } break;
+        default: break;
+        }
+    }
+
+    inline void putResult(void* pointer)
+    {
+        uint8_t isValid = (pointer != nullptr) ? 1 : 0;
+        if (record != nullptr)
+            append(&isValid, sizeof(isValid));
+
+        if (op == capture::Op::MapBuffer)
+            writer->trackMap(CaptureWriter::Buffer, subject, pointer, mapType);
+    }
+
+    SGFX_FORCE_INLINE void putResult(std::nullptr_t)
+    {
+        putResult(static_cast<void*>(nullptr));
+    }
+
+    template <typename T>
+    inline void putResult(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "captured results are numbers, handles or plain structs");
+        if (record != nullptr)
+            append(&value, sizeof(value));
+    }
+
+public:
+
+    enum NestedTag { Nested };
+
+    SGFX_FORCE_INLINE CaptureScope()
+    {
+        CaptureWriter& captureWriter = getCaptureWriter();
+        if (captureWriter.isActive()) {
+            writer = &captureWriter;
+            thread = &CaptureWriter::getThread();
+            if (thread->depth++ == 0)
+                record = &thread->record;
+        }
+    }
+
+    // a record sgfx writes inside a call it makes (the transient data submit uploads)
+    SGFX_FORCE_INLINE explicit CaptureScope(NestedTag)
+        : isNested(true)
+    {
+        CaptureWriter& captureWriter = getCaptureWriter();
+        if (captureWriter.isActive()) {
+            writer = &captureWriter;
+            thread = &CaptureWriter::getThread();
+            record = &thread->nestedRecord;
+        }
+    }
+
+    SGFX_FORCE_INLINE ~CaptureScope()
+    {
+        if (writer == nullptr)
+            return;
+
+        if (!isNested)
+            thread->depth--;
+
+        if (record != nullptr) {
+            static const uint8_t padding[8] = { 0 };
+            append(padding, (8 - record->GetSize() % 8) % 8);
+
+            capture::RecordHeader header;
+            header.op    = static_cast<uint16_t>(op);
+            header.flags = 0;
+            header.size  = static_cast<uint32_t>(record->GetSize() - sizeof(header));
+            std::memcpy(record->GetData(), &header, sizeof(header));
+
+            writer->commit(*record);
+        }
+    }
+
+    SGFX_FORCE_INLINE bool isActive() const { return writer != nullptr; }
+
+    template <typename ...Args>
+    inline void write(capture::Op callOp, const Args&... args)
+    {
+        op = callOp;
+        if (record != nullptr)
+            record->Resize(sizeof(capture::RecordHeader));
+
+        int expand[] = { 0, (put(args), 0)... };
+        (void)expand;
+
+        if (record != nullptr && (op == capture::Op::UnmapBuffer || op == capture::Op::UnmapTexture)) {
+            CaptureData mapped = writer->takeMapped(
+                (op == capture::Op::UnmapBuffer) ? CaptureWriter::Buffer : CaptureWriter::Texture,
+                subject
+            );
+            appendData(mapped.data, mapped.size);
+        }
+    }
+
+    template <typename T>
+    SGFX_FORCE_INLINE T result(const T& value)
+    {
+        if (writer != nullptr)
+            putResult(value);
+        return value;
+    }
+};
+
+// SGFX_CAPTURE(Op, arguments...) at the top of a public function records the call, arguments
+// passed by pointer are wrapped into the Capture* structs above; functions with a result return
+// SGFX_CAPTURE_RESULT(result), SGFX_CAPTURE_NESTED records inside a call
+#if SGFX_ENABLE_CAPTURE
+#   define SGFX_CAPTURE(...)        SGFX_NS_INTERNAL::CaptureScope captureScope; if (captureScope.isActive()) captureScope.write(sgfx::capture::Op::__VA_ARGS__)
+#   define SGFX_CAPTURE_RESULT(x)   captureScope.result(x)
+#   define SGFX_CAPTURE_NESTED(...) do { SGFX_NS_INTERNAL::CaptureScope captureScope(SGFX_NS_INTERNAL::CaptureScope::Nested); if (captureScope.isActive()) captureScope.write(sgfx::capture::Op::__VA_ARGS__); } while (0)
+#else
+#   define SGFX_CAPTURE(...)        ((void)0)
+#   define SGFX_CAPTURE_RESULT(x)   (x)
+#   define SGFX_CAPTURE_NESTED(...) ((void)0)
+#endif
+
+// returns the index of the lowest set bit, mask must not be zero
+SGFX_FORCE_INLINE uint32_t bitScanForward(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+}
+
+// returns the index of the highest set bit, mask must not be zero
+SGFX_FORCE_INLINE uint32_t bitScanReverse(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(63 - __builtin_clzll(mask));
+#endif
+}
+
+// stable LSD radix sort of items with a uint64_t key member, 8 bits per pass
+// items and temp both hold count items, returns the one that ends up sorted
+// passes where all items share the same digit are skipped
+template <typename T>
+inline T* radixSortByKey(T* items, T* temp, size_t count)
+{
+    enum { kNumPasses = 8, kNumBuckets = 256 };
+
+    size_t histograms[kNumPasses][kNumBuckets];
+    std::memset(histograms, 0, sizeof(histograms));
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t key = items[i].key;
+        for (uint32_t pass = 0; pass < kNumPasses; ++pass)
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    T* src = items;
+    T* dst = temp;
+
+    for (uint32_t pass = 0; pass < kNumPasses; ++pass) {
+        size_t* histogram = histograms[pass];
+        if (count == 0 || histogram[(src[0].key >> (pass * 8)) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (uint32_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+            size_t bucketSize = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            dst[histogram[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+
+        T* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    return src;
+}
+
+///
+/// ShadowBindings mirrors one class of device binding slots (constant buffers, shader resources,
+/// samplers) so that backends only talk to the device about slots that actually changed.
+///
+/// set() compares against the shadow copy and marks changed slots dirty. flush() hands the dirty
+/// slots to a backend emitter as contiguous ranges, emitter(first, count, values + first), so
+/// neighbouring changes become a single range bind. Slots are found by scanning bitmasks, a draw
+/// that changes nothing costs the same whatever the number of slots.
+///
+/// setUsedSlots() narrows the tracked slots to the ones a shader reads, set() ignores the rest so
+/// they are never bound and never need to be unbound.
+///
+/// T is a native object or name, T() means unbound.
+///
+template <typename T, uint32_t kNumSlots>
+class ShadowBindings final
+{
+public:
+
+    enum
+    {
+        kNumWords = (kNumSlots + 63) / 64
+    };
+
+private:
+
+    T        values[kNumSlots];
+    uint64_t dirtyMask[kNumWords]; // changed since the last flush
+    uint64_t boundMask[kNumWords]; // holding something other than T()
+    uint64_t usedMask[kNumWords];  // read by the shader, all slots unless told otherwise
+
+public:
+
+    SGFX_FORCE_INLINE ShadowBindings()
+    {
+        std::memset(usedMask, 0xFF, sizeof(usedMask));
+        reset();
+    }
+
+    // forgets the shadow copy (but not the used slots), the device is assumed to have nothing bound
+    inline void reset()
+    {
+        for (uint32_t i = 0; i < kNumSlots; ++i)
+            values[i] = T();
+
+        std::memset(dirtyMask, 0, sizeof(dirtyMask));
+        std::memset(boundMask, 0, sizeof(boundMask));
+    }
+
+    // usedSlots is kNumWords words, the shadow copy must not hold anything yet
+    SGFX_FORCE_INLINE void setUsedSlots(const uint64_t* usedSlots)
+    {
+        for (uint32_t word = 0; word < kNumWords; ++word)
+            usedMask[word] = usedSlots[word];
+    }
+
+    SGFX_FORCE_INLINE const uint64_t* getUsedSlots() const
+    {
+        return usedMask;
+    }
+
+    SGFX_FORCE_INLINE T get(uint32_t slot) const
+    {
+        return values[slot];
+    }
+
+    SGFX_FORCE_INLINE bool isDirty() const
+    {
+        for (uint32_t word = 0; word < kNumWords; ++word) {
+            if (dirtyMask[word] != 0)
+                return true;
+        }
+        return false;
+    }
+
+    SGFX_FORCE_INLINE void set(uint32_t slot, T value)
+    {
+        uint64_t bit = 1ull << (slot % 64);
+        if ((usedMask[slot / 64] & bit) == 0)
+            return;
+        if (values[slot] == value) {
+            if (value != T())
+                SGFX_STAT(numRedundantBinds, 1);
+            return;
+        }
+
+        values[slot] = value;
+        dirtyMask[slot / 64] |= bit;
+
+        if (value != T())
+            boundMask[slot / 64] |= bit;
+        else
+            boundMask[slot / 64] &= ~bit;
+    }
+
+    // records a binding the backend made on its own (a buffer bound at an offset), flush() leaves
+    // the slot alone until it changes again
+    SGFX_FORCE_INLINE void assume(uint32_t slot, T value)
+    {
+        uint64_t bit = 1ull << (slot % 64);
+        if ((usedMask[slot / 64] & bit) == 0)
+            return;
+
+        values[slot] = value;
+        dirtyMask[slot / 64] &= ~bit;
+
+        if (value != T())
+            boundMask[slot / 64] |= bit;
+        else
+            boundMask[slot / 64] &= ~bit;
+    }
+
+    // the device binding of the slot no longer matches the shadow copy, flush() binds it again
+    SGFX_FORCE_INLINE void invalidate(uint32_t slot)
+    {
+        uint64_t bit = 1ull << (slot % 64);
+        dirtyMask[slot / 64] |= usedMask[slot / 64] & bit;
+    }
+
+    // unbinds every bound slot outside of keepMask (kNumWords words)
+    SGFX_FORCE_INLINE void unbindExcept(const uint64_t* keepMask)
+    {
+        for (uint32_t word = 0; word < kNumWords; ++word) {
+            uint64_t unbindMask = boundMask[word] & ~keepMask[word];
+            while (unbindMask != 0) {
+                values[word * 64 + bitScanForward(unbindMask)] = T();
+                unbindMask &= unbindMask - 1;
+            }
+
+            dirtyMask[word] |= boundMask[word] & ~keepMask[word];
+            boundMask[word] &= keepMask[word];
+        }
+    }
+
+    SGFX_FORCE_INLINE void unbindAll()
+    {
+        const uint64_t keepMask[kNumWords] = { 0 };
+        unbindExcept(keepMask);
+    }
+
+    // emits the dirty slots as contiguous ranges, returns the number of ranges
+    template <typename Emitter>
+    inline uint32_t flush(Emitter& emitter)
+    {
+        uint32_t numRanges  = 0;
+        uint32_t rangeFirst = 0;
+        uint32_t rangeCount = 0;
+
+        for (uint32_t word = 0; word < kNumWords; ++word) {
+            uint64_t bits = dirtyMask[word];
+            dirtyMask[word] = 0;
+
+            while (bits != 0) {
+                uint32_t first = bitScanForward(bits);
+                uint64_t rest  = ~(bits >> first); // the run ends at the first zero
+                uint32_t count = (rest != 0) ? bitScanForward(rest) : 64 - first;
+
+                bits = (first + count < 64) ? bits & (~0ull << (first + count)) : 0;
+
+                // runs touching a word boundary continue in the next word
+                uint32_t slot = word * 64 + first;
+                if (rangeCount != 0 && rangeFirst + rangeCount == slot) {
+                    rangeCount += count;
+                    continue;
+                }
+
+                if (rangeCount != 0) {
+                    emitter(rangeFirst, rangeCount, values + rangeFirst);
+                    numRanges++;
+                    SGFX_STAT(numBoundSlots, rangeCount);
+                }
+
+                rangeFirst = slot;
+                rangeCount = count;
+            }
+        }
+
+        if (rangeCount != 0) {
+            emitter(rangeFirst, rangeCount, values + rangeFirst);
+            numRanges++;
+            SGFX_STAT(numBoundSlots, rangeCount);
+        }
+
+        SGFX_STAT(numBindCalls, numRanges);
+        return numRanges;
+    }
+};
+
+// binding layout helpers, a layout stored by a backend is never null, see getFullBindingLayout()
+enum class BindingClass : uint32_t
+{
+    ConstantBuffers,
+    Samplers,
+    ShaderResources
+};
+
+SGFX_FORCE_INLINE const uint64_t* getLayoutSlots(const StageBindingLayout& layout, BindingClass bindingClass)
+{
+    switch (bindingClass) {
+    case BindingClass::ConstantBuffers: return &layout.constantBuffers;
+    case BindingClass::Samplers:        return &layout.samplers;
+    default:                            return layout.shaderResources;
+    }
+}
+
+// the layout of a shader that did not declare one, every slot may be read
+SGFX_FORCE_INLINE StageBindingLayout getFullBindingLayout()
+{
+    StageBindingLayout layout;
+    layout.constantBuffers    = ~0ull;
+    layout.samplers           = ~0ull;
+    layout.shaderResources[0] = ~0ull;
+    layout.shaderResources[1] = ~0ull;
+    return layout;
+}
+
+SGFX_FORCE_INLINE void mergeBindingLayout(StageBindingLayout& dest, const StageBindingLayout& source)
+{
+    dest.constantBuffers    |= source.constantBuffers;
+    dest.samplers           |= source.samplers;
+    dest.shaderResources[0] |= source.shaderResources[0];
+    dest.shaderResources[1] |= source.shaderResources[1];
+}
+
+// narrows [first, first + count) to the span between its first and last used slot
+// returns false if no slot of the range is used, unused slots inside the span are passed along
+SGFX_FORCE_INLINE bool trimRange(const uint64_t* usedMask, uint32_t first, uint32_t count, uint32_t& outFirst, uint32_t& outCount)
+{
+    uint32_t end  = first + count;
+    uint32_t low  = end;
+    uint32_t high = 0;
+
+    for (uint32_t word = first / 64; word * 64 < end; ++word) {
+        uint32_t wordFirst = word * 64;
+        uint64_t bits      = usedMask[word];
+
+        if (first > wordFirst)
+            bits &= ~0ull << (first - wordFirst);
+        if (end < wordFirst + 64)
+            bits &= (1ull << (end - wordFirst)) - 1;
+
+        if (bits != 0) {
+            if (low == end)
+                low = wordFirst + bitScanForward(bits);
+            high = wordFirst + bitScanReverse(bits);
+        }
+    }
+
+    if (low == end)
+        return false;
+
+    outFirst = low;
+    outCount = high - low + 1;
+    return true;
+}
+
+// emulated draw queues for pre-DX12 APIs (DX11 and GL4)
+struct ShaderResource final
+{
+    bool     isTexture = false;
+    uint32_t value     = 0;
+
+    inline ShaderResource() {}
+    inline ShaderResource(bool texture, uint32_t newHandle)
+        : isTexture(texture), value(newHandle)
+    {}
+};
+
+///
+/// DrawCall is the full binding state of a single draw as seen by the backends.
+///
+/// DrawQueue does not store DrawCalls, it records a packed command stream instead and
+/// DrawCallStream decodes it back into a DrawCall one draw at a time.
+///
+struct DrawCall final
+{
+    enum Type : uint32_t
+    {
+        Draw                            = 0,
+        DrawIndexed                     = 1,
+        DrawInstanced                   = 2,
+        DrawIndexedInstanced            = 3,
+
+        DrawInstancedIndirect           = 4,
+        DrawIndexedInstancedIndirect    = 5
+    };
+
+    enum
+    {
+        kMaxConstantBuffers     = 8,
+        kMaxShaderResources     = 128,
+        kMaxVertexBuffers       = 16,
+
+        // bytes, inline constants are padded to 16 bytes, backends stream them into windows of
+        // kMaxInlineConstantsSize at kInlineConstantsAlign offsets and bind the whole window
+        kMaxInlineConstantsSize = 256,
+        kInlineConstantsAlign   = 256
+    };
+
+    ConstantBufferHandle    constantBuffers[kMaxConstantBuffers];
+    ShaderResource          shaderResources[kMaxShaderResources];
+
+    // bytes, the range of constantBuffers[slot] that is bound, size 0 binds the whole buffer
+    uint32_t                constantBufferOffsets[kMaxConstantBuffers];
+    uint32_t                constantBufferSizes[kMaxConstantBuffers];
+
+    // inline constants, a slot in inlineConstantMask reads them instead of constantBuffers[slot]
+    // the data lives in the command stream, pointers stay valid until the queue is cleared
+    const uint32_t*         inlineConstants[kMaxConstantBuffers];
+    uint32_t                inlineConstantsSize[kMaxConstantBuffers]; // bytes
+    uint32_t                inlineConstantMask;
+
+    BufferHandle      vertexBuffers[kMaxVertexBuffers];
+    BufferHandle      indexBuffer;
+    uint32_t          vertexBufferOffsets[kMaxVertexBuffers]; // bytes
+    uint32_t          indexBufferOffset;
+    IndexFormat       indexFormat;
+    BufferHandle      indirectArgsBuffer;
+    size_t            indirectArgsOffset;
+    PrimitiveTopology primitiveTopology;
+
+    uint32_t instanceCount;
+    uint32_t count;
+    uint32_t startVertex;
+    uint32_t startIndex;
+    uint32_t startInstance;
+    Type     type;
+
+    // resource table bound at resourceTableSlot, shaderResources that are set take precedence
+    ResourceTableHandle resourceTable;
+    uint32_t            resourceTableSlot;
+
+    // slots that may hold a binding, all other slots are unbound and do not need to be looked at
+    uint32_t vertexBufferMask;
+    uint32_t constantBufferMask;
+    uint64_t shaderResourceMask[2];
+};
+
+///
+/// ResourceTable is the backend independent part of a resource table, the resources it binds to
+/// consecutive slots. Backends keep the resolved native views next to it, so binding a table
+/// costs no handle lookups.
+///
+struct ResourceTable final
+{
+    enum
+    {
+        kMaxResources = 32
+    };
+
+    ShaderResource resources[kMaxResources];
+    uint32_t       numResources = 0;
+
+    // false if there are too many entries
+    inline bool init(const ResourceTableEntry* entries, uint32_t numEntries)
+    {
+        if (numEntries > kMaxResources)
+            return false;
+
+        for (uint32_t i = 0; i < numEntries; ++i) {
+            bool isTexture = entries[i].texture.value != 0;
+            resources[i] = ShaderResource(isTexture, isTexture ? entries[i].texture.value : entries[i].buffer.value);
+        }
+
+        numResources = numEntries;
+        return true;
+    }
+
+    // number of slots the table covers when bound at firstSlot
+    SGFX_FORCE_INLINE uint32_t getNumSlots(uint32_t firstSlot) const
+    {
+        if (firstSlot + numResources <= DrawCall::kMaxShaderResources)
+            return numResources;
+        return (firstSlot < DrawCall::kMaxShaderResources) ? DrawCall::kMaxShaderResources - firstSlot : 0;
+    }
+};
+
+// sets the bits of [first, first + count) in a multi-word slot mask
+SGFX_FORCE_INLINE void addSlotRange(uint64_t* mask, uint32_t first, uint32_t count)
+{
+    uint32_t end = first + count;
+
+    for (uint32_t word = first / 64; word * 64 < end; ++word) {
+        uint32_t wordFirst = word * 64;
+        uint64_t bits      = ~0ull;
+
+        if (first > wordFirst)
+            bits &= ~0ull << (first - wordFirst);
+        if (end < wordFirst + 64)
+            bits &= (1ull << (end - wordFirst)) - 1;
+
+        mask[word] |= bits;
+    }
+}
+
+// true if the draw binds a constant buffer or shader resource the layout does not read
+inline bool hasUnusedBinds(const DrawCall& call, const StageBindingLayout& layout)
+{
+    if ((call.inlineConstantMask & ~layout.constantBuffers) != 0)
+        return true;
+
+    uint64_t mask = call.constantBufferMask & ~layout.constantBuffers;
+    for (; mask != 0; mask &= mask - 1) {
+        if (call.constantBuffers[bitScanForward(mask)].value != 0)
+            return true;
+    }
+
+    for (uint32_t word = 0; word < 2; ++word) {
+        mask = call.shaderResourceMask[word] & ~layout.shaderResources[word];
+        for (; mask != 0; mask &= mask - 1) {
+            if (call.shaderResources[word * 64 + bitScanForward(mask)].value != 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+// inline constants are stored as whole 16 byte registers
+SGFX_FORCE_INLINE uint32_t getInlineConstantsWords(size_t size)
+{
+    return static_cast<uint32_t>((size + 15) / 16 * 4);
+}
+
+///
+/// StreamRing suballocates a fixed size GPU buffer front to back, for data the CPU writes once and
+/// the GPU reads shortly after (inline constants). A range that does not fit into the rest of the
+/// buffer starts the ring over at offset 0 and allocate() reports it: the backend orphans the
+/// buffer then (D3D11 WRITE_DISCARD, GL buffer invalidation) instead of waiting for the GPU, and
+/// writes every other range without synchronization (D3D11 WRITE_NO_OVERWRITE, GL unsynchronized
+/// mapping). Ranges handed out before the ring started over must not be bound again.
+///
+struct StreamRing final
+{
+    size_t   capacity = 0;
+    size_t   offset   = 0;
+    uint32_t numWraps = 0;
+
+    // size must not exceed capacity, returns true if the ring started over
+    SGFX_FORCE_INLINE bool allocate(size_t size, size_t alignment, size_t& outOffset)
+    {
+        size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        bool   wraps   = aligned + size > capacity;
+        if (wraps) {
+            aligned = 0;
+            numWraps++;
+        }
+
+        outOffset = aligned;
+        offset    = aligned + size;
+        return wraps;
+    }
+};
+
+///
+/// ConstantBlockAllocator hands out constant blocks for createConstantAllocator().
+///
+/// Blocks are sized in multiples of kBlockAlign bytes. A page is carved front to back, the part
+/// of a page that is too small for the next block and every freed block go to a free list per
+/// size, so objects of the same kind keep reusing each other's blocks and nothing is ever merged.
+/// Pages are constant buffers created through the public API and live as long as the allocator.
+/// When packBlocks is false the pages are exactly one block large (no offset binds).
+///
+class ConstantBlockAllocator final
+{
+public:
+
+    enum : uint32_t
+    {
+        kBlockAlign   = 256,
+        kMaxBlockSize = 65536, // 4096 constants, the most a constant buffer bind can cover
+        kNumSizes     = kMaxBlockSize / kBlockAlign
+    };
+
+private:
+
+    struct FreeBlock
+    {
+        ConstantBufferHandle buffer;
+        uint32_t             offset;
+        uint32_t             next; // index + 1 of the next free block of the same size, 0 ends the list
+    };
+
+    DynamicArray<ConstantBufferHandle, 16, 64> pages;
+    DynamicArray<FreeBlock, 1, 256>            freeBlocks;
+
+    uint32_t             freeLists[kNumSizes + 1]; // by size in kBlockAlign units, index + 1 of the first block
+    uint32_t             unusedBlocks = 0;         // list of freeBlocks entries that can be reused
+
+    ConstantBufferHandle page;
+    uint32_t             pageOffset = 0;
+    uint32_t             pageSize;
+    bool                 packBlocks;
+
+    inline void addFreeBlock(ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+    {
+        uint32_t index = unusedBlocks;
+        if (index != 0) {
+            unusedBlocks = freeBlocks[index - 1].next;
+        } else {
+            freeBlocks.Add(FreeBlock());
+            index = static_cast<uint32_t>(freeBlocks.GetSize());
+        }
+
+        FreeBlock& block = freeBlocks[index - 1];
+        block.buffer = buffer;
+        block.offset = offset;
+        block.next   = freeLists[size / kBlockAlign];
+        freeLists[size / kBlockAlign] = index;
+    }
+
+    inline ConstantBufferHandle addPage(uint32_t size)
+    {
+        ConstantBufferHandle buffer = createConstantBuffer(nullptr, size);
+        if (buffer.value != 0)
+            pages.Add(buffer);
+        return buffer;
+    }
+
+public:
+
+    inline ConstantBlockAllocator(size_t newPageSize, bool newPackBlocks)
+    {
+        std::memset(freeLists, 0, sizeof(freeLists));
+
+        pageSize   = static_cast<uint32_t>((newPageSize + kBlockAlign - 1) & ~static_cast<size_t>(kBlockAlign - 1));
+        packBlocks = newPackBlocks;
+    }
+
+    inline ConstantBlock allocate(size_t size)
+    {
+        ConstantBlock block;
+        if (size == 0 || size > kMaxBlockSize)
+            return block;
+
+        uint32_t alignedSize = static_cast<uint32_t>((size + kBlockAlign - 1) & ~static_cast<size_t>(kBlockAlign - 1));
+        uint32_t index       = freeLists[alignedSize / kBlockAlign];
+
+        if (index != 0) {
+            FreeBlock& freeBlock = freeBlocks[index - 1];
+            freeLists[alignedSize / kBlockAlign] = freeBlock.next;
+
+            block.buffer = freeBlock.buffer;
+            block.offset = freeBlock.offset;
+            block.size   = alignedSize;
+
+            freeBlock.next = unusedBlocks;
+            unusedBlocks   = index;
+            return block;
+        }
+
+        if (packBlocks && alignedSize <= pageSize) {
+            if (page.value == 0 || pageOffset + alignedSize > pageSize) {
+                if (page.value != 0 && pageOffset < pageSize)
+                    addFreeBlock(page, pageOffset, pageSize - pageOffset);
+
+                page       = addPage(pageSize);
+                pageOffset = 0;
+                if (page.value == 0)
+                    return block;
+            }
+
+            block.buffer = page;
+            block.offset = pageOffset;
+            block.size   = alignedSize;
+
+            pageOffset += alignedSize;
+            return block;
+        }
+
+        // blocks larger than a page get a page of their own
+        block.buffer = addPage(alignedSize);
+        block.size   = (block.buffer.value != 0) ? alignedSize : 0;
+        return block;
+    }
+
+    inline void free(const ConstantBlock& block)
+    {
+        if (block.buffer.value != 0 && block.size != 0 && block.size <= kMaxBlockSize)
+            addFreeBlock(block.buffer, block.offset, block.size);
+    }
+
+    // releases the pages, the allocator must not be used afterwards
+    inline void releasePages()
+    {
+        for (ConstantBufferHandle& buffer : pages)
+            releaseConstantBuffer(buffer);
+
+        pages.Purge();
+        freeBlocks.Purge();
+    }
+};
+
+///
+/// BufferHeapAllocator suballocates the buffer of createBufferHeap() with a two-level segregated
+/// fit (TLSF) allocator.
+///
+/// Sizes and offsets are counted in units of the heap's stride (kDefaultUnit bytes without one),
+/// so every block of a structured buffer starts at an element. Free blocks are kept in one list
+/// per size class, the first level is the power of two below the size and the second level splits
+/// it into kNumSecondLevels ranges. A bitmap per level tells which lists hold blocks: allocate()
+/// rounds the size up to the next class and takes the head of the first list at or above it, and
+/// free() merges the block with free neighbours right away, so neither ever searches.
+///
+/// compact() slides the allocated blocks down over the free space in front of them with GPU
+/// copies. A buffer cannot be copied into itself on every backend, so the data goes through a
+/// scratch buffer. Blocks keep their id when they move and owners look up the new offset with
+/// getBlock().
+///
+class BufferHeapAllocator final
+{
+public:
+
+    enum : uint32_t
+    {
+        kDefaultUnit     = 16,      // bytes
+        kScratchSize     = 1 << 20, // bytes, compaction copies at most this much at a time
+        kMaxCapacity     = 1u << 30, // units
+
+        kSecondLevelBits = 4,
+        kNumSecondLevels = 1 << kSecondLevelBits,
+        kNumFirstLevels  = 32 - kSecondLevelBits + 1
+    };
+
+private:
+
+    enum : uint8_t
+    {
+        kUnused,
+        kFree,
+        kAllocated
+    };
+
+    struct Block
+    {
+        uint32_t offset;   // units
+        uint32_t size;     // units
+        uint32_t prev;     // neighbours by offset, index + 1, 0 ends the list
+        uint32_t next;
+        uint32_t prevFree; // list of the size class while free, nextFree also links unused entries
+        uint32_t nextFree;
+        uint8_t  state;
+    };
+
+    DynamicArray<Block, 1, 256> blocks;
+
+    uint32_t     firstLevelMap = 0;
+    uint32_t     secondLevelMaps[kNumFirstLevels];
+    uint32_t     freeLists[kNumFirstLevels][kNumSecondLevels]; // index + 1 of the first block
+    uint32_t     unusedBlocks  = 0;
+    uint32_t     firstBlock    = 0; // the block at offset 0
+
+    BufferHandle buffer;
+    BufferHandle scratch;
+    uint32_t     flags;
+    uint32_t     stride;
+    uint32_t     unit;     // bytes
+    uint32_t     capacity; // units
+    uint32_t     usedSize  = 0; // units
+    uint32_t     numBlocks = 0;
+    uint32_t     numFree   = 0;
+
+    static SGFX_FORCE_INLINE void mapSize(uint32_t size, uint32_t& fl, uint32_t& sl)
+    {
+        if (size < kNumSecondLevels) {
+            fl = 0;
+            sl = size;
+        } else {
+            uint32_t log2 = bitScanReverse(size);
+            fl = log2 - kSecondLevelBits + 1;
+            sl = (size >> (log2 - kSecondLevelBits)) - kNumSecondLevels;
+        }
+    }
+
+    inline uint32_t addEntry()
+    {
+        uint32_t id = unusedBlocks;
+        if (id != 0) {
+            unusedBlocks = blocks[id - 1].nextFree;
+        } else {
+            blocks.Add(Block());
+            id = static_cast<uint32_t>(blocks.GetSize());
+        }
+        return id;
+    }
+
+    inline void removeEntry(uint32_t id)
+    {
+        blocks[id - 1].state    = kUnused;
+        blocks[id - 1].nextFree = unusedBlocks;
+        unusedBlocks = id;
+    }
+
+    inline void insertFree(uint32_t id)
+    {
+        Block& block = blocks[id - 1];
+
+        uint32_t fl, sl;
+        mapSize(block.size, fl, sl);
+
+        block.state    = kFree;
+        block.prevFree = 0;
+        block.nextFree = freeLists[fl][sl];
+        if (block.nextFree != 0)
+            blocks[block.nextFree - 1].prevFree = id;
+
+        freeLists[fl][sl]    = id;
+        firstLevelMap       |= 1u << fl;
+        secondLevelMaps[fl] |= 1u << sl;
+        numFree++;
+    }
+
+    inline void removeFree(uint32_t id)
+    {
+        Block& block = blocks[id - 1];
+
+        uint32_t fl, sl;
+        mapSize(block.size, fl, sl);
+
+        if (block.prevFree != 0)
+            blocks[block.prevFree - 1].nextFree = block.nextFree;
+        else
+            freeLists[fl][sl] = block.nextFree;
+        if (block.nextFree != 0)
+            blocks[block.nextFree - 1].prevFree = block.prevFree;
+
+        if (freeLists[fl][sl] == 0) {
+            secondLevelMaps[fl] &= ~(1u << sl);
+            if (secondLevelMaps[fl] == 0)
+                firstLevelMap &= ~(1u << fl);
+        }
+        numFree--;
+    }
+
+    // a free block of at least size units, 0 if there is none
+    inline uint32_t findFree(uint32_t size) const
+    {
+        if (size >= kNumSecondLevels)
+            size += (1u << (bitScanReverse(size) - kSecondLevelBits)) - 1;
+
+        uint32_t fl, sl;
+        mapSize(size, fl, sl);
+        if (fl >= kNumFirstLevels)
+            return 0;
+
+        uint32_t slMap = secondLevelMaps[fl] & (~0u << sl);
+        if (slMap == 0) {
+            uint32_t flMap = (fl + 1 < kNumFirstLevels) ? (firstLevelMap & (~0u << (fl + 1))) : 0;
+            if (flMap == 0)
+                return 0;
+
+            fl    = bitScanForward(flMap);
+            slMap = secondLevelMaps[fl];
+        }
+        return freeLists[fl][bitScanForward(slMap)];
+    }
+
+    // merges the block with its free neighbours and puts the result in its free list
+    inline void addFree(uint32_t id)
+    {
+        uint32_t prev = blocks[id - 1].prev;
+        if (prev != 0 && blocks[prev - 1].state == kFree) {
+            removeFree(prev);
+            blocks[prev - 1].size += blocks[id - 1].size;
+            blocks[prev - 1].next  = blocks[id - 1].next;
+            if (blocks[id - 1].next != 0)
+                blocks[blocks[id - 1].next - 1].prev = prev;
+
+            removeEntry(id);
+            numBlocks--;
+            id = prev;
+        }
+
+        uint32_t next = blocks[id - 1].next;
+        if (next != 0 && blocks[next - 1].state == kFree) {
+            removeFree(next);
+            blocks[id - 1].size += blocks[next - 1].size;
+            blocks[id - 1].next  = blocks[next - 1].next;
+            if (blocks[next - 1].next != 0)
+                blocks[blocks[next - 1].next - 1].prev = id;
+
+            removeEntry(next);
+            numBlocks--;
+        }
+
+        insertFree(id);
+    }
+
+    // copies size units from src to dst through the scratch buffer, front to back so dst may
+    // overlap the part of src that is already copied
+    inline bool moveData(uint32_t dst, uint32_t src, uint32_t size)
+    {
+        uint32_t scratchSize = kScratchSize / unit;
+        if (scratchSize == 0)
+            scratchSize = 1;
+        if (scratchSize > capacity)
+            scratchSize = capacity;
+
+        if (scratch.value == 0) {
+            scratch = createBuffer(flags, nullptr, static_cast<size_t>(scratchSize) * unit, stride);
+            if (scratch.value == 0)
+                return false;
+        }
+
+        for (uint32_t done = 0; done < size; done += scratchSize) {
+            size_t bytes = static_cast<size_t>((size - done < scratchSize) ? size - done : scratchSize) * unit;
+            copyBufferRegion(scratch, 0, buffer, static_cast<size_t>(src + done) * unit, bytes);
+            copyBufferRegion(buffer, static_cast<size_t>(dst + done) * unit, scratch, 0, bytes);
+        }
+        return true;
+    }
+
+    inline BufferBlock makeBlock(uint32_t id) const
+    {
+        BufferBlock result;
+        result.buffer = buffer;
+        result.offset = blocks[id - 1].offset * unit;
+        result.size   = blocks[id - 1].size * unit;
+        result.id     = id;
+        return result;
+    }
+
+public:
+
+    // flags and stride are the ones of the buffer, size is rounded up to a whole stride
+    inline BufferHeapAllocator(uint32_t newFlags, size_t size, size_t newStride)
+    {
+        std::memset(secondLevelMaps, 0, sizeof(secondLevelMaps));
+        std::memset(freeLists, 0, sizeof(freeLists));
+
+        flags    = newFlags & ~(BufferFlags::CPURead | BufferFlags::CPUWrite);
+        stride   = static_cast<uint32_t>(newStride);
+        unit     = (stride != 0) ? stride : static_cast<uint32_t>(kDefaultUnit);
+        size_t numUnits = (size + unit - 1) / unit;
+        capacity = static_cast<uint32_t>((numUnits < kMaxCapacity) ? numUnits : static_cast<size_t>(kMaxCapacity));
+    }
+
+    // creates the buffer, false if that failed or the heap is empty
+    inline bool init()
+    {
+        if (capacity == 0)
+            return false;
+
+        buffer = createBuffer(flags, nullptr, static_cast<size_t>(capacity) * unit, stride);
+        if (buffer.value == 0)
+            return false;
+
+        firstBlock = addEntry();
+
+        Block& block = blocks[firstBlock - 1];
+        block.offset = 0;
+        block.size   = capacity;
+        block.prev   = 0;
+        block.next   = 0;
+
+        numBlocks = 1;
+        insertFree(firstBlock);
+        return true;
+    }
+
+    inline BufferBlock allocate(size_t size)
+    {
+        BufferBlock result;
+
+        size_t units = (size + unit - 1) / unit;
+        if (units == 0 || units > capacity)
+            return result;
+
+        uint32_t id = findFree(static_cast<uint32_t>(units));
+        if (id == 0)
+            return result;
+
+        removeFree(id);
+
+        // the rest of the block stays free
+        if (blocks[id - 1].size > units) {
+            uint32_t rest = addEntry();
+
+            Block& block = blocks[id - 1];
+            Block& split = blocks[rest - 1];
+            split.offset = block.offset + static_cast<uint32_t>(units);
+            split.size   = block.size - static_cast<uint32_t>(units);
+            split.prev   = id;
+            split.next   = block.next;
+            if (block.next != 0)
+                blocks[block.next - 1].prev = rest;
+
+            block.size = static_cast<uint32_t>(units);
+            block.next = rest;
+
+            numBlocks++;
+            insertFree(rest);
+        }
+
+        blocks[id - 1].state = kAllocated;
+        usedSize += static_cast<uint32_t>(units);
+        return makeBlock(id);
+    }
+
+    inline void free(uint32_t id)
+    {
+        if (id == 0 || id > blocks.GetSize() || blocks[id - 1].state != kAllocated)
+            return;
+
+        usedSize -= blocks[id - 1].size;
+        addFree(id);
+    }
+
+    // where the block is now, an invalid buffer if the id is not allocated
+    inline BufferBlock getBlock(uint32_t id) const
+    {
+        if (id == 0 || id > blocks.GetSize() || blocks[id - 1].state != kAllocated)
+            return BufferBlock();
+        return makeBlock(id);
+    }
+
+    // moves allocated blocks down into the free space before them until maxBytes were moved, the
+    // last block may go over, returns the bytes moved
+    inline size_t compact(size_t maxBytes)
+    {
+        size_t moved = 0;
+        uint32_t hole = firstBlock;
+
+        while (hole != 0 && moved < maxBytes) {
+            // the first free block followed by an allocated one, free blocks never touch
+            while (hole != 0 && blocks[hole - 1].state != kFree)
+                hole = blocks[hole - 1].next;
+            if (hole == 0 || blocks[hole - 1].next == 0)
+                break;
+
+            uint32_t id = blocks[hole - 1].next;
+            if (!moveData(blocks[hole - 1].offset, blocks[id - 1].offset, blocks[id - 1].size))
+                break;
+
+            // swap the two blocks, the hole may then merge with the free block after it
+            removeFree(hole);
+
+            Block& space = blocks[hole - 1];
+            Block& block = blocks[id - 1];
+
+            block.offset  = space.offset;
+            space.offset += block.size;
+
+            space.next = block.next;
+            block.prev = space.prev;
+            block.next = hole;
+            space.prev = id;
+
+            if (block.prev != 0)
+                blocks[block.prev - 1].next = id;
+            else
+                firstBlock = id;
+            if (space.next != 0)
+                blocks[space.next - 1].prev = hole;
+
+            moved += static_cast<size_t>(block.size) * unit;
+            addFree(hole);
+        }
+        return moved;
+    }
+
+    inline BufferHeapStats getStats() const
+    {
+        BufferHeapStats stats;
+        stats.capacity        = static_cast<size_t>(capacity) * unit;
+        stats.usedSize        = static_cast<size_t>(usedSize) * unit;
+        stats.largestFreeSize = 0;
+        stats.numBlocks       = numBlocks - numFree;
+        stats.numFreeBlocks   = numFree;
+
+        // the largest free block is in the highest list that holds any
+        if (firstLevelMap != 0) {
+            uint32_t fl = bitScanReverse(firstLevelMap);
+            uint32_t sl = bitScanReverse(secondLevelMaps[fl]);
+
+            for (uint32_t id = freeLists[fl][sl]; id != 0; id = blocks[id - 1].nextFree) {
+                size_t size = static_cast<size_t>(blocks[id - 1].size) * unit;
+                if (size > stats.largestFreeSize)
+                    stats.largestFreeSize = size;
+            }
+        }
+        return stats;
+    }
+
+    // releases the buffers, the allocator must not be used afterwards
+    inline void releaseBuffers()
+    {
+        releaseBuffer(buffer);
+        releaseBuffer(scratch);
+
+        blocks.Purge();
+    }
+};
+
+///
+/// TransientRing hands out the memory of allocateTransient(), ranges of one dynamic (CPUWrite)
+/// buffer that the CPU writes for a single frame.
+///
+/// Allocations point straight into the mapped buffer. The buffer is mapped by the first
+/// allocation after an unmap and stays mapped until unmap(), which backends call before they
+/// submit draws. Positions count the bytes handed out since the buffer was created, so the range
+/// a frame used is simply [frame start, head). An allocation never straddles the end of the buffer
+/// and is only made once the frame that last used the memory is kFramesInFlight presents old, so
+/// appending maps with WriteNoOverwrite and never waits for the GPU. A new buffer, or one that
+/// starts over while unmapped, is mapped with WriteDiscard instead, which lets the driver rename
+/// it rather than track what the frames in flight read. When the frames in flight leave no room
+/// the buffer is replaced by one twice as large and released once its last frame is that old, so
+/// a steady workload stops creating buffers after the first few frames.
+///
+class TransientRing final
+{
+public:
+
+    enum : uint32_t
+    {
+        kFramesInFlight = 3,
+        kMinCapacity    = 1 << 20 // bytes
+    };
+
+private:
+
+    struct Buffer
+    {
+        BufferHandle handle;
+        uint8_t*     mapped    = nullptr; // the whole buffer, between the first allocation and unmap()
+        size_t       capacity  = 0;
+        uint64_t     head      = 0; // bytes handed out
+        uint64_t     unmapped  = 0; // head at the last unmap
+        uint32_t     lastFrame = 0; // frame the buffer was last allocated from
+    };
+
+    Buffer               current;
+    DynamicArray<Buffer> retired; // replaced buffers, frames in flight may still read them
+
+    uint64_t             frameStarts[kFramesInFlight]; // head at the start of the last frames
+    uint32_t             frame = 0;
+
+    static inline void unmapBuffer(Buffer& buffer)
+    {
+        if (buffer.mapped == nullptr)
+            return;
+
+        // a capture gets what was written since the last unmap, the memory is only read back then
+        for (uint64_t position = buffer.unmapped; position < buffer.head;) {
+            size_t offset = static_cast<size_t>(position % buffer.capacity);
+            size_t size   = static_cast<size_t>(buffer.head - position);
+            if (size > buffer.capacity - offset)
+                size = buffer.capacity - offset;
+
+            SGFX_CAPTURE_NESTED(TransientData, buffer.handle, offset, CaptureData{ buffer.mapped + offset, size });
+            position += size;
+        }
+
+        sgfx::unmapBuffer(buffer.handle);
+        buffer.mapped   = nullptr;
+        buffer.unmapped = buffer.head;
+    }
+
+    static inline void destroyBuffer(Buffer& buffer)
+    {
+        unmapBuffer(buffer);
+        if (buffer.handle.value != 0)
+            releaseBuffer(buffer.handle);
+        buffer = Buffer();
+    }
+
+    // retires the current buffer and creates one with room for at least minCapacity bytes
+    inline bool grow(size_t minCapacity)
+    {
+        size_t capacity = (current.capacity != 0) ? current.capacity * 2 : static_cast<size_t>(kMinCapacity);
+        while (capacity < minCapacity)
+            capacity *= 2;
+
+        // a retired buffer stays mapped until the next unmap(), its allocations are still written
+        if (current.handle.value != 0) {
+            current.lastFrame = frame;
+            retired.Add(current);
+        }
+
+        current          = Buffer();
+        current.handle   = createBuffer(BufferFlags::VertexBuffer | BufferFlags::IndexBuffer | BufferFlags::CPUWrite, nullptr, capacity, 0);
+        current.capacity = capacity;
+
+        for (uint32_t i = 0; i < kFramesInFlight; ++i)
+            frameStarts[i] = 0;
+
+        return current.handle.value != 0;
+    }
+
+public:
+
+    inline TransientRing()
+    {
+        std::memset(frameStarts, 0, sizeof(frameStarts));
+    }
+
+    inline TransientAllocation allocate(size_t size, size_t alignment)
+    {
+        TransientAllocation allocation;
+        if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+            return allocation;
+
+        for (uint32_t attempt = 0; attempt < 2; ++attempt) {
+            if (current.capacity >= size + alignment) {
+                uint64_t start  = (current.head + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+                size_t   offset = static_cast<size_t>(start % current.capacity);
+                if (offset + size > current.capacity) {
+                    start += current.capacity - offset;
+                    offset = 0;
+                }
+
+                // the oldest frame in flight started at frameStarts[(frame + 1) % kFramesInFlight]
+                if (start + size - frameStarts[(frame + 1) % kFramesInFlight] <= current.capacity) {
+                    if (current.mapped == nullptr) {
+                        bool startsOver = current.head == 0 || start / current.capacity != (current.head - 1) / current.capacity;
+
+                        void* mapped = mapBuffer(current.handle, startsOver ? MapType::WriteDiscard : MapType::WriteNoOverwrite);
+                        if (mapped == nullptr)
+                            break;
+                        current.mapped = static_cast<uint8_t*>(mapped);
+                    }
+
+                    current.head = start + size;
+
+                    allocation.buffer = current.handle;
+                    allocation.offset = static_cast<uint32_t>(offset);
+                    allocation.cpuPtr = current.mapped + offset;
+                    return allocation;
+                }
+            }
+
+            if (attempt == 0 && !grow(size + alignment))
+                break;
+        }
+
+        return allocation;
+    }
+
+    // unmaps the buffers, the memory handed out so far becomes visible to the draws submitted next
+    inline void unmap()
+    {
+        for (Buffer& buffer : retired)
+            unmapBuffer(buffer);
+        unmapBuffer(current);
+    }
+
+    // called by present(), the memory of the oldest frame in flight is free again
+    inline void endFrame()
+    {
+        unmap();
+
+        frame++;
+        frameStarts[frame % kFramesInFlight] = current.head;
+
+        for (size_t i = 0; i < retired.GetSize();) {
+            if (frame - retired[i].lastFrame >= kFramesInFlight) {
+                destroyBuffer(retired[i]);
+                retired.RemoveSwap(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // releases the buffers, the ring can be used again afterwards
+    inline void release()
+    {
+        for (Buffer& buffer : retired)
+            destroyBuffer(buffer);
+        destroyBuffer(current);
+
+        retired.Purge();
+        std::memset(frameStarts, 0, sizeof(frameStarts));
+        frame = 0;
+    }
+};
+
+///
+/// DrawCommand describes the packed DrawQueue command stream.
+///
+/// The stream is a sequence of 32-bit words. Every command starts with a header word holding
+/// the opcode, the binding slot and opcode-specific flags, followed by a variable-length payload:
+///
+///     SetPrimitiveTopology    flags = topology, no payload
+///     SetVertexBuffer         slot, flags = 1 if at an offset, handle word, offset word if flagged
+///     SetIndexBuffer          flags = 1 if at an offset | 2 if 16-bit, handle word, offset word if flagged
+///     SetConstantBuffer       slot, flags = 1 if ranged, handle word, ranged: offset and size words
+///     SetResource             slot, flags = isTexture, handle word
+///     Draw                    flags = DrawCall::Type, draw parameters (see DrawQueue::pushDraw)
+///     SetResourceTable        slot = first slot, handle word
+///     SetInlineConstants      slot, flags = size in words, the constants; size 0 unbinds
+///
+/// Binding commands are only recorded when the binding differs from the one the decoder holds
+/// after the previous draw, so a draw reusing the previous bindings costs just its Draw command.
+///
+struct DrawCommand final
+{
+    enum Opcode : uint32_t
+    {
+        SetPrimitiveTopology    = 0,
+        SetVertexBuffer         = 1,
+        SetIndexBuffer          = 2,
+        SetConstantBuffer       = 3,
+        SetResource             = 4,
+        Draw                    = 5,
+        SetResourceTable        = 6,
+        SetInlineConstants      = 7
+    };
+
+    static SGFX_FORCE_INLINE uint32_t makeHeader(Opcode opcode, uint32_t slot, uint32_t flags)
+    {
+        return static_cast<uint32_t>(opcode) | (slot << 8) | (flags << 16);
+    }
+
+    static SGFX_FORCE_INLINE Opcode   getOpcode(uint32_t header) { return static_cast<Opcode>(header & 0xFF); }
+    static SGFX_FORCE_INLINE uint32_t getSlot(uint32_t header)   { return (header >> 8) & 0xFF; }
+    static SGFX_FORCE_INLINE uint32_t getFlags(uint32_t header)  { return header >> 16; }
+
+    // words following the header of a binding command, Draw commands are not covered
+    static SGFX_FORCE_INLINE uint32_t getPayloadSize(uint32_t header)
+    {
+        uint32_t flags = getFlags(header);
+
+        switch (getOpcode(header)) {
+        case SetVertexBuffer:       return (flags != 0) ? 2 : 1;
+        case SetIndexBuffer:        return 1 + (flags & 1);
+        case SetConstantBuffer:     return (flags != 0) ? 3 : 1;
+        case SetResource:           return 1;
+        case SetResourceTable:      return 1;
+        case SetInlineConstants:    return flags;
+        default:                    return 0;
+        }
+    }
+
+    static SGFX_FORCE_INLINE const uint32_t* readHandle(const uint32_t* words, uint32_t& value)
+    {
+        value = words[0];
+        return words + 1;
+    }
+
+    static SGFX_FORCE_INLINE const uint32_t* readSize(const uint32_t* words, size_t& value)
+    {
+        uint64_t value64 = static_cast<uint64_t>(words[0]) | (static_cast<uint64_t>(words[1]) << 32);
+        value = static_cast<size_t>(value64);
+        return words + 2;
+    }
+};
+
+///
+/// DrawCommandSegment is a piece of a DrawRecorder command stream: the whole stream, or a single
+/// draw once the recorder records sort keys.
+///
+/// Every segment is recorded starting from unbound state, so segments recorded independently
+/// (on different threads) can be decoded one after another in any order.
+///
+struct DrawCommandSegment final
+{
+    const uint32_t* begin;
+    const uint32_t* end;
+};
+
+// a segment and the sort key it is ordered by
+struct DrawSortItem final
+{
+    uint64_t            key;
+    DrawCommandSegment  segment;
+};
+
+///
+/// DrawInstancing is the automatic instancing of the submitted pipeline state (see
+/// PipelineStateDescriptor::instanceConstantsSlot), backends hand it to getDrawCalls() along with
+/// the transient ring the merged constants are packed into.
+///
+struct DrawInstancing final
+{
+    uint32_t       constantsSlot;
+    uint32_t       vertexSlot;
+    TransientRing* ring;
+};
+
+///
+/// DrawCallStream is a forward range over the draws recorded in a DrawQueue.
+///
+/// Each iteration step applies the binding commands preceding a Draw command to the decoded
+/// DrawCall, so bindings persist from one draw to the next exactly as recorded. The decoded
+/// bindings are cleared whenever the stream moves on to the next segment.
+///
+/// With mergeInstances a run of instanced draws that share all bindings, have the same type and
+/// the same vertex/index range, and continue each other's instance range (startInstance of a
+/// draw equals startInstance + instanceCount of the previous one) is decoded as a single draw
+/// covering all the instances. Instance-rate vertex attributes see the same data either way, but
+/// SV_InstanceID/gl_InstanceID restart at 0 only once per merged draw, so the merge is opt-in.
+///
+/// With an instancing description as well, a run of drawIndexed calls with the same bindings and
+/// index range, only the inline constants at DrawInstancing::constantsSlot set in between, is
+/// decoded as a single drawIndexedInstanced. The constants of the draws are packed into transient
+/// memory that the merged draw binds at DrawInstancing::vertexSlot instead of the constants, up to
+/// kMaxMergedDraws draws per merged draw. Sorted draws, each recorded on its own, merge as well.
+///
+class DrawCallStream final
+{
+    const DrawCommandSegment* segments;
+    uint32_t                  numSegments;
+    bool                      mergeInstances;
+    const DrawInstancing*     instancing;
+
+public:
+
+    enum : uint32_t
+    {
+        kMaxMergedDraws = 256
+    };
+
+    class Iterator final
+    {
+        DrawCall                  call;
+        const DrawCommandSegment* segment     = nullptr; // next segment to decode
+        const DrawCommandSegment* lastSegment = nullptr;
+        const uint32_t*           current     = nullptr; // first command of the current draw, nullptr at the end
+        const uint32_t*           position    = nullptr; // first command of the next draw
+        const uint32_t*           end         = nullptr;
+
+        // binding commands of the first draw in the current segment, they describe the whole
+        // binding state for as long as no later draw in the segment changes a binding
+        const uint32_t*           segmentBegin  = nullptr;
+        const uint32_t*           prefixBegin   = nullptr;
+        const uint32_t*           prefixEnd     = nullptr;
+        bool                      isPrefixState = false;
+        bool                      mergeInstances = false;
+        const DrawInstancing*     instancing     = nullptr;
+
+        // the instance data binding of the last merged draw replaced, put back before the next
+        // draw is decoded
+        struct
+        {
+            BufferHandle          buffer;
+            uint32_t              offset;
+            bool                  wasBound;
+        }                         replaced;
+        bool                      hasReplaced = false;
+
+        // the call's slot masks hold the slots written since the last reset, so a reset only
+        // clears what was bound
+        inline void resetBindings()
+        {
+            while (call.vertexBufferMask != 0) {
+                uint32_t slot = bitScanForward(call.vertexBufferMask);
+                call.vertexBuffers[slot]       = BufferHandle::invalidHandle();
+                call.vertexBufferOffsets[slot] = 0;
+                call.vertexBufferMask &= call.vertexBufferMask - 1;
+            }
+
+            while (call.constantBufferMask != 0) {
+                uint32_t slot = bitScanForward(call.constantBufferMask);
+                call.constantBuffers[slot]       = ConstantBufferHandle::invalidHandle();
+                call.constantBufferOffsets[slot] = 0;
+                call.constantBufferSizes[slot]   = 0;
+                call.constantBufferMask &= call.constantBufferMask - 1;
+            }
+
+            for (uint32_t word = 0; word < 2; ++word) {
+                while (call.shaderResourceMask[word] != 0) {
+                    call.shaderResources[word * 64 + bitScanForward(call.shaderResourceMask[word])] = ShaderResource();
+                    call.shaderResourceMask[word] &= call.shaderResourceMask[word] - 1;
+                }
+            }
+
+            call.primitiveTopology  = static_cast<PrimitiveTopology>(0);
+            call.indexBuffer        = BufferHandle::invalidHandle();
+            call.indexBufferOffset  = 0;
+            call.indexFormat        = IndexFormat::UInt32;
+            call.resourceTable      = ResourceTableHandle::invalidHandle();
+            call.resourceTableSlot  = 0;
+            call.inlineConstantMask = 0;
+        }
+
+        // decodes the draw starting at current, returns false if the segment has no more draws
+        SGFX_FORCE_INLINE bool decode()
+        {
+            const uint32_t* words = current;
+
+            while (words < end) {
+                uint32_t header = *words++;
+                uint32_t slot   = DrawCommand::getSlot(header);
+                uint32_t flags  = DrawCommand::getFlags(header);
+
+                switch (DrawCommand::getOpcode(header)) {
+                case DrawCommand::SetPrimitiveTopology: {
+                    call.primitiveTopology = static_cast<PrimitiveTopology>(flags);
+                } break;
+
+                case DrawCommand::SetVertexBuffer: {
+                    words = DrawCommand::readHandle(words, call.vertexBuffers[slot].value);
+                    call.vertexBufferOffsets[slot] = (flags != 0) ? words[0] : 0;
+                    words += (flags != 0) ? 1 : 0;
+                    call.vertexBufferMask |= 1u << slot;
+                } break;
+
+                case DrawCommand::SetIndexBuffer: {
+                    words = DrawCommand::readHandle(words, call.indexBuffer.value);
+                    call.indexBufferOffset = (flags & 1) ? words[0] : 0;
+                    call.indexFormat       = (flags & 2) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+                    words += (flags & 1) ? 1 : 0;
+                } break;
+
+                case DrawCommand::SetConstantBuffer: {
+                    words = DrawCommand::readHandle(words, call.constantBuffers[slot].value);
+                    call.constantBufferOffsets[slot] = (flags != 0) ? words[0] : 0;
+                    call.constantBufferSizes[slot]   = (flags != 0) ? words[1] : 0;
+                    words += (flags != 0) ? 2 : 0;
+                    call.constantBufferMask |= 1u << slot;
+                } break;
+
+                case DrawCommand::SetResource: {
+                    call.shaderResources[slot].isTexture = (flags != 0);
+                    words = DrawCommand::readHandle(words, call.shaderResources[slot].value);
+                    call.shaderResourceMask[slot / 64] |= 1ull << (slot % 64);
+                } break;
+
+                case DrawCommand::SetResourceTable: {
+                    call.resourceTableSlot = slot;
+                    words = DrawCommand::readHandle(words, call.resourceTable.value);
+                } break;
+
+                case DrawCommand::SetInlineConstants: {
+                    call.inlineConstants[slot]     = words;
+                    call.inlineConstantsSize[slot] = flags * sizeof(uint32_t);
+                    if (flags != 0)
+                        call.inlineConstantMask |= 1u << slot;
+                    else
+                        call.inlineConstantMask &= ~(1u << slot);
+                    words += flags;
+                } break;
+
+                case DrawCommand::Draw: {
+                    if (current == segmentBegin) {
+                        prefixBegin   = current;
+                        prefixEnd     = words - 1;
+                        isPrefixState = true;
+                    } else if (current != words - 1) {
+                        isPrefixState = false;
+                    }
+
+                    call.type               = static_cast<DrawCall::Type>(flags);
+                    call.instanceCount      = 0;
+                    call.count              = 0;
+                    call.startVertex        = 0;
+                    call.startIndex         = 0;
+                    call.startInstance      = 0;
+                    call.indirectArgsBuffer = BufferHandle::invalidHandle();
+                    call.indirectArgsOffset = 0;
+
+                    switch (call.type) {
+                    case DrawCall::Draw: {
+                        call.count         = words[0];
+                        call.startVertex   = words[1];
+                        words += 2;
+                    } break;
+
+                    case DrawCall::DrawIndexed: {
+                        call.count         = words[0];
+                        call.startIndex    = words[1];
+                        call.startVertex   = words[2];
+                        words += 3;
+                    } break;
+
+                    case DrawCall::DrawInstanced: {
+                        call.instanceCount = words[0];
+                        call.count         = words[1];
+                        call.startVertex   = words[2];
+                        call.startInstance = words[3];
+                        words += 4;
+                    } break;
+
+                    case DrawCall::DrawIndexedInstanced: {
+                        call.instanceCount = words[0];
+                        call.count         = words[1];
+                        call.startIndex    = words[2];
+                        call.startVertex   = words[3];
+                        call.startInstance = words[4];
+                        words += 5;
+                    } break;
+
+                    case DrawCall::DrawInstancedIndirect:
+                    case DrawCall::DrawIndexedInstancedIndirect: {
+                        words = DrawCommand::readHandle(words, call.indirectArgsBuffer.value);
+                        words = DrawCommand::readSize(words, call.indirectArgsOffset);
+                    } break;
+                    }
+
+                    position = words;
+                    return true;
+                }
+                }
+            }
+
+            position = end;
+            return false;
+        }
+
+        // folds the draws continuing the decoded draw's instance range into it, the draws are
+        // checked in the command stream so that a draw which does not merge is left undecoded
+        inline void mergeFollowingInstances()
+        {
+            uint32_t numParams = 0;
+
+            switch (call.type) {
+            case DrawCall::DrawInstanced:           numParams = 4; break;
+            case DrawCall::DrawIndexedInstanced:    numParams = 5; break;
+            default:                                return;
+            }
+
+            const uint32_t drawHeader = DrawCommand::makeHeader(DrawCommand::Draw, 0, call.type);
+
+            for (;;) {
+                const uint32_t*           words       = position;
+                const DrawCommandSegment* nextSegment = nullptr;
+
+                if (words == end) {
+                    // the next segment must start by recording exactly the bindings we hold
+                    if (!isPrefixState || segment == lastSegment)
+                        return;
+
+                    size_t prefixSize = static_cast<size_t>(prefixEnd - prefixBegin);
+
+                    nextSegment = segment;
+                    if (static_cast<size_t>(nextSegment->end - nextSegment->begin) <= prefixSize + numParams)
+                        return;
+                    if (std::memcmp(nextSegment->begin, prefixBegin, prefixSize * sizeof(uint32_t)) != 0)
+                        return;
+
+                    words = nextSegment->begin + prefixSize;
+                } else if (end - words <= numParams) {
+                    return;
+                }
+
+                // binding commands in between end the run
+                if (words[0] != drawHeader)
+                    return;
+
+                const uint32_t* params = words + 1;
+
+                // everything but the instance range must match
+                bool isSameRange = (call.type == DrawCall::DrawInstanced)
+                    ? (params[1] == call.count && params[2] == call.startVertex)
+                    : (params[1] == call.count && params[2] == call.startIndex && params[3] == call.startVertex);
+
+                if (!isSameRange || params[numParams - 1] != call.startInstance + call.instanceCount)
+                    return;
+
+                call.instanceCount += params[0];
+                position = params + numParams;
+
+                if (nextSegment != nullptr) {
+                    prefixEnd    = nextSegment->begin + (prefixEnd - prefixBegin);
+                    prefixBegin  = nextSegment->begin;
+                    segmentBegin = nextSegment->begin;
+                    end          = nextSegment->end;
+                    segment++;
+                }
+            }
+        }
+
+        // the bindings of the next segment up to its first draw must be the prefix we hold, but for
+        // the data of the instance constants; returns where its first draw starts or nullptr
+        inline const uint32_t* matchPrefix(const DrawCommandSegment* next, uint32_t constantsHeader, const uint32_t*& constants) const
+        {
+            const uint32_t* ours   = prefixBegin;
+            const uint32_t* theirs = next->begin;
+
+            constants = nullptr;
+            while (ours < prefixEnd) {
+                uint32_t size = DrawCommand::getPayloadSize(*ours);
+                if (next->end - theirs <= size || *theirs != *ours)
+                    return nullptr;
+
+                if (*ours == constantsHeader)
+                    constants = theirs + 1;
+                else if (std::memcmp(ours + 1, theirs + 1, size * sizeof(uint32_t)) != 0)
+                    return nullptr;
+
+                ours   += 1 + size;
+                theirs += 1 + size;
+            }
+            return (constants != nullptr) ? theirs : nullptr;
+        }
+
+        // folds the drawIndexed calls following the decoded one into an instanced draw, their
+        // inline constants become per-instance data (see DrawInstancing)
+        inline void mergeFollowingDraws()
+        {
+            uint32_t constantsSlot = instancing->constantsSlot;
+            uint32_t vertexSlot    = instancing->vertexSlot;
+
+            if ((call.inlineConstantMask & (1u << constantsSlot)) == 0)
+                return;
+
+            const uint32_t numWords        = call.inlineConstantsSize[constantsSlot] / sizeof(uint32_t);
+            const uint32_t constantsHeader = DrawCommand::makeHeader(DrawCommand::SetInlineConstants, constantsSlot, numWords);
+            const uint32_t drawHeader      = DrawCommand::makeHeader(DrawCommand::Draw, 0, DrawCall::DrawIndexed);
+
+            // decoder state to go back to when there is no memory for the instance data
+            const uint32_t*           runPosition     = position;
+            const uint32_t*           runEnd          = end;
+            const DrawCommandSegment* runSegment      = segment;
+            const uint32_t*           runSegmentBegin = segmentBegin;
+            const uint32_t*           runPrefixBegin  = prefixBegin;
+            const uint32_t*           runPrefixEnd    = prefixEnd;
+            bool                      runPrefixState  = isPrefixState;
+
+            const uint32_t* instances[kMaxMergedDraws];
+            uint32_t        numInstances  = 1;
+            bool            matchesPrefix = isPrefixState; // but for the instance constants
+
+            instances[0] = call.inlineConstants[constantsSlot];
+
+            while (numInstances < kMaxMergedDraws) {
+                const uint32_t*           words       = position;
+                const uint32_t*           constants   = instances[numInstances - 1];
+                const DrawCommandSegment* nextSegment = nullptr;
+
+                if (words == end) {
+                    if (!matchesPrefix || segment == lastSegment)
+                        break;
+
+                    nextSegment = segment;
+                    words       = matchPrefix(nextSegment, constantsHeader, constants);
+                    if (words == nullptr)
+                        break;
+                } else if (end - words > numWords && words[0] == constantsHeader) {
+                    constants = words + 1;
+                    words    += 1 + numWords;
+                }
+
+                const uint32_t* segmentEnd = (nextSegment != nullptr) ? nextSegment->end : end;
+                if (segmentEnd - words < 4 || words[0] != drawHeader)
+                    break;
+
+                const uint32_t* params = words + 1;
+                if (params[0] != call.count || params[1] != call.startIndex || params[2] != call.startVertex)
+                    break;
+
+                instances[numInstances++] = constants;
+                position = params + 3;
+
+                if (nextSegment != nullptr) {
+                    prefixEnd     = nextSegment->begin + (prefixEnd - prefixBegin);
+                    prefixBegin   = nextSegment->begin;
+                    segmentBegin  = nextSegment->begin;
+                    end           = nextSegment->end;
+                    isPrefixState = true;
+                    matchesPrefix = true;
+                    segment++;
+                } else if (constants != instances[numInstances - 2]) {
+                    isPrefixState = false;
+                }
+            }
+
+            if (numInstances < 2)
+                return;
+
+            size_t              stride     = numWords * sizeof(uint32_t);
+            TransientAllocation allocation = instancing->ring->allocate(numInstances * stride, 16);
+            if (allocation.cpuPtr == nullptr) {
+                position      = runPosition;
+                end           = runEnd;
+                segment       = runSegment;
+                segmentBegin  = runSegmentBegin;
+                prefixBegin   = runPrefixBegin;
+                prefixEnd     = runPrefixEnd;
+                isPrefixState = runPrefixState;
+                return;
+            }
+
+            uint8_t* instanceData = static_cast<uint8_t*>(allocation.cpuPtr);
+            for (uint32_t i = 0; i < numInstances; ++i)
+                std::memcpy(instanceData + i * stride, instances[i], stride);
+            instancing->ring->unmap();
+
+            // the following draws see the constants of the last draw of the run
+            replaced.buffer   = call.vertexBuffers[vertexSlot];
+            replaced.offset   = call.vertexBufferOffsets[vertexSlot];
+            replaced.wasBound = (call.vertexBufferMask & (1u << vertexSlot)) != 0;
+            hasReplaced       = true;
+
+            call.vertexBuffers[vertexSlot]       = allocation.buffer;
+            call.vertexBufferOffsets[vertexSlot] = allocation.offset;
+            call.vertexBufferMask               |= 1u << vertexSlot;
+            call.inlineConstants[constantsSlot]  = instances[numInstances - 1];
+            call.inlineConstantMask             &= ~(1u << constantsSlot);
+
+            call.type          = DrawCall::DrawIndexedInstanced;
+            call.instanceCount = numInstances;
+            call.startInstance = 0;
+        }
+
+        inline void restoreReplaced()
+        {
+            uint32_t vertexSlot = instancing->vertexSlot;
+
+            call.vertexBuffers[vertexSlot]       = replaced.buffer;
+            call.vertexBufferOffsets[vertexSlot] = replaced.offset;
+            if (!replaced.wasBound)
+                call.vertexBufferMask &= ~(1u << vertexSlot);
+            call.inlineConstantMask |= 1u << instancing->constantsSlot;
+            hasReplaced = false;
+        }
+
+        inline void next()
+        {
+            if (hasReplaced)
+                restoreReplaced();
+
+            for (;;) {
+                if (position != end) {
+                    current = position;
+                    if (decode()) {
+                        if (mergeInstances) {
+                            if (instancing != nullptr && call.type == DrawCall::DrawIndexed)
+                                mergeFollowingDraws();
+                            else
+                                mergeFollowingInstances();
+                        }
+                        return;
+                    }
+                }
+
+                if (segment == lastSegment) {
+                    current = nullptr;
+                    return;
+                }
+
+                // every segment is recorded from unbound state
+                resetBindings();
+                position     = segment->begin;
+                segmentBegin = segment->begin;
+                end          = segment->end;
+                segment++;
+            }
+        }
+
+    public:
+
+        // the end iterator, never decodes anything
+        SGFX_FORCE_INLINE Iterator() {}
+
+        SGFX_FORCE_INLINE Iterator(const DrawCommandSegment* segments, uint32_t numSegments, bool merge, const DrawInstancing* newInstancing)
+            : segment(segments), lastSegment(segments + numSegments), mergeInstances(merge), instancing(newInstancing)
+        {
+            call = DrawCall();
+            next();
+        }
+
+        SGFX_FORCE_INLINE const DrawCall& operator*()  const { return call; }
+        SGFX_FORCE_INLINE const DrawCall* operator->() const { return &call; }
+
+        SGFX_FORCE_INLINE Iterator& operator++()
+        {
+            next();
+            return *this;
+        }
+
+        SGFX_FORCE_INLINE bool operator==(const Iterator& other) const { return current == other.current; }
+        SGFX_FORCE_INLINE bool operator!=(const Iterator& other) const { return current != other.current; }
+    };
+
+    SGFX_FORCE_INLINE DrawCallStream(const DrawCommandSegment* newSegments, uint32_t newNumSegments, bool newMergeInstances = false, const DrawInstancing* newInstancing = nullptr)
+        : segments(newSegments), numSegments(newNumSegments), mergeInstances(newMergeInstances), instancing(newInstancing)
+    {}
+
+    // range for support
+    SGFX_FORCE_INLINE Iterator begin() const { return Iterator(segments, numSegments, mergeInstances, instancing); }
+    SGFX_FORCE_INLINE Iterator end()   const { return Iterator(); }
+};
+
+// keyed draw of a DrawRecorder, offsets are in words because the command stream can move
+struct DrawSortEntry final
+{
+    uint64_t            key;
+    uint32_t            begin;
+    uint32_t            end;
+};
+
+// recording state of a DrawRecorder, allocated from the frame arena on first use in a frame
+struct DrawQueueBindings final
+{
+    // bindings set since the last draw, slots are tracked with bitmasks
+    DrawCall            pending;
+    uint32_t            pendingVertexBuffers;
+    uint32_t            pendingConstantBuffers;
+    uint32_t            pendingInlineConstants; // their data is in inlineConstantData
+    uint64_t            pendingResources[2];
+
+    // bindings the decoder holds after the last recorded draw
+    DrawCall            bound;
+    uint32_t            boundVertexBuffers;
+    uint32_t            boundConstantBuffers;
+    uint32_t            boundInlineConstants;
+    uint32_t            boundInlineOffsets[DrawCall::kMaxConstantBuffers]; // of the recorded data, in words
+    uint64_t            boundResources[2];
+
+    // inline constants set since the last draw, with sticky bindings since they were set
+    uint32_t            inlineConstantData[DrawCall::kMaxConstantBuffers][DrawCall::kMaxInlineConstantsSize / sizeof(uint32_t)];
+
+    // sort keys, once a key is set every following draw of the frame is recorded on its own
+    DrawSortEntry*      sortEntries;
+    uint32_t            numSortEntries;
+    uint32_t            sortEntryCapacity;
+    uint64_t            pendingSortKey;
+    bool                isKeyed;
+
+    // set whenever the next draw may need binding commands, sticky recorders skip the flush otherwise
+    bool                isDirty;
+
+    static_assert(DrawCall::kMaxVertexBuffers   <= 32,  "vertex buffer mask is too small");
+    static_assert(DrawCall::kMaxConstantBuffers <= 32,  "constant buffer mask is too small");
+    static_assert(DrawCall::kMaxShaderResources <= 128, "shader resource mask is too small");
+
+    SGFX_FORCE_INLINE void reset()
+    {
+        *this = DrawQueueBindings();
+    }
+
+    // makes the next draw record its bindings from unbound state
+    inline void unbindAll()
+    {
+        while (boundVertexBuffers != 0) {
+            uint32_t slot = bitScanForward(boundVertexBuffers);
+            bound.vertexBuffers[slot]       = BufferHandle::invalidHandle();
+            bound.vertexBufferOffsets[slot] = 0;
+            boundVertexBuffers &= boundVertexBuffers - 1;
+        }
+
+        while (boundConstantBuffers != 0) {
+            uint32_t slot = bitScanForward(boundConstantBuffers);
+            bound.constantBuffers[slot]       = ConstantBufferHandle::invalidHandle();
+            bound.constantBufferOffsets[slot] = 0;
+            bound.constantBufferSizes[slot]   = 0;
+            boundConstantBuffers &= boundConstantBuffers - 1;
+        }
+
+        for (uint32_t word = 0; word < 2; ++word) {
+            while (boundResources[word] != 0) {
+                bound.shaderResources[word * 64 + bitScanForward(boundResources[word])] = ShaderResource();
+                boundResources[word] &= boundResources[word] - 1;
+            }
+        }
+
+        bound.primitiveTopology = static_cast<PrimitiveTopology>(0);
+        bound.indexBuffer       = BufferHandle::invalidHandle();
+        bound.indexBufferOffset = 0;
+        bound.indexFormat       = IndexFormat::UInt32;
+        bound.resourceTable     = ResourceTableHandle::invalidHandle();
+        bound.resourceTableSlot = 0;
+        boundInlineConstants    = 0;
+        isDirty                 = true;
+    }
+
+    // forgets everything set since the last draw, or with sticky bindings everything set at all
+    inline void clearPending()
+    {
+        pending.primitiveTopology = static_cast<PrimitiveTopology>(0);
+        pending.indexBuffer       = BufferHandle::invalidHandle();
+        pending.indexBufferOffset = 0;
+        pending.indexFormat       = IndexFormat::UInt32;
+        pending.resourceTable     = ResourceTableHandle::invalidHandle();
+        pending.resourceTableSlot = 0;
+        pendingVertexBuffers      = 0;
+        pendingConstantBuffers    = 0;
+        pendingInlineConstants    = 0;
+        pendingResources[0]       = 0;
+        pendingResources[1]       = 0;
+        isDirty                   = true;
+    }
+};
+
+class DrawQueue;
+
+///
+/// DrawRecorder records draws into a command stream allocated from a FrameArena.
+///
+/// An idle recorder holds no memory. Recording storage is taken from the arena of the recording
+/// thread when the recorder is first used in a frame and is given back wholesale by present(),
+/// so anything recorded but not submitted by then is discarded.
+///
+/// A recorder only touches its own state and the arena of the calling thread, so recorders of
+/// the same DrawQueue can be recorded on different threads at the same time without locking.
+///
+class DrawRecorder final
+{
+    enum
+    {
+        kMinCommandWords = 256
+    };
+
+    friend class DrawQueue;
+
+    DrawQueue*          queue           = nullptr; // set while attached to a queue
+    uint32_t            order           = 0;       // creation order among the recorders of the queue
+    uint32_t            key             = 0;
+    bool                isSticky        = false;   // DrawQueueFlags::StickyBindings of the queue
+
+    FrameArena*         arena           = nullptr;
+    uint32_t            frameIndex      = 0;
+    DrawQueueBindings*  bindings        = nullptr;
+    uint32_t*           commands        = nullptr;
+    size_t              numCommandWords = 0;
+    size_t              commandCapacity = 0;
+    uint32_t            numDrawCalls    = 0;
+
+    SGFX_FORCE_INLINE bool hasStorage() const
+    {
+        return frameIndex == getFrameIndex();
+    }
+
+    inline void acquireStorage()
+    {
+        arena      = getFrameArena();
+        frameIndex = getFrameIndex();
+
+        bindings = ::new (arena->Allocate(sizeof(DrawQueueBindings))) DrawQueueBindings();
+        bindings->reset();
+
+        commands        = nullptr;
+        numCommandWords = 0;
+        commandCapacity = 0;
+        numDrawCalls    = 0;
+    }
+
+    SGFX_FORCE_INLINE void prepare()
+    {
+        if (!hasStorage())
+            acquireStorage();
+    }
+
+    inline void growCommands(size_t numWords)
+    {
+        size_t newCapacity = commandCapacity * 2;
+        if (newCapacity < kMinCommandWords)
+            newCapacity = kMinCommandWords;
+        if (newCapacity < numCommandWords + numWords)
+            newCapacity = numCommandWords + numWords;
+
+        // the old stream stays in the arena until the end of the frame
+        uint32_t* newCommands = static_cast<uint32_t*>(arena->Allocate(newCapacity * sizeof(uint32_t)));
+        if (numCommandWords != 0)
+            std::memcpy(newCommands, commands, numCommandWords * sizeof(uint32_t));
+
+        commands        = newCommands;
+        commandCapacity = newCapacity;
+    }
+
+    SGFX_FORCE_INLINE uint32_t* allocateWords(size_t numWords)
+    {
+        if (numCommandWords + numWords > commandCapacity)
+            growCommands(numWords);
+
+        uint32_t* words = commands + numCommandWords;
+        numCommandWords += numWords;
+        return words;
+    }
+
+    SGFX_FORCE_INLINE void pushHeader(DrawCommand::Opcode opcode, uint32_t slot, uint32_t flags)
+    {
+        *allocateWords(1) = DrawCommand::makeHeader(opcode, slot, flags);
+    }
+
+    SGFX_FORCE_INLINE void pushHandle(uint32_t value)
+    {
+        *allocateWords(1) = value;
+    }
+
+    SGFX_FORCE_INLINE void pushSize(size_t value)
+    {
+        uint64_t  value64 = static_cast<uint64_t>(value);
+        uint32_t* words   = allocateWords(2);
+        words[0] = static_cast<uint32_t>(value64);
+        words[1] = static_cast<uint32_t>(value64 >> 32);
+    }
+
+    inline void pushSortEntry(uint64_t sortKey, size_t begin, size_t end)
+    {
+        if (bindings->numSortEntries == bindings->sortEntryCapacity) {
+            uint32_t newCapacity = bindings->sortEntryCapacity * 2;
+            if (newCapacity < kMinCommandWords)
+                newCapacity = kMinCommandWords;
+
+            // same as the command stream, the old entries stay in the arena
+            DrawSortEntry* newEntries = static_cast<DrawSortEntry*>(arena->Allocate(newCapacity * sizeof(DrawSortEntry)));
+            if (bindings->numSortEntries != 0)
+                std::memcpy(newEntries, bindings->sortEntries, bindings->numSortEntries * sizeof(DrawSortEntry));
+
+            bindings->sortEntries       = newEntries;
+            bindings->sortEntryCapacity = newCapacity;
+        }
+
+        DrawSortEntry& entry = bindings->sortEntries[bindings->numSortEntries++];
+        entry.key   = sortKey;
+        entry.begin = static_cast<uint32_t>(begin);
+        entry.end   = static_cast<uint32_t>(end);
+    }
+
+    // once keyed, every draw becomes a segment of its own that can be moved around
+    inline void beginKeyed()
+    {
+        // draws recorded before the first key stay together and sort as key 0
+        if (numCommandWords != 0)
+            pushSortEntry(0, 0, numCommandWords);
+
+        bindings->isKeyed = true;
+        bindings->unbindAll();
+    }
+
+    inline void endKeyedDraw(size_t begin)
+    {
+        pushSortEntry(bindings->pendingSortKey, begin, numCommandWords);
+        bindings->pendingSortKey = 0;
+        bindings->unbindAll();
+    }
+
+    // emits the binding commands needed to turn the bound state into the pending one
+    SGFX_FORCE_INLINE void flushBindings()
+    {
+        DrawCall& pending = bindings->pending;
+        DrawCall& bound   = bindings->bound;
+
+        if (pending.primitiveTopology != bound.primitiveTopology) {
+            bound.primitiveTopology = pending.primitiveTopology;
+            pushHeader(DrawCommand::SetPrimitiveTopology, 0, static_cast<uint32_t>(bound.primitiveTopology));
+        }
+
+        if (pending.indexBuffer.value != bound.indexBuffer.value || pending.indexBufferOffset != bound.indexBufferOffset || pending.indexFormat != bound.indexFormat) {
+            bound.indexBuffer       = pending.indexBuffer;
+            bound.indexBufferOffset = pending.indexBufferOffset;
+            bound.indexFormat       = pending.indexFormat;
+            pushHeader(DrawCommand::SetIndexBuffer, 0, ((bound.indexBufferOffset != 0) ? 1 : 0) | ((bound.indexFormat == IndexFormat::UInt16) ? 2 : 0));
+            pushHandle(bound.indexBuffer.value);
+            if (bound.indexBufferOffset != 0)
+                *allocateWords(1) = bound.indexBufferOffset;
+        }
+
+        if (pending.resourceTable.value != bound.resourceTable.value || pending.resourceTableSlot != bound.resourceTableSlot) {
+            bound.resourceTable     = pending.resourceTable;
+            bound.resourceTableSlot = pending.resourceTableSlot;
+            pushHeader(DrawCommand::SetResourceTable, bound.resourceTableSlot, 0);
+            pushHandle(bound.resourceTable.value);
+        }
+
+        // slots set now or bound before, everything not set since the last draw gets unbound
+        uint32_t vbMask = bindings->pendingVertexBuffers | bindings->boundVertexBuffers;
+        bindings->boundVertexBuffers = 0;
+        while (vbMask != 0) {
+            uint32_t idx = bitScanForward(vbMask);
+            vbMask &= vbMask - 1;
+
+            uint32_t value  = 0;
+            uint32_t offset = 0;
+            if (bindings->pendingVertexBuffers & (1u << idx)) {
+                value  = pending.vertexBuffers[idx].value;
+                offset = pending.vertexBufferOffsets[idx];
+            }
+
+            if (value != bound.vertexBuffers[idx].value || offset != bound.vertexBufferOffsets[idx]) {
+                bound.vertexBuffers[idx].value  = value;
+                bound.vertexBufferOffsets[idx]  = offset;
+                pushHeader(DrawCommand::SetVertexBuffer, idx, (offset != 0) ? 1 : 0);
+                pushHandle(value);
+                if (offset != 0)
+                    *allocateWords(1) = offset;
+            }
+            if (value != 0)
+                bindings->boundVertexBuffers |= 1u << idx;
+        }
+
+        uint32_t cbMask = bindings->pendingConstantBuffers | bindings->boundConstantBuffers;
+        bindings->boundConstantBuffers = 0;
+        while (cbMask != 0) {
+            uint32_t idx = bitScanForward(cbMask);
+            cbMask &= cbMask - 1;
+
+            uint32_t value  = 0;
+            uint32_t offset = 0;
+            uint32_t size   = 0;
+            if (bindings->pendingConstantBuffers & (1u << idx)) {
+                value  = pending.constantBuffers[idx].value;
+                offset = pending.constantBufferOffsets[idx];
+                size   = pending.constantBufferSizes[idx];
+            }
+
+            if (value != bound.constantBuffers[idx].value || offset != bound.constantBufferOffsets[idx] || size != bound.constantBufferSizes[idx]) {
+                bound.constantBuffers[idx].value  = value;
+                bound.constantBufferOffsets[idx]  = offset;
+                bound.constantBufferSizes[idx]    = size;
+                pushHeader(DrawCommand::SetConstantBuffer, idx, (size != 0) ? 1 : 0);
+                pushHandle(value);
+                if (size != 0) {
+                    uint32_t* words = allocateWords(2);
+                    words[0] = offset;
+                    words[1] = size;
+                }
+            }
+            if (value != 0)
+                bindings->boundConstantBuffers |= 1u << idx;
+        }
+
+        // inline constants are compared with the ones recorded last, a draw setting the same
+        // constants again costs nothing
+        uint32_t icMask   = bindings->pendingInlineConstants | bindings->boundInlineConstants;
+        uint32_t wasBound = bindings->boundInlineConstants;
+        bindings->boundInlineConstants = bindings->pendingInlineConstants;
+        while (icMask != 0) {
+            uint32_t idx = bitScanForward(icMask);
+            icMask &= icMask - 1;
+
+            if ((bindings->pendingInlineConstants & (1u << idx)) == 0) {
+                pushHeader(DrawCommand::SetInlineConstants, idx, 0);
+                continue;
+            }
+
+            const uint32_t* data     = bindings->inlineConstantData[idx];
+            uint32_t        numWords = pending.inlineConstantsSize[idx] / sizeof(uint32_t);
+
+            if ((wasBound & (1u << idx)) != 0 && bound.inlineConstantsSize[idx] == numWords * sizeof(uint32_t)
+                && std::memcmp(commands + bindings->boundInlineOffsets[idx], data, numWords * sizeof(uint32_t)) == 0)
+                continue;
+
+            pushHeader(DrawCommand::SetInlineConstants, idx, numWords);
+
+            uint32_t* words = allocateWords(numWords);
+            std::memcpy(words, data, numWords * sizeof(uint32_t));
+
+            bound.inlineConstantsSize[idx]    = numWords * sizeof(uint32_t);
+            bindings->boundInlineOffsets[idx] = static_cast<uint32_t>(words - commands);
+        }
+
+        for (uint32_t word = 0; word < 2; ++word) {
+            uint64_t srvMask = bindings->pendingResources[word] | bindings->boundResources[word];
+            bindings->boundResources[word] = 0;
+            while (srvMask != 0) {
+                uint32_t bit = bitScanForward(srvMask);
+                uint32_t idx = word * 64 + bit;
+                srvMask &= srvMask - 1;
+
+                ShaderResource value;
+                if (bindings->pendingResources[word] & (1ull << bit))
+                    value = pending.shaderResources[idx];
+
+                ShaderResource& current = bound.shaderResources[idx];
+                if (value.value != current.value || value.isTexture != current.isTexture) {
+                    current = value;
+                    pushHeader(DrawCommand::SetResource, idx, value.isTexture ? 1 : 0);
+                    pushHandle(value.value);
+                }
+                if (value.value != 0)
+                    bindings->boundResources[word] |= 1ull << bit;
+            }
+        }
+
+        // bindings do not carry over to the next draw unless they are sticky
+        if (!isSticky)
+            bindings->clearPending();
+        bindings->isDirty = false;
+    }
+
+    SGFX_FORCE_INLINE void pushDraw(DrawCall::Type type, const uint32_t* params, size_t numParams)
+    {
+        prepare();
+
+        size_t begin = numCommandWords;
+        if (!isSticky || bindings->isDirty)
+            flushBindings();
+
+        pushHeader(DrawCommand::Draw, 0, type);
+        std::memcpy(allocateWords(numParams), params, numParams * sizeof(uint32_t));
+
+        numDrawCalls++;
+        if (bindings->isKeyed)
+            endKeyedDraw(begin);
+    }
+
+    SGFX_FORCE_INLINE void pushDrawIndirect(DrawCall::Type type, BufferHandle indirectArgs, size_t argsOffset)
+    {
+        prepare();
+
+        size_t begin = numCommandWords;
+        if (!isSticky || bindings->isDirty)
+            flushBindings();
+
+        pushHeader(DrawCommand::Draw, 0, type);
+        pushHandle(indirectArgs.value);
+        pushSize(argsOffset);
+
+        numDrawCalls++;
+        if (bindings->isKeyed)
+            endKeyedDraw(begin);
+    }
+
+public:
+
+    SGFX_FORCE_INLINE DrawRecorder() {}
+    inline ~DrawRecorder();
+
+    SGFX_FORCE_INLINE DrawQueue* getQueue() const         { return queue; }
+    SGFX_FORCE_INLINE uint32_t   getKey() const           { return key; }
+    SGFX_FORCE_INLINE void       setKey(uint32_t newKey)  { key = newKey; }
+
+    SGFX_FORCE_INLINE uint32_t   getNumDrawCalls() const  { return hasStorage() ? numDrawCalls : 0; }
+    SGFX_FORCE_INLINE size_t     getCommandSize() const   { return hasStorage() ? numCommandWords * sizeof(uint32_t) : 0; }
+
+    SGFX_FORCE_INLINE DrawCommandSegment getCommands() const
+    {
+        DrawCommandSegment segment = { nullptr, nullptr };
+        if (hasStorage()) {
+            segment.begin = commands;
+            segment.end   = commands + numCommandWords;
+        }
+        return segment;
+    }
+
+    SGFX_FORCE_INLINE bool isKeyed() const
+    {
+        return hasStorage() && bindings->isKeyed;
+    }
+
+    SGFX_FORCE_INLINE uint32_t getNumSegments() const
+    {
+        if (getNumDrawCalls() == 0)
+            return 0;
+        return bindings->isKeyed ? bindings->numSortEntries : 1;
+    }
+
+    // writes getNumSegments() segments in recording order
+    inline void getSegments(DrawCommandSegment* segments) const
+    {
+        if (getNumDrawCalls() == 0)
+            return;
+
+        if (!bindings->isKeyed) {
+            segments[0] = getCommands();
+            return;
+        }
+
+        for (uint32_t i = 0; i < bindings->numSortEntries; ++i) {
+            segments[i].begin = commands + bindings->sortEntries[i].begin;
+            segments[i].end   = commands + bindings->sortEntries[i].end;
+        }
+    }
+
+    // same as getSegments(), with the sort key of every segment
+    inline void getSortItems(DrawSortItem* items) const
+    {
+        if (getNumDrawCalls() == 0)
+            return;
+
+        if (!bindings->isKeyed) {
+            items[0].key     = 0;
+            items[0].segment = getCommands();
+            return;
+        }
+
+        for (uint32_t i = 0; i < bindings->numSortEntries; ++i) {
+            items[i].key           = bindings->sortEntries[i].key;
+            items[i].segment.begin = commands + bindings->sortEntries[i].begin;
+            items[i].segment.end   = commands + bindings->sortEntries[i].end;
+        }
+    }
+
+    SGFX_FORCE_INLINE void clear()
+    {
+        // the command storage is kept for the rest of the frame
+        if (hasStorage()) {
+            numCommandWords = 0;
+            numDrawCalls    = 0;
+            bindings->reset();
+        }
+    }
+
+    SGFX_FORCE_INLINE void resetBindings()
+    {
+        prepare();
+        bindings->clearPending();
+    }
+
+    // key of the next draw, draws without a key sort as key 0
+    SGFX_FORCE_INLINE void setSortKey(uint64_t sortKey)
+    {
+        prepare();
+        if (!bindings->isKeyed)
+            beginKeyed();
+        bindings->pendingSortKey = sortKey;
+    }
+
+    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)
+    {
+        prepare();
+        bindings->pending.primitiveTopology = topology;
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle, uint32_t offset = 0)
+    {
+        prepare();
+        bindings->pending.vertexBuffers[idx]       = handle;
+        bindings->pending.vertexBufferOffsets[idx] = offset;
+        bindings->pendingVertexBuffers |= 1u << idx;
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle, uint32_t offset = 0, IndexFormat format = IndexFormat::UInt32)
+    {
+        prepare();
+        bindings->pending.indexBuffer       = handle;
+        bindings->pending.indexBufferOffset = offset;
+        bindings->pending.indexFormat       = format;
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle resource)
+    {
+        setConstantBufferRange(idx, resource, 0, 0);
+    }
+
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t idx, ConstantBufferHandle resource, uint32_t offset, uint32_t size)
+    {
+        prepare();
+        bindings->pending.constantBuffers[idx]       = resource;
+        bindings->pending.constantBufferOffsets[idx] = (size != 0) ? offset : 0;
+        bindings->pending.constantBufferSizes[idx]   = size;
+        bindings->pendingConstantBuffers |= 1u << idx;
+        bindings->pendingInlineConstants &= ~(1u << idx);
+        bindings->isDirty = true;
+    }
+
+    // the constants are copied right away, they are compared and recorded at the next draw
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t idx, const void* data, size_t size)
+    {
+        if (size > DrawCall::kMaxInlineConstantsSize)
+            return;
+
+        prepare();
+
+        uint32_t  numWords = getInlineConstantsWords(size);
+        uint32_t* words    = bindings->inlineConstantData[idx];
+        std::memcpy(words, data, size);
+        std::memset(reinterpret_cast<uint8_t*>(words) + size, 0, numWords * sizeof(uint32_t) - size);
+
+        bindings->pending.inlineConstantsSize[idx] = numWords * sizeof(uint32_t);
+        bindings->pendingInlineConstants |= 1u << idx;
+        bindings->pendingConstantBuffers &= ~(1u << idx);
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, BufferHandle resource)
+    {
+        prepare();
+        bindings->pending.shaderResources[idx] = ShaderResource(false, resource.value);
+        bindings->pendingResources[idx / 64] |= 1ull << (idx % 64);
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, TextureHandle resource)
+    {
+        prepare();
+        bindings->pending.shaderResources[idx] = ShaderResource(true, resource.value);
+        bindings->pendingResources[idx / 64] |= 1ull << (idx % 64);
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void setResourceTable(uint32_t firstSlot, ResourceTableHandle table)
+    {
+        prepare();
+        bindings->pending.resourceTable     = table;
+        bindings->pending.resourceTableSlot = firstSlot;
+        bindings->isDirty = true;
+    }
+
+    SGFX_FORCE_INLINE void draw(uint32_t count, uint32_t startVertex)
+    {
+        const uint32_t params[] = { count, startVertex };
+        pushDraw(DrawCall::Draw, params, 2);
+    }
+
+    SGFX_FORCE_INLINE void drawIndexed(uint32_t count, uint32_t startIndex, uint32_t startVertex)
+    {
+        const uint32_t params[] = { count, startIndex, startVertex };
+        pushDraw(DrawCall::DrawIndexed, params, 3);
+    }
+
+    SGFX_FORCE_INLINE void drawInstanced(uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+    {
+        const uint32_t params[] = { instanceCount, count, startVertex, startInstance };
+        pushDraw(DrawCall::DrawInstanced, params, 4);
+    }
+
+    SGFX_FORCE_INLINE void drawIndexedInstanced(uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
+    {
+        const uint32_t params[] = { instanceCount, count, startIndex, startVertex, startInstance };
+        pushDraw(DrawCall::DrawIndexedInstanced, params, 5);
+    }
+
+    SGFX_FORCE_INLINE void drawInstancedIndirect(BufferHandle indirectArgs, size_t argsOffset)
+    {
+        pushDrawIndirect(DrawCall::DrawInstancedIndirect, indirectArgs, argsOffset);
+    }
+
+    SGFX_FORCE_INLINE void drawIndexedInstancedIndirect(BufferHandle indirectArgs, size_t argsOffset)
+    {
+        pushDrawIndirect(DrawCall::DrawIndexedInstancedIndirect, indirectArgs, argsOffset);
+    }
+};
+
+///
+/// DrawQueue is a pipeline state, its sampler states and the draws recorded for them.
+///
+/// Draws issued on the queue itself go to its own recorder. Additional recorders can be attached
+/// to record parts of the queue in parallel. getDrawCalls() stitches the streams together: the
+/// queue's own draws first, then the attached recorders ordered by key and by creation order for
+/// equal keys, so the result does not depend on which thread finished recording first.
+///
+class DrawQueue final
+{
+    PipelineStateHandle                 state;
+    DrawRecorder                        recorder;
+    DynamicArray<DrawRecorder*, 2, 8>   recorders;
+    uint32_t                            numCreatedRecorders = 0;
+
+    DrawQueue(const DrawQueue& other) = delete;
+    DrawQueue& operator=(const DrawQueue& other) = delete;
+
+    // insertion sort, recorders are few and keep their order from the previous submit
+    inline void sortRecorders()
+    {
+        DrawRecorder** data = recorders.GetData();
+        for (size_t i = 1; i < recorders.GetSize(); ++i) {
+            DrawRecorder* value = data[i];
+
+            size_t j = i;
+            for (; j > 0; --j) {
+                const DrawRecorder* prev = data[j - 1];
+                if (prev->key < value->key || (prev->key == value->key && prev->order < value->order))
+                    break;
+                data[j] = data[j - 1];
+            }
+            data[j] = value;
+        }
+    }
+
+public:
+
+    enum
+    {
+        kMaxSamplerStates = 8
+    };
+    SamplerStateHandle samplerStates[kMaxSamplerStates];
+
+    QueueStats         stats; // of the last submit, see QueueStatsScope
+
+    DrawQueue(PipelineStateHandle _state, uint32_t flags = 0) : state(_state)
+    {
+        recorder.isSticky = (flags & DrawQueueFlags::StickyBindings) != 0;
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    inline ~DrawQueue()
+    {
+        for (DrawRecorder* attached : recorders)
+            attached->queue = nullptr;
+    }
+
+    SGFX_FORCE_INLINE PipelineStateHandle getState() const { return state; }
+
+    // recorders are attached and detached by the submitting thread, never while recording
+    inline void attachRecorder(DrawRecorder* attached)
+    {
+        attached->queue    = this;
+        attached->order    = numCreatedRecorders++;
+        attached->isSticky = recorder.isSticky;
+        recorders.Add(attached);
+    }
+
+    inline void detachRecorder(DrawRecorder* attached)
+    {
+        // getDrawCalls() sorts the recorders anyway
+        recorders.RemoveSwap(attached);
+        attached->queue = nullptr;
+    }
+
+    inline uint32_t getNumDrawCalls() const
+    {
+        uint32_t numDrawCalls = recorder.getNumDrawCalls();
+        for (const DrawRecorder* attached : recorders)
+            numDrawCalls += attached->getNumDrawCalls();
+        return numDrawCalls;
+    }
+
+    inline size_t getCommandSize() const
+    {
+        size_t commandSize = recorder.getCommandSize();
+        for (const DrawRecorder* attached : recorders)
+            commandSize += attached->getCommandSize();
+        return commandSize;
+    }
+
+    // recording must be finished on all threads, the segment list lives in the frame arena
+    //
+    // flags are SubmitFlags: with SortByKey the draws are reordered by their sort keys, draws with
+    // equal keys keep the order described above, MergeInstances is applied after sorting and
+    // merges drawIndexed runs as well when the pipeline state's instancing is passed
+    inline DrawCallStream getDrawCalls(uint32_t flags = 0, const DrawInstancing* instancing = nullptr)
+    {
+        bool sortByKey      = (flags & SubmitFlags::SortByKey) != 0;
+        bool mergeInstances = (flags & SubmitFlags::MergeInstances) != 0;
+
+        if (instancing != nullptr && (instancing->ring == nullptr
+            || instancing->constantsSlot >= DrawCall::kMaxConstantBuffers
+            || instancing->vertexSlot >= DrawCall::kMaxVertexBuffers))
+            instancing = nullptr;
+
+        sortRecorders();
+
+        FrameArena* arena       = getFrameArena();
+        uint32_t    numSegments = recorder.getNumSegments();
+        bool        isKeyed     = recorder.isKeyed();
+
+        for (const DrawRecorder* attached : recorders) {
+            numSegments += attached->getNumSegments();
+            isKeyed     |= attached->isKeyed();
+        }
+
+        DrawCommandSegment* segments = static_cast<DrawCommandSegment*>(arena->Allocate(numSegments * sizeof(DrawCommandSegment)));
+
+        // nothing to sort when no keys were set
+        if (!sortByKey || !isKeyed) {
+            DrawCommandSegment* out = segments;
+
+            recorder.getSegments(out);
+            out += recorder.getNumSegments();
+
+            for (const DrawRecorder* attached : recorders) {
+                attached->getSegments(out);
+                out += attached->getNumSegments();
+            }
+
+            return DrawCallStream(segments, numSegments, mergeInstances, instancing);
+        }
+
+        DrawSortItem* items = static_cast<DrawSortItem*>(arena->Allocate(2 * numSegments * sizeof(DrawSortItem)));
+        DrawSortItem* out   = items;
+
+        recorder.getSortItems(out);
+        out += recorder.getNumSegments();
+
+        for (const DrawRecorder* attached : recorders) {
+            attached->getSortItems(out);
+            out += attached->getNumSegments();
+        }
+
+        const DrawSortItem* sorted = radixSortByKey(items, items + numSegments, numSegments);
+        for (uint32_t i = 0; i < numSegments; ++i)
+            segments[i] = sorted[i].segment;
+
+        return DrawCallStream(segments, numSegments, mergeInstances, instancing);
+    }
+
+    inline void clear()
+    {
+        recorder.clear();
+        for (DrawRecorder* attached : recorders)
+            attached->clear();
+    }
+
+    SGFX_FORCE_INLINE void setSamplerState(uint32_t idx, SamplerStateHandle handle)
+    {
+        samplerStates[idx] = handle;
+    }
+
+    SGFX_FORCE_INLINE void setSortKey(uint64_t sortKey)                                         { recorder.setSortKey(sortKey); }
+    SGFX_FORCE_INLINE void resetBindings()                                                      { recorder.resetBindings(); }
+    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)                     { recorder.setPrimitiveTopology(topology); }
+    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle, uint32_t offset = 0)
+    {
+        recorder.setVertexBuffer(idx, handle, offset);
+    }
+    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle, uint32_t offset = 0, IndexFormat format = IndexFormat::UInt32)
+    {
+        recorder.setIndexBuffer(handle, offset, format);
+    }
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle resource)       { recorder.setConstantBuffer(idx, resource); }
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t idx, ConstantBufferHandle resource, uint32_t offset, uint32_t size)
+    {
+        recorder.setConstantBufferRange(idx, resource, offset, size);
+    }
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, BufferHandle resource)                     { recorder.setResource(idx, resource); }
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, TextureHandle resource)                    { recorder.setResource(idx, resource); }
+    SGFX_FORCE_INLINE void setResourceTable(uint32_t firstSlot, ResourceTableHandle table)      { recorder.setResourceTable(firstSlot, table); }
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t idx, const void* data, size_t size)      { recorder.setInlineConstants(idx, data, size); }
+
+    SGFX_FORCE_INLINE void draw(uint32_t count, uint32_t startVertex)
+    {
+        recorder.draw(count, startVertex);
+    }
+
+    SGFX_FORCE_INLINE void drawIndexed(uint32_t count, uint32_t startIndex, uint32_t startVertex)
+    {
+        recorder.drawIndexed(count, startIndex, startVertex);
+    }
+
+    SGFX_FORCE_INLINE void drawInstanced(uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+    {
+        recorder.drawInstanced(instanceCount, count, startVertex, startInstance);
     }
 
     SGFX_FORCE_INLINE void drawIndexedInstanced(uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
     {
-        currentDrawCall.instanceCount = instanceCount;
-        currentDrawCall.count         = count;
-        currentDrawCall.startVertex   = startVertex;
-        currentDrawCall.startIndex    = startIndex;
-        currentDrawCall.startInstance = startInstance;
-        currentDrawCall.type          = DrawCall::DrawIndexedInstanced;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        recorder.drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
     }
 
     SGFX_FORCE_INLINE void drawInstancedIndirect(BufferHandle indirectArgs, size_t argsOffset)
     {
-        currentDrawCall.type                = DrawCall::DrawInstancedIndirect;
-        currentDrawCall.indirectArgsBuffer  = indirectArgs;
-        currentDrawCall.indirectArgsOffset  = argsOffset;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        recorder.drawInstancedIndirect(indirectArgs, argsOffset);
     }
 
     SGFX_FORCE_INLINE void drawIndexedInstancedIndirect(BufferHandle indirectArgs, size_t argsOffset)
     {
-        currentDrawCall.type                = DrawCall::DrawIndexedInstancedIndirect;
-        currentDrawCall.indirectArgsBuffer  = indirectArgs;
-        currentDrawCall.indirectArgsOffset  = argsOffset;
-        drawCalls.Add(currentDrawCall);
-        std::memset(&currentDrawCall, 0, sizeof(currentDrawCall));
+        recorder.drawIndexedInstancedIndirect(indirectArgs, argsOffset);
+    }
+};
+
+inline DrawRecorder::~DrawRecorder()
+{
+    if (queue != nullptr)
+        queue->detachRecorder(this);
+}
+
+///
+/// DrawBundle holds draws baked out of a DrawQueue, they are replayed until the bundle is released.
+///
+/// Baking diffs consecutive draws once (see bakeDrawCalls), the backend stores only the binds that
+/// change, already resolved to native objects in its own Command type. Resolved objects are not
+/// reference counted: every command keeps the handle it was resolved from, and the backend checks
+/// those again before a replay whenever objects were released since the last check. A bundle that
+/// references a released object stays invalid and is never replayed.
+///
+template <typename Command>
+struct DrawBundle final
+{
+    PipelineStateHandle             state;
+    SamplerStateHandle              samplerStates[DrawQueue::kMaxSamplerStates];
+    DynamicArray<Command, 1, 256>   commands;
+    DynamicArray<uint32_t, 1, 256>  constantData; // inline constants of the commands
+
+    uint32_t                        numDrawCalls = 0;
+    uint32_t                        numReleases  = 0; // releases seen by the last validation
+    bool                            isValid      = true;
+
+    inline DrawBundle(const DrawQueue& queue)
+        : state(queue.getState())
+    {
+        for (uint32_t i = 0; i < DrawQueue::kMaxSamplerStates; ++i)
+            samplerStates[i] = queue.samplerStates[i];
+    }
+
+    // copies inline constants into the bundle, returns their offset in constantData
+    inline uint32_t addConstantData(const uint32_t* data, uint32_t size)
+    {
+        size_t offset = constantData.GetSize();
+        constantData.Resize(offset + size / sizeof(uint32_t));
+        std::memcpy(constantData.GetData() + offset, data, size);
+        return static_cast<uint32_t>(offset);
+    }
+};
+
+///
+/// DrawBundlePendingBinds defers the bind commands of a bundle during a masked replay.
+///
+/// Binds that come before hidden draws are not executed, only the latest bind command of every
+/// slot is kept and executed before the next visible draw, so visible draws see the same state
+/// they would see in a full replay. Commands only need the opcode and slot fields.
+///
+template <typename Command>
+struct DrawBundlePendingBinds final
+{
+    const Command*  topology       = nullptr;
+    const Command*  indexBuffer    = nullptr;
+    const Command*  vertexBuffers[DrawCall::kMaxVertexBuffers];
+    const Command*  constantBuffers[DrawCall::kMaxConstantBuffers];
+    const Command*  resources[DrawCall::kMaxShaderResources];
+
+    uint32_t        vertexBufferMask   = 0;
+    uint32_t        constantBufferMask = 0;
+    uint64_t        resourceMask[2]    = { 0, 0 };
+
+    SGFX_FORCE_INLINE void add(const Command& command)
+    {
+        switch (command.opcode) {
+        case DrawCommand::SetPrimitiveTopology: { topology    = &command; } break;
+        case DrawCommand::SetIndexBuffer:       { indexBuffer = &command; } break;
+
+        case DrawCommand::SetVertexBuffer: {
+            vertexBuffers[command.slot] = &command;
+            vertexBufferMask |= 1u << command.slot;
+        } break;
+
+        case DrawCommand::SetConstantBuffer:
+        case DrawCommand::SetInlineConstants: {
+            constantBuffers[command.slot] = &command;
+            constantBufferMask |= 1u << command.slot;
+        } break;
+
+        case DrawCommand::SetResource: {
+            resources[command.slot] = &command;
+            resourceMask[command.slot / 64] |= 1ull << (command.slot % 64);
+        } break;
+
+        default: {} break;
+        }
+    }
+
+    // executes the pending binds, in no particular order as every slot is independent
+    template <typename Executor>
+    inline void flush(Executor& executor)
+    {
+        if (topology != nullptr) {
+            executor(*topology);
+            topology = nullptr;
+        }
+
+        if (indexBuffer != nullptr) {
+            executor(*indexBuffer);
+            indexBuffer = nullptr;
+        }
+
+        for (; vertexBufferMask != 0; vertexBufferMask &= vertexBufferMask - 1)
+            executor(*vertexBuffers[bitScanForward(vertexBufferMask)]);
+
+        for (; constantBufferMask != 0; constantBufferMask &= constantBufferMask - 1)
+            executor(*constantBuffers[bitScanForward(constantBufferMask)]);
+
+        for (uint32_t word = 0; word < 2; ++word) {
+            for (; resourceMask[word] != 0; resourceMask[word] &= resourceMask[word] - 1)
+                executor(*resources[word * 64 + bitScanForward(resourceMask[word])]);
+        }
     }
 };
 
+// replays the commands of a bundle through the executor, with a visibility mask only the
+// visible draws are executed, bit i of visibilityMask[i / 64] is draw i in recording order
+template <typename Command, typename Executor>
+inline void replayBundle(const DrawBundle<Command>& bundle, const uint64_t* visibilityMask, Executor& executor)
+{
+    if (visibilityMask == nullptr) {
+        for (const Command& command : bundle.commands)
+            executor(command);
+        return;
+    }
+
+    DrawBundlePendingBinds<Command> pending;
+    uint32_t                        drawIndex = 0;
+
+    for (const Command& command : bundle.commands) {
+        if (command.opcode != DrawCommand::Draw) {
+            pending.add(command);
+            continue;
+        }
+
+        bool isVisible = ((visibilityMask[drawIndex / 64] >> (drawIndex % 64)) & 1) != 0;
+        drawIndex++;
+
+        if (isVisible) {
+            pending.flush(executor);
+            executor(command);
+        }
+    }
+}
+
+// walks the draws recorded into the queue and calls the baker for every bind that changes from
+// one draw to the next, then for the draw itself; the state before the first draw is unknown,
+// so it gets its topology and index buffer and every other slot it uses
+// resource tables are flattened into single resource binds, baker.getResourceTable() resolves them
+// inline constants are handed out as baker.setInlineConstants(), the baker copies them, buffer
+// ranges as baker.setConstantBufferRange(), vertex and index buffers come with their offset and
+// index buffers with their IndexFormat
+template <typename Baker>
+inline void bakeDrawCalls(DrawQueue* queue, Baker& baker)
+{
+    DrawCall       previous;
+    ShaderResource previousResources[DrawCall::kMaxShaderResources];
+    bool           isFirst = true;
+
+    for (const DrawCall& call : queue->getDrawCalls()) {
+        if (isFirst || call.primitiveTopology != previous.primitiveTopology)
+            baker.setPrimitiveTopology(call.primitiveTopology);
+
+        if (isFirst || call.indexBuffer.value != previous.indexBuffer.value || call.indexBufferOffset != previous.indexBufferOffset || call.indexFormat != previous.indexFormat)
+            baker.setIndexBuffer(call.indexBuffer, call.indexBufferOffset, call.indexFormat);
+
+        for (uint32_t i = 0; i < DrawCall::kMaxVertexBuffers; ++i) {
+            if (call.vertexBuffers[i].value != previous.vertexBuffers[i].value || (!isFirst && call.vertexBufferOffsets[i] != previous.vertexBufferOffsets[i]))
+                baker.setVertexBuffer(i, call.vertexBuffers[i], call.vertexBufferOffsets[i]);
+        }
+
+        for (uint32_t i = 0; i < DrawCall::kMaxConstantBuffers; ++i) {
+            bool isInline  = ((call.inlineConstantMask >> i) & 1) != 0;
+            bool wasInline = !isFirst && ((previous.inlineConstantMask >> i) & 1) != 0;
+
+            if (isInline) {
+                if (!wasInline || call.inlineConstants[i] != previous.inlineConstants[i])
+                    baker.setInlineConstants(i, call.inlineConstants[i], call.inlineConstantsSize[i]);
+            } else if (wasInline || call.constantBuffers[i].value != previous.constantBuffers[i].value
+                || (!isFirst && (call.constantBufferOffsets[i] != previous.constantBufferOffsets[i] || call.constantBufferSizes[i] != previous.constantBufferSizes[i]))) {
+                if (call.constantBufferSizes[i] != 0)
+                    baker.setConstantBufferRange(i, call.constantBuffers[i], call.constantBufferOffsets[i], call.constantBufferSizes[i]);
+                else
+                    baker.setConstantBuffer(i, call.constantBuffers[i]);
+            }
+        }
+
+        const ResourceTable* table         = baker.getResourceTable(call.resourceTable);
+        uint32_t             numTableSlots = (table != nullptr) ? table->getNumSlots(call.resourceTableSlot) : 0;
+
+        for (uint32_t i = 0; i < DrawCall::kMaxShaderResources; ++i) {
+            ShaderResource resource = call.shaderResources[i];
+            if (resource.value == 0 && i - call.resourceTableSlot < numTableSlots)
+                resource = table->resources[i - call.resourceTableSlot];
+
+            if (resource.value != previousResources[i].value || resource.isTexture != previousResources[i].isTexture) {
+                previousResources[i] = resource;
+                baker.setResource(i, resource);
+            }
+        }
+
+        baker.draw(call);
+
+        previous = call;
+        isFirst  = false;
+    }
+}
+
 struct ComputeQueue final
 {
     enum
@@ -1126,6 +5867,7 @@ struct ComputeQueue final
     ShaderResource          shaderResourcesRW[kMaxShaderResourcesRW];
 
     ComputeShaderHandle     shader;
+    StageBindingLayout      layout; // set by createComputeQueue
 
     SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle resource)
     {
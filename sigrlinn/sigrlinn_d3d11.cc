@@ -61,9 +61,12 @@ namespace sgfx
 
 using namespace SGFX_NS_INTERNAL;
 
+// CPUWrite buffers are dynamic, they can't be mapped with a plain D3D11_MAP_WRITE
 static D3D11_MAP MapMapType[MapType::Count] = {
     D3D11_MAP_READ,
-    D3D11_MAP_WRITE_DISCARD
+    D3D11_MAP_WRITE_DISCARD,
+    D3D11_MAP_WRITE_DISCARD,
+    D3D11_MAP_WRITE_NO_OVERWRITE
 };
 static_assert((sizeof(MapMapType) / sizeof(D3D11_MAP)) == static_cast<uint32_t>(MapType::Count), "Mapping is broken!");
 
@@ -74,6 +77,12 @@ static D3D11_PRIMITIVE_TOPOLOGY MapPrimitiveTopology[PrimitiveTopology::Count] =
 };
 static_assert((sizeof(MapPrimitiveTopology) / sizeof(D3D11_PRIMITIVE_TOPOLOGY)) == static_cast<size_t>(PrimitiveTopology::Count), "Mapping is broken!");
 
+static DXGI_FORMAT MapIndexFormat[IndexFormat::Count] = {
+    DXGI_FORMAT_R32_UINT,
+    DXGI_FORMAT_R16_UINT
+};
+static_assert((sizeof(MapIndexFormat) / sizeof(DXGI_FORMAT)) == static_cast<size_t>(IndexFormat::Count), "Mapping is broken!");
+
 static D3D11_FILTER MapTextureFilter[TextureFilter::Count] = {
     D3D11_FILTER_MIN_MAG_MIP_POINT,
     D3D11_FILTER_MIN_MAG_POINT_MIP_LINEAR,
@@ -238,9 +247,14 @@ AllocFunc             g_allocFunc = sgfx_malloc;
 FreeFunc              g_freeFunc  = sgfx_free;
 
 #ifdef SGFX_USE_D3D11_1
-ID3DUserDefinedAnnotation* g_debugAnnotation = nullptr;
+ID3DUserDefinedAnnotation* g_debugAnnotation    = nullptr;
+ID3D11DeviceContext1*      g_pImmediateContext1 = nullptr; // constant buffer offsets and partial updates
 #endif
 
+// set by initD3D11 when the device binds constant buffers at an offset and updates part of them,
+// the D3D11.0 paths are taken otherwise whatever the build
+static bool g_constantBufferOffsets = false;
+
 //=============================================================================
 struct DXSharedBuffer final
 {
@@ -310,7 +324,245 @@ struct DXSharedBuffer final
     }
 };
 
+// resource table with its views resolved at creation, the views hold a reference each
+struct DXResourceTable final
+{
+    ResourceTable               table;
+    ID3D11ShaderResourceView*   views[ResourceTable::kMaxResources];
+};
+
+// without partial updates a ranged update uploads the whole buffer, the shadow copy keeps the
+// bytes outside of the range
+struct DXConstantBuffer final
+{
+    ID3D11Buffer* buffer = nullptr;
+    uint8_t*      shadow = nullptr;
+
+    SGFX_FORCE_INLINE DXConstantBuffer(ID3D11Buffer* newBuffer, uint8_t* newShadow)
+        : buffer(newBuffer)
+        , shadow(newShadow)
+    {}
+
+    SGFX_FORCE_INLINE ~DXConstantBuffer()
+    {
+        if (shadow != nullptr)
+            g_freeFunc(shadow);
+    }
+
+    DXConstantBuffer(const DXConstantBuffer& other) = delete;
+    DXConstantBuffer& operator=(const DXConstantBuffer& other) = delete;
+};
+
+// native objects referenced by draw calls, the state cache resolves handles through these
+static HandleTable<DXSharedBuffer>          g_sharedBuffers; // buffers and textures
+static HandleTable<DXResourceTable>         g_resourceTables;
+static HandleTable<DXConstantBuffer>        g_constantBuffers;
+static HandleTable<ID3D11SamplerState*>     g_samplerStates;
+static HandleTable<ID3D11VertexShader*>     g_vertexShaders;
+static HandleTable<ID3D11HullShader*>       g_hullShaders;
+static HandleTable<ID3D11DomainShader*>     g_domainShaders;
+static HandleTable<ID3D11GeometryShader*>   g_geometryShaders;
+static HandleTable<ID3D11PixelShader*>      g_pixelShaders;
+static HandleTable<ID3D11ComputeShader*>    g_computeShaders;
+static HandleTable<ConstantBlockAllocator>  g_constantAllocators;
+static HandleTable<BufferHeapAllocator>     g_bufferHeaps;
+
+static TransientRing                        g_transientRing;
+
+// the buffer behind a constant buffer handle, nullptr for the invalid handle
+static SGFX_FORCE_INLINE ID3D11Buffer* dxGetConstantBuffer(uint32_t handle)
+{
+    DXConstantBuffer* constantBuffer = g_constantBuffers.Get(handle);
+    return (constantBuffer != nullptr) ? constantBuffer->buffer : nullptr;
+}
+
 //=============================================================================
+// inline constants, see setInlineConstants
+static ID3D11Buffer* dxCreateDynamicConstantBuffer(UINT size)
+{
+    D3D11_BUFFER_DESC bufferDesc;
+    std::memset(&bufferDesc, 0, sizeof(bufferDesc));
+    bufferDesc.ByteWidth      = size;
+    bufferDesc.Usage          = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    ID3D11Buffer* buffer = nullptr;
+    if (FAILED(g_pd3dDevice->CreateBuffer(&bufferDesc, nullptr, &buffer))) {
+        // TODO: error handling
+        return nullptr;
+    }
+    return buffer;
+}
+
+#ifdef SGFX_USE_D3D11_1
+// all inline constants are streamed into one buffer and bound with their offset
+enum
+{
+    kInlineConstantRingSize = 1 << 20
+};
+
+struct DXConstantRing final
+{
+    ID3D11Buffer* buffer = nullptr;
+    StreamRing    ring;
+};
+
+static DXConstantRing g_inlineConstantRing;
+#endif
+
+// D3D11.0 cannot bind constant buffers at an offset, every slot gets a buffer of its own
+static ID3D11Buffer* g_inlineConstantBuffers[DrawCall::kMaxConstantBuffers] = { nullptr };
+
+// the buffer the inline constants of slot i are bound from
+static SGFX_FORCE_INLINE ID3D11Buffer* dxGetInlineConstantsBuffer(UINT i)
+{
+#ifdef SGFX_USE_D3D11_1
+    if (g_constantBufferOffsets) {
+        if (g_inlineConstantRing.buffer == nullptr) {
+            g_inlineConstantRing.buffer        = dxCreateDynamicConstantBuffer(kInlineConstantRingSize);
+            g_inlineConstantRing.ring.capacity = kInlineConstantRingSize;
+        }
+        return g_inlineConstantRing.buffer;
+    }
+#endif
+
+    if (g_inlineConstantBuffers[i] == nullptr)
+        g_inlineConstantBuffers[i] = dxCreateDynamicConstantBuffer(DrawCall::kMaxInlineConstantsSize);
+    return g_inlineConstantBuffers[i];
+}
+
+// returns the offset the constants were written to, wrapped is set if the ring started over
+static size_t dxStreamInlineConstants(UINT i, const uint32_t* data, uint32_t size, bool& wrapped)
+{
+    ID3D11Buffer* buffer = dxGetInlineConstantsBuffer(i);
+    if (buffer == nullptr)
+        return 0;
+
+    size_t    offset  = 0;
+    D3D11_MAP mapType = D3D11_MAP_WRITE_DISCARD;
+
+#ifdef SGFX_USE_D3D11_1
+    if (g_constantBufferOffsets) {
+        if (g_inlineConstantRing.ring.allocate(DrawCall::kMaxInlineConstantsSize, DrawCall::kInlineConstantsAlign, offset))
+            wrapped = true;
+        else
+            mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+    }
+#else
+    (void)wrapped;
+#endif
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (SUCCEEDED(g_pImmediateContext->Map(buffer, 0, mapType, 0, &mapped))) {
+        std::memcpy(static_cast<uint8_t*>(mapped.pData) + offset, data, size);
+        g_pImmediateContext->Unmap(buffer, 0);
+
+        SGFX_STAT(numBytesUploaded, size);
+    }
+
+    return offset;
+}
+
+//=============================================================================
+// binds the ranges handed out by ShadowBindings to the shader stages a pipeline uses
+// every stage only receives the part of a range its binding layout reads
+struct DXStageBinder final
+{
+    bool isCompute = false;
+
+    bool vs = false;
+    bool hs = false;
+    bool ds = false;
+    bool gs = false;
+    bool ps = false;
+
+    SurfaceBindingLayout layout;
+
+    SGFX_FORCE_INLINE void operator()(UINT first, UINT count, ID3D11SamplerState* const* states) const
+    {
+        if (isCompute) {
+            g_pImmediateContext->CSSetSamplers(first, count, states);
+            return;
+        }
+
+        UINT stageFirst = 0;
+        UINT stageCount = 0;
+        if (vs && trimRange(&layout.vs.samplers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->VSSetSamplers(stageFirst, stageCount, states + (stageFirst - first));
+        if (hs && trimRange(&layout.hs.samplers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->HSSetSamplers(stageFirst, stageCount, states + (stageFirst - first));
+        if (ds && trimRange(&layout.ds.samplers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->DSSetSamplers(stageFirst, stageCount, states + (stageFirst - first));
+        if (gs && trimRange(&layout.gs.samplers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->GSSetSamplers(stageFirst, stageCount, states + (stageFirst - first));
+        if (ps && trimRange(&layout.ps.samplers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->PSSetSamplers(stageFirst, stageCount, states + (stageFirst - first));
+    }
+
+    SGFX_FORCE_INLINE void operator()(UINT first, UINT count, ID3D11Buffer* const* buffers) const
+    {
+        if (isCompute) {
+            g_pImmediateContext->CSSetConstantBuffers(first, count, buffers);
+            return;
+        }
+
+        UINT stageFirst = 0;
+        UINT stageCount = 0;
+        if (vs && trimRange(&layout.vs.constantBuffers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->VSSetConstantBuffers(stageFirst, stageCount, buffers + (stageFirst - first));
+        if (hs && trimRange(&layout.hs.constantBuffers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->HSSetConstantBuffers(stageFirst, stageCount, buffers + (stageFirst - first));
+        if (ds && trimRange(&layout.ds.constantBuffers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->DSSetConstantBuffers(stageFirst, stageCount, buffers + (stageFirst - first));
+        if (gs && trimRange(&layout.gs.constantBuffers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->GSSetConstantBuffers(stageFirst, stageCount, buffers + (stageFirst - first));
+        if (ps && trimRange(&layout.ps.constantBuffers, first, count, stageFirst, stageCount))
+            g_pImmediateContext->PSSetConstantBuffers(stageFirst, stageCount, buffers + (stageFirst - first));
+    }
+
+    SGFX_FORCE_INLINE void operator()(UINT first, UINT count, ID3D11ShaderResourceView* const* views) const
+    {
+        if (isCompute) {
+            g_pImmediateContext->CSSetShaderResources(first, count, views);
+            return;
+        }
+
+        UINT stageFirst = 0;
+        UINT stageCount = 0;
+        if (vs && trimRange(layout.vs.shaderResources, first, count, stageFirst, stageCount))
+            g_pImmediateContext->VSSetShaderResources(stageFirst, stageCount, views + (stageFirst - first));
+        if (hs && trimRange(layout.hs.shaderResources, first, count, stageFirst, stageCount))
+            g_pImmediateContext->HSSetShaderResources(stageFirst, stageCount, views + (stageFirst - first));
+        if (ds && trimRange(layout.ds.shaderResources, first, count, stageFirst, stageCount))
+            g_pImmediateContext->DSSetShaderResources(stageFirst, stageCount, views + (stageFirst - first));
+        if (gs && trimRange(layout.gs.shaderResources, first, count, stageFirst, stageCount))
+            g_pImmediateContext->GSSetShaderResources(stageFirst, stageCount, views + (stageFirst - first));
+        if (ps && trimRange(layout.ps.shaderResources, first, count, stageFirst, stageCount))
+            g_pImmediateContext->PSSetShaderResources(stageFirst, stageCount, views + (stageFirst - first));
+    }
+
+#ifdef SGFX_USE_D3D11_1
+    // binds size bytes of the buffer at byte offset to the stages that read slot, both multiples of 256
+    SGFX_FORCE_INLINE void bindConstantWindow(UINT slot, ID3D11Buffer* buffer, UINT offset, UINT size) const
+    {
+        UINT firstConstant = offset / 16;
+        UINT numConstants  = size / 16;
+
+        if (vs && ((layout.vs.constantBuffers >> slot) & 1))
+            g_pImmediateContext1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+        if (hs && ((layout.hs.constantBuffers >> slot) & 1))
+            g_pImmediateContext1->HSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+        if (ds && ((layout.ds.constantBuffers >> slot) & 1))
+            g_pImmediateContext1->DSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+        if (gs && ((layout.gs.constantBuffers >> slot) & 1))
+            g_pImmediateContext1->GSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+        if (ps && ((layout.ps.constantBuffers >> slot) & 1))
+            g_pImmediateContext1->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+    }
+#endif
+};
+
 struct DXStateCache final
 {
     enum
@@ -319,114 +571,268 @@ struct DXStateCache final
         SC_Compute = 1
     };
 
-    uint32_t type;
-
-    ID3D11SamplerState*         samplerStates[DrawQueue::kMaxSamplerStates];
-    ID3D11Buffer*               constantBuffers[DrawCall::kMaxConstantBuffers];
-    ID3D11ShaderResourceView*   shaderResourceViews[DrawCall::kMaxShaderResources];
+    ShadowBindings<ID3D11SamplerState*, DrawQueue::kMaxSamplerStates>           samplerStates;
+    ShadowBindings<ID3D11Buffer*, DrawCall::kMaxConstantBuffers>                constantBuffers;
+    ShadowBindings<ID3D11ShaderResourceView*, DrawCall::kMaxShaderResources>    shaderResourceViews;
     ID3D11UnorderedAccessView*  shaderUAVs[ComputeQueue::kMaxShaderResourcesRW];
     uint32_t                    shaderUAVCounters[ComputeQueue::kMaxShaderResourcesRW];
 
-    bool vs = false;
-    bool hs = false;
-    bool ds = false;
-    bool gs = false;
-    bool ps = false;
+    DXStageBinder      stages;
+    StageBindingLayout layout; // union of the stage layouts
+
+    // slots bound to a window of their buffer (buffer ranges and inline constants in the ring),
+    // byte offset and size of the window, windows that changed are bound at the next flush
+    UINT               constantWindowOffsets[DrawCall::kMaxConstantBuffers];
+    UINT               constantWindowSizes[DrawCall::kMaxConstantBuffers];
+    uint32_t           constantWindowMask  = 0;
+    uint32_t           constantWindowBinds = 0;
 
-    SGFX_FORCE_INLINE DXStateCache(uint32_t newType)
+    // inline constants of every slot, slots that need streaming are flagged until the next flush
+    const uint32_t*    inlineConstants[DrawCall::kMaxConstantBuffers];
+    uint32_t           inlineConstantsSize[DrawCall::kMaxConstantBuffers];
+    uint32_t           inlineConstantMask    = 0;
+    uint32_t           inlineConstantUploads = 0;
+
+    SGFX_FORCE_INLINE DXStateCache(uint32_t type)
     {
-        clear();
+        std::memset(shaderUAVs, 0, sizeof(shaderUAVs));
+        std::memset(shaderUAVCounters, 0, sizeof(shaderUAVCounters));
+        std::memset(inlineConstants, 0, sizeof(inlineConstants));
 
-        type = newType;
+        stages.isCompute = (type == SC_Compute);
     }
 
+    // called once the stages are known, slots no stage reads are never bound
+    SGFX_FORCE_INLINE void setLayout(const SurfaceBindingLayout& surfaceLayout)
+    {
+        stages.layout = surfaceLayout;
+
+        layout = StageBindingLayout();
+        if (stages.vs) mergeBindingLayout(layout, surfaceLayout.vs);
+        if (stages.hs) mergeBindingLayout(layout, surfaceLayout.hs);
+        if (stages.ds) mergeBindingLayout(layout, surfaceLayout.ds);
+        if (stages.gs) mergeBindingLayout(layout, surfaceLayout.gs);
+        if (stages.ps) mergeBindingLayout(layout, surfaceLayout.ps);
+
+        samplerStates.setUsedSlots(&layout.samplers);
+        constantBuffers.setUsedSlots(&layout.constantBuffers);
+        shaderResourceViews.setUsedSlots(layout.shaderResources);
+    }
+
+    // unbinds the shader resources and forgets the rest, the next queue may use another cache
     SGFX_FORCE_INLINE void clear()
     {
-        std::memset(samplerStates, 0, sizeof(samplerStates));
-        std::memset(constantBuffers, 0, sizeof(constantBuffers));
-        std::memset(shaderResourceViews, 0, sizeof(shaderResourceViews));
+        shaderResourceViews.unbindAll();
+        shaderResourceViews.flush(stages);
+
+        samplerStates.reset();
+        constantBuffers.reset();
+
         std::memset(shaderUAVs, 0, sizeof(shaderUAVs));
         std::memset(shaderUAVCounters, 0, sizeof(shaderUAVCounters));
 
-        if (vs) g_pImmediateContext->VSSetShaderResources(0, DrawCall::kMaxShaderResources, shaderResourceViews);
-        if (hs) g_pImmediateContext->HSSetShaderResources(0, DrawCall::kMaxShaderResources, shaderResourceViews);
-        if (ds) g_pImmediateContext->DSSetShaderResources(0, DrawCall::kMaxShaderResources, shaderResourceViews);
-        if (gs) g_pImmediateContext->GSSetShaderResources(0, DrawCall::kMaxShaderResources, shaderResourceViews);
-        if (ps) g_pImmediateContext->PSSetShaderResources(0, DrawCall::kMaxShaderResources, shaderResourceViews);
+        dropConstantWindows(constantWindowMask);
     }
 
     SGFX_FORCE_INLINE void setSamplerStates(const SamplerStateHandle* handles)
     {
-        for (UINT i = 0; i < DrawQueue::kMaxSamplerStates; ++i) {
-            ID3D11SamplerState* state = static_cast<ID3D11SamplerState*>(handles[i].value);
-            if (state != samplerStates[i]) {
-                samplerStates[i] = state;
-
-                if (type == SC_Draw) {
-                    if (vs) g_pImmediateContext->VSSetSamplers(i, 1, &state);
-                    if (hs) g_pImmediateContext->HSSetSamplers(i, 1, &state);
-                    if (ds) g_pImmediateContext->DSSetSamplers(i, 1, &state);
-                    if (gs) g_pImmediateContext->GSSetSamplers(i, 1, &state);
-                    if (ps) g_pImmediateContext->PSSetSamplers(i, 1, &state);
-                }
+        for (UINT i = 0; i < DrawQueue::kMaxSamplerStates; ++i)
+            samplerStates.set(i, g_samplerStates.GetValue(handles[i].value));
 
-                if (type == SC_Compute)
-                    g_pImmediateContext->CSSetSamplers(i, 1, &state);
+        samplerStates.flush(stages);
+    }
+
+    SGFX_FORCE_INLINE void dropInlineConstants(uint32_t mask)
+    {
+        inlineConstantMask    &= ~mask;
+        inlineConstantUploads &= ~mask;
+
+        for (; mask != 0; mask &= mask - 1)
+            inlineConstants[bitScanForward(mask)] = nullptr;
+    }
+
+    SGFX_FORCE_INLINE void dropConstantWindows(uint32_t mask)
+    {
+        constantWindowMask  &= ~mask;
+        constantWindowBinds &= ~mask;
+        dropInlineConstants(inlineConstantMask & mask);
+    }
+
+    // the whole buffer, a slot holding a window is bound again even if the buffer stays the same
+    SGFX_FORCE_INLINE void setConstantBuffer(UINT i, ID3D11Buffer* state)
+    {
+        if ((constantWindowMask | inlineConstantMask) & (1u << i)) {
+            dropConstantWindows(1u << i);
+            constantBuffers.invalidate(i);
+        }
+        constantBuffers.set(i, state);
+    }
+
+    // windows are bound by bindConstantWindows(), the shadow copy only learns about the buffer
+    // D3D11.0 binds whole buffers, its windows always start at offset 0 (see getGPUCaps)
+    SGFX_FORCE_INLINE void setConstantWindow(UINT i, ID3D11Buffer* state, UINT offset, UINT size)
+    {
+        uint32_t bit = 1u << i;
+
+        if (g_constantBufferOffsets) {
+            if ((constantWindowMask & bit) == 0 || constantBuffers.get(i) != state
+                || constantWindowOffsets[i] != offset || constantWindowSizes[i] != size) {
+                constantBuffers.assume(i, state);
+                constantWindowOffsets[i] = offset;
+                constantWindowSizes[i]   = size;
+                constantWindowBinds |= bit;
             }
+        } else {
+            constantBuffers.set(i, state);
+            constantWindowOffsets[i] = offset;
+            constantWindowSizes[i]   = size;
         }
+
+        constantWindowMask |= bit;
     }
 
-    SGFX_FORCE_INLINE void setConstantBuffers(const ConstantBufferHandle* handles)
+    SGFX_FORCE_INLINE void setConstantBufferRange(UINT i, ID3D11Buffer* state, UINT offset, UINT size)
     {
-        for (UINT i = 0; i < DrawCall::kMaxConstantBuffers; ++i) {
-            ID3D11Buffer* state = static_cast<ID3D11Buffer*>(handles[i].value);
-            if (state != constantBuffers[i]) {
-                constantBuffers[i] = state;
-
-                if (type == SC_Draw) {
-                    if (vs) g_pImmediateContext->VSSetConstantBuffers(i, 1, &state);
-                    if (hs) g_pImmediateContext->HSSetConstantBuffers(i, 1, &state);
-                    if (ds) g_pImmediateContext->DSSetConstantBuffers(i, 1, &state);
-                    if (gs) g_pImmediateContext->GSSetConstantBuffers(i, 1, &state);
-                    if (ps) g_pImmediateContext->PSSetConstantBuffers(i, 1, &state);
-                }
+        if ((layout.constantBuffers & (1u << i)) == 0)
+            return;
 
-                if (type == SC_Compute)
-                    g_pImmediateContext->CSSetConstantBuffers(i, 1, &state);
-            }
+        if (state == nullptr) {
+            setConstantBuffer(i, nullptr);
+            return;
         }
+
+        // D3D11.1 binds multiples of 16 constants
+        dropInlineConstants(inlineConstantMask & (1u << i));
+        setConstantWindow(i, state, offset, (size + 255) & ~255u);
     }
 
-    SGFX_FORCE_INLINE void setShaderResources(const ShaderResource* resources)
+    // data must stay put until the next flush, constants at the same address are streamed once
+    SGFX_FORCE_INLINE void setInlineConstants(UINT i, const uint32_t* data, uint32_t size)
     {
-        for (UINT i = 0; i < DrawCall::kMaxShaderResources; ++i) {
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(resources[i].value);
+        uint32_t bit = 1u << i;
+        if ((layout.constantBuffers & bit) == 0)
+            return;
 
-            ID3D11ShaderResourceView* state = nullptr;
-            if (buffer != nullptr)
-                state = buffer->dataView;
+        if (inlineConstants[i] != data) {
+            inlineConstants[i]     = data;
+            inlineConstantsSize[i] = size;
+            inlineConstantUploads |= bit;
+        }
+
+        inlineConstantMask |= bit;
+    }
 
-            if (state != shaderResourceViews[i]) {
-                shaderResourceViews[i] = state;
+    SGFX_FORCE_INLINE void setConstantBuffers(const DrawCall& call)
+    {
+        uint64_t mask = (call.constantBufferMask | call.inlineConstantMask) & layout.constantBuffers;
+        constantBuffers.unbindExcept(&mask);
+        dropConstantWindows(constantWindowMask & ~static_cast<uint32_t>(mask));
+
+        while (mask != 0) {
+            UINT i = bitScanForward(mask);
+            ID3D11Buffer* buffer = dxGetConstantBuffer(call.constantBuffers[i].value);
+
+            if (call.inlineConstantMask & (1u << i))
+                setInlineConstants(i, call.inlineConstants[i], call.inlineConstantsSize[i]);
+            else if (call.constantBufferSizes[i] != 0)
+                setConstantBufferRange(i, buffer, call.constantBufferOffsets[i], call.constantBufferSizes[i]);
+            else
+                setConstantBuffer(i, buffer);
+            mask &= mask - 1;
+        }
+    }
 
-                if (type == SC_Draw) {
-                    if (vs) g_pImmediateContext->VSSetShaderResources(i, 1, &state);
-                    if (hs) g_pImmediateContext->HSSetShaderResources(i, 1, &state);
-                    if (ds) g_pImmediateContext->DSSetShaderResources(i, 1, &state);
-                    if (gs) g_pImmediateContext->GSSetShaderResources(i, 1, &state);
-                    if (ps) g_pImmediateContext->PSSetShaderResources(i, 1, &state);
+    SGFX_FORCE_INLINE bool streamInlineConstants(uint32_t mask)
+    {
+        bool wrapped = false;
+        for (; mask != 0; mask &= mask - 1) {
+            UINT   i      = bitScanForward(mask);
+            size_t offset = dxStreamInlineConstants(i, inlineConstants[i], inlineConstantsSize[i], wrapped);
+            setConstantWindow(i, dxGetInlineConstantsBuffer(i), static_cast<UINT>(offset), DrawCall::kMaxInlineConstantsSize);
+        }
+        return wrapped;
+    }
+
+    // ranges streamed before the ring started over are gone, so a wrap restreams every slot
+    inline void uploadInlineConstants()
+    {
+        if (streamInlineConstants(inlineConstantUploads))
+            streamInlineConstants(inlineConstantMask);
+
+        inlineConstantUploads = 0;
+    }
+
+    SGFX_FORCE_INLINE void bindConstantWindows()
+    {
+#ifdef SGFX_USE_D3D11_1
+        for (; constantWindowBinds != 0; constantWindowBinds &= constantWindowBinds - 1) {
+            UINT i = bitScanForward(constantWindowBinds);
+            stages.bindConstantWindow(i, constantBuffers.get(i), constantWindowOffsets[i], constantWindowSizes[i]);
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, 1);
+        }
+#endif
+    }
+
+    SGFX_FORCE_INLINE void setShaderResource(UINT i, ID3D11ShaderResourceView* state)
+    {
+        shaderResourceViews.set(i, state);
+    }
+
+    // resources set on their own take precedence over the call's resource table
+    SGFX_FORCE_INLINE void setShaderResources(const DrawCall& call)
+    {
+        const DXResourceTable* table = g_resourceTables.Get(call.resourceTable.value);
+
+        UINT tableSlot     = call.resourceTableSlot;
+        UINT numTableSlots = (table != nullptr) ? table->table.getNumSlots(tableSlot) : 0;
+
+        uint64_t masks[2] = { call.shaderResourceMask[0], call.shaderResourceMask[1] };
+        addSlotRange(masks, tableSlot, numTableSlots);
+
+        masks[0] &= layout.shaderResources[0];
+        masks[1] &= layout.shaderResources[1];
+        shaderResourceViews.unbindExcept(masks);
+
+        for (UINT word = 0; word < 2; ++word) {
+            uint64_t mask = masks[word];
+            while (mask != 0) {
+                UINT i = word * 64 + bitScanForward(mask);
+
+                ID3D11ShaderResourceView* state = nullptr;
+                if (call.shaderResources[i].value != 0) {
+                    DXSharedBuffer* buffer = g_sharedBuffers.Get(call.shaderResources[i].value);
+                    if (buffer != nullptr)
+                        state = buffer->dataView;
+                } else if (i - tableSlot < numTableSlots) {
+                    state = table->views[i - tableSlot];
                 }
 
-                if (type == SC_Compute)
-                    g_pImmediateContext->CSSetShaderResources(i, 1, &state);
+                shaderResourceViews.set(i, state);
+                mask &= mask - 1;
             }
         }
     }
 
+    // applies the constant buffer and shader resource changes, called before every draw
+    SGFX_FORCE_INLINE void flush()
+    {
+        if (inlineConstantUploads != 0)
+            uploadInlineConstants();
+
+        if (!constantBuffers.isDirty() && !shaderResourceViews.isDirty() && constantWindowBinds == 0)
+            return;
+
+        constantBuffers.flush(stages);
+        bindConstantWindows();
+        shaderResourceViews.flush(stages);
+    }
+
     SGFX_FORCE_INLINE void setShaderResourcesRW(const ShaderResource* resources)
     {
         for (UINT i = 0; i < ComputeQueue::kMaxShaderResourcesRW; ++i) {
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(resources[i].value);
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(resources[i].value);
 
             ID3D11UnorderedAccessView* state = nullptr;
             if (buffer != nullptr)
@@ -435,8 +841,12 @@ struct DXStateCache final
             if (state != shaderUAVs[i]) {
                 shaderUAVs[i] = state;
 
-                if (type == SC_Compute)
+                if (stages.isCompute) {
                     g_pImmediateContext->CSSetUnorderedAccessViews(i, 1, &state, shaderUAVCounters);
+
+                    SGFX_STAT(numBindCalls, 1);
+                    SGFX_STAT(numBoundSlots, 1);
+                }
             }
         }
     }
@@ -446,6 +856,9 @@ struct DXStateCache final
 struct VertexFormatImpl final
 {
     ID3D11InputLayout* inputLayout;
+
+    // bytes, the elements of a slot packed back to back, used for buffers created without a stride
+    UINT               strides[DrawCall::kMaxVertexBuffers];
 };
 
 struct SurfaceShaderImpl final
@@ -455,6 +868,8 @@ struct SurfaceShaderImpl final
     ID3D11DomainShader*   ds;
     ID3D11GeometryShader* gs;
     ID3D11PixelShader*    ps;
+
+    SurfaceBindingLayout  layout;
 };
 
 struct PipelineStateImpl final
@@ -468,6 +883,8 @@ struct PipelineStateImpl final
 
     // additional stuff passed as parameters
     UINT                     stencilRef;
+    uint32_t                 instanceConstantsSlot = PipelineStateDescriptor::kNoInstancing;
+    uint32_t                 instanceVertexSlot    = 0;
 
     // state cache
     DXStateCache             stateCache = DXStateCache(DXStateCache::SC_Draw);
@@ -501,6 +918,80 @@ struct RenderTargetImpl final
     }
 };
 
+//=============================================================================
+// bundle command, binds are resolved to native objects
+struct DXBundleCommand final
+{
+    DrawCommand::Opcode opcode;
+    uint32_t            slot;   // bind slot, DrawCall::Type for draws
+    uint32_t            handle; // handle the native objects were resolved from, 0 for unbinds and direct draws
+
+    union
+    {
+        D3D11_PRIMITIVE_TOPOLOGY    topology;
+        ID3D11ShaderResourceView*   resource;
+
+        struct
+        {
+            ID3D11Buffer*           buffer;
+            UINT                    offset; // bytes, size 0 binds the whole buffer
+            UINT                    size;
+        } constantBuffer;
+
+        struct
+        {
+            ID3D11Buffer*           buffer;
+            UINT                    stride; // 0 takes the stride of the vertex format
+            UINT                    offset;
+        } vertexBuffer;
+
+        struct
+        {
+            ID3D11Buffer*           buffer;
+            UINT                    offset;
+            DXGI_FORMAT             format;
+        } indexBuffer;
+
+        struct
+        {
+            UINT                    count;
+            UINT                    instanceCount;
+            UINT                    startIndex;
+            UINT                    startVertex;
+            UINT                    startInstance;
+        } draw;
+
+        struct
+        {
+            ID3D11Buffer*           args;
+            ID3D11Buffer*           indirectBuffer;
+            UINT                    offset;
+        } indirect;
+
+        struct
+        {
+            uint32_t                offset; // in the bundle's constantData
+            uint32_t                size;
+        } constants;
+    };
+};
+
+typedef DrawBundle<DXBundleCommand> DXBundle;
+
+//=============================================================================
+// object tables, the handle values index into these
+static HandleTable<VertexFormatImpl>    g_vertexFormats;
+static HandleTable<SurfaceShaderImpl>   g_surfaceShaders;
+static HandleTable<PipelineStateImpl>   g_pipelineStates;
+static HandleTable<RenderTargetImpl>    g_renderTargets;
+static HandleTable<DrawQueue>           g_drawQueues;
+static HandleTable<DrawRecorder>        g_drawRecorders;
+static HandleTable<DXBundle>            g_bundles;
+static HandleTable<ComputeQueue>        g_computeQueues;
+static HandleTable<FrameArena>          g_frameArenas;
+
+static ErrorReportFunc                  g_bindingValidationFunc = nullptr;
+
 static SGFX_FORCE_INLINE UINT dxFormatStride(DataFormat format)
 {
     switch (format) {
@@ -533,7 +1024,7 @@ static SGFX_FORCE_INLINE UINT dxFormatStride(DataFormat format)
 static void dxSetPipelineState(PipelineStateHandle handle)
 {
     if (handle != PipelineStateHandle::invalidHandle()) {
-        PipelineStateImpl* impl = static_cast<PipelineStateImpl*>(handle.value);
+        PipelineStateImpl* impl = g_pipelineStates.Get(handle.value);
 
         g_pImmediateContext->RSSetState(impl->rasterizerState);
         g_pImmediateContext->OMSetBlendState(impl->blendState, nullptr, 0xffffffff);
@@ -549,27 +1040,58 @@ static void dxSetPipelineState(PipelineStateHandle handle)
         g_pImmediateContext->DSSetShader(impl->shader->ds, nullptr, 0);
         g_pImmediateContext->GSSetShader(impl->shader->gs, nullptr, 0);
         g_pImmediateContext->PSSetShader(impl->shader->ps, nullptr, 0);
+
+        SGFX_STAT(numPipelineStateChanges, 1);
+    }
+}
+
+// indirect draws are counted as calls only, their arguments live on the GPU
+static SGFX_FORCE_INLINE void dxCountDraw(DrawCall::Type type, uint32_t count, uint32_t instanceCount)
+{
+    switch (type) {
+    case DrawCall::Draw:
+    case DrawCall::DrawIndexed:          { SGFX_STAT(numPrimitives, count); } break;
+    case DrawCall::DrawInstanced:
+    case DrawCall::DrawIndexedInstanced: { SGFX_STAT(numPrimitives, static_cast<uint64_t>(count) * instanceCount); } break;
+    default: break;
     }
+
+    SGFX_STAT(numDrawCalls, 1);
+    (void)count; (void)instanceCount;
 }
 
-static void dxProcessDrawQueue(DrawQueue* queue)
+static void dxProcessDrawQueue(DrawQueue* queue, uint32_t flags)
 {
-    PipelineStateImpl* psimpl = static_cast<PipelineStateImpl*>(queue->getState().value);
+    PipelineStateImpl* psimpl = g_pipelineStates.Get(queue->getState().value);
 
     dxSetPipelineState(queue->getState());
 
     psimpl->stateCache.setSamplerStates(queue->samplerStates);
 
+#if SGFX_VALIDATE_BINDINGS
+    bool foundUnusedBinds = false;
+#endif
+
+    // automatic instancing packs the merged constants into the transient ring
+    DrawInstancing instancing = { psimpl->instanceConstantsSlot, psimpl->instanceVertexSlot, &g_transientRing };
+    bool           isInstanced = instancing.constantsSlot != PipelineStateDescriptor::kNoInstancing;
+
     // process draw calls
-    for (const DrawCall& call: queue->getDrawCalls()) {
-        DXSharedBuffer* indexBuffer  = static_cast<DXSharedBuffer*>(call.indexBuffer.value);
-        UINT            offset       = 0;
+    for (const DrawCall& call: queue->getDrawCalls(flags, isInstanced ? &instancing : nullptr)) {
+        DXSharedBuffer* indexBuffer  = g_sharedBuffers.Get(call.indexBuffer.value);
+
+#if SGFX_VALIDATE_BINDINGS
+        if (!foundUnusedBinds)
+            foundUnusedBinds = hasUnusedBinds(call, psimpl->stateCache.layout);
+#endif
 
         g_pImmediateContext->IASetPrimitiveTopology(MapPrimitiveTopology[static_cast<size_t>(call.primitiveTopology)]);
+        SGFX_STAT(numInputBinds, 1);
+
         if (psimpl->vertexFormat != nullptr) {
 
             for (size_t i = 0; i < DrawCall::kMaxVertexBuffers; ++i) {
-                DXSharedBuffer* vertexBuffer = static_cast<DXSharedBuffer*>(call.vertexBuffers[i].value);
+                DXSharedBuffer* vertexBuffer = g_sharedBuffers.Get(call.vertexBuffers[i].value);
 
                 // TODO: state cache for vertex buffers
                 if (vertexBuffer != nullptr) {
@@ -578,22 +1100,28 @@ static void dxProcessDrawQueue(DrawQueue* queue)
                         vbuffer = static_cast<ID3D11Buffer*>(vertexBuffer->dataBuffer);
 
                     UINT stride = static_cast<UINT>(vertexBuffer->dataBufferStride);
+                    UINT offset = call.vertexBufferOffsets[i];
+                    if (stride == 0)
+                        stride = psimpl->vertexFormat->strides[i];
 
                     g_pImmediateContext->IASetVertexBuffers(static_cast<UINT>(i), 1, &vbuffer, &stride, &offset);
+                    SGFX_STAT(numInputBinds, 1);
                 } else break;
             }
 
             ID3D11Buffer* ibuffer = nullptr;
             if (indexBuffer != nullptr)
                 ibuffer = static_cast<ID3D11Buffer*>(indexBuffer->dataBuffer);
-            g_pImmediateContext->IASetIndexBuffer(ibuffer, DXGI_FORMAT_R32_UINT, 0); // TODO: different index format
+            g_pImmediateContext->IASetIndexBuffer(ibuffer, MapIndexFormat[static_cast<size_t>(call.indexFormat)], call.indexBufferOffset);
+            SGFX_STAT(numInputBinds, 1);
         }
 
-        // constant buffers
-        psimpl->stateCache.setConstantBuffers(call.constantBuffers);
+        // constant buffers, shader resources and textures
+        psimpl->stateCache.setConstantBuffers(call);
+        psimpl->stateCache.setShaderResources(call);
+        psimpl->stateCache.flush();
 
-        // shader resources and textures
-        psimpl->stateCache.setShaderResources(call.shaderResources);
+        dxCountDraw(call.type, call.count, call.instanceCount);
 
         switch (call.type) {
         case DrawCall::Draw:                 { g_pImmediateContext->Draw(call.count, call.startVertex); } break;
@@ -603,7 +1131,7 @@ static void dxProcessDrawQueue(DrawQueue* queue)
 
         case DrawCall::DrawInstancedIndirect: {
 
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(call.indirectArgsBuffer.value);
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(call.indirectArgsBuffer.value);
 
             // TODO: AppendConsumeBuffer support!
             //g_pImmediateContext->CopyStructureCount(buffer->indirectBuffer, call.indirectArgsOffset, buffer->dataUAV);
@@ -613,7 +1141,7 @@ static void dxProcessDrawQueue(DrawQueue* queue)
 
         case DrawCall::DrawIndexedInstancedIndirect: {
 
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(call.indirectArgsBuffer.value);
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(call.indirectArgsBuffer.value);
 
             // TODO: AppendConsumeBuffer support!
             //g_pImmediateContext->CopyStructureCount(buffer->indirectBuffer, call.indirectArgsOffset, buffer->dataUAV);
@@ -625,19 +1153,301 @@ static void dxProcessDrawQueue(DrawQueue* queue)
     }
 
     psimpl->stateCache.clear();
+
+#if SGFX_VALIDATE_BINDINGS
+    if (foundUnusedBinds && g_bindingValidationFunc != nullptr)
+        g_bindingValidationFunc("draw queue binds slots that the binding layout of its pipeline does not read");
+#endif
 }
 
-template <typename T, typename ...Args>
-static SGFX_FORCE_INLINE T* sgfx_new(Args&&... args)
+//=============================================================================
+// resolves the binds handed out by bakeDrawCalls into bundle commands
+struct DXBundleBaker final
 {
-    return new (g_allocFunc(sizeof(T))) T(static_cast<Args&&>(args)...);
+    DXBundle* bundle;
+
+    SGFX_FORCE_INLINE const ResourceTable* getResourceTable(ResourceTableHandle handle)
+    {
+        DXResourceTable* table = g_resourceTables.Get(handle.value);
+        return (table != nullptr) ? &table->table : nullptr;
+    }
+
+    SGFX_FORCE_INLINE DXBundleCommand& addCommand(DrawCommand::Opcode opcode, uint32_t slot, uint32_t handle)
+    {
+        DXBundleCommand command;
+        std::memset(&command, 0, sizeof(command));
+        command.opcode = opcode;
+        command.slot   = slot;
+        command.handle = handle;
+
+        bundle->commands.Add(command);
+        return bundle->commands[bundle->commands.GetSize() - 1];
+    }
+
+    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)
+    {
+        addCommand(DrawCommand::SetPrimitiveTopology, 0, 0).topology = MapPrimitiveTopology[static_cast<size_t>(topology)];
+    }
+
+    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle, uint32_t offset)
+    {
+        DXBundleCommand& command = addCommand(DrawCommand::SetVertexBuffer, idx, handle.value);
+
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+        if (buffer != nullptr) {
+            command.vertexBuffer.buffer = static_cast<ID3D11Buffer*>(buffer->dataBuffer);
+            command.vertexBuffer.stride = static_cast<UINT>(buffer->dataBufferStride);
+            command.vertexBuffer.offset = offset;
+        }
+    }
+
+    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle, uint32_t offset, IndexFormat format)
+    {
+        DXBundleCommand& command = addCommand(DrawCommand::SetIndexBuffer, 0, handle.value);
+        command.indexBuffer.format = MapIndexFormat[static_cast<size_t>(format)];
+
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+        if (buffer != nullptr) {
+            command.indexBuffer.buffer = static_cast<ID3D11Buffer*>(buffer->dataBuffer);
+            command.indexBuffer.offset = offset;
+        }
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle handle)
+    {
+        addCommand(DrawCommand::SetConstantBuffer, idx, handle.value).constantBuffer.buffer = dxGetConstantBuffer(handle.value);
+    }
+
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t idx, ConstantBufferHandle handle, uint32_t offset, uint32_t size)
+    {
+        DXBundleCommand& command = addCommand(DrawCommand::SetConstantBuffer, idx, handle.value);
+        command.constantBuffer.buffer = dxGetConstantBuffer(handle.value);
+        command.constantBuffer.offset = offset;
+        command.constantBuffer.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t idx, const uint32_t* data, uint32_t size)
+    {
+        DXBundleCommand& command = addCommand(DrawCommand::SetInlineConstants, idx, 0);
+        command.constants.offset = bundle->addConstantData(data, size);
+        command.constants.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, const ShaderResource& resource)
+    {
+        DXBundleCommand& command = addCommand(DrawCommand::SetResource, idx, resource.value);
+
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(resource.value);
+        if (buffer != nullptr)
+            command.resource = buffer->dataView;
+    }
+
+    SGFX_FORCE_INLINE void draw(const DrawCall& call)
+    {
+        bool isIndirect = call.type == DrawCall::DrawInstancedIndirect || call.type == DrawCall::DrawIndexedInstancedIndirect;
+
+        DXBundleCommand& command = addCommand(DrawCommand::Draw, call.type, isIndirect ? call.indirectArgsBuffer.value : 0);
+        if (isIndirect) {
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(call.indirectArgsBuffer.value);
+
+            command.indirect.args           = static_cast<ID3D11Buffer*>(buffer->dataBuffer);
+            command.indirect.indirectBuffer = buffer->indirectBuffer;
+            command.indirect.offset         = static_cast<UINT>(call.indirectArgsOffset);
+        } else {
+            command.draw.count         = call.count;
+            command.draw.instanceCount = call.instanceCount;
+            command.draw.startIndex    = call.startIndex;
+            command.draw.startVertex   = call.startVertex;
+            command.draw.startInstance = call.startInstance;
+        }
+
+        bundle->numDrawCalls++;
+    }
+};
+
+// releases of every object type a bundle can resolve
+static SGFX_FORCE_INLINE uint32_t dxNumBundleReleases()
+{
+    return g_sharedBuffers.GetNumReleases() + g_constantBuffers.GetNumReleases()
+        + g_samplerStates.GetNumReleases() + g_pipelineStates.GetNumReleases();
+}
+
+static bool dxCheckBundle(const DXBundle* bundle)
+{
+    if (!g_pipelineStates.IsValid(bundle->state.value))
+        return false;
+
+    for (const SamplerStateHandle& sampler : bundle->samplerStates) {
+        if (sampler.value != 0 && !g_samplerStates.IsValid(sampler.value))
+            return false;
+    }
+
+    for (const DXBundleCommand& command : bundle->commands) {
+        if (command.handle == 0)
+            continue;
+
+        bool isValid = (command.opcode == DrawCommand::SetConstantBuffer)
+            ? g_constantBuffers.IsValid(command.handle)
+            : g_sharedBuffers.IsValid(command.handle);
+        if (!isValid)
+            return false;
+    }
+
+    return true;
+}
+
+// only walks the bundle when something was released since the last check
+static SGFX_FORCE_INLINE bool dxValidateBundle(DXBundle* bundle)
+{
+    uint32_t numReleases = dxNumBundleReleases();
+    if (bundle->isValid && bundle->numReleases != numReleases) {
+        bundle->numReleases = numReleases;
+        bundle->isValid     = dxCheckBundle(bundle);
+    }
+    return bundle->isValid;
+}
+
+// executes single bundle commands, see replayBundle
+struct DXBundleExecutor final
+{
+    PipelineStateImpl* psimpl;
+    const uint32_t*    constantData;
+
+    SGFX_FORCE_INLINE void operator()(const DXBundleCommand& command)
+    {
+        switch (command.opcode) {
+        case DrawCommand::SetPrimitiveTopology: {
+            g_pImmediateContext->IASetPrimitiveTopology(command.topology);
+            SGFX_STAT(numInputBinds, 1);
+        } break;
+
+        case DrawCommand::SetVertexBuffer: {
+            if (psimpl->vertexFormat != nullptr) {
+                UINT stride = command.vertexBuffer.stride;
+                if (stride == 0)
+                    stride = psimpl->vertexFormat->strides[command.slot];
+
+                g_pImmediateContext->IASetVertexBuffers(command.slot, 1, &command.vertexBuffer.buffer, &stride, &command.vertexBuffer.offset);
+                SGFX_STAT(numInputBinds, 1);
+            }
+        } break;
+
+        case DrawCommand::SetIndexBuffer: {
+            if (psimpl->vertexFormat != nullptr) {
+                g_pImmediateContext->IASetIndexBuffer(command.indexBuffer.buffer, command.indexBuffer.format, command.indexBuffer.offset);
+                SGFX_STAT(numInputBinds, 1);
+            }
+        } break;
+
+        case DrawCommand::SetConstantBuffer: {
+            if (command.constantBuffer.size != 0)
+                psimpl->stateCache.setConstantBufferRange(command.slot, command.constantBuffer.buffer, command.constantBuffer.offset, command.constantBuffer.size);
+            else
+                psimpl->stateCache.setConstantBuffer(command.slot, command.constantBuffer.buffer);
+        } break;
+        case DrawCommand::SetResource:       { psimpl->stateCache.setShaderResource(command.slot, command.resource); } break;
+
+        // bakeDrawCalls expands resource tables into SetResource commands, a bundle never holds one
+        case DrawCommand::SetResourceTable: break;
+
+        case DrawCommand::SetInlineConstants: {
+            psimpl->stateCache.setInlineConstants(command.slot, constantData + command.constants.offset, command.constants.size);
+        } break;
+
+        case DrawCommand::Draw: {
+            const auto& params = command.draw;
+
+            psimpl->stateCache.flush();
+
+            dxCountDraw(static_cast<DrawCall::Type>(command.slot), params.count, params.instanceCount);
+
+            switch (static_cast<DrawCall::Type>(command.slot)) {
+            case DrawCall::Draw:                 { g_pImmediateContext->Draw(params.count, params.startVertex); } break;
+            case DrawCall::DrawIndexed:          { g_pImmediateContext->DrawIndexed(params.count, params.startIndex, params.startVertex); } break;
+            case DrawCall::DrawInstanced:        { g_pImmediateContext->DrawInstanced(params.count, params.instanceCount, params.startVertex, params.startInstance); } break;
+            case DrawCall::DrawIndexedInstanced: { g_pImmediateContext->DrawIndexedInstanced(params.count, params.instanceCount, params.startIndex, params.startVertex, params.startInstance); } break;
+
+            case DrawCall::DrawInstancedIndirect: {
+                // TODO: AppendConsumeBuffer support!
+                g_pImmediateContext->CopyResource(command.indirect.indirectBuffer, command.indirect.args);
+                g_pImmediateContext->DrawInstancedIndirect(command.indirect.indirectBuffer, command.indirect.offset);
+            } break;
+
+            case DrawCall::DrawIndexedInstancedIndirect: {
+                // TODO: AppendConsumeBuffer support!
+                g_pImmediateContext->CopyResource(command.indirect.indirectBuffer, command.indirect.args);
+                g_pImmediateContext->DrawIndexedInstancedIndirect(command.indirect.indirectBuffer, command.indirect.offset);
+            } break;
+            }
+        } break;
+        }
+    }
+};
+
+static void dxProcessBundle(const DXBundle* bundle, const uint64_t* visibilityMask)
+{
+    PipelineStateImpl* psimpl = g_pipelineStates.Get(bundle->state.value);
+
+    dxSetPipelineState(bundle->state);
+
+    psimpl->stateCache.setSamplerStates(bundle->samplerStates);
+
+    DXBundleExecutor executor = { psimpl, bundle->constantData.GetData() };
+    replayBundle(*bundle, visibilityMask, executor);
+
+    psimpl->stateCache.clear();
+}
+
+//=============================================================================
+// frame arenas backing the draw queue storage
+static FrameArena               g_frameArena;
+static FrameArena*              g_userFrameArenas = nullptr;
+static thread_local FrameArena* t_frameArena      = nullptr;
+static uint32_t                 g_frameIndex      = 1;
+
+// counted on the device thread, the last frame's counters are kept for getFrameStats
+static FrameStats               g_frameStats;
+static FrameStats               g_lastFrameStats;
+static Profiler                 g_profiler;
+static CaptureWriter            g_captureWriter;
+
+namespace SGFX_NS_INTERNAL
+{
+
+FrameArena* getFrameArena()
+{
+    return (t_frameArena != nullptr) ? t_frameArena : &g_frameArena;
+}
+
+uint32_t getFrameIndex()
+{
+    return g_frameIndex;
 }
 
-template <typename T>
-static SGFX_FORCE_INLINE void sgfx_delete(T* t)
+FrameStats& getStatCounters()
 {
-    t->~T();
-    g_freeFunc(t);
+    return g_frameStats;
+}
+
+Profiler& getProfiler()
+{
+    return g_profiler;
+}
+
+CaptureWriter& getCaptureWriter()
+{
+    return g_captureWriter;
+}
+
+}
+
+static void resetFrameArenas()
+{
+    g_frameArena.Reset();
+    for (FrameArena* arena = g_userFrameArenas; arena != nullptr; arena = arena->nextArena)
+        arena->Reset();
+
+    g_frameIndex++;
 }
 
 //=============================================================================
@@ -651,6 +1461,22 @@ bool initD3D11(void* d3dDevice, void* d3dContext, void* d3dSwapChain)
     HRESULT hr = g_pImmediateContext->QueryInterface(&g_debugAnnotation);
     if (FAILED(hr))
         g_debugAnnotation = nullptr; // probably redundant
+
+    hr = g_pImmediateContext->QueryInterface(&g_pImmediateContext1);
+    if (FAILED(hr))
+        g_pImmediateContext1 = nullptr;
+
+    // a D3D11.1 runtime on a D3D11.0 driver has the interface but neither of the features
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+    std::memset(&options, 0, sizeof(options));
+    if (g_pImmediateContext1 != nullptr)
+        g_pd3dDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+
+    g_constantBufferOffsets = options.ConstantBufferOffsetting && options.ConstantBufferPartialUpdate;
+    if (!g_constantBufferOffsets && g_pImmediateContext1 != nullptr) {
+        g_pImmediateContext1->Release();
+        g_pImmediateContext1 = nullptr;
+    }
 #endif
 
     return true;
@@ -658,10 +1484,45 @@ bool initD3D11(void* d3dDevice, void* d3dContext, void* d3dSwapChain)
 
 void shutdown()
 {
+    g_captureWriter.stop();
+
+    // storage recorded before the shutdown must not look current after the next init
+    resetFrameArenas();
+
+    // objects the application did not release go away while the device is still alive
+    g_transientRing.release();
+    g_drawRecorders.Purge();
+    g_drawQueues.Purge();
+    g_bundles.Purge();
+    g_computeQueues.Purge();
+    g_renderTargets.Purge();
+    g_sharedBuffers.Purge();
+    g_frameArenas.Purge();
+    g_userFrameArenas = nullptr;
+
+    g_frameArena.Purge();
+    g_profiler.release();
+
 #ifdef SGFX_USE_D3D11_1
     if (g_debugAnnotation)
         g_debugAnnotation->Release();
+    if (g_pImmediateContext1)
+        g_pImmediateContext1->Release();
+    g_debugAnnotation    = nullptr;
+    g_pImmediateContext1 = nullptr;
+
+    if (g_inlineConstantRing.buffer != nullptr)
+        g_inlineConstantRing.buffer->Release();
+    g_inlineConstantRing = DXConstantRing();
 #endif
+
+    for (ID3D11Buffer*& buffer : g_inlineConstantBuffers) {
+        if (buffer != nullptr)
+            buffer->Release();
+        buffer = nullptr;
+    }
+
+    g_constantBufferOffsets = false;
 }
 
 void setAllocator(AllocFunc nalloc, FreeFunc nfree)
@@ -698,6 +1559,9 @@ uint64_t getGPUCaps()
     caps |= GPUCaps::TextureFormatInteger;
     caps |= GPUCaps::TextureFormatFloat;
 
+    if (g_constantBufferOffsets)
+        caps |= GPUCaps::ConstantBufferOffsets;
+
     if (featureLevel >= D3D_FEATURE_LEVEL_10_0) {
         caps |= GPUCaps::GeometryShader;
         caps |= GPUCaps::ComputeShader;
@@ -730,6 +1594,8 @@ bool compileShader(
     size_t& outDataSize
 )
 {
+    SGFX_PROFILE_ZONE("sgfx::compileShader");
+
     D3D_SHADER_MACRO* d3dmacros = nullptr;
 
     if (macros != nullptr) {
@@ -820,193 +1686,256 @@ bool compileShader(
 // shaders
 VertexShaderHandle createVertexShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreateVertexShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11VertexShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreateVertexShader(data, dataSize, nullptr, &shader))) {
-        return VertexShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(VertexShaderHandle::invalidHandle());
     }
-    return VertexShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(VertexShaderHandle(g_vertexShaders.Create(shader)));
 }
 
 void releaseVertexShader(VertexShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseVertexShader, handle);
     if (handle != VertexShaderHandle::invalidHandle()) {
-        ID3D11VertexShader* shader = static_cast<ID3D11VertexShader*>(handle.value);
+        ID3D11VertexShader* shader = g_vertexShaders.GetValue(handle.value);
         shader->Release();
+        g_vertexShaders.Release(handle.value);
     }
 }
 
 HullShaderHandle createHullShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreateHullShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11HullShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreateHullShader(data, dataSize, nullptr, &shader))) {
-        return HullShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(HullShaderHandle::invalidHandle());
     }
-    return HullShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(HullShaderHandle(g_hullShaders.Create(shader)));
 }
 
 void releaseHullShader(HullShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseHullShader, handle);
     if (handle != HullShaderHandle::invalidHandle()) {
-        ID3D11HullShader* shader = static_cast<ID3D11HullShader*>(handle.value);
+        ID3D11HullShader* shader = g_hullShaders.GetValue(handle.value);
         shader->Release();
+        g_hullShaders.Release(handle.value);
     }
 }
 
 DomainShaderHandle createDomainShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreateDomainShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11DomainShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreateDomainShader(data, dataSize, nullptr, &shader))) {
-        return DomainShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(DomainShaderHandle::invalidHandle());
     }
-    return DomainShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(DomainShaderHandle(g_domainShaders.Create(shader)));
 }
 
 void releaseDomainShader(DomainShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseDomainShader, handle);
     if (handle != DomainShaderHandle::invalidHandle()) {
-        ID3D11DomainShader* shader = static_cast<ID3D11DomainShader*>(handle.value);
+        ID3D11DomainShader* shader = g_domainShaders.GetValue(handle.value);
         shader->Release();
+        g_domainShaders.Release(handle.value);
     }
 }
 
 GeometryShaderHandle createGeometryShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreateGeometryShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11GeometryShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreateGeometryShader(data, dataSize, nullptr, &shader))) {
-        return GeometryShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(GeometryShaderHandle::invalidHandle());
     }
-    return GeometryShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(GeometryShaderHandle(g_geometryShaders.Create(shader)));
 }
 
 void releaseGeometryShader(GeometryShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseGeometryShader, handle);
     if (handle != GeometryShaderHandle::invalidHandle()) {
-        ID3D11GeometryShader* shader = static_cast<ID3D11GeometryShader*>(handle.value);
+        ID3D11GeometryShader* shader = g_geometryShaders.GetValue(handle.value);
         shader->Release();
+        g_geometryShaders.Release(handle.value);
     }
 }
 
 PixelShaderHandle createPixelShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreatePixelShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11PixelShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreatePixelShader(data, dataSize, nullptr, &shader))) {
-        return PixelShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(PixelShaderHandle::invalidHandle());
     }
-    return PixelShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(PixelShaderHandle(g_pixelShaders.Create(shader)));
 }
 
 void releasePixelShader(PixelShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleasePixelShader, handle);
     if (handle != PixelShaderHandle::invalidHandle()) {
-        ID3D11PixelShader* shader = static_cast<ID3D11PixelShader*>(handle.value);
+        ID3D11PixelShader* shader = g_pixelShaders.GetValue(handle.value);
         shader->Release();
+        g_pixelShaders.Release(handle.value);
     }
 }
 
-SurfaceShaderHandle linkSurfaceShader(VertexShaderHandle vs, HullShaderHandle hs, DomainShaderHandle ds, GeometryShaderHandle gs, PixelShaderHandle ps)
+SurfaceShaderHandle linkSurfaceShader(VertexShaderHandle vs, HullShaderHandle hs, DomainShaderHandle ds, GeometryShaderHandle gs, PixelShaderHandle ps, const SurfaceBindingLayout* layout)
 {
-    SurfaceShaderImpl* impl = sgfx::sgfx_new<SurfaceShaderImpl>();
-    impl->vs = static_cast<ID3D11VertexShader*>(vs.value);
-    impl->hs = static_cast<ID3D11HullShader*>(hs.value);
-    impl->ds = static_cast<ID3D11DomainShader*>(ds.value);
-    impl->gs = static_cast<ID3D11GeometryShader*>(gs.value);
-    impl->ps = static_cast<ID3D11PixelShader*>(ps.value);
-    return SurfaceShaderHandle(impl);
+    SGFX_CAPTURE(LinkSurfaceShader, vs, hs, ds, gs, ps, capturePod(layout));
+    uint32_t handle = g_surfaceShaders.Create();
+
+    SurfaceShaderImpl* impl = g_surfaceShaders.Get(handle);
+    impl->vs = g_vertexShaders.GetValue(vs.value);
+    impl->hs = g_hullShaders.GetValue(hs.value);
+    impl->ds = g_domainShaders.GetValue(ds.value);
+    impl->gs = g_geometryShaders.GetValue(gs.value);
+    impl->ps = g_pixelShaders.GetValue(ps.value);
+
+    if (layout != nullptr) {
+        impl->layout = *layout;
+    } else {
+        StageBindingLayout fullLayout = getFullBindingLayout();
+        impl->layout.vs = fullLayout;
+        impl->layout.hs = fullLayout;
+        impl->layout.ds = fullLayout;
+        impl->layout.gs = fullLayout;
+        impl->layout.ps = fullLayout;
+    }
+    return SGFX_CAPTURE_RESULT(SurfaceShaderHandle(handle));
 }
 
 void releaseSurfaceShader(SurfaceShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseSurfaceShader, handle);
     if (handle != SurfaceShaderHandle::invalidHandle()) {
-        SurfaceShaderImpl* impl = static_cast<SurfaceShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_surfaceShaders.Release(handle.value);
     }
 }
 
-ComputeQueueHandle createComputeQueue(ComputeShaderHandle shader)
+void setBindingValidationFunc(ErrorReportFunc func)
+{
+    g_bindingValidationFunc = func;
+}
+
+ComputeQueueHandle createComputeQueue(ComputeShaderHandle shader, const StageBindingLayout* layout)
 {
-    ComputeQueue* queue = sgfx::sgfx_new<ComputeQueue>();
+    SGFX_CAPTURE(CreateComputeQueue, shader, capturePod(layout));
+    uint32_t handle = g_computeQueues.Create();
+
+    ComputeQueue* queue = g_computeQueues.Get(handle);
     queue->shader = shader;
+    queue->layout = (layout != nullptr) ? *layout : getFullBindingLayout();
 
-    return ComputeQueueHandle(queue);
+    return SGFX_CAPTURE_RESULT(ComputeQueueHandle(handle));
 }
 
 void releaseComputeQueue(ComputeQueueHandle handle)
 {
+    SGFX_CAPTURE(ReleaseComputeQueue, handle);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
-        sgfx_delete(queue);
+        g_computeQueues.Release(handle.value);
     }
 }
 
 void setConstantBuffer(ComputeQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer)
 {
+    SGFX_CAPTURE(SetConstantBufferCompute, handle, idx, buffer);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
         queue->setConstantBuffer(idx, buffer);
     }
 }
 
 void setResource(ComputeQueueHandle handle, uint32_t idx, BufferHandle resource)
 {
+    SGFX_CAPTURE(SetResourceBufferCompute, handle, idx, resource);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
 void setResource(ComputeQueueHandle handle, uint32_t idx, TextureHandle resource)
 {
+    SGFX_CAPTURE(SetResourceTextureCompute, handle, idx, resource);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
 void setResourceRW(ComputeQueueHandle handle, uint32_t idx, BufferHandle resource)
 {
+    SGFX_CAPTURE(SetResourceRWBufferCompute, handle, idx, resource);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
         queue->setResourceRW(idx, resource);
     }
 }
 
 void setResourceRW(ComputeQueueHandle handle, uint32_t idx, TextureHandle resource)
 {
+    SGFX_CAPTURE(SetResourceRWTextureCompute, handle, idx, resource);
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue* queue = static_cast<ComputeQueue*>(handle.value);
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
         queue->setResourceRW(idx, resource);
     }
 }
 
 void submit(ComputeQueueHandle handle, uint32_t x, uint32_t y, uint32_t z)
 {
+    SGFX_CAPTURE(SubmitCompute, handle, x, y, z);
+    SGFX_PROFILE_ZONE("sgfx::dispatch");
+
     if (handle != ComputeQueueHandle::invalidHandle()) {
-        ComputeQueue*           queue   = static_cast<ComputeQueue*>(handle.value);
-        ID3D11ComputeShader*    shader  = static_cast<ID3D11ComputeShader*>(queue->shader.value);
+        ComputeQueue*           queue   = g_computeQueues.Get(handle.value);
+        ID3D11ComputeShader*    shader  = g_computeShaders.GetValue(queue->shader.value);
+
+        // only the slot ranges the layout reads are bound (and unbound afterwards)
+        UINT bufferFirst   = 0;
+        UINT bufferCount   = 0;
+        UINT resourceFirst = 0;
+        UINT resourceCount = 0;
 
         // constant buffers are ID3D11Buffers effectively
         ID3D11Buffer* constantBuffers[ComputeQueue::kMaxConstantBuffers] = { nullptr };
-        for (size_t i = 0; i < ComputeQueue::kMaxConstantBuffers; ++i)
-            constantBuffers[i] = static_cast<ID3D11Buffer*>(queue->constantBuffers[i].value);
+        if (trimRange(&queue->layout.constantBuffers, 0, ComputeQueue::kMaxConstantBuffers, bufferFirst, bufferCount)) {
+            for (UINT i = bufferFirst; i < bufferFirst + bufferCount; ++i)
+                constantBuffers[i] = dxGetConstantBuffer(queue->constantBuffers[i].value);
 
-        // TODO: add statecache here!
-        g_pImmediateContext->CSSetConstantBuffers(0, ComputeQueue::kMaxConstantBuffers, constantBuffers);
+            // TODO: add statecache here!
+            g_pImmediateContext->CSSetConstantBuffers(bufferFirst, bufferCount, constantBuffers + bufferFirst);
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, bufferCount);
+        }
 
         // shader resources and textures
         ID3D11ShaderResourceView* shaderResources[ComputeQueue::kMaxShaderResources] = { nullptr };
-        for (size_t i = 0; i < ComputeQueue::kMaxShaderResources; ++i) {
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(queue->shaderResources[i].value);
-            if (buffer != nullptr)
-                shaderResources[i] = buffer->dataView;
-        }
+        bool hasShaderResources = trimRange(queue->layout.shaderResources, 0, ComputeQueue::kMaxShaderResources, resourceFirst, resourceCount);
+        if (hasShaderResources) {
+            for (UINT i = resourceFirst; i < resourceFirst + resourceCount; ++i) {
+                DXSharedBuffer* buffer = g_sharedBuffers.Get(queue->shaderResources[i].value);
+                if (buffer != nullptr)
+                    shaderResources[i] = buffer->dataView;
+            }
 
-        // TODO: add statecache here!
-        g_pImmediateContext->CSSetShaderResources(0, ComputeQueue::kMaxShaderResources, shaderResources);
+            // TODO: add statecache here!
+            g_pImmediateContext->CSSetShaderResources(resourceFirst, resourceCount, shaderResources + resourceFirst);
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, resourceCount);
+        }
 
         // UAVs
         ID3D11UnorderedAccessView* shaderUAVs[ComputeQueue::kMaxShaderResourcesRW] = { nullptr };
         for (size_t i = 0; i < ComputeQueue::kMaxShaderResourcesRW; ++i) {
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(queue->shaderResourcesRW[i].value);
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(queue->shaderResourcesRW[i].value);
             if (buffer != nullptr)
                 shaderUAVs[i] = buffer->dataUAV;
         }
@@ -1015,13 +1944,19 @@ void submit(ComputeQueueHandle handle, uint32_t x, uint32_t y, uint32_t z)
         uint32_t shaderUAVCounters[ComputeQueue::kMaxShaderResourcesRW] = { 0 };
         g_pImmediateContext->CSSetUnorderedAccessViews(0, ComputeQueue::kMaxShaderResourcesRW, shaderUAVs, shaderUAVCounters);
 
+        SGFX_STAT(numBindCalls, 1);
+        SGFX_STAT(numBoundSlots, ComputeQueue::kMaxShaderResourcesRW);
+
         // dispatch
         g_pImmediateContext->CSSetShader(shader, nullptr, 0);
         g_pImmediateContext->Dispatch(x, y, z);
 
+        SGFX_STAT(numDispatches, 1);
+
         // cleanup
         ID3D11ShaderResourceView*   clearSRVs[ComputeQueue::kMaxShaderResources]            = { nullptr };
-        g_pImmediateContext->CSSetShaderResources(0, ComputeQueue::kMaxShaderResources, clearSRVs);
+        if (hasShaderResources)
+            g_pImmediateContext->CSSetShaderResources(resourceFirst, resourceCount, clearSRVs);
 
         ID3D11UnorderedAccessView*  clearUAVs[ComputeQueue::kMaxShaderResourcesRW]          = { nullptr };
         uint32_t                    clearUAVCounters[ComputeQueue::kMaxShaderResourcesRW]   = { 0 };
@@ -1031,18 +1966,21 @@ void submit(ComputeQueueHandle handle, uint32_t x, uint32_t y, uint32_t z)
 
 ComputeShaderHandle createComputeShader(const void* data, size_t dataSize)
 {
+    SGFX_CAPTURE(CreateComputeShader, CaptureData{ data, dataSize }, dataSize);
     ID3D11ComputeShader* shader = nullptr;
     if (FAILED(g_pd3dDevice->CreateComputeShader(data, dataSize, nullptr, &shader))) {
-        return ComputeShaderHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(ComputeShaderHandle::invalidHandle());
     }
-    return ComputeShaderHandle(shader);
+    return SGFX_CAPTURE_RESULT(ComputeShaderHandle(g_computeShaders.Create(shader)));
 }
 
 void releaseComputeShader(ComputeShaderHandle handle)
 {
+    SGFX_CAPTURE(ReleaseComputeShader, handle);
     if (handle != ComputeShaderHandle::invalidHandle()) {
-        ID3D11ComputeShader* shader = static_cast<ID3D11ComputeShader*>(handle.value);
+        ID3D11ComputeShader* shader = g_computeShaders.GetValue(handle.value);
         shader->Release();
+        g_computeShaders.Release(handle.value);
     }
 }
 
@@ -1053,8 +1991,9 @@ VertexFormatHandle createVertexFormat(
     ErrorReportFunc errorReport
 )
 {
+    SGFX_CAPTURE(CreateVertexFormat, CaptureVertexElements{ elements, size }, size, CaptureData{ shaderBytecode, shaderBytecodeSize }, shaderBytecodeSize);
     if (elements == nullptr || size == 0)
-        return VertexFormatHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(VertexFormatHandle::invalidHandle());
 
     size_t totalSize = size * sizeof(D3D11_INPUT_ELEMENT_DESC);
     D3D11_INPUT_ELEMENT_DESC* inputData = reinterpret_cast<D3D11_INPUT_ELEMENT_DESC*>(alloca(totalSize));
@@ -1078,25 +2017,41 @@ VertexFormatHandle createVertexFormat(
     ID3D11InputLayout* layout = nullptr;
     if (FAILED(g_pd3dDevice->CreateInputLayout(inputData, static_cast<UINT>(size), shaderBytecode, shaderBytecodeSize, &layout))) {
         if (errorReport != nullptr) errorReport("Failed to create vertex format!");
-        return VertexFormatHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(VertexFormatHandle::invalidHandle());
     }
 
-    VertexFormatImpl* impl = sgfx_new<VertexFormatImpl>();
+    uint32_t handle = g_vertexFormats.Create();
+
+    VertexFormatImpl* impl = g_vertexFormats.Get(handle);
     impl->inputLayout = layout;
-    return VertexFormatHandle(impl);
+
+    std::memset(impl->strides, 0, sizeof(impl->strides));
+    for (size_t i = 0; i < size; ++i) {
+        if (elements[i].slot < DrawCall::kMaxVertexBuffers) {
+            UINT end = static_cast<UINT>(elements[i].offset) + dxFormatStride(elements[i].format);
+            if (end > impl->strides[elements[i].slot])
+                impl->strides[elements[i].slot] = end;
+        }
+    }
+
+    return SGFX_CAPTURE_RESULT(VertexFormatHandle(handle));
 }
 
 void releaseVertexFormat(VertexFormatHandle handle)
 {
+    SGFX_CAPTURE(ReleaseVertexFormat, handle);
     if (handle != VertexFormatHandle::invalidHandle()) {
-        VertexFormatImpl* impl = static_cast<VertexFormatImpl*>(handle.value);
+        VertexFormatImpl* impl = g_vertexFormats.Get(handle.value);
         impl->inputLayout->Release();
-        sgfx_delete(impl);
+        g_vertexFormats.Release(handle.value);
     }
 }
 
 PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
 {
+    SGFX_CAPTURE(CreatePipelineState, capturePod(desc));
+    SGFX_PROFILE_ZONE("sgfx::createPipelineState");
+
     const RasterizerState& rsState = desc.rasterizerState;
 
     D3D11_RASTERIZER_DESC rasterizerDesc;
@@ -1113,7 +2068,7 @@ PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
 
     ID3D11RasterizerState* rasterizerState = nullptr;
     if (FAILED(g_pd3dDevice->CreateRasterizerState(&rasterizerDesc, &rasterizerState))) {
-        return PipelineStateHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(PipelineStateHandle::invalidHandle());
     }
 
     const BlendState& bsState = desc.blendState;
@@ -1150,7 +2105,7 @@ PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
     ID3D11BlendState* blendState = nullptr;
     if (FAILED(g_pd3dDevice->CreateBlendState(&blendDesc, &blendState))) {
         rasterizerState->Release();
-        return PipelineStateHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(PipelineStateHandle::invalidHandle());
     }
 
     const DepthStencilState& dsState = desc.depthStencilState;
@@ -1175,41 +2130,49 @@ PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
     if (FAILED(g_pd3dDevice->CreateDepthStencilState(&depthStencilDesc, &depthStencilState))) {
         rasterizerState->Release();
         blendState->Release();
-        return PipelineStateHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(PipelineStateHandle::invalidHandle());
     }
 
-    PipelineStateImpl* impl = sgfx::sgfx_new<PipelineStateImpl>();
+    uint32_t handle = g_pipelineStates.Create();
+
+    PipelineStateImpl* impl = g_pipelineStates.Get(handle);
     impl->rasterizerState   = rasterizerState;
     impl->blendState        = blendState;
     impl->depthStencilState = depthStencilState;
 
-    impl->shader       = static_cast<SurfaceShaderImpl*>(desc.shader.value);
-    impl->vertexFormat = static_cast<VertexFormatImpl*>(desc.vertexFormat.value);
+    impl->shader       = g_surfaceShaders.Get(desc.shader.value);
+    impl->vertexFormat = g_vertexFormats.Get(desc.vertexFormat.value);
 
     impl->stencilRef = dsState.stencilRef;
 
-    impl->stateCache.vs = impl->shader->vs != nullptr;
-    impl->stateCache.hs = impl->shader->hs != nullptr;
-    impl->stateCache.ds = impl->shader->ds != nullptr;
-    impl->stateCache.gs = impl->shader->gs != nullptr;
-    impl->stateCache.ps = impl->shader->ps != nullptr;
+    impl->instanceConstantsSlot = desc.instanceConstantsSlot;
+    impl->instanceVertexSlot    = desc.instanceVertexSlot;
+
+    impl->stateCache.stages.vs = impl->shader->vs != nullptr;
+    impl->stateCache.stages.hs = impl->shader->hs != nullptr;
+    impl->stateCache.stages.ds = impl->shader->ds != nullptr;
+    impl->stateCache.stages.gs = impl->shader->gs != nullptr;
+    impl->stateCache.stages.ps = impl->shader->ps != nullptr;
+    impl->stateCache.setLayout(impl->shader->layout);
 
-    return PipelineStateHandle(impl);
+    return SGFX_CAPTURE_RESULT(PipelineStateHandle(handle));
 }
 
 void releasePipelineState(PipelineStateHandle handle)
 {
+    SGFX_CAPTURE(ReleasePipelineState, handle);
     if (handle != PipelineStateHandle::invalidHandle()) {
-        PipelineStateImpl* impl = static_cast<PipelineStateImpl*>(handle.value);
+        PipelineStateImpl* impl = g_pipelineStates.Get(handle.value);
         impl->rasterizerState->Release();
         impl->blendState->Release();
         impl->depthStencilState->Release();
-        sgfx::sgfx_delete(impl);
+        g_pipelineStates.Release(handle.value);
     }
 }
 
 BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t stride)
 {
+    SGFX_CAPTURE(CreateBuffer, flags, CaptureData{ mem, size }, size, stride);
     D3D11_USAGE bufferUsage    = D3D11_USAGE_IMMUTABLE;
     UINT        bufferCPUFlags = 0;
     UINT        bufferBindFlag = 0;
@@ -1222,10 +2185,10 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
     bool isIndirect   = false;
 
     if (flags & BufferFlags::VertexBuffer) {
-        bufferBindFlag = D3D11_BIND_VERTEX_BUFFER;
+        bufferBindFlag |= D3D11_BIND_VERTEX_BUFFER;
     }
     if (flags & BufferFlags::IndexBuffer) {
-        bufferBindFlag = D3D11_BIND_INDEX_BUFFER;
+        bufferBindFlag |= D3D11_BIND_INDEX_BUFFER;
     }
 
     if (flags & BufferFlags::StructuredBuffer) {
@@ -1259,6 +2222,11 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
         isIndirect      = true;
     }
 
+    // immutable buffers need their data up front, buffers created without it are filled later
+    if (bufferUsage == D3D11_USAGE_IMMUTABLE && mem == nullptr) {
+        bufferUsage     = D3D11_USAGE_DEFAULT;
+    }
+
     D3D11_BUFFER_DESC bufferDesc;
     std::memset(&bufferDesc, 0, sizeof(bufferDesc));
 
@@ -1276,10 +2244,12 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
     ID3D11Buffer* d3dbuffer = nullptr;
     if (FAILED(g_pd3dDevice->CreateBuffer(&bufferDesc, (bufferData.pSysMem == nullptr) ? nullptr : &bufferData, &d3dbuffer))) {
         // TODO: error handling
-        return BufferHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(BufferHandle::invalidHandle());
     }
 
-    DXSharedBuffer* buffer = sgfx_new<DXSharedBuffer>();
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* buffer = g_sharedBuffers.Get(handle);
     buffer->dataBuffer          = d3dbuffer;
     buffer->dataBufferStride    = stride;
 
@@ -1287,38 +2257,45 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
     if (isStructured) buffer->createView(size / stride);
     if (isUAV)        buffer->createUAV(size / stride, isCounter, isAppend);
 
-    return BufferHandle(buffer);
+    SGFX_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        SGFX_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(BufferHandle(handle));
 }
 
 void releaseBuffer(BufferHandle handle)
 {
+    SGFX_CAPTURE(ReleaseBuffer, handle);
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
-        sgfx::sgfx_delete(buffer);
+        g_sharedBuffers.Release(handle.value);
     }
 }
 
 void* mapBuffer(BufferHandle handle, MapType type)
 {
+    SGFX_CAPTURE(MapBuffer, handle, type);
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         D3D11_MAPPED_SUBRESOURCE mappedData;
         std::memset(&mappedData, 0, sizeof(mappedData));
 
         if (FAILED(g_pImmediateContext->Map(buffer->dataBuffer, 0, MapMapType[static_cast<size_t>(type)], 0, &mappedData))) {
-            return nullptr;
+            return SGFX_CAPTURE_RESULT(nullptr);
         }
 
-        return mappedData.pData;
+        SGFX_STAT(numBufferMaps, 1);
+        return SGFX_CAPTURE_RESULT(mappedData.pData);
     }
-    return nullptr;
+    return SGFX_CAPTURE_RESULT(nullptr);
 }
 
 void unmapBuffer(BufferHandle handle)
 {
+    SGFX_CAPTURE(UnmapBuffer, handle);
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         g_pImmediateContext->Unmap(buffer->dataBuffer, 0);
     }
@@ -1326,8 +2303,11 @@ void unmapBuffer(BufferHandle handle)
 
 void copyBufferData(BufferHandle handle, size_t offset, size_t size, const void* mem)
 {
+    SGFX_CAPTURE(CopyBufferData, handle, offset, size, CaptureData{ mem, size });
+    SGFX_PROFILE_ZONE("sgfx::copyBufferData");
+
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         D3D11_BOX box;
         box.left   = static_cast<UINT>(offset);
@@ -1344,13 +2324,16 @@ void copyBufferData(BufferHandle handle, size_t offset, size_t size, const void*
             mem,
             0, 0
         );
+
+        SGFX_STAT(numBytesUploaded, size);
     }
 }
 
 void clearBufferRW(BufferHandle handle, uint32_t value)
 {
+    SGFX_CAPTURE(ClearBufferRWUInt, handle, value);
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         uint32_t d3dValues[4] = { value, 0, 0, 0 };
 
@@ -1361,8 +2344,9 @@ void clearBufferRW(BufferHandle handle, uint32_t value)
 
 void clearBufferRW(BufferHandle handle, float value)
 {
+    SGFX_CAPTURE(ClearBufferRWFloat, handle, value);
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         float d3dValues[4] = { value, 0.F, 0.0F, 0.0F };
 
@@ -1373,6 +2357,7 @@ void clearBufferRW(BufferHandle handle, float value)
 
 ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
 {
+    SGFX_CAPTURE(CreateConstantBuffer, CaptureData{ mem, size }, size);
     D3D11_BUFFER_DESC bufferDesc;
     std::memset(&bufferDesc, 0, sizeof(bufferDesc));
     bufferDesc.ByteWidth           = static_cast<UINT>(size);
@@ -1390,31 +2375,213 @@ ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
     ID3D11Buffer* buffer = nullptr;
     if (FAILED(g_pd3dDevice->CreateBuffer(&bufferDesc, (mem == nullptr) ? nullptr : &data, &buffer))) {
         // TODO: error handling
-        return ConstantBufferHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(ConstantBufferHandle::invalidHandle());
+    }
+
+    uint8_t* shadow = nullptr;
+    if (!g_constantBufferOffsets) {
+        shadow = static_cast<uint8_t*>(allocate(size));
+        if (mem != nullptr)
+            std::memcpy(shadow, mem, size);
+        else
+            std::memset(shadow, 0, size);
+    }
+
+    SGFX_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        SGFX_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(ConstantBufferHandle(g_constantBuffers.Create(buffer, shadow)));
+}
+
+void updateConstantBuffer(ConstantBufferHandle handle, const void* mem)
+{
+    SGFX_CAPTURE(UpdateConstantBuffer, handle, CaptureConstantData{ mem });
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        DXConstantBuffer* constantBuffer = g_constantBuffers.Get(handle.value);
+        ID3D11Buffer*     buffer         = constantBuffer->buffer;
+
+        D3D11_BUFFER_DESC bufferDesc;
+        buffer->GetDesc(&bufferDesc);
+
+        g_pImmediateContext->UpdateSubresource(buffer, 0, nullptr, mem, 0, 0);
+        if (constantBuffer->shadow != nullptr)
+            std::memcpy(constantBuffer->shadow, mem, bufferDesc.ByteWidth);
+
+        SGFX_STAT(numBytesUploaded, bufferDesc.ByteWidth);
+    }
+}
+
+void updateConstantBuffer(ConstantBufferHandle handle, const void* mem, size_t offset, size_t size)
+{
+    SGFX_CAPTURE(UpdateConstantBufferRange, handle, CaptureData{ mem, size }, offset, size);
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        DXConstantBuffer* constantBuffer = g_constantBuffers.Get(handle.value);
+        ID3D11Buffer*     buffer         = constantBuffer->buffer;
+
+        D3D11_BUFFER_DESC bufferDesc;
+        buffer->GetDesc(&bufferDesc);
+
+        if (offset >= bufferDesc.ByteWidth)
+            return;
+        if (size > bufferDesc.ByteWidth - offset)
+            size = bufferDesc.ByteWidth - offset;
+
+#ifdef SGFX_USE_D3D11_1
+        if (g_constantBufferOffsets) {
+            D3D11_BOX box;
+            box.left   = static_cast<UINT>(offset);
+            box.right  = static_cast<UINT>(offset + size);
+            box.top    = 0;
+            box.bottom = 1;
+            box.front  = 0;
+            box.back   = 1;
+
+            g_pImmediateContext1->UpdateSubresource1(buffer, 0, &box, mem, 0, 0, 0);
+            SGFX_STAT(numBytesUploaded, size);
+            return;
+        }
+#endif
+
+        // D3D11.0 only updates whole constant buffers, the range goes into the shadow copy first
+        std::memcpy(constantBuffer->shadow + offset, mem, size);
+        g_pImmediateContext->UpdateSubresource(buffer, 0, nullptr, constantBuffer->shadow, 0, 0);
+
+        SGFX_STAT(numBytesUploaded, bufferDesc.ByteWidth);
+    }
+}
+
+void releaseConstantBuffer(ConstantBufferHandle handle)
+{
+    SGFX_CAPTURE(ReleaseConstantBuffer, handle);
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        ID3D11Buffer* buffer = dxGetConstantBuffer(handle.value);
+        buffer->Release();
+        g_constantBuffers.Release(handle.value);
+    }
+}
+
+ConstantAllocatorHandle createConstantAllocator(size_t pageSize)
+{
+    SGFX_CAPTURE(CreateConstantAllocator, pageSize);
+    bool packBlocks = (getGPUCaps() & GPUCaps::ConstantBufferOffsets) != 0;
+    return SGFX_CAPTURE_RESULT(ConstantAllocatorHandle(g_constantAllocators.Create(pageSize, packBlocks)));
+}
+
+void releaseConstantAllocator(ConstantAllocatorHandle handle)
+{
+    SGFX_CAPTURE(ReleaseConstantAllocator, handle);
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->releasePages();
+        g_constantAllocators.Release(handle.value);
+    }
+}
+
+ConstantBlock allocateConstantBlock(ConstantAllocatorHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateConstantBlock, handle, CaptureData{ mem, size }, size);
+    ConstantBlock block;
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        block = g_constantAllocators.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != ConstantBufferHandle::invalidHandle())
+            updateConstantBuffer(block.buffer, mem, block.offset, size);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeConstantBlock(ConstantAllocatorHandle handle, const ConstantBlock& block)
+{
+    SGFX_CAPTURE(FreeConstantBlock, handle, capturePod(block));
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->free(block);
+    }
+}
+
+TransientAllocation allocateTransient(size_t size, size_t alignment)
+{
+    SGFX_CAPTURE(AllocateTransient, size, alignment);
+    return SGFX_CAPTURE_RESULT(g_transientRing.allocate(size, alignment));
+}
+
+BufferHeapHandle createBufferHeap(uint32_t flags, size_t size, size_t stride)
+{
+    SGFX_CAPTURE(CreateBufferHeap, flags, size, stride);
+    uint32_t handle = g_bufferHeaps.Create(flags, size, stride);
+    if (!g_bufferHeaps.Get(handle)->init()) {
+        g_bufferHeaps.Get(handle)->releaseBuffers();
+        g_bufferHeaps.Release(handle);
+        return SGFX_CAPTURE_RESULT(BufferHeapHandle::invalidHandle());
+    }
+    return SGFX_CAPTURE_RESULT(BufferHeapHandle(handle));
+}
+
+void releaseBufferHeap(BufferHeapHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBufferHeap, handle);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->releaseBuffers();
+        g_bufferHeaps.Release(handle.value);
+    }
+}
+
+BufferBlock allocateBufferBlock(BufferHeapHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateBufferBlock, handle, CaptureData{ mem, size }, size);
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != BufferHandle::invalidHandle())
+            copyBufferData(block.buffer, block.offset, size, mem);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeBufferBlock(BufferHeapHandle handle, const BufferBlock& block)
+{
+    SGFX_CAPTURE(FreeBufferBlock, handle, capturePod(block));
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->free(block.id);
+    }
+}
+
+BufferBlock getBufferBlock(BufferHeapHandle handle, uint32_t id)
+{
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->getBlock(id);
     }
-
-    return ConstantBufferHandle(buffer);
+    return block;
 }
 
-void updateConstantBuffer(ConstantBufferHandle handle, const void* mem)
+size_t compactBufferHeap(BufferHeapHandle handle, size_t maxBytes)
 {
-    if (handle != ConstantBufferHandle::invalidHandle()) {
-        ID3D11Buffer* buffer = static_cast<ID3D11Buffer*>(handle.value);
-
-        g_pImmediateContext->UpdateSubresource(buffer, 0, nullptr, mem, 0, 0);
+    SGFX_CAPTURE(CompactBufferHeap, handle, maxBytes);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        return SGFX_CAPTURE_RESULT(g_bufferHeaps.Get(handle.value)->compact(maxBytes));
     }
+    return SGFX_CAPTURE_RESULT(static_cast<size_t>(0));
 }
 
-void releaseConstantBuffer(ConstantBufferHandle handle)
+BufferHeapStats getBufferHeapStats(BufferHeapHandle handle)
 {
-    if (handle != ConstantBufferHandle::invalidHandle()) {
-        ID3D11Buffer* buffer = static_cast<ID3D11Buffer*>(handle.value);
-        buffer->Release();
+    BufferHeapStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        stats = g_bufferHeaps.Get(handle.value)->getStats();
     }
+    return stats;
 }
 
 SamplerStateHandle createSamplerState(const SamplerStateDescriptor& desc)
 {
+    SGFX_CAPTURE(CreateSamplerState, capturePod(desc));
     D3D11_SAMPLER_DESC samplerDesc;
     std::memset(&samplerDesc, 0, sizeof(samplerDesc));
 
@@ -1435,22 +2602,25 @@ SamplerStateHandle createSamplerState(const SamplerStateDescriptor& desc)
     ID3D11SamplerState* sampler = nullptr;
     if (FAILED(g_pd3dDevice->CreateSamplerState(&samplerDesc, &sampler))) {
         // TODO: error handling
-        return SamplerStateHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(SamplerStateHandle::invalidHandle());
     }
 
-    return SamplerStateHandle(sampler);
+    return SGFX_CAPTURE_RESULT(SamplerStateHandle(g_samplerStates.Create(sampler)));
 }
 
 void releaseSamplerState(SamplerStateHandle handle)
 {
+    SGFX_CAPTURE(ReleaseSamplerState, handle);
     if (handle != SamplerStateHandle::invalidHandle()) {
-        ID3D11SamplerState* samplerState = static_cast<ID3D11SamplerState*>(handle.value);
+        ID3D11SamplerState* samplerState = g_samplerStates.GetValue(handle.value);
         samplerState->Release();
+        g_samplerStates.Release(handle.value);
     }
 }
 
 Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
+    SGFX_CAPTURE(CreateTexture1D, width, format, numMipmaps, flags);
     UINT        bindFlags   = D3D11_BIND_SHADER_RESOURCE;
     D3D11_USAGE usageFlags  = D3D11_USAGE_DEFAULT;
     UINT        cpuAccess   = 0;
@@ -1489,7 +2659,7 @@ Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numM
     ID3D11Texture1D* d3dTexture = nullptr;
     if (FAILED(g_pd3dDevice->CreateTexture1D(&textureDesc, nullptr, &d3dTexture))) {
         // TODO: error handling
-        return Texture1DHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
     }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -1505,7 +2675,7 @@ Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numM
         if (FAILED(g_pd3dDevice->CreateShaderResourceView(d3dTexture, &viewDesc, &d3dResourceView))) {
             // TODO: error handling
             d3dTexture->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
@@ -1523,20 +2693,24 @@ Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numM
             d3dTexture->Release();
             if (d3dResourceView != nullptr)
                 d3dResourceView->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
-    DXSharedBuffer* texture = sgfx::sgfx_new<DXSharedBuffer>();
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* texture = g_sharedBuffers.Get(handle);
     texture->dataBuffer = d3dTexture;
     texture->dataView   = d3dResourceView;
     texture->dataUAV    = d3dUAV;
 
-    return Texture1DHandle(texture);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture1DHandle(handle));
 }
 
 Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
+    SGFX_CAPTURE(CreateTexture2D, width, height, format, numMipmaps, flags);
     UINT        bindFlags   = D3D11_BIND_SHADER_RESOURCE;
     D3D11_USAGE usageFlags  = D3D11_USAGE_DEFAULT;
     UINT        cpuAccess   = 0;
@@ -1600,7 +2774,7 @@ Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat form
     ID3D11Texture2D* d3dTexture = nullptr;
     if (FAILED(g_pd3dDevice->CreateTexture2D(&textureDesc, nullptr, &d3dTexture))) {
         // TODO: error handling
-        return Texture1DHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
     }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -1616,7 +2790,7 @@ Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat form
         if (FAILED(g_pd3dDevice->CreateShaderResourceView(d3dTexture, &viewDesc, &d3dResourceView))) {
             // TODO: error handling
             d3dTexture->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
@@ -1634,20 +2808,24 @@ Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat form
             d3dTexture->Release();
             if (d3dResourceView != nullptr)
                 d3dResourceView->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
-    DXSharedBuffer* texture = sgfx::sgfx_new<DXSharedBuffer>();
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* texture = g_sharedBuffers.Get(handle);
     texture->dataBuffer = d3dTexture;
     texture->dataView   = d3dResourceView;
     texture->dataUAV    = d3dUAV;
 
-    return Texture2DHandle(texture);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture2DHandle(handle));
 }
 
 Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
+    SGFX_CAPTURE(CreateTexture3D, width, height, depth, format, numMipmaps, flags);
     UINT        bindFlags   = D3D11_BIND_SHADER_RESOURCE;
     D3D11_USAGE usageFlags  = D3D11_USAGE_DEFAULT;
     UINT        cpuAccess   = 0;
@@ -1687,7 +2865,7 @@ Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth,
     ID3D11Texture3D* d3dTexture = nullptr;
     if (FAILED(g_pd3dDevice->CreateTexture3D(&textureDesc, nullptr, &d3dTexture))) {
         // TODO: error handling
-        return Texture1DHandle::invalidHandle();
+        return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
     }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -1703,7 +2881,7 @@ Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth,
         if (FAILED(g_pd3dDevice->CreateShaderResourceView(d3dTexture, &viewDesc, &d3dResourceView))) {
             // TODO: error handling
             d3dTexture->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
@@ -1723,22 +2901,26 @@ Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth,
             d3dTexture->Release();
             if (d3dResourceView != nullptr)
                 d3dResourceView->Release();
-            return Texture1DHandle::invalidHandle();
+            return SGFX_CAPTURE_RESULT(Texture1DHandle::invalidHandle());
         }
     }
 
-    DXSharedBuffer* texture = sgfx::sgfx_new<DXSharedBuffer>();
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* texture = g_sharedBuffers.Get(handle);
     texture->dataBuffer = d3dTexture;
     texture->dataView   = d3dResourceView;
     texture->dataUAV    = d3dUAV;
 
-    return Texture3DHandle(texture);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture3DHandle(handle));
 }
 
 void clearTextureRW(TextureHandle handle, uint32_t value)
 {
+    SGFX_CAPTURE(ClearTextureRWUInt, handle, value);
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         uint32_t d3dValues[4] = { value, 0, 0, 0 };
 
@@ -1749,8 +2931,9 @@ void clearTextureRW(TextureHandle handle, uint32_t value)
 
 void clearTextureRW(TextureHandle handle, float value)
 {
+    SGFX_CAPTURE(ClearTextureRWFloat, handle, value);
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         float d3dValues[4] = { value, 0.F, 0.0F, 0.0F };
 
@@ -1761,25 +2944,27 @@ void clearTextureRW(TextureHandle handle, float value)
 
 void* mapTexture(TextureHandle handle, MapType type)
 {
+    SGFX_CAPTURE(MapTexture, handle, type);
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         D3D11_MAPPED_SUBRESOURCE mappedData;
         std::memset(&mappedData, 0, sizeof(mappedData));
 
         if (FAILED(g_pImmediateContext->Map(buffer->dataBuffer, 0, MapMapType[static_cast<size_t>(type)], 0, &mappedData))) {
-            return nullptr;
+            return SGFX_CAPTURE_RESULT(nullptr);
         }
 
-        return mappedData.pData;
+        return SGFX_CAPTURE_RESULT(mappedData.pData);
     }
-    return nullptr;
+    return SGFX_CAPTURE_RESULT(nullptr);
 }
 
 void unmapTexture(TextureHandle handle)
 {
+    SGFX_CAPTURE(UnmapTexture, handle);
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
 
         g_pImmediateContext->Unmap(buffer->dataBuffer, 0);
     }
@@ -1794,8 +2979,11 @@ void updateTexture(
     size_t rowPitch, size_t depthPitch
 )
 {
+    SGFX_CAPTURE(UpdateTexture, handle, CaptureTextureData{ mem, sizeX, sizeY, sizeZ, rowPitch, depthPitch }, mip, offsetX, sizeX, offsetY, sizeY, offsetZ, sizeZ, rowPitch, depthPitch);
+    SGFX_PROFILE_ZONE("sgfx::updateTexture");
+
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* texture  = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* texture  = g_sharedBuffers.Get(handle.value);
 
         D3D11_BOX box;
         box.left   = static_cast<UINT>(offsetX);
@@ -1806,22 +2994,61 @@ void updateTexture(
         box.back   = static_cast<UINT>(offsetZ + sizeZ);
 
         g_pImmediateContext->UpdateSubresource(texture->dataBuffer, mip, &box, mem, static_cast<UINT>(rowPitch), static_cast<UINT>(depthPitch));
+
+        // the source footprint the pitches describe
+        SGFX_STAT(numBytesUploaded, (sizeZ > 1) ? depthPitch * sizeZ : rowPitch * sizeY);
     }
 }
 
 void releaseTexture(TextureHandle handle)
 {
+    SGFX_CAPTURE(ReleaseTexture, handle);
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* texture = static_cast<DXSharedBuffer*>(handle.value);
-        sgfx::sgfx_delete(texture);
+        g_sharedBuffers.Release(handle.value);
+    }
+}
+
+ResourceTableHandle createResourceTable(const ResourceTableEntry* entries, uint32_t numEntries)
+{
+    SGFX_CAPTURE(CreateResourceTable, CaptureData{ entries, numEntries * sizeof(ResourceTableEntry) }, numEntries);
+    if (numEntries > ResourceTable::kMaxResources)
+        return SGFX_CAPTURE_RESULT(ResourceTableHandle::invalidHandle());
+
+    uint32_t handle = g_resourceTables.Create();
+
+    DXResourceTable* impl = g_resourceTables.Get(handle);
+    impl->table.init(entries, numEntries);
+
+    for (uint32_t i = 0; i < numEntries; ++i) {
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(impl->table.resources[i].value);
+
+        impl->views[i] = (buffer != nullptr) ? buffer->dataView : nullptr;
+        if (impl->views[i] != nullptr)
+            impl->views[i]->AddRef();
+    }
+
+    return SGFX_CAPTURE_RESULT(ResourceTableHandle(handle));
+}
+
+void releaseResourceTable(ResourceTableHandle handle)
+{
+    SGFX_CAPTURE(ReleaseResourceTable, handle);
+    if (handle != ResourceTableHandle::invalidHandle()) {
+        DXResourceTable* impl = g_resourceTables.Get(handle.value);
+        for (uint32_t i = 0; i < impl->table.numResources; ++i) {
+            if (impl->views[i] != nullptr)
+                impl->views[i]->Release();
+        }
+        g_resourceTables.Release(handle.value);
     }
 }
 
 void copyResource(TextureHandle src, TextureHandle dst)
 {
+    SGFX_CAPTURE(CopyResourceTexture, src, dst);
     if (src != dst && src != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* dxSrc = static_cast<DXSharedBuffer*>(src.value);
-        DXSharedBuffer* dxDst = static_cast<DXSharedBuffer*>(dst.value);
+        DXSharedBuffer* dxSrc = g_sharedBuffers.Get(src.value);
+        DXSharedBuffer* dxDst = g_sharedBuffers.Get(dst.value);
 
         g_pImmediateContext->CopyResource(dxDst->dataBuffer, dxSrc->dataBuffer);
     }
@@ -1829,43 +3056,87 @@ void copyResource(TextureHandle src, TextureHandle dst)
 
 void copyResource(BufferHandle src, BufferHandle dst)
 {
+    SGFX_CAPTURE(CopyResourceBuffer, src, dst);
     if (src != dst && src != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* dxSrc = static_cast<DXSharedBuffer*>(src.value);
-        DXSharedBuffer* dxDst = static_cast<DXSharedBuffer*>(dst.value);
+        DXSharedBuffer* dxSrc = g_sharedBuffers.Get(src.value);
+        DXSharedBuffer* dxDst = g_sharedBuffers.Get(dst.value);
 
         g_pImmediateContext->CopyResource(dxDst->dataBuffer, dxSrc->dataBuffer);
     }
 }
 
+void copyBufferRegion(BufferHandle dst, size_t dstOffset, BufferHandle src, size_t srcOffset, size_t size)
+{
+    SGFX_CAPTURE(CopyBufferRegion, dst, dstOffset, src, srcOffset, size);
+    if (src != dst && src != BufferHandle::invalidHandle() && dst != BufferHandle::invalidHandle()) {
+        DXSharedBuffer* dxSrc = g_sharedBuffers.Get(src.value);
+        DXSharedBuffer* dxDst = g_sharedBuffers.Get(dst.value);
+
+        D3D11_BOX box;
+        box.left   = static_cast<UINT>(srcOffset);
+        box.right  = static_cast<UINT>(srcOffset + size);
+        box.top    = 0;
+        box.bottom = 1;
+        box.front  = 0;
+        box.back   = 1;
+
+        g_pImmediateContext->CopySubresourceRegion(
+            dxDst->dataBuffer, 0,
+            static_cast<UINT>(dstOffset), 0, 0,
+            dxSrc->dataBuffer, 0,
+            &box
+        );
+
+        SGFX_STAT(numBytesCopied, size);
+    }
+}
+
 void copyResource(ConstantBufferHandle src, ConstantBufferHandle dst)
 {
+    SGFX_CAPTURE(CopyResourceConstantBuffer, src, dst);
     if (src != dst && src != ConstantBufferHandle::invalidHandle()) {
-        ID3D11Buffer* dxSrc = static_cast<ID3D11Buffer*>(src.value);
-        ID3D11Buffer* dxDst = static_cast<ID3D11Buffer*>(dst.value);
+        DXConstantBuffer* dxSrc = g_constantBuffers.Get(src.value);
+        DXConstantBuffer* dxDst = g_constantBuffers.Get(dst.value);
+        if (dxDst == nullptr)
+            return;
+
+        g_pImmediateContext->CopyResource(dxDst->buffer, dxSrc->buffer);
 
-        g_pImmediateContext->CopyResource(dxDst, dxSrc);
+        // CopyResource needs buffers of the same size
+        if (dxDst->shadow != nullptr) {
+            D3D11_BUFFER_DESC bufferDesc;
+            dxDst->buffer->GetDesc(&bufferDesc);
+            std::memcpy(dxDst->shadow, dxSrc->shadow, bufferDesc.ByteWidth);
+        }
     }
 }
 
 Texture2DHandle getBackBuffer()
 {
-    DXSharedBuffer* buffer = sgfx_new<DXSharedBuffer>();
+    SGFX_CAPTURE(GetBackBuffer);
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* buffer = g_sharedBuffers.Get(handle);
     if (FAILED(g_pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&buffer->dataBuffer))) {
         // TODO: error handling
-        return Texture2DHandle::invalidHandle();
+        g_sharedBuffers.Release(handle);
+        return SGFX_CAPTURE_RESULT(Texture2DHandle::invalidHandle());
     }
 
-    return Texture2DHandle(buffer);
+    return SGFX_CAPTURE_RESULT(Texture2DHandle(handle));
 }
 
 RenderTargetHandle createRenderTarget(const RenderTargetDescriptor& desc)
 {
-    RenderTargetImpl* impl = sgfx_new<RenderTargetImpl>();
+    SGFX_CAPTURE(CreateRenderTarget, capturePod(desc));
+    uint32_t handle = g_renderTargets.Create();
+
+    RenderTargetImpl* impl = g_renderTargets.Get(handle);
 
     impl->numRenderTargets = desc.numColorTextures;
 
     for (uint32_t i = 0; i < desc.numColorTextures; ++i) {
-        DXSharedBuffer* textureResource = static_cast<DXSharedBuffer*>(desc.colorTextures[i].value);
+        DXSharedBuffer* textureResource = g_sharedBuffers.Get(desc.colorTextures[i].value);
 
         D3D11_RENDER_TARGET_VIEW_DESC rtDesc;
         std::memset(&rtDesc, 0, sizeof(rtDesc));
@@ -1877,14 +3148,14 @@ RenderTargetHandle createRenderTarget(const RenderTargetDescriptor& desc)
         ID3D11RenderTargetView* renderTargetView = nullptr;
         if (FAILED(g_pd3dDevice->CreateRenderTargetView(textureResource->dataBuffer, &rtDesc, &renderTargetView))) {
             // TODO: error handling
-            sgfx_delete(impl);
-            return RenderTargetHandle::invalidHandle();
+            g_renderTargets.Release(handle);
+            return SGFX_CAPTURE_RESULT(RenderTargetHandle::invalidHandle());
         }
 
         impl->renderTargetViews[i] = renderTargetView;
     }
 
-    DXSharedBuffer* depthStencilResource = static_cast<DXSharedBuffer*>(desc.depthStencilTexture.value);
+    DXSharedBuffer* depthStencilResource = g_sharedBuffers.Get(desc.depthStencilTexture.value);
 
     if (depthStencilResource != nullptr) {
         D3D11_DEPTH_STENCIL_VIEW_DESC dsDesc;
@@ -1908,26 +3179,27 @@ RenderTargetHandle createRenderTarget(const RenderTargetDescriptor& desc)
         ID3D11DepthStencilView* depthStencilView = nullptr;
         if (FAILED(g_pd3dDevice->CreateDepthStencilView(depthStencilResource->dataBuffer, &dsDesc, &depthStencilView))) {
             // TODO: error handling
-            sgfx_delete(impl);
-            return RenderTargetHandle::invalidHandle();
+            g_renderTargets.Release(handle);
+            return SGFX_CAPTURE_RESULT(RenderTargetHandle::invalidHandle());
         }
 
         impl->depthStencilView = depthStencilView;
     }
 
-    return RenderTargetHandle(impl);
+    return SGFX_CAPTURE_RESULT(RenderTargetHandle(handle));
 }
 
 void releaseRenderTarget(RenderTargetHandle handle)
 {
+    SGFX_CAPTURE(ReleaseRenderTarget, handle);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
-        sgfx_delete(rtimpl);
+        g_renderTargets.Release(handle.value);
     }
 }
 
 void setViewport(uint32_t width, uint32_t height, float minDepth, float maxDepth)
 {
+    SGFX_CAPTURE(SetViewport, width, height, minDepth, maxDepth);
     D3D11_VIEWPORT vp;
 
     vp.Width    = static_cast<float>(width);
@@ -1942,12 +3214,13 @@ void setViewport(uint32_t width, uint32_t height, float minDepth, float maxDepth
 
 void setResourceRW(RenderTargetHandle handle, uint32_t idx, BufferHandle resource)
 {
+    SGFX_CAPTURE(SetResourceRWBufferRenderTarget, handle, idx, resource);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
 
         ID3D11UnorderedAccessView* uav = nullptr;
         if (resource != BufferHandle::invalidHandle()) {
-            DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(resource.value);
+            DXSharedBuffer* buffer = g_sharedBuffers.Get(resource.value);
 
             uav = buffer->dataUAV;
         }
@@ -1958,12 +3231,13 @@ void setResourceRW(RenderTargetHandle handle, uint32_t idx, BufferHandle resourc
 
 void setResourceRW(RenderTargetHandle handle, uint32_t idx, TextureHandle resource)
 {
+    SGFX_CAPTURE(SetResourceRWTextureRenderTarget, handle, idx, resource);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
 
         ID3D11UnorderedAccessView* uav = nullptr;
         if (resource != TextureHandle::invalidHandle()) {
-            DXSharedBuffer* texture = static_cast<DXSharedBuffer*>(resource.value);
+            DXSharedBuffer* texture = g_sharedBuffers.Get(resource.value);
 
             uav = texture->dataUAV;
         }
@@ -1974,6 +3248,7 @@ void setResourceRW(RenderTargetHandle handle, uint32_t idx, TextureHandle resour
 
 void setRenderTarget(RenderTargetHandle handle)
 {
+    SGFX_CAPTURE(SetRenderTarget, handle);
     // reset previous RTs
     ID3D11RenderTargetView*     rtViews[RenderTargetSlot::Count]    = { nullptr };
     ID3D11UnorderedAccessView*  uaViews[1]                          = { nullptr };
@@ -1985,7 +3260,7 @@ void setRenderTarget(RenderTargetHandle handle)
     );
 
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
 
         g_pImmediateContext->OMSetRenderTargetsAndUnorderedAccessViews(
             rtimpl->numRenderTargets, rtimpl->renderTargetViews,
@@ -1994,12 +3269,15 @@ void setRenderTarget(RenderTargetHandle handle)
             rtimpl->uavCounters
         );
     }
+
+    SGFX_STAT(numRenderTargetChanges, 1);
 }
 
 void clearRenderTarget(RenderTargetHandle handle, uint32_t color)
 {
+    SGFX_CAPTURE(ClearRenderTarget, handle, color);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
         float fcolor[4];
         fcolor[0] = static_cast<float>((color >> 0)  & 0xFF) / 255.0F;
         fcolor[1] = static_cast<float>((color >> 8)  & 0xFF) / 255.0F;
@@ -2015,8 +3293,9 @@ void clearRenderTarget(RenderTargetHandle handle, uint32_t color)
 
 void clearRenderTarget(RenderTargetHandle handle, uint32_t slot, uint32_t color)
 {
+    SGFX_CAPTURE(ClearRenderTargetSlot, handle, slot, color);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
         float fcolor[4];
         fcolor[0] = static_cast<float>((color >> 0)  & 0xFF) / 255.0F;
         fcolor[1] = static_cast<float>((color >> 8)  & 0xFF) / 255.0F;
@@ -2030,8 +3309,9 @@ void clearRenderTarget(RenderTargetHandle handle, uint32_t slot, uint32_t color)
 
 void clearDepthStencil(RenderTargetHandle handle, float depth, uint8_t stencil)
 {
+    SGFX_CAPTURE(ClearDepthStencil, handle, depth, stencil);
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* rtimpl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* rtimpl = g_renderTargets.Get(handle.value);
 
         if (rtimpl->depthStencilView != nullptr)
             g_pImmediateContext->ClearDepthStencilView(rtimpl->depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, depth, stencil);
@@ -2040,147 +3320,556 @@ void clearDepthStencil(RenderTargetHandle handle, float depth, uint8_t stencil)
 
 void present(uint32_t swapInterval)
 {
+    SGFX_CAPTURE(Present, swapInterval);
     g_pSwapChain->Present(swapInterval, 0);
+
+    resetFrameArenas();
+    g_transientRing.endFrame();
+
+    g_lastFrameStats = g_frameStats;
+    std::memset(&g_frameStats, 0, sizeof(g_frameStats));
 }
 
 // draw queue stuff is similar for all APIs
 
-DrawQueueHandle createDrawQueue(PipelineStateHandle state)
+FrameArenaHandle createFrameArena(size_t blockSize)
+{
+    SGFX_CAPTURE(CreateFrameArena, blockSize);
+    if (blockSize == 0)
+        blockSize = FrameArena::kDefaultBlockSize;
+
+    uint32_t handle = g_frameArenas.Create(blockSize);
+
+    FrameArena* arena = g_frameArenas.Get(handle);
+    arena->nextArena  = g_userFrameArenas;
+    g_userFrameArenas = arena;
+
+    return SGFX_CAPTURE_RESULT(FrameArenaHandle(handle));
+}
+
+void releaseFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(ReleaseFrameArena, handle);
+    if (handle != FrameArenaHandle::invalidHandle()) {
+        FrameArena* arena = g_frameArenas.Get(handle.value);
+
+        for (FrameArena** link = &g_userFrameArenas; *link != nullptr; link = &(*link)->nextArena) {
+            if (*link == arena) {
+                *link = arena->nextArena;
+                break;
+            }
+        }
+
+        if (t_frameArena == arena)
+            t_frameArena = nullptr;
+
+        g_frameArenas.Release(handle.value);
+    }
+}
+
+void setThreadFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(SetThreadFrameArena, handle);
+    t_frameArena = g_frameArenas.Get(handle.value);
+}
+
+DrawQueueHandle createDrawQueue(PipelineStateHandle state, uint32_t flags)
 {
-    DrawQueue* queue = sgfx_new<DrawQueue>(state);
-    return DrawQueueHandle(queue);
+    SGFX_CAPTURE(CreateDrawQueue, state, flags);
+    return SGFX_CAPTURE_RESULT(DrawQueueHandle(g_drawQueues.Create(state, flags)));
 }
 
 void releaseDrawQueue(DrawQueueHandle handle)
 {
+    SGFX_CAPTURE(ReleaseDrawQueue, handle);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
-        sgfx_delete(queue);
+        g_drawQueues.Release(handle.value);
     }
 }
 
 void setSamplerState(DrawQueueHandle handle, uint32_t idx, SamplerStateHandle sampler)
 {
+    SGFX_CAPTURE(SetSamplerState, handle, idx, sampler);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setSamplerState(idx, sampler);
     }
 }
 
+void setSortKey(DrawQueueHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(SetSortKey, handle, key);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(ResetBindings, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->resetBindings();
+    }
+}
+
 void setPrimitiveTopology(DrawQueueHandle handle, PrimitiveTopology topology)
 {
+    SGFX_CAPTURE(SetPrimitiveTopology, handle, topology);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setPrimitiveTopology(topology);
     }
 }
 
 void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx)
 {
+    SGFX_CAPTURE(SetVertexBuffer, handle, vb, idx);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setVertexBuffer(idx, vb);
     }
 }
 
 void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib)
 {
+    SGFX_CAPTURE(SetIndexBuffer, handle, ib);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setIndexBuffer(ib);
     }
 }
 
+void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(SetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(SetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(SetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset, format);
+    }
+}
+
 void setConstantBuffer(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer)
 {
+    SGFX_CAPTURE(SetConstantBuffer, handle, idx, buffer);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setConstantBuffer(idx, buffer);
     }
 }
 
+void setConstantBufferRange(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(SetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
 void setResource(DrawQueueHandle handle, uint32_t idx, BufferHandle resource)
 {
+    SGFX_CAPTURE(SetResourceBuffer, handle, idx, resource);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
 void setResource(DrawQueueHandle handle, uint32_t idx, TextureHandle resource)
 {
+    SGFX_CAPTURE(SetResourceTexture, handle, idx, resource);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
+void setResourceTable(DrawQueueHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(SetResourceTable, handle, firstSlot, table);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawQueueHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(SetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setInlineConstants(idx, data, size);
+    }
+}
+
 void draw(DrawQueueHandle handle, uint32_t count, uint32_t startVertex)
 {
+    SGFX_CAPTURE(Draw, handle, count, startVertex);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->draw(count, startVertex);
     }
 }
 
 void drawIndexed(DrawQueueHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
 {
+    SGFX_CAPTURE(DrawIndexed, handle, count, startIndex, startVertex);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawIndexed(count, startIndex, startVertex);
     }
 }
 
 void drawInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
 {
+    SGFX_CAPTURE(DrawInstanced, handle, instanceCount, count, startVertex, startInstance);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawInstanced(instanceCount, count, startVertex, startInstance);
     }
 }
 
 void drawIndexedInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
 {
+    SGFX_CAPTURE(DrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
     }
 }
 
 void drawInstancedIndirect(DrawQueueHandle handle, BufferHandle indirectArgs, size_t argsOffset)
 {
+    SGFX_CAPTURE(DrawInstancedIndirect, handle, indirectArgs, argsOffset);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawInstancedIndirect(indirectArgs, argsOffset);
     }
 }
 
 void drawIndexedInstancedIndirect(DrawQueueHandle handle, BufferHandle indirectArgs, size_t argsOffset)
 {
+    SGFX_CAPTURE(DrawIndexedInstancedIndirect, handle, indirectArgs, argsOffset);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawIndexedInstancedIndirect(indirectArgs, argsOffset);
     }
 }
 
-void submit(DrawQueueHandle handle)
+DrawRecorderHandle createDrawRecorder(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(CreateDrawRecorder, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+
+        uint32_t recorderHandle = g_drawRecorders.Create();
+        queue->attachRecorder(g_drawRecorders.Get(recorderHandle));
+
+        return SGFX_CAPTURE_RESULT(DrawRecorderHandle(recorderHandle));
+    }
+    return SGFX_CAPTURE_RESULT(DrawRecorderHandle::invalidHandle());
+}
+
+void releaseDrawRecorder(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseDrawRecorder, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        g_drawRecorders.Release(handle.value);
+    }
+}
+
+void setDrawRecorderKey(DrawRecorderHandle handle, uint32_t key)
+{
+    SGFX_CAPTURE(SetDrawRecorderKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setKey(key);
+    }
+}
+
+void setSortKey(DrawRecorderHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(RecorderSetSortKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(RecorderResetBindings, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->resetBindings();
+    }
+}
+
+void setPrimitiveTopology(DrawRecorderHandle handle, PrimitiveTopology topology)
+{
+    SGFX_CAPTURE(RecorderSetPrimitiveTopology, handle, topology);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setPrimitiveTopology(topology);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx)
+{
+    SGFX_CAPTURE(RecorderSetVertexBuffer, handle, vb, idx);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib)
+{
+    SGFX_CAPTURE(RecorderSetIndexBuffer, handle, ib);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset, format);
+    }
+}
+
+void setConstantBuffer(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer)
+{
+    SGFX_CAPTURE(RecorderSetConstantBuffer, handle, idx, buffer);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBuffer(idx, buffer);
+    }
+}
+
+void setConstantBufferRange(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(RecorderSetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceBuffer, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceTexture, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResourceTable(DrawRecorderHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(RecorderSetResourceTable, handle, firstSlot, table);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawRecorderHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(RecorderSetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setInlineConstants(idx, data, size);
+    }
+}
+
+void draw(DrawRecorderHandle handle, uint32_t count, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDraw, handle, count, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->draw(count, startVertex);
+    }
+}
+
+void drawIndexed(DrawRecorderHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDrawIndexed, handle, count, startIndex, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexed(count, startIndex, startVertex);
+    }
+}
+
+void drawInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawInstanced, handle, instanceCount, count, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawInstanced(instanceCount, count, startVertex, startInstance);
+    }
+}
+
+void drawIndexedInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
+    }
+}
+
+void drawInstancedIndirect(DrawRecorderHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(RecorderDrawInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+void drawIndexedInstancedIndirect(DrawRecorderHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(RecorderDrawIndexedInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexedInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+void submit(DrawQueueHandle handle, uint32_t flags)
 {
+    SGFX_CAPTURE(Submit, handle, flags);
+    SGFX_PROFILE_ZONE("sgfx::submit");
+
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
-        if (queue->getDrawCalls().GetSize() != 0) {
-            dxProcessDrawQueue(queue);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        QueueStatsScope statsScope(queue->stats);
+
+        if (queue->getNumDrawCalls() != 0) {
+            g_transientRing.unmap();
+            dxProcessDrawQueue(queue, flags);
             queue->clear();
         }
     }
 }
 
+BundleHandle createBundle(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(CreateBundle, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue  = g_drawQueues.Get(handle.value);
+        uint32_t   bundle = g_bundles.Create(*queue);
+
+        if (bundle != 0) {
+            DXBundleBaker baker = { g_bundles.Get(bundle) };
+            bakeDrawCalls(queue, baker);
+            baker.bundle->numReleases = dxNumBundleReleases();
+        }
+
+        queue->clear();
+        return SGFX_CAPTURE_RESULT(BundleHandle(bundle));
+    }
+    return SGFX_CAPTURE_RESULT(BundleHandle::invalidHandle());
+}
+
+void releaseBundle(BundleHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBundle, handle);
+    if (handle != BundleHandle::invalidHandle()) {
+        g_bundles.Release(handle.value);
+    }
+}
+
+bool isBundleValid(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return dxValidateBundle(g_bundles.Get(handle.value));
+    return false;
+}
+
+uint32_t getNumDrawCalls(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return g_bundles.Get(handle.value)->numDrawCalls;
+    return 0;
+}
+
+void submit(BundleHandle handle, const uint64_t* visibilityMask)
+{
+    SGFX_CAPTURE(SubmitBundle, handle, CaptureBundleMask{ handle, visibilityMask });
+    SGFX_PROFILE_ZONE("sgfx::submitBundle");
+
+    if (handle != BundleHandle::invalidHandle()) {
+        DXBundle* bundle = g_bundles.Get(handle.value);
+        if (dxValidateBundle(bundle) && bundle->numDrawCalls != 0) {
+            g_transientRing.unmap();
+            dxProcessBundle(bundle, visibilityMask);
+        }
+    }
+}
+
 void flush()
 {
+    SGFX_CAPTURE(Flush);
     g_pImmediateContext->Flush();
 }
 
 void beginPerfEvent(const wchar_t* name)
 {
+    SGFX_CAPTURE(BeginPerfEvent, CaptureWideString{ name });
+    g_profiler.begin(name, true);
+
 #ifdef SGFX_USE_D3D11_1
     if (g_debugAnnotation)
         g_debugAnnotation->BeginEvent(name);
@@ -2189,10 +3878,57 @@ void beginPerfEvent(const wchar_t* name)
 
 void endPerfEvent()
 {
+    SGFX_CAPTURE(EndPerfEvent);
 #ifdef SGFX_USE_D3D11_1
     if (g_debugAnnotation)
         g_debugAnnotation->EndEvent();
 #endif
+
+    g_profiler.end();
+}
+
+void startProfiler()
+{
+    g_profiler.start();
+}
+
+void stopProfiler()
+{
+    g_profiler.stop();
+}
+
+bool writeProfilerTrace(const char* path)
+{
+    return g_profiler.writeTrace(path);
+}
+
+bool startCapture(const char* path)
+{
+    DXGI_SWAP_CHAIN_DESC desc;
+    if (FAILED(g_pSwapChain->GetDesc(&desc)))
+        return false;
+    return g_captureWriter.start(path, desc.BufferDesc.Width, desc.BufferDesc.Height);
+}
+
+void stopCapture()
+{
+    g_captureWriter.stop();
+}
+
+const FrameStats& getFrameStats()
+{
+    return g_lastFrameStats;
+}
+
+QueueStats getQueueStats(DrawQueueHandle handle)
+{
+    QueueStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        stats = g_drawQueues.Get(handle.value)->stats;
+    }
+    return stats;
 }
 
 // D3D11 interop
@@ -2201,13 +3937,13 @@ namespace d3d11
 
 ID3D11Buffer* getNativeBuffer(ConstantBufferHandle handle)
 {
-    return static_cast<ID3D11Buffer*>(handle.value);
+    return dxGetConstantBuffer(handle.value);
 }
 
 ID3D11Resource* getNativeResource(BufferHandle handle)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataBuffer;
     }
     return nullptr;
@@ -2216,7 +3952,7 @@ ID3D11Resource* getNativeResource(BufferHandle handle)
 ID3D11ShaderResourceView* getNativeSRV(BufferHandle handle)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataView;
     }
     return nullptr;
@@ -2225,7 +3961,7 @@ ID3D11ShaderResourceView* getNativeSRV(BufferHandle handle)
 ID3D11UnorderedAccessView* getNativeUAV(BufferHandle handle)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataUAV;
     }
     return nullptr;
@@ -2234,7 +3970,7 @@ ID3D11UnorderedAccessView* getNativeUAV(BufferHandle handle)
 ID3D11Resource* getNativeResource(TextureHandle handle)
 {
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataBuffer;
     }
     return nullptr;
@@ -2243,7 +3979,7 @@ ID3D11Resource* getNativeResource(TextureHandle handle)
 ID3D11ShaderResourceView* getNativeSRV(TextureHandle handle)
 {
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataView;
     }
     return nullptr;
@@ -2252,7 +3988,7 @@ ID3D11ShaderResourceView* getNativeSRV(TextureHandle handle)
 ID3D11UnorderedAccessView* getNativeUAV(TextureHandle handle)
 {
     if (handle != TextureHandle::invalidHandle()) {
-        DXSharedBuffer* buffer = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
         return buffer->dataUAV;
     }
     return nullptr;
@@ -2260,13 +3996,13 @@ ID3D11UnorderedAccessView* getNativeUAV(TextureHandle handle)
 
 ID3D11SamplerState* getNativeSamplerState(SamplerStateHandle handle)
 {
-    return static_cast<ID3D11SamplerState*>(handle.value);
+    return g_samplerStates.GetValue(handle.value);
 }
 
 ID3D11RenderTargetView* getNativeRTV(RenderTargetHandle handle, size_t idx)
 {
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* impl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
         return impl->renderTargetViews[idx];
     }
     return nullptr;
@@ -2275,7 +4011,7 @@ ID3D11RenderTargetView* getNativeRTV(RenderTargetHandle handle, size_t idx)
 ID3D11DepthStencilView* getNativeDSV(RenderTargetHandle handle)
 {
     if (handle != RenderTargetHandle::invalidHandle()) {
-        RenderTargetImpl* impl = static_cast<RenderTargetImpl*>(handle.value);
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
         return impl->depthStencilView;
     }
     return nullptr;
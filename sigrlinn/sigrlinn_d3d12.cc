@@ -231,19 +231,6 @@ static inline void sgfx_free(void* ptr)
     return free(ptr);
 }
 
-template <typename T, typename ...Args>
-static inline T* sgfx_new(Args&... args)
-{
-    return new (g_allocFunc(sizeof(T))) T(static_cast<Args&&>(args)...);
-}
-
-template <typename T>
-static inline void sgfx_delete(T* t)
-{
-    t->~T();
-    g_freeFunc(t);
-}
-
 //=============================================================================
 struct DXDescriptorAllocator final
 {
@@ -413,15 +400,26 @@ struct DXConstantBuffer final
     }
 };
 
+//=============================================================================
+// object tables, the handle values index into these
+static HandleTable<DXCommonShaderImpl>      g_shaders;
+static HandleTable<DXSurfaceShaderImpl>     g_surfaceShaders;
+static HandleTable<DXInputLayoutImpl>       g_vertexFormats;
+static HandleTable<ID3D12PipelineState*>    g_pipelineStates;
+static HandleTable<DXSharedBuffer>          g_sharedBuffers;
+static HandleTable<DXConstantBuffer>        g_constantBuffers;
+
 template <typename T>
 static inline T dxCreateCommonShader(const void* bytecode, size_t bytecodeSize)
 {
-    DXCommonShaderImpl* impl = sgfx_new<DXCommonShaderImpl>();
+    uint32_t handle = g_shaders.Create();
+
+    DXCommonShaderImpl* impl = g_shaders.Get(handle);
     impl->bytecodeSize = bytecodeSize;
     impl->bytecode     = sgfx_malloc(impl->bytecodeSize);
     std::memcpy(impl->bytecode, bytecode, impl->bytecodeSize);
 
-    return T(impl);
+    return T(handle);
 }
 
 static inline D3D12_SHADER_BYTECODE dxGetShaderBytecode(DXCommonShaderImpl* impl)
@@ -663,8 +661,7 @@ VertexShaderHandle createVertexShader(const void* data, size_t dataSize)
 void releaseVertexShader(VertexShaderHandle handle)
 {
     if (handle != VertexShaderHandle::invalidHandle()) {
-        DXCommonShaderImpl* impl = static_cast<DXCommonShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_shaders.Release(handle.value);
     }
 }
 
@@ -676,8 +673,7 @@ HullShaderHandle createHullShader(const void* data, size_t dataSize)
 void releaseHullShader(HullShaderHandle handle)
 {
     if (handle != HullShaderHandle::invalidHandle()) {
-        DXCommonShaderImpl* impl = static_cast<DXCommonShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_shaders.Release(handle.value);
     }
 }
 
@@ -689,8 +685,7 @@ DomainShaderHandle createDomainShader(const void* data, size_t dataSize)
 void releaseDomainShader(DomainShaderHandle handle)
 {
     if (handle != DomainShaderHandle::invalidHandle()) {
-        DXCommonShaderImpl* impl = static_cast<DXCommonShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_shaders.Release(handle.value);
     }
 }
 
@@ -702,34 +697,38 @@ GeometryShaderHandle createGeometryShader(const void* data, size_t dataSize)
 void releaseGeometryShader(GeometryShaderHandle handle)
 {
     if (handle != GeometryShaderHandle::invalidHandle()) {
-        DXCommonShaderImpl* impl = static_cast<DXCommonShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_shaders.Release(handle.value);
     }
 }
 
 SurfaceShaderHandle  linkSurfaceShader(
-    VertexShaderHandle   vs,
-    HullShaderHandle     hs,
-    DomainShaderHandle   ds,
-    GeometryShaderHandle gs,
-    PixelShaderHandle    ps
+    VertexShaderHandle          vs,
+    HullShaderHandle            hs,
+    DomainShaderHandle          ds,
+    GeometryShaderHandle        gs,
+    PixelShaderHandle           ps,
+    const SurfaceBindingLayout* layout
 )
 {
-    DXSurfaceShaderImpl* impl = sgfx_new<DXSurfaceShaderImpl>();
-    impl->vs = static_cast<DXCommonShaderImpl*>(vs.value);
-    impl->hs = static_cast<DXCommonShaderImpl*>(hs.value);
-    impl->ds = static_cast<DXCommonShaderImpl*>(ds.value);
-    impl->gs = static_cast<DXCommonShaderImpl*>(gs.value);
-    impl->ps = static_cast<DXCommonShaderImpl*>(ps.value);
-
-    return SurfaceShaderHandle(impl);
+    // TODO: build the root signature from the layout
+    (void)layout;
+
+    uint32_t handle = g_surfaceShaders.Create();
+
+    DXSurfaceShaderImpl* impl = g_surfaceShaders.Get(handle);
+    impl->vs = g_shaders.Get(vs.value);
+    impl->hs = g_shaders.Get(hs.value);
+    impl->ds = g_shaders.Get(ds.value);
+    impl->gs = g_shaders.Get(gs.value);
+    impl->ps = g_shaders.Get(ps.value);
+
+    return SurfaceShaderHandle(handle);
 }
 
 void releaseSurfaceShader(SurfaceShaderHandle handle)
 {
     if (handle != SurfaceShaderHandle::invalidHandle()) {
-        DXSurfaceShaderImpl* impl = static_cast<DXSurfaceShaderImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_surfaceShaders.Release(handle.value);
     }
 }
 
@@ -754,7 +753,9 @@ VertexFormatHandle createVertexFormat(
     if (elements == nullptr || size == 0)
         return VertexFormatHandle::invalidHandle();
 
-    DXInputLayoutImpl* impl = sgfx_new<DXInputLayoutImpl>();
+    uint32_t handle = g_vertexFormats.Create();
+
+    DXInputLayoutImpl* impl = g_vertexFormats.Get(handle);
 
     size_t totalSize = size * sizeof(D3D12_INPUT_ELEMENT_DESC);
     D3D12_INPUT_ELEMENT_DESC* inputData = reinterpret_cast<D3D12_INPUT_ELEMENT_DESC*>(sgfx_malloc(totalSize));
@@ -778,14 +779,13 @@ VertexFormatHandle createVertexFormat(
     impl->inputElementsSize = size;
     impl->stride            = stride;
 
-    return VertexFormatHandle(impl);
+    return VertexFormatHandle(handle);
 }
 
 void releaseVertexFormat(VertexFormatHandle handle)
 {
     if (handle != VertexFormatHandle::invalidHandle()) {
-        DXInputLayoutImpl* impl = static_cast<DXInputLayoutImpl*>(handle.value);
-        sgfx_delete(impl);
+        g_vertexFormats.Release(handle.value);
     }
 }
 
@@ -820,8 +820,8 @@ PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
         return PipelineStateHandle::invalidHandle();
     }
 
-    DXInputLayoutImpl*   inputLayout = static_cast<DXInputLayoutImpl*>(desc.vertexFormat.value);
-    DXSurfaceShaderImpl* shader      = static_cast<DXSurfaceShaderImpl*>(desc.shader.value);
+    DXInputLayoutImpl*   inputLayout = g_vertexFormats.Get(desc.vertexFormat.value);
+    DXSurfaceShaderImpl* shader      = g_surfaceShaders.Get(desc.shader.value);
 
     // rasterizer state
     D3D12_RASTERIZER_DESC rasterizerDesc;
@@ -923,14 +923,15 @@ PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
     // drop the root signature because we don't need it anymore
     rootSignature->Release();
 
-    return PipelineStateHandle(pipelineState);
+    return PipelineStateHandle(g_pipelineStates.Create(pipelineState));
 }
 
 void releasePipelineState(PipelineStateHandle handle)
 {
     if (handle != PipelineStateHandle::invalidHandle()) {
-        ID3D12PipelineState* impl = static_cast<ID3D12PipelineState*>(handle.value);
+        ID3D12PipelineState* impl = g_pipelineStates.GetValue(handle.value);
         impl->Release();
+        g_pipelineStates.Release(handle.value);
     }
 }
 
@@ -1032,7 +1033,9 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
         }
     }
 
-    DXSharedBuffer* buffer = sgfx_new<DXSharedBuffer>();
+    uint32_t handle = g_sharedBuffers.Create();
+
+    DXSharedBuffer* buffer = g_sharedBuffers.Get(handle);
     buffer->dataBuffer = d3dResource;
     buffer->dataSize   = size;
     buffer->dataStride = stride;
@@ -1075,21 +1078,20 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
         );
     }
 
-    return BufferHandle(buffer);
+    return BufferHandle(handle);
 }
 
 void releaseBuffer(BufferHandle handle)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* impl = static_cast<DXSharedBuffer*>(handle.value);
-        sgfx_delete(impl);
+        g_sharedBuffers.Release(handle.value);
     }
 }
 
 void* mapBuffer(BufferHandle handle, MapType type)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* impl = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* impl = g_sharedBuffers.Get(handle.value);
         return impl->map(type);
     }
 
@@ -1099,7 +1101,7 @@ void* mapBuffer(BufferHandle handle, MapType type)
 void unmapBuffer(BufferHandle handle)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* impl = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* impl = g_sharedBuffers.Get(handle.value);
         impl->unmap();
     }
 }
@@ -1107,7 +1109,7 @@ void unmapBuffer(BufferHandle handle)
 void copyBufferData(BufferHandle handle, size_t offset, size_t size, const void* mem)
 {
     if (handle != BufferHandle::invalidHandle()) {
-        DXSharedBuffer* impl = static_cast<DXSharedBuffer*>(handle.value);
+        DXSharedBuffer* impl = g_sharedBuffers.Get(handle.value);
 
         D3D12_RANGE mappedRange = { offset, size };
         void*       mappedData  = nullptr;
@@ -1178,14 +1180,16 @@ ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
         }
     }
 
-    DXConstantBuffer* buffer = sgfx_new<DXConstantBuffer>();
+    uint32_t handle = g_constantBuffers.Create();
+
+    DXConstantBuffer* buffer = g_constantBuffers.Get(handle);
     buffer->dataBuffer = d3dResource;
 
     buffer->dataHandle              = g_srvAllocator.allocateDescriptor();
     buffer->dataView.BufferLocation = d3dResource->GetGPUVirtualAddress();
     buffer->dataView.SizeInBytes    = size;
 
-    return ConstantBufferHandle(buffer);
+    return ConstantBufferHandle(handle);
 }
 
 }
@@ -60,11 +60,79 @@ struct GLTexFilter final
     {}
 };
 
-static GLenum MapMapType[MapType::Count] = {
-    GL_READ_ONLY,
-    GL_WRITE_ONLY
+static inline void* sgfx_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static inline void sgfx_free(void* ptr)
+{
+    return free(ptr);
+}
+
+AllocFunc g_allocFunc = sgfx_malloc;
+FreeFunc  g_freeFunc  = sgfx_free;
+
+//=============================================================================
+// frame arenas backing the draw queue storage
+static FrameArena               g_frameArena;
+static FrameArena*              g_userFrameArenas = nullptr;
+static thread_local FrameArena* t_frameArena      = nullptr;
+static uint32_t                 g_frameIndex      = 1;
+
+// counted on the context thread, the last frame's counters are kept for getFrameStats
+static FrameStats               g_frameStats;
+static FrameStats               g_lastFrameStats;
+static Profiler                 g_profiler;
+static CaptureWriter            g_captureWriter;
+
+namespace SGFX_NS_INTERNAL
+{
+
+FrameArena* getFrameArena()
+{
+    return (t_frameArena != nullptr) ? t_frameArena : &g_frameArena;
+}
+
+uint32_t getFrameIndex()
+{
+    return g_frameIndex;
+}
+
+FrameStats& getStatCounters()
+{
+    return g_frameStats;
+}
+
+Profiler& getProfiler()
+{
+    return g_profiler;
+}
+
+CaptureWriter& getCaptureWriter()
+{
+    return g_captureWriter;
+}
+
+}
+
+static void resetFrameArenas()
+{
+    g_frameArena.Reset();
+    for (FrameArena* arena = g_userFrameArenas; arena != nullptr; arena = arena->nextArena)
+        arena->Reset();
+
+    g_frameIndex++;
+}
+
+// the invalidate bit orphans the storage, the driver hands out a new copy if the GPU still reads it
+static GLbitfield MapMapType[MapType::Count] = {
+    GL_MAP_READ_BIT,
+    GL_MAP_WRITE_BIT,
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT,
+    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
 };
-static_assert((sizeof(MapMapType) / sizeof(GLenum)) == static_cast<uint32_t>(MapType::Count), "Mapping is broken!");
+static_assert((sizeof(MapMapType) / sizeof(GLbitfield)) == static_cast<uint32_t>(MapType::Count), "Mapping is broken!");
 
 static GLenum MapPrimitiveTopology[PrimitiveTopology::Count] = {
     GL_TRIANGLES,
@@ -73,6 +141,18 @@ static GLenum MapPrimitiveTopology[PrimitiveTopology::Count] = {
 };
 static_assert((sizeof(MapPrimitiveTopology) / sizeof(GLenum)) == static_cast<size_t>(PrimitiveTopology::Count), "Mapping is broken!");
 
+static GLenum MapIndexFormat[IndexFormat::Count] = {
+    GL_UNSIGNED_INT,
+    GL_UNSIGNED_SHORT
+};
+static_assert((sizeof(MapIndexFormat) / sizeof(GLenum)) == static_cast<size_t>(IndexFormat::Count), "Mapping is broken!");
+
+static uint32_t MapIndexSize[IndexFormat::Count] = {
+    sizeof(uint32_t),
+    sizeof(uint16_t)
+};
+static_assert((sizeof(MapIndexSize) / sizeof(uint32_t)) == static_cast<size_t>(IndexFormat::Count), "Mapping is broken!");
+
 static GLTexFilter MapTextureFilter[TextureFilter::Count] = {
     GLTexFilter(GL_NEAREST, GL_NEAREST_MIPMAP_NEAREST),
     GLTexFilter(GL_NEAREST, GL_NEAREST_MIPMAP_LINEAR),
@@ -252,6 +332,9 @@ struct GLVertexFormatImpl final // VF is a VAO with bound attribs
 {
     GLuint vaoID = 0;
 
+    // bytes, the elements of a slot packed back to back, used for buffers created without a stride
+    GLsizei strides[DrawCall::kMaxVertexBuffers];
+
     SGFX_FORCE_INLINE GLVertexFormatImpl()  { glGenVertexArrays(1, &vaoID); }
     SGFX_FORCE_INLINE ~GLVertexFormatImpl() { glDeleteVertexArrays(1, &vaoID); }
 };
@@ -268,6 +351,84 @@ struct GLTextureImpl final
     SGFX_FORCE_INLINE ~GLTextureImpl() { glDeleteTextures(1, &textureID); }
 };
 
+// resource table with the texture and buffer names resolved at creation
+struct GLResourceTable final
+{
+    ResourceTable table;
+    GLuint        names[ResourceTable::kMaxResources];
+};
+
+//-------------------------------------------------------------------------------------------------
+// bundle command, binds are resolved to GL object names
+struct GLBundleCommand final
+{
+    DrawCommand::Opcode opcode;
+    uint32_t            slot;      // bind slot, DrawCall::Type for draws
+    uint32_t            handle;    // handle the name was resolved from, 0 for unbinds and draws
+    bool                isTexture; // resources only, textures and buffers live in different tables
+
+    union
+    {
+        GLenum          topology;
+        GLuint          name;
+
+        struct
+        {
+            GLuint      name;
+            uint32_t    offset; // bytes
+            GLsizei     stride; // 0 takes the stride from the vertex format
+        } vertexBuffer;
+
+        struct
+        {
+            uint32_t    count;
+            uint32_t    instanceCount;
+            uint32_t    startIndex;
+            uint32_t    startVertex;
+            uint32_t    startInstance;
+        } draw;
+
+        struct
+        {
+            GLuint      name;
+            uint32_t    offset; // bytes, size 0 binds the whole buffer
+            uint32_t    size;
+        } constantBuffer;
+
+        struct
+        {
+            GLuint      name;
+            uint32_t    offset; // bytes
+            IndexFormat format;
+        } indexBuffer;
+
+        struct
+        {
+            uint32_t    offset; // in the bundle's constantData
+            uint32_t    size;
+        } constants;
+    };
+};
+
+typedef DrawBundle<GLBundleCommand> GLBundle;
+
+//-------------------------------------------------------------------------------------------------
+// object tables, the handle values index into these
+static HandleTable<GLSamplerStateImpl>      g_samplerStates;
+static HandleTable<GLBufferImpl>            g_buffers; // buffers and constant buffers
+static HandleTable<GLVertexFormatImpl>      g_vertexFormats;
+static HandleTable<GLTextureImpl>           g_textures;
+static HandleTable<PipelineStateDescriptor> g_pipelineStates;
+static HandleTable<DrawQueue>               g_drawQueues;
+static HandleTable<DrawRecorder>            g_drawRecorders;
+static HandleTable<GLBundle>                g_bundles;
+static HandleTable<FrameArena>              g_frameArenas;
+static HandleTable<GLResourceTable>         g_resourceTables;
+static HandleTable<ConstantBlockAllocator>  g_constantAllocators;
+static HandleTable<BufferHeapAllocator>     g_bufferHeaps;
+
+static TransientRing                        g_transientRing;
+
 //-------------------------------------------------------------------------------------------------
 
 static SGFX_FORCE_INLINE GLenum GL_getInternalFormat(DataFormat format)
@@ -412,10 +573,10 @@ static SGFX_FORCE_INLINE GLsizei GL_getInternalStride(DataFormat format)
 static void GL_setPipelineState(PipelineStateHandle handle)
 {
     if (handle != PipelineStateHandle::invalidHandle()) {
-        PipelineStateDescriptor* state = static_cast<PipelineStateDescriptor*>(handle.value);
+        PipelineStateDescriptor* state = g_pipelineStates.Get(handle.value);
 
         // vao
-        GLVertexFormatImpl* vertexFormat = static_cast<GLVertexFormatImpl*>(state->vertexFormat.value);
+        GLVertexFormatImpl* vertexFormat = g_vertexFormats.Get(state->vertexFormat.value);
         if (vertexFormat != nullptr)
             glBindVertexArray(vertexFormat->vaoID);
         else
@@ -527,134 +688,731 @@ static void GL_setPipelineState(PipelineStateHandle handle)
         } else {
             glDisable(GL_STENCIL_TEST);
         }
+
+        SGFX_STAT(numPipelineStateChanges, 1);
     }
 }
 
-static void GL_processDrawQueue(DrawQueue* queue)
+//-------------------------------------------------------------------------------------------------
+// inline constants are streamed into one uniform buffer and bound with glBindBufferRange
+enum
 {
-    GL_setPipelineState(queue->getState());
+    kInlineConstantRingSize = 1 << 20
+};
+
+struct GLConstantRing final
+{
+    GLuint     name = 0;
+    StreamRing ring;
+};
+
+static GLConstantRing g_inlineConstantRing;
+
+// bytes, glBindBufferRange offsets into uniform buffers, GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT of
+// the context rounded up to a power of two and never below DrawCall::kInlineConstantsAlign
+static size_t g_uniformBufferAlignment = DrawCall::kInlineConstantsAlign;
 
-    // set sampler states
-    GLuint samplers[DrawQueue::kMaxSamplerStates] = { 0 };
-    for (size_t i = 0; i < DrawQueue::kMaxSamplerStates; ++i) {
-        GLSamplerStateImpl* samplerState = static_cast<GLSamplerStateImpl*>(queue->samplerStates[i].value);
+static void GL_queryUniformBufferAlignment()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    g_uniformBufferAlignment = DrawCall::kInlineConstantsAlign;
+    while (g_uniformBufferAlignment < static_cast<size_t>(alignment))
+        g_uniformBufferAlignment *= 2;
+}
 
-        if (samplerState != nullptr)
-            samplers[i] = samplerState->samplerID;
+static SGFX_FORCE_INLINE GLuint GL_getInlineConstantsBuffer()
+{
+    if (g_inlineConstantRing.name == 0) {
+        glGenBuffers(1, &g_inlineConstantRing.name);
+        glNamedBufferDataEXT(g_inlineConstantRing.name, kInlineConstantRingSize, nullptr, GL_STREAM_DRAW);
+        g_inlineConstantRing.ring.capacity = kInlineConstantRingSize;
     }
-    glBindSamplers(0, DrawQueue::kMaxSamplerStates, samplers);
+    return g_inlineConstantRing.name;
+}
 
-    // process draw calls
-    for (const DrawCall& call: queue->getDrawCalls()) {
+// returns the offset the constants were written to, wrapped is set if the ring started over
+static size_t GL_streamInlineConstants(const uint32_t* data, uint32_t size, bool& wrapped)
+{
+    GLuint name = GL_getInlineConstantsBuffer();
+
+    size_t offset = 0;
+    if (g_inlineConstantRing.ring.allocate(DrawCall::kMaxInlineConstantsSize, g_uniformBufferAlignment, offset)) {
+        // orphan the storage the GPU may still read
+        glNamedBufferDataEXT(name, kInlineConstantRingSize, nullptr, GL_STREAM_DRAW);
+        wrapped = true;
+    }
 
-        // vertex and index buffers
-        GLBufferImpl* vertexBuffer = static_cast<GLBufferImpl*>(call.vertexBuffers[0].value);
-        GLBufferImpl* indexBuffer  = static_cast<GLBufferImpl*>(call.indexBuffer.value);
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    void* ptr = glMapNamedBufferRangeEXT(name, offset, size, access);
+    if (ptr != nullptr) {
+        std::memcpy(ptr, data, size);
+        glUnmapNamedBufferEXT(name);
 
-        GLuint vbuffer = 0;
-        if (vertexBuffer != nullptr)
-            vbuffer = vertexBuffer->bufferID;
+        SGFX_STAT(numBytesUploaded, size);
+    }
 
-        GLuint ibuffer = 0;
-        if (indexBuffer != nullptr)
-            ibuffer = indexBuffer->bufferID;
+    return offset;
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbuffer);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuffer);
+//-------------------------------------------------------------------------------------------------
+// binds the ranges handed out by ShadowBindings to one indexed binding point
+struct GLRangeBinder final
+{
+    enum Target
+    {
+        Samplers,
+        UniformBuffers,
+        StorageBuffers,
+        Textures
+    };
 
-        // constant buffers
-        GLuint constantBuffers[DrawCall::kMaxConstantBuffers] = { 0 };
-        for (size_t i = 0; i < DrawCall::kMaxConstantBuffers; ++i) {
-            GLBufferImpl* buffer = static_cast<GLBufferImpl*>(call.constantBuffers[i].value);
+    Target target;
 
-            if (buffer != nullptr)
-                constantBuffers[i] = buffer->bufferID;
+    SGFX_FORCE_INLINE void operator()(uint32_t first, uint32_t count, const GLuint* names) const
+    {
+        switch (target) {
+        case Samplers:       { glBindSamplers(first, count, names); } break;
+        case UniformBuffers: { glBindBuffersBase(GL_UNIFORM_BUFFER, first, count, names); } break;
+        case StorageBuffers: { glBindBuffersBase(GL_SHADER_STORAGE_BUFFER, first, count, names); } break;
+        case Textures:       { glBindTextures(first, count, names); } break;
         }
-        glBindBuffersBase(GL_UNIFORM_BUFFER, 0, DrawCall::kMaxConstantBuffers, constantBuffers);
-
-        // shader resources
-        // this is a tricky part, because it can be either a buffer or a texture
-        // this code attempts to bind as much stuff as possible with a single call
-        enum SRVType {
-            SRV_None,
-            SRV_Texture,
-            SRV_Buffer
-        };
+    }
+};
+
+// the context's indexed bindings, forgotten after every queue because deleted objects are
+// unbound by GL behind our back and their names get reused
+struct GLStateCache final
+{
+    ShadowBindings<GLuint, DrawQueue::kMaxSamplerStates>  samplers;
+    ShadowBindings<GLuint, DrawCall::kMaxConstantBuffers> uniformBuffers;
+
+    // a shader resource slot holds either a texture or a storage buffer
+    ShadowBindings<GLuint, DrawCall::kMaxShaderResources> textures;
+    ShadowBindings<GLuint, DrawCall::kMaxShaderResources> storageBuffers;
+
+    GLRangeBinder samplerBinder       = { GLRangeBinder::Samplers };
+    GLRangeBinder uniformBufferBinder = { GLRangeBinder::UniformBuffers };
+    GLRangeBinder textureBinder       = { GLRangeBinder::Textures };
+    GLRangeBinder storageBufferBinder = { GLRangeBinder::StorageBuffers };
+
+    // slots bound to a window of their buffer (buffer ranges and inline constants in the ring),
+    // byte offset and size of the window, windows that changed are bound at the next flush
+    uint32_t        constantWindowOffsets[DrawCall::kMaxConstantBuffers] = { 0 };
+    uint32_t        constantWindowSizes[DrawCall::kMaxConstantBuffers]   = { 0 };
+    uint32_t        constantWindowMask  = 0;
+    uint32_t        constantWindowBinds = 0;
+
+    // inline constants of every slot, slots that need streaming are flagged until the next flush
+    const uint32_t* inlineConstants[DrawCall::kMaxConstantBuffers]     = { nullptr };
+    uint32_t        inlineConstantsSize[DrawCall::kMaxConstantBuffers] = { 0 };
+    uint32_t        inlineConstantMask    = 0;
+    uint32_t        inlineConstantUploads = 0;
+
+    SGFX_FORCE_INLINE void clear()
+    {
+        samplers.reset();
+        uniformBuffers.reset();
+        textures.reset();
+        storageBuffers.reset();
+
+        dropConstantWindows(constantWindowMask);
+    }
 
-        GLsizei count = 0;
-        GLuint  shaderResources[DrawCall::kMaxShaderResources] = { 0 };
-        
-        SRVType prevType    = call.shaderResources[0].isTexture ? SRV_Texture : SRV_Buffer;
-        SRVType currentType = SRV_None;
-        GLsizei lastIndex   = 0;
+    SGFX_FORCE_INLINE void setSamplerStates(const SamplerStateHandle* handles)
+    {
+        for (uint32_t i = 0; i < DrawQueue::kMaxSamplerStates; ++i) {
+            GLSamplerStateImpl* samplerState = g_samplerStates.Get(handles[i].value);
+            samplers.set(i, (samplerState != nullptr) ? samplerState->samplerID : 0);
+        }
 
-        for (GLsizei i = 0; i < DrawCall::kMaxShaderResources; ++i) {
-            const ShaderResource& resource = call.shaderResources[i];
+        samplers.flush(samplerBinder);
+    }
 
-            if (resource.isTexture)
-                currentType = SRV_Texture;
-            else
-                currentType = SRV_Buffer;
-
-            if (resource.isTexture) {
-                if (prevType != currentType) { // flush buffers
-                    glBindBuffersBase(GL_SHADER_STORAGE_BUFFER, i, count, shaderResources);
-                    lastIndex = i;
-                    count     = 0;
-                    prevType  = currentType;
-                }
+    SGFX_FORCE_INLINE void dropInlineConstants(uint32_t mask)
+    {
+        inlineConstantMask    &= ~mask;
+        inlineConstantUploads &= ~mask;
+
+        for (; mask != 0; mask &= mask - 1)
+            inlineConstants[bitScanForward(mask)] = nullptr;
+    }
+
+    SGFX_FORCE_INLINE void dropConstantWindows(uint32_t mask)
+    {
+        constantWindowMask  &= ~mask;
+        constantWindowBinds &= ~mask;
+        dropInlineConstants(inlineConstantMask & mask);
+    }
+
+    // the whole buffer, a slot holding a window is bound again even if the buffer stays the same
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t i, GLuint name)
+    {
+        if ((constantWindowMask | inlineConstantMask) & (1u << i)) {
+            dropConstantWindows(1u << i);
+            uniformBuffers.invalidate(i);
+        }
+        uniformBuffers.set(i, name);
+    }
+
+    // windows are bound by bindConstantWindows(), the shadow copy only learns about the buffer
+    SGFX_FORCE_INLINE void setConstantWindow(uint32_t i, GLuint name, uint32_t offset, uint32_t size)
+    {
+        uint32_t bit = 1u << i;
+
+        if ((constantWindowMask & bit) == 0 || uniformBuffers.get(i) != name
+            || constantWindowOffsets[i] != offset || constantWindowSizes[i] != size) {
+            uniformBuffers.assume(i, name);
+            constantWindowOffsets[i] = offset;
+            constantWindowSizes[i]   = size;
+            constantWindowBinds |= bit;
+        }
+
+        constantWindowMask |= bit;
+    }
 
-                GLTextureImpl* texture = static_cast<GLTextureImpl*>(resource.value);
-                shaderResources[count] = texture->textureID;
-                count++;
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t i, GLuint name, uint32_t offset, uint32_t size)
+    {
+        if (name == 0) {
+            setConstantBuffer(i, 0);
+            return;
+        }
+
+        dropInlineConstants(inlineConstantMask & (1u << i));
+        setConstantWindow(i, name, offset, size);
+    }
+
+    // data must stay put until the next flush, constants at the same address are streamed once
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t i, const uint32_t* data, uint32_t size)
+    {
+        uint32_t bit = 1u << i;
+
+        if (inlineConstants[i] != data) {
+            inlineConstants[i]     = data;
+            inlineConstantsSize[i] = size;
+            inlineConstantUploads |= bit;
+        }
+
+        inlineConstantMask |= bit;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffers(const DrawCall& call)
+    {
+        uint64_t mask = call.constantBufferMask | call.inlineConstantMask;
+        uniformBuffers.unbindExcept(&mask);
+        dropConstantWindows(constantWindowMask & ~static_cast<uint32_t>(mask));
+
+        while (mask != 0) {
+            uint32_t i = bitScanForward(mask);
+            if (call.inlineConstantMask & (1u << i)) {
+                setInlineConstants(i, call.inlineConstants[i], call.inlineConstantsSize[i]);
             } else {
-                if (prevType != currentType) { // flush textures
-                    glBindTextures(i, count, shaderResources);
-                    lastIndex = i;
-                    count     = 0;
-                    prevType  = currentType;
+                GLBufferImpl* buffer = g_buffers.Get(call.constantBuffers[i].value);
+                GLuint        name   = (buffer != nullptr) ? buffer->bufferID : 0;
+
+                if (call.constantBufferSizes[i] != 0)
+                    setConstantBufferRange(i, name, call.constantBufferOffsets[i], call.constantBufferSizes[i]);
+                else
+                    setConstantBuffer(i, name);
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    SGFX_FORCE_INLINE bool streamInlineConstants(uint32_t mask)
+    {
+        bool wrapped = false;
+        for (; mask != 0; mask &= mask - 1) {
+            uint32_t i      = bitScanForward(mask);
+            size_t   offset = GL_streamInlineConstants(inlineConstants[i], inlineConstantsSize[i], wrapped);
+            setConstantWindow(i, g_inlineConstantRing.name, static_cast<uint32_t>(offset), DrawCall::kMaxInlineConstantsSize);
+        }
+        return wrapped;
+    }
+
+    // ranges streamed before the ring started over are gone, so a wrap restreams every slot
+    inline void uploadInlineConstants()
+    {
+        if (streamInlineConstants(inlineConstantUploads))
+            streamInlineConstants(inlineConstantMask);
+
+        inlineConstantUploads = 0;
+    }
+
+    SGFX_FORCE_INLINE void bindConstantWindows()
+    {
+        for (; constantWindowBinds != 0; constantWindowBinds &= constantWindowBinds - 1) {
+            uint32_t i = bitScanForward(constantWindowBinds);
+            glBindBufferRange(GL_UNIFORM_BUFFER, i, uniformBuffers.get(i), constantWindowOffsets[i], constantWindowSizes[i]);
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, 1);
+        }
+    }
+
+    SGFX_FORCE_INLINE void setShaderResource(uint32_t i, bool isTexture, GLuint name)
+    {
+        textures.set(i, isTexture ? name : 0);
+        storageBuffers.set(i, isTexture ? 0 : name);
+    }
+
+    // resources set on their own take precedence over the call's resource table
+    SGFX_FORCE_INLINE void setShaderResources(const DrawCall& call)
+    {
+        const GLResourceTable* table = g_resourceTables.Get(call.resourceTable.value);
+
+        uint32_t tableSlot     = call.resourceTableSlot;
+        uint32_t numTableSlots = (table != nullptr) ? table->table.getNumSlots(tableSlot) : 0;
+
+        uint64_t masks[2] = { call.shaderResourceMask[0], call.shaderResourceMask[1] };
+        addSlotRange(masks, tableSlot, numTableSlots);
+
+        textures.unbindExcept(masks);
+        storageBuffers.unbindExcept(masks);
+
+        for (uint32_t word = 0; word < 2; ++word) {
+            uint64_t mask = masks[word];
+            while (mask != 0) {
+                uint32_t i = word * 64 + bitScanForward(mask);
+                const ShaderResource& resource = call.shaderResources[i];
+
+                if (resource.value == 0 && i - tableSlot < numTableSlots) {
+                    uint32_t entry = i - tableSlot;
+                    setShaderResource(i, table->table.resources[entry].isTexture, table->names[entry]);
+                    mask &= mask - 1;
+                    continue;
                 }
 
-                GLBufferImpl* buffer   = static_cast<GLBufferImpl*>(resource.value);
-                shaderResources[count] = buffer->bufferID;
-                count++;
+                GLuint name = 0;
+                if (resource.isTexture) {
+                    GLTextureImpl* texture = g_textures.Get(resource.value);
+                    if (texture != nullptr)
+                        name = texture->textureID;
+                } else {
+                    GLBufferImpl* buffer = g_buffers.Get(resource.value);
+                    if (buffer != nullptr)
+                        name = buffer->bufferID;
+                }
+
+                setShaderResource(i, resource.isTexture, name);
+                mask &= mask - 1;
             }
         }
+    }
+
+    // applies the uniform buffer and shader resource changes, called before every draw
+    SGFX_FORCE_INLINE void flush()
+    {
+        if (inlineConstantUploads != 0)
+            uploadInlineConstants();
+
+        uniformBuffers.flush(uniformBufferBinder);
+        bindConstantWindows();
+        textures.flush(textureBinder);
+        storageBuffers.flush(storageBufferBinder);
+    }
+};
+
+static GLStateCache g_stateCache;
+
+// indirect draws are counted as calls only, their arguments live on the GPU
+static SGFX_FORCE_INLINE void GL_countDraw(DrawCall::Type type, uint32_t count, uint32_t instanceCount)
+{
+    switch (type) {
+    case DrawCall::Draw:
+    case DrawCall::DrawIndexed:          { SGFX_STAT(numPrimitives, count); } break;
+    case DrawCall::DrawInstanced:
+    case DrawCall::DrawIndexedInstanced: { SGFX_STAT(numPrimitives, static_cast<uint64_t>(count) * instanceCount); } break;
+    default: break;
+    }
+
+    SGFX_STAT(numDrawCalls, 1);
+    (void)count; (void)instanceCount;
+}
+
+static void GL_processDrawQueue(DrawQueue* queue, uint32_t flags)
+{
+    GL_setPipelineState(queue->getState());
 
-        // bind remaining resources
-        if (count != 0) {
-            switch (currentType) {
-            case SRV_None:    {} break;
-            case SRV_Texture: { glBindTextures(lastIndex, count, shaderResources); } break;
-            case SRV_Buffer:  { glBindBuffersBase(GL_SHADER_STORAGE_BUFFER, lastIndex, count, shaderResources); } break;
+    PipelineStateDescriptor*  state        = g_pipelineStates.Get(queue->getState().value);
+    const GLVertexFormatImpl* vertexFormat = (state != nullptr) ? g_vertexFormats.Get(state->vertexFormat.value) : nullptr;
+
+    g_stateCache.setSamplerStates(queue->samplerStates);
+
+    // automatic instancing packs the merged constants into the transient ring
+    DrawInstancing instancing  = { PipelineStateDescriptor::kNoInstancing, 0, &g_transientRing };
+    if (state != nullptr) {
+        instancing.constantsSlot = state->instanceConstantsSlot;
+        instancing.vertexSlot    = state->instanceVertexSlot;
+    }
+    bool           isInstanced = instancing.constantsSlot != PipelineStateDescriptor::kNoInstancing;
+
+    // process draw calls
+    for (const DrawCall& call: queue->getDrawCalls(flags, isInstanced ? &instancing : nullptr)) {
+
+        // vertex buffers go to the binding point of their slot, the offset is applied there
+        if (vertexFormat != nullptr) {
+            for (uint32_t mask = call.vertexBufferMask; mask != 0; mask &= mask - 1) {
+                uint32_t      slot         = bitScanForward(mask);
+                GLBufferImpl* vertexBuffer = g_buffers.Get(call.vertexBuffers[slot].value);
+
+                GLuint  vbuffer = 0;
+                GLsizei stride  = vertexFormat->strides[slot];
+                if (vertexBuffer != nullptr) {
+                    vbuffer = vertexBuffer->bufferID;
+                    if (vertexBuffer->dataStride != 0)
+                        stride = static_cast<GLsizei>(vertexBuffer->dataStride);
+                }
+
+                glBindVertexBuffer(slot, vbuffer, call.vertexBufferOffsets[slot], stride);
+                SGFX_STAT(numInputBinds, 1);
             }
         }
 
+        GLBufferImpl* indexBuffer = g_buffers.Get(call.indexBuffer.value);
+
+        GLuint ibuffer = 0;
+        if (indexBuffer != nullptr)
+            ibuffer = indexBuffer->bufferID;
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuffer);
+        SGFX_STAT(numInputBinds, 1);
+
+        // bytes, the index buffer offset plus the first index
+        GLenum        indexType = MapIndexFormat[static_cast<size_t>(call.indexFormat)];
+        const GLvoid* indices   = reinterpret_cast<const GLvoid*>(static_cast<uintptr_t>(call.indexBufferOffset) + call.startIndex * MapIndexSize[static_cast<size_t>(call.indexFormat)]);
+
+        // constant buffers, shader resources and textures
+        g_stateCache.setConstantBuffers(call);
+        g_stateCache.setShaderResources(call);
+        g_stateCache.flush();
+
         // draw
         GLenum topology = MapPrimitiveTopology[static_cast<size_t>(call.primitiveTopology)];
 
+        GL_countDraw(call.type, call.count, call.instanceCount);
+
         switch (call.type) {
-        case DrawCall::Draw:                 { glDrawArrays(topology, call.count, call.startVertex); } break;
-        case DrawCall::DrawIndexed:          { glDrawElements(topology, call.count, GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(call.startIndex)); } break;
-        case DrawCall::DrawInstanced:        { glDrawArraysInstanced(topology, 0, call.instanceCount, call.count); } break;
-        case DrawCall::DrawIndexedInstanced: { glDrawElementsInstanced(topology, call.instanceCount, GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(call.startIndex), call.count); } break;
+        case DrawCall::Draw:                 { glDrawArrays(topology, call.startVertex, call.count); } break;
+        case DrawCall::DrawIndexed:          { glDrawElementsBaseVertex(topology, call.count, indexType, indices, call.startVertex); } break;
+        case DrawCall::DrawInstanced:        { glDrawArraysInstancedBaseInstance(topology, call.startVertex, call.count, call.instanceCount, call.startInstance); } break;
+        case DrawCall::DrawIndexedInstanced: { glDrawElementsInstancedBaseVertexBaseInstance(topology, call.count, indexType, indices, call.instanceCount, call.startVertex, call.startInstance); } break;
+        }
+    }
+
+    g_stateCache.clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+// resolves the binds handed out by bakeDrawCalls into bundle commands
+struct GLBundleBaker final
+{
+    GLBundle* bundle;
+
+    SGFX_FORCE_INLINE const ResourceTable* getResourceTable(ResourceTableHandle handle)
+    {
+        GLResourceTable* table = g_resourceTables.Get(handle.value);
+        return (table != nullptr) ? &table->table : nullptr;
+    }
+
+    SGFX_FORCE_INLINE GLBundleCommand& addCommand(DrawCommand::Opcode opcode, uint32_t slot, uint32_t handle)
+    {
+        GLBundleCommand command;
+        std::memset(&command, 0, sizeof(command));
+        command.opcode = opcode;
+        command.slot   = slot;
+        command.handle = handle;
+
+        bundle->commands.Add(command);
+        return bundle->commands[bundle->commands.GetSize() - 1];
+    }
+
+    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)
+    {
+        addCommand(DrawCommand::SetPrimitiveTopology, 0, 0).topology = MapPrimitiveTopology[static_cast<size_t>(topology)];
+    }
+
+    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle, uint32_t offset)
+    {
+        GLBufferImpl* buffer = g_buffers.Get(handle.value);
+
+        GLBundleCommand& command = addCommand(DrawCommand::SetVertexBuffer, idx, handle.value);
+        command.vertexBuffer.name   = (buffer != nullptr) ? buffer->bufferID : 0;
+        command.vertexBuffer.offset = offset;
+        command.vertexBuffer.stride = (buffer != nullptr) ? static_cast<GLsizei>(buffer->dataStride) : 0;
+    }
+
+    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle, uint32_t offset, IndexFormat format)
+    {
+        GLBufferImpl* buffer = g_buffers.Get(handle.value);
+
+        GLBundleCommand& command = addCommand(DrawCommand::SetIndexBuffer, 0, handle.value);
+        command.indexBuffer.name   = (buffer != nullptr) ? buffer->bufferID : 0;
+        command.indexBuffer.offset = offset;
+        command.indexBuffer.format = format;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle handle)
+    {
+        GLBufferImpl* buffer = g_buffers.Get(handle.value);
+        addCommand(DrawCommand::SetConstantBuffer, idx, handle.value).constantBuffer.name = (buffer != nullptr) ? buffer->bufferID : 0;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t idx, ConstantBufferHandle handle, uint32_t offset, uint32_t size)
+    {
+        GLBufferImpl*    buffer  = g_buffers.Get(handle.value);
+        GLBundleCommand& command = addCommand(DrawCommand::SetConstantBuffer, idx, handle.value);
+        command.constantBuffer.name   = (buffer != nullptr) ? buffer->bufferID : 0;
+        command.constantBuffer.offset = offset;
+        command.constantBuffer.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t idx, const uint32_t* data, uint32_t size)
+    {
+        GLBundleCommand& command = addCommand(DrawCommand::SetInlineConstants, idx, 0);
+        command.constants.offset = bundle->addConstantData(data, size);
+        command.constants.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, const ShaderResource& resource)
+    {
+        GLBundleCommand& command = addCommand(DrawCommand::SetResource, idx, resource.value);
+        command.isTexture = resource.isTexture;
+
+        if (resource.isTexture) {
+            GLTextureImpl* texture = g_textures.Get(resource.value);
+            command.name = (texture != nullptr) ? texture->textureID : 0;
+        } else {
+            GLBufferImpl* buffer = g_buffers.Get(resource.value);
+            command.name = (buffer != nullptr) ? buffer->bufferID : 0;
+        }
+    }
+
+    SGFX_FORCE_INLINE void draw(const DrawCall& call)
+    {
+        GLBundleCommand& command = addCommand(DrawCommand::Draw, call.type, 0);
+        command.draw.count         = call.count;
+        command.draw.instanceCount = call.instanceCount;
+        command.draw.startIndex    = call.startIndex;
+        command.draw.startVertex   = call.startVertex;
+        command.draw.startInstance = call.startInstance;
+
+        bundle->numDrawCalls++;
+    }
+};
+
+// releases of every object type a bundle can resolve
+static SGFX_FORCE_INLINE uint32_t GL_numBundleReleases()
+{
+    return g_buffers.GetNumReleases() + g_textures.GetNumReleases()
+        + g_samplerStates.GetNumReleases() + g_pipelineStates.GetNumReleases();
+}
+
+static bool GL_checkBundle(const GLBundle* bundle)
+{
+    if (!g_pipelineStates.IsValid(bundle->state.value))
+        return false;
+
+    for (const SamplerStateHandle& sampler : bundle->samplerStates) {
+        if (sampler.value != 0 && !g_samplerStates.IsValid(sampler.value))
+            return false;
+    }
+
+    for (const GLBundleCommand& command : bundle->commands) {
+        if (command.handle == 0)
+            continue;
+
+        bool isValid = command.isTexture
+            ? g_textures.IsValid(command.handle)
+            : g_buffers.IsValid(command.handle);
+        if (!isValid)
+            return false;
+    }
+
+    return true;
+}
+
+// only walks the bundle when something was released since the last check
+static SGFX_FORCE_INLINE bool GL_validateBundle(GLBundle* bundle)
+{
+    uint32_t numReleases = GL_numBundleReleases();
+    if (bundle->isValid && bundle->numReleases != numReleases) {
+        bundle->numReleases = numReleases;
+        bundle->isValid     = GL_checkBundle(bundle);
+    }
+    return bundle->isValid;
+}
+
+// executes single bundle commands, see replayBundle
+struct GLBundleExecutor final
+{
+    GLenum                    topology;
+    const uint32_t*           constantData;
+    uintptr_t                 indexOffset; // bytes, of the bound index buffer
+    IndexFormat               indexFormat;
+    const GLVertexFormatImpl* vertexFormat;
+
+    SGFX_FORCE_INLINE void operator()(const GLBundleCommand& command)
+    {
+        switch (command.opcode) {
+        case DrawCommand::SetPrimitiveTopology: { topology = command.topology; } break;
+        case DrawCommand::SetVertexBuffer: {
+            if (vertexFormat != nullptr && command.slot < DrawCall::kMaxVertexBuffers) {
+                GLsizei stride = command.vertexBuffer.stride;
+                if (stride == 0)
+                    stride = vertexFormat->strides[command.slot];
+
+                glBindVertexBuffer(command.slot, command.vertexBuffer.name, command.vertexBuffer.offset, stride);
+                SGFX_STAT(numInputBinds, 1);
+            }
+        } break;
+        case DrawCommand::SetIndexBuffer: {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.indexBuffer.name);
+            SGFX_STAT(numInputBinds, 1);
+            indexOffset = command.indexBuffer.offset;
+            indexFormat = command.indexBuffer.format;
+        } break;
+        case DrawCommand::SetConstantBuffer: {
+            if (command.constantBuffer.size != 0)
+                g_stateCache.setConstantBufferRange(command.slot, command.constantBuffer.name, command.constantBuffer.offset, command.constantBuffer.size);
+            else
+                g_stateCache.setConstantBuffer(command.slot, command.constantBuffer.name);
+        } break;
+        case DrawCommand::SetResource:          { g_stateCache.setShaderResource(command.slot, command.isTexture, command.name); } break;
+
+        case DrawCommand::SetInlineConstants: {
+            g_stateCache.setInlineConstants(command.slot, constantData + command.constants.offset, command.constants.size);
+        } break;
+
+        case DrawCommand::Draw: {
+            const auto&   params  = command.draw;
+            GLenum        indexType = MapIndexFormat[static_cast<size_t>(indexFormat)];
+            const GLvoid* indices   = reinterpret_cast<const GLvoid*>(indexOffset + params.startIndex * MapIndexSize[static_cast<size_t>(indexFormat)]);
+
+            g_stateCache.flush();
+
+            GL_countDraw(static_cast<DrawCall::Type>(command.slot), params.count, params.instanceCount);
+
+            switch (static_cast<DrawCall::Type>(command.slot)) {
+            case DrawCall::Draw:                 { glDrawArrays(topology, params.startVertex, params.count); } break;
+            case DrawCall::DrawIndexed:          { glDrawElementsBaseVertex(topology, params.count, indexType, indices, params.startVertex); } break;
+            case DrawCall::DrawInstanced:        { glDrawArraysInstancedBaseInstance(topology, params.startVertex, params.count, params.instanceCount, params.startInstance); } break;
+            case DrawCall::DrawIndexedInstanced: { glDrawElementsInstancedBaseVertexBaseInstance(topology, params.count, indexType, indices, params.instanceCount, params.startVertex, params.startInstance); } break;
+            }
+        } break;
         }
     }
+};
+
+static void GL_processBundle(const GLBundle* bundle, const uint64_t* visibilityMask)
+{
+    GL_setPipelineState(bundle->state);
+
+    g_stateCache.setSamplerStates(bundle->samplerStates);
+
+    PipelineStateDescriptor* state        = g_pipelineStates.Get(bundle->state.value);
+    GLVertexFormatImpl*      vertexFormat = (state != nullptr) ? g_vertexFormats.Get(state->vertexFormat.value) : nullptr;
+
+    GLBundleExecutor executor = { GL_TRIANGLES, bundle->constantData.GetData(), 0, IndexFormat::UInt32, vertexFormat };
+    replayBundle(*bundle, visibilityMask, executor);
+
+    g_stateCache.clear();
 }
 
 //=============================================================================
 bool initOpenGL()
 {
     glewInit();
+    GL_queryUniformBufferAlignment();
     return true;
 }
 
 void shutdown()
-{}
+{
+    g_captureWriter.stop();
+
+    // storage recorded before the shutdown must not look current after the next init
+    resetFrameArenas();
+
+    // objects the application did not release go away while the context is still alive
+    g_transientRing.release();
+    g_drawRecorders.Purge();
+    g_drawQueues.Purge();
+    g_bundles.Purge();
+    g_textures.Purge();
+    g_buffers.Purge();
+    g_samplerStates.Purge();
+    g_vertexFormats.Purge();
+    g_frameArenas.Purge();
+    g_userFrameArenas = nullptr;
+
+    g_frameArena.Purge();
+    g_profiler.release();
+
+    if (g_inlineConstantRing.name != 0)
+        glDeleteBuffers(1, &g_inlineConstantRing.name);
+    g_inlineConstantRing = GLConstantRing();
+}
+
+void setAllocator(AllocFunc nalloc, FreeFunc nfree)
+{
+    g_allocFunc = nalloc;
+    g_freeFunc  = nfree;
+}
+
+void* allocate(size_t size)
+{
+    return g_allocFunc(size);
+}
+
+void deallocate(void* ptr)
+{
+    return g_freeFunc(ptr);
+}
 
 uint64_t getGPUCaps()
 {
-    return 0; // not implemented yet
+    uint64_t caps = 0;
+
+    // default features, core since GL 2.0
+    caps |= GPUCaps::MultipleRenderTargets;
+    caps |= GPUCaps::AlphaToCoverage;
+
+    if (GLEW_VERSION_3_0) {
+        caps |= GPUCaps::TextureArray;
+        caps |= GPUCaps::StreamOutput; // transform feedback
+        caps |= GPUCaps::TextureFormatInteger;
+        caps |= GPUCaps::TextureFormatFloat;
+    }
+
+    if (GLEW_VERSION_3_2)
+        caps |= GPUCaps::GeometryShader;
+
+    if (GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader)
+        caps |= GPUCaps::TessellationShader;
+    if (GLEW_VERSION_4_0 || GLEW_ARB_texture_cube_map_array)
+        caps |= GPUCaps::CubemapArray;
+    if (GLEW_VERSION_4_0 || GLEW_ARB_draw_buffers_blend)
+        caps |= GPUCaps::SeparateBlend; // per render target blend states
+
+    if (GLEW_VERSION_4_3 || GLEW_ARB_compute_shader)
+        caps |= GPUCaps::ComputeShader;
+    if (GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object) {
+        caps |= GPUCaps::StructuredBuffer;
+        caps |= GPUCaps::RWStructuredBuffer;
+    }
+
+    if (GLEW_EXT_texture_compression_s3tc)
+        caps |= GPUCaps::TextureCompressionDXT;
+    if (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility)
+        caps |= GPUCaps::TextureCompressionETC;
+
+    // glBindBufferRange is core, but constant blocks are packed at kBlockAlign offsets
+    if (g_uniformBufferAlignment <= ConstantBlockAllocator::kBlockAlign)
+        caps |= GPUCaps::ConstantBufferOffsets;
+
+    return caps;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -672,6 +1430,8 @@ bool compileShader(
     size_t& outDataSize
 )
 {
+    SGFX_PROFILE_ZONE("sgfx::compileShader");
+
     return false;
 }
 
@@ -682,51 +1442,69 @@ VertexFormatHandle createVertexFormat(
     ErrorReportFunc          errorReport
 )
 {
-    GLVertexFormatImpl* impl = new GLVertexFormatImpl;
+    SGFX_CAPTURE(CreateVertexFormat, CaptureVertexElements{ elements, size }, size, CaptureData{ shaderBytecode, shaderBytecodeSize }, shaderBytecodeSize);
+    uint32_t handle = g_vertexFormats.Create();
 
+    GLVertexFormatImpl* impl = g_vertexFormats.Get(handle);
+
+    // attribs read from the binding point of their slot, buffers and offsets are bound per draw
+    std::memset(impl->strides, 0, sizeof(impl->strides));
     glBindVertexArray(impl->vaoID);
     for (GLuint i = 0; i < size; ++i) {
-        glVertexAttribPointer(
+        GLuint slot = elements[i].slot;
+        if (slot >= DrawCall::kMaxVertexBuffers)
+            continue;
+
+        glVertexAttribFormat(
             i,
             GL_getInternalSize(elements[i].format),
             GL_getInternalType(elements[i].format),
-            false,
-            GL_getInternalStride(elements[i].format),
-            reinterpret_cast<const GLvoid*>(elements[i].offset)
+            GL_FALSE,
+            static_cast<GLuint>(elements[i].offset)
         );
+        glVertexAttribBinding(i, slot);
+        glVertexBindingDivisor(slot, elements[i].perInstanceData ? 1 : 0);
         glEnableVertexAttribArray(i);
+
+        GLsizei end = static_cast<GLsizei>(elements[i].offset) + GL_getInternalStride(elements[i].format);
+        if (end > impl->strides[slot])
+            impl->strides[slot] = end;
     }
     glBindVertexArray(0);
 
-    return VertexFormatHandle(impl);
+    return SGFX_CAPTURE_RESULT(VertexFormatHandle(handle));
 }
 
 void releaseVertexFormat(VertexFormatHandle handle)
 {
+    SGFX_CAPTURE(ReleaseVertexFormat, handle);
     if (handle != VertexFormatHandle::invalidHandle()) {
-        GLVertexFormatImpl* impl = static_cast<GLVertexFormatImpl*>(handle.value);
-        delete impl;
+        g_vertexFormats.Release(handle.value);
     }
 }
 
 PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
 {
-    PipelineStateDescriptor* ret = new PipelineStateDescriptor;
-    std::memcpy(ret, &desc, sizeof(PipelineStateDescriptor));
-    return PipelineStateHandle(ret);
+    SGFX_CAPTURE(CreatePipelineState, capturePod(desc));
+    SGFX_PROFILE_ZONE("sgfx::createPipelineState");
+
+    return SGFX_CAPTURE_RESULT(PipelineStateHandle(g_pipelineStates.Create(desc)));
 }
 
 void releasePipelineState(PipelineStateHandle handle)
 {
+    SGFX_CAPTURE(ReleasePipelineState, handle);
     if (handle != PipelineStateHandle::invalidHandle()) {
-        PipelineStateDescriptor* desc = static_cast<PipelineStateDescriptor*>(handle.value);
-        delete desc;
+        g_pipelineStates.Release(handle.value);
     }
 }
 
 BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t stride)
 {
-    GLBufferImpl* impl = new GLBufferImpl;
+    SGFX_CAPTURE(CreateBuffer, flags, CaptureData{ mem, size }, size, stride);
+    uint32_t handle = g_buffers.Create();
+
+    GLBufferImpl* impl = g_buffers.Get(handle);
 
     enum class AccessFrequency { Static, Dynamic };
     enum class AccessNature    { Draw,   Read, Copy };
@@ -756,6 +1534,10 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
         nature = AccessNature::Read;
     }
 
+    // buffers created without data are filled later
+    if (mem == nullptr)
+        freq = AccessFrequency::Dynamic;
+
     GLenum glUsage = 0;
     switch (freq) {
     case AccessFrequency::Static: {
@@ -781,32 +1563,39 @@ BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t s
 
     glNamedBufferDataEXT(impl->bufferID, size, mem, glUsage);
 
-    return BufferHandle(impl);
+    SGFX_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        SGFX_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(BufferHandle(handle));
 }
 
 void releaseBuffer(BufferHandle handle)
 {
+    SGFX_CAPTURE(ReleaseBuffer, handle);
     if (handle != BufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
-        delete impl;
+        g_buffers.Release(handle.value);
     }
 }
 
 void* mapBuffer(BufferHandle handle, MapType type)
 {
+    SGFX_CAPTURE(MapBuffer, handle, type);
     if (handle != BufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
+        GLBufferImpl* impl = g_buffers.Get(handle.value);
 
-        return glMapNamedBufferEXT(impl->bufferID, MapMapType[static_cast<uint64_t>(type)]);
+        SGFX_STAT(numBufferMaps, 1);
+        return SGFX_CAPTURE_RESULT(glMapNamedBufferRangeEXT(impl->bufferID, 0, impl->dataSize, MapMapType[static_cast<uint64_t>(type)]));
     }
 
-    return nullptr;
+    return SGFX_CAPTURE_RESULT(nullptr);
 }
 
 void unmapBuffer(BufferHandle handle)
 {
+    SGFX_CAPTURE(UnmapBuffer, handle);
     if (handle != BufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
+        GLBufferImpl* impl = g_buffers.Get(handle.value);
 
         glUnmapNamedBufferEXT(impl->bufferID);
     }
@@ -814,16 +1603,37 @@ void unmapBuffer(BufferHandle handle)
 
 void copyBufferData(BufferHandle handle, size_t offset, size_t size, const void* mem)
 {
+    SGFX_CAPTURE(CopyBufferData, handle, offset, size, CaptureData{ mem, size });
+    SGFX_PROFILE_ZONE("sgfx::copyBufferData");
+
     if (handle != BufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
+        GLBufferImpl* impl = g_buffers.Get(handle.value);
 
         glNamedBufferSubDataEXT(impl->bufferID, offset, size, mem);
+
+        SGFX_STAT(numBytesUploaded, size);
+    }
+}
+
+void copyBufferRegion(BufferHandle dst, size_t dstOffset, BufferHandle src, size_t srcOffset, size_t size)
+{
+    SGFX_CAPTURE(CopyBufferRegion, dst, dstOffset, src, srcOffset, size);
+    if (src != dst && src != BufferHandle::invalidHandle() && dst != BufferHandle::invalidHandle()) {
+        GLBufferImpl* glSrc = g_buffers.Get(src.value);
+        GLBufferImpl* glDst = g_buffers.Get(dst.value);
+
+        glNamedCopyBufferSubDataEXT(glSrc->bufferID, glDst->bufferID, srcOffset, dstOffset, size);
+
+        SGFX_STAT(numBytesCopied, size);
     }
 }
 
 ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
 {
-    GLBufferImpl* impl = new GLBufferImpl;
+    SGFX_CAPTURE(CreateConstantBuffer, CaptureData{ mem, size }, size);
+    uint32_t handle = g_buffers.Create();
+
+    GLBufferImpl* impl = g_buffers.Get(handle);
 
     impl->isImmutable  = false;
     impl->isStructured = false;
@@ -832,29 +1642,172 @@ ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
 
     glNamedBufferDataEXT(impl->bufferID, size, mem, GL_DYNAMIC_DRAW);
 
-    return ConstantBufferHandle(impl);
+    SGFX_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        SGFX_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(ConstantBufferHandle(handle));
 }
 
 void updateConstantBuffer(ConstantBufferHandle handle, const void* mem)
 {
+    SGFX_CAPTURE(UpdateConstantBuffer, handle, CaptureConstantData{ mem });
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
     if (handle != ConstantBufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
+        GLBufferImpl* impl = g_buffers.Get(handle.value);
 
         glNamedBufferSubDataEXT(impl->bufferID, 0, impl->dataSize, mem);
+
+        SGFX_STAT(numBytesUploaded, impl->dataSize);
+    }
+}
+
+void updateConstantBuffer(ConstantBufferHandle handle, const void* mem, size_t offset, size_t size)
+{
+    SGFX_CAPTURE(UpdateConstantBufferRange, handle, CaptureData{ mem, size }, offset, size);
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        GLBufferImpl* impl = g_buffers.Get(handle.value);
+
+        if (offset < impl->dataSize) {
+            size = (size < impl->dataSize - offset) ? size : impl->dataSize - offset;
+            glNamedBufferSubDataEXT(impl->bufferID, offset, size, mem);
+
+            SGFX_STAT(numBytesUploaded, size);
+        }
     }
 }
 
 void releaseConstantBuffer(ConstantBufferHandle handle)
 {
+    SGFX_CAPTURE(ReleaseConstantBuffer, handle);
     if (handle != ConstantBufferHandle::invalidHandle()) {
-        GLBufferImpl* impl = static_cast<GLBufferImpl*>(handle.value);
-        delete impl;
+        g_buffers.Release(handle.value);
+    }
+}
+
+ConstantAllocatorHandle createConstantAllocator(size_t pageSize)
+{
+    SGFX_CAPTURE(CreateConstantAllocator, pageSize);
+    bool packBlocks = (getGPUCaps() & GPUCaps::ConstantBufferOffsets) != 0;
+    return SGFX_CAPTURE_RESULT(ConstantAllocatorHandle(g_constantAllocators.Create(pageSize, packBlocks)));
+}
+
+void releaseConstantAllocator(ConstantAllocatorHandle handle)
+{
+    SGFX_CAPTURE(ReleaseConstantAllocator, handle);
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->releasePages();
+        g_constantAllocators.Release(handle.value);
+    }
+}
+
+ConstantBlock allocateConstantBlock(ConstantAllocatorHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateConstantBlock, handle, CaptureData{ mem, size }, size);
+    ConstantBlock block;
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        block = g_constantAllocators.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != ConstantBufferHandle::invalidHandle())
+            updateConstantBuffer(block.buffer, mem, block.offset, size);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeConstantBlock(ConstantAllocatorHandle handle, const ConstantBlock& block)
+{
+    SGFX_CAPTURE(FreeConstantBlock, handle, capturePod(block));
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->free(block);
     }
 }
 
+TransientAllocation allocateTransient(size_t size, size_t alignment)
+{
+    SGFX_CAPTURE(AllocateTransient, size, alignment);
+    return SGFX_CAPTURE_RESULT(g_transientRing.allocate(size, alignment));
+}
+
+BufferHeapHandle createBufferHeap(uint32_t flags, size_t size, size_t stride)
+{
+    SGFX_CAPTURE(CreateBufferHeap, flags, size, stride);
+    uint32_t handle = g_bufferHeaps.Create(flags, size, stride);
+    if (!g_bufferHeaps.Get(handle)->init()) {
+        g_bufferHeaps.Get(handle)->releaseBuffers();
+        g_bufferHeaps.Release(handle);
+        return SGFX_CAPTURE_RESULT(BufferHeapHandle::invalidHandle());
+    }
+    return SGFX_CAPTURE_RESULT(BufferHeapHandle(handle));
+}
+
+void releaseBufferHeap(BufferHeapHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBufferHeap, handle);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->releaseBuffers();
+        g_bufferHeaps.Release(handle.value);
+    }
+}
+
+BufferBlock allocateBufferBlock(BufferHeapHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateBufferBlock, handle, CaptureData{ mem, size }, size);
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != BufferHandle::invalidHandle())
+            copyBufferData(block.buffer, block.offset, size, mem);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeBufferBlock(BufferHeapHandle handle, const BufferBlock& block)
+{
+    SGFX_CAPTURE(FreeBufferBlock, handle, capturePod(block));
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->free(block.id);
+    }
+}
+
+BufferBlock getBufferBlock(BufferHeapHandle handle, uint32_t id)
+{
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->getBlock(id);
+    }
+    return block;
+}
+
+size_t compactBufferHeap(BufferHeapHandle handle, size_t maxBytes)
+{
+    SGFX_CAPTURE(CompactBufferHeap, handle, maxBytes);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        return SGFX_CAPTURE_RESULT(g_bufferHeaps.Get(handle.value)->compact(maxBytes));
+    }
+    return SGFX_CAPTURE_RESULT(static_cast<size_t>(0));
+}
+
+BufferHeapStats getBufferHeapStats(BufferHeapHandle handle)
+{
+    BufferHeapStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        stats = g_bufferHeaps.Get(handle.value)->getStats();
+    }
+    return stats;
+}
+
 SamplerStateHandle createSamplerState(const SamplerStateDescriptor& desc)
 {
-    GLSamplerStateImpl* impl = new GLSamplerStateImpl;
+    SGFX_CAPTURE(CreateSamplerState, capturePod(desc));
+    uint32_t handle = g_samplerStates.Create();
+
+    GLSamplerStateImpl* impl = g_samplerStates.Get(handle);
 
     // filter
     const GLTexFilter& filterImpl = MapTextureFilter[static_cast<uint64_t>(desc.filter)];
@@ -879,20 +1832,23 @@ SamplerStateHandle createSamplerState(const SamplerStateDescriptor& desc)
     glSamplerParameterf (impl->samplerID, GL_TEXTURE_MIN_LOD, desc.minLod);
     glSamplerParameterf (impl->samplerID, GL_TEXTURE_MAX_LOD, desc.maxLod);
 
-    return SamplerStateHandle(impl);
+    return SGFX_CAPTURE_RESULT(SamplerStateHandle(handle));
 }
 
 void releaseSamplerState(SamplerStateHandle handle)
 {
+    SGFX_CAPTURE(ReleaseSamplerState, handle);
     if (handle != SamplerStateHandle::invalidHandle()) {
-        GLSamplerStateImpl* impl = static_cast<GLSamplerStateImpl*>(handle.value);
-        delete impl;
+        g_samplerStates.Release(handle.value);
     }
 }
 
 Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
-    GLTextureImpl* impl = new GLTextureImpl;
+    SGFX_CAPTURE(CreateTexture1D, width, format, numMipmaps, flags);
+    uint32_t handle = g_textures.Create();
+
+    GLTextureImpl* impl = g_textures.Get(handle);
     impl->numDimensions    = 1;
     impl->glInternalFormat = GL_getInternalFormat(format);
     impl->glType           = GL_getInternalType(format);
@@ -905,12 +1861,16 @@ Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numM
         width
     );
 
-    return Texture1DHandle(impl);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture1DHandle(handle));
 }
 
 Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
-    GLTextureImpl* impl = new GLTextureImpl;
+    SGFX_CAPTURE(CreateTexture2D, width, height, format, numMipmaps, flags);
+    uint32_t handle = g_textures.Create();
+
+    GLTextureImpl* impl = g_textures.Get(handle);
     impl->numDimensions    = 2;
     impl->glInternalFormat = GL_getInternalFormat(format);
     impl->glType           = GL_getInternalType(format);
@@ -924,12 +1884,16 @@ Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat form
         height
     );
 
-    return Texture2DHandle(impl);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture2DHandle(handle));
 }
 
 Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth, DataFormat format, uint32_t numMipmaps, uint32_t flags)
 {
-    GLTextureImpl* impl = new GLTextureImpl;
+    SGFX_CAPTURE(CreateTexture3D, width, height, depth, format, numMipmaps, flags);
+    uint32_t handle = g_textures.Create();
+
+    GLTextureImpl* impl = g_textures.Get(handle);
     impl->numDimensions    = 3;
     impl->glInternalFormat = GL_getInternalFormat(format);
     impl->glType           = GL_getInternalType(format);
@@ -944,7 +1908,8 @@ Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth,
         depth
     );
 
-    return Texture3DHandle(impl);
+    SGFX_STAT(numTexturesCreated, 1);
+    return SGFX_CAPTURE_RESULT(Texture3DHandle(handle));
 }
 
 void updateTexture(
@@ -956,8 +1921,11 @@ void updateTexture(
     size_t rowPitch, size_t depthPitch
 )
 {
+    SGFX_CAPTURE(UpdateTexture, handle, CaptureTextureData{ mem, sizeX, sizeY, sizeZ, rowPitch, depthPitch }, mip, offsetX, sizeX, offsetY, sizeY, offsetZ, sizeZ, rowPitch, depthPitch);
+    SGFX_PROFILE_ZONE("sgfx::updateTexture");
+
     if (handle != TextureHandle::invalidHandle()) {
-        GLTextureImpl* impl = static_cast<GLTextureImpl*>(handle.value);
+        GLTextureImpl* impl = g_textures.Get(handle.value);
 
         if (impl->numDimensions == 1) {
             glTextureSubImage1DEXT(
@@ -989,128 +1957,627 @@ void updateTexture(
                 mem
             );
         }
+
+        // the source footprint the pitches describe
+        SGFX_STAT(numBytesUploaded, (sizeZ > 1) ? depthPitch * sizeZ : rowPitch * sizeY);
     }
 }
 
 void releaseTexture(TextureHandle handle)
 {
+    SGFX_CAPTURE(ReleaseTexture, handle);
     if (handle != TextureHandle::invalidHandle()) {
-        GLTextureImpl* impl = static_cast<GLTextureImpl*>(handle.value);
-        delete impl;
+        g_textures.Release(handle.value);
     }
 }
 
+ResourceTableHandle createResourceTable(const ResourceTableEntry* entries, uint32_t numEntries)
+{
+    SGFX_CAPTURE(CreateResourceTable, CaptureData{ entries, numEntries * sizeof(ResourceTableEntry) }, numEntries);
+    if (numEntries > ResourceTable::kMaxResources)
+        return SGFX_CAPTURE_RESULT(ResourceTableHandle::invalidHandle());
+
+    uint32_t handle = g_resourceTables.Create();
+
+    GLResourceTable* impl = g_resourceTables.Get(handle);
+    impl->table.init(entries, numEntries);
+
+    for (uint32_t i = 0; i < numEntries; ++i) {
+        const ShaderResource& resource = impl->table.resources[i];
+
+        impl->names[i] = 0;
+        if (resource.isTexture) {
+            GLTextureImpl* texture = g_textures.Get(resource.value);
+            if (texture != nullptr)
+                impl->names[i] = texture->textureID;
+        } else {
+            GLBufferImpl* buffer = g_buffers.Get(resource.value);
+            if (buffer != nullptr)
+                impl->names[i] = buffer->bufferID;
+        }
+    }
+
+    return SGFX_CAPTURE_RESULT(ResourceTableHandle(handle));
+}
+
+void releaseResourceTable(ResourceTableHandle handle)
+{
+    SGFX_CAPTURE(ReleaseResourceTable, handle);
+    if (handle != ResourceTableHandle::invalidHandle()) {
+        g_resourceTables.Release(handle.value);
+    }
+}
+
+void present(uint32_t swapInterval)
+{
+    SGFX_CAPTURE(Present, swapInterval);
+    // buffer swapping is owned by the platform layer, only recycle the frame memory here
+    resetFrameArenas();
+    g_transientRing.endFrame();
+
+    g_lastFrameStats = g_frameStats;
+    std::memset(&g_frameStats, 0, sizeof(g_frameStats));
+}
+
 // draw queue stuff is similar for all APIs
 
-DrawQueueHandle createDrawQueue(PipelineStateHandle state)
+FrameArenaHandle createFrameArena(size_t blockSize)
+{
+    SGFX_CAPTURE(CreateFrameArena, blockSize);
+    if (blockSize == 0)
+        blockSize = FrameArena::kDefaultBlockSize;
+
+    uint32_t handle = g_frameArenas.Create(blockSize);
+
+    FrameArena* arena = g_frameArenas.Get(handle);
+    arena->nextArena  = g_userFrameArenas;
+    g_userFrameArenas = arena;
+
+    return SGFX_CAPTURE_RESULT(FrameArenaHandle(handle));
+}
+
+void releaseFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(ReleaseFrameArena, handle);
+    if (handle != FrameArenaHandle::invalidHandle()) {
+        FrameArena* arena = g_frameArenas.Get(handle.value);
+
+        for (FrameArena** link = &g_userFrameArenas; *link != nullptr; link = &(*link)->nextArena) {
+            if (*link == arena) {
+                *link = arena->nextArena;
+                break;
+            }
+        }
+
+        if (t_frameArena == arena)
+            t_frameArena = nullptr;
+
+        g_frameArenas.Release(handle.value);
+    }
+}
+
+void setThreadFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(SetThreadFrameArena, handle);
+    t_frameArena = g_frameArenas.Get(handle.value);
+}
+
+DrawQueueHandle createDrawQueue(PipelineStateHandle state, uint32_t flags)
 {
-    DrawQueue* queue = new DrawQueue(state);
-    return DrawQueueHandle(queue);
+    SGFX_CAPTURE(CreateDrawQueue, state, flags);
+    return SGFX_CAPTURE_RESULT(DrawQueueHandle(g_drawQueues.Create(state, flags)));
 }
 
 void releaseDrawQueue(DrawQueueHandle handle)
 {
+    SGFX_CAPTURE(ReleaseDrawQueue, handle);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
-        delete queue;
+        g_drawQueues.Release(handle.value);
     }
 }
 
 void setSamplerState(DrawQueueHandle handle, uint32_t idx, SamplerStateHandle sampler)
 {
+    SGFX_CAPTURE(SetSamplerState, handle, idx, sampler);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setSamplerState(idx, sampler);
     }
 }
 
+void setSortKey(DrawQueueHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(SetSortKey, handle, key);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(ResetBindings, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->resetBindings();
+    }
+}
+
 void setPrimitiveTopology(DrawQueueHandle handle, PrimitiveTopology topology)
 {
+    SGFX_CAPTURE(SetPrimitiveTopology, handle, topology);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setPrimitiveTopology(topology);
     }
 }
 
 void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx)
 {
+    SGFX_CAPTURE(SetVertexBuffer, handle, vb, idx);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setVertexBuffer(idx, vb);
     }
 }
 
 void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib)
 {
+    SGFX_CAPTURE(SetIndexBuffer, handle, ib);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setIndexBuffer(ib);
     }
 }
 
+void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(SetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(SetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(SetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset, format);
+    }
+}
+
 void setConstantBuffer(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer)
 {
+    SGFX_CAPTURE(SetConstantBuffer, handle, idx, buffer);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setConstantBuffer(idx, buffer);
     }
 }
 
+void setConstantBufferRange(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(SetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
 void setResource(DrawQueueHandle handle, uint32_t idx, BufferHandle resource)
 {
+    SGFX_CAPTURE(SetResourceBuffer, handle, idx, resource);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
 void setResource(DrawQueueHandle handle, uint32_t idx, TextureHandle resource)
 {
+    SGFX_CAPTURE(SetResourceTexture, handle, idx, resource);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->setResource(idx, resource);
     }
 }
 
+void setResourceTable(DrawQueueHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(SetResourceTable, handle, firstSlot, table);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawQueueHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(SetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setInlineConstants(idx, data, size);
+    }
+}
+
 void draw(DrawQueueHandle handle, uint32_t count, uint32_t startVertex)
 {
+    SGFX_CAPTURE(Draw, handle, count, startVertex);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->draw(count, startVertex);
     }
 }
 
 void drawIndexed(DrawQueueHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
 {
+    SGFX_CAPTURE(DrawIndexed, handle, count, startIndex, startVertex);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawIndexed(count, startIndex, startVertex);
     }
 }
 
 void drawInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
 {
+    SGFX_CAPTURE(DrawInstanced, handle, instanceCount, count, startVertex, startInstance);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawInstanced(instanceCount, count, startVertex, startInstance);
     }
 }
 
 void drawIndexedInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
 {
+    SGFX_CAPTURE(DrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
         queue->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
     }
 }
 
-void submit(DrawQueueHandle handle)
+DrawRecorderHandle createDrawRecorder(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(CreateDrawRecorder, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+
+        uint32_t recorderHandle = g_drawRecorders.Create();
+        queue->attachRecorder(g_drawRecorders.Get(recorderHandle));
+
+        return SGFX_CAPTURE_RESULT(DrawRecorderHandle(recorderHandle));
+    }
+    return SGFX_CAPTURE_RESULT(DrawRecorderHandle::invalidHandle());
+}
+
+void releaseDrawRecorder(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseDrawRecorder, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        g_drawRecorders.Release(handle.value);
+    }
+}
+
+void setDrawRecorderKey(DrawRecorderHandle handle, uint32_t key)
+{
+    SGFX_CAPTURE(SetDrawRecorderKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setKey(key);
+    }
+}
+
+void setSortKey(DrawRecorderHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(RecorderSetSortKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(RecorderResetBindings, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->resetBindings();
+    }
+}
+
+void setPrimitiveTopology(DrawRecorderHandle handle, PrimitiveTopology topology)
+{
+    SGFX_CAPTURE(RecorderSetPrimitiveTopology, handle, topology);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setPrimitiveTopology(topology);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx)
+{
+    SGFX_CAPTURE(RecorderSetVertexBuffer, handle, vb, idx);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib)
+{
+    SGFX_CAPTURE(RecorderSetIndexBuffer, handle, ib);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset, format);
+    }
+}
+
+void setConstantBuffer(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer)
+{
+    SGFX_CAPTURE(RecorderSetConstantBuffer, handle, idx, buffer);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBuffer(idx, buffer);
+    }
+}
+
+void setConstantBufferRange(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(RecorderSetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceBuffer, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceTexture, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResourceTable(DrawRecorderHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(RecorderSetResourceTable, handle, firstSlot, table);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawRecorderHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(RecorderSetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setInlineConstants(idx, data, size);
+    }
+}
+
+void draw(DrawRecorderHandle handle, uint32_t count, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDraw, handle, count, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->draw(count, startVertex);
+    }
+}
+
+void drawIndexed(DrawRecorderHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDrawIndexed, handle, count, startIndex, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexed(count, startIndex, startVertex);
+    }
+}
+
+void drawInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawInstanced, handle, instanceCount, count, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawInstanced(instanceCount, count, startVertex, startInstance);
+    }
+}
+
+void drawIndexedInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
+    }
+}
+
+void submit(DrawQueueHandle handle, uint32_t flags)
+{
+    SGFX_CAPTURE(Submit, handle, flags);
+    SGFX_PROFILE_ZONE("sgfx::submit");
+
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        QueueStatsScope statsScope(queue->stats);
+
+        g_transientRing.unmap();
+        GL_processDrawQueue(queue, flags);
+        queue->clear();
+    }
+}
+
+BundleHandle createBundle(DrawQueueHandle handle)
 {
+    SGFX_CAPTURE(CreateBundle, handle);
     if (handle != DrawQueueHandle::invalidHandle()) {
-        DrawQueue* queue = static_cast<DrawQueue*>(handle.value);
-        GL_processDrawQueue(queue);
+        DrawQueue* queue  = g_drawQueues.Get(handle.value);
+        uint32_t   bundle = g_bundles.Create(*queue);
+
+        if (bundle != 0) {
+            GLBundleBaker baker = { g_bundles.Get(bundle) };
+            bakeDrawCalls(queue, baker);
+            baker.bundle->numReleases = GL_numBundleReleases();
+        }
+
         queue->clear();
+        return SGFX_CAPTURE_RESULT(BundleHandle(bundle));
+    }
+    return SGFX_CAPTURE_RESULT(BundleHandle::invalidHandle());
+}
+
+void releaseBundle(BundleHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBundle, handle);
+    if (handle != BundleHandle::invalidHandle()) {
+        g_bundles.Release(handle.value);
+    }
+}
+
+bool isBundleValid(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return GL_validateBundle(g_bundles.Get(handle.value));
+    return false;
+}
+
+uint32_t getNumDrawCalls(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return g_bundles.Get(handle.value)->numDrawCalls;
+    return 0;
+}
+
+void submit(BundleHandle handle, const uint64_t* visibilityMask)
+{
+    SGFX_CAPTURE(SubmitBundle, handle, CaptureBundleMask{ handle, visibilityMask });
+    SGFX_PROFILE_ZONE("sgfx::submitBundle");
+
+    if (handle != BundleHandle::invalidHandle()) {
+        GLBundle* bundle = g_bundles.Get(handle.value);
+        if (GL_validateBundle(bundle) && bundle->numDrawCalls != 0) {
+            g_transientRing.unmap();
+            GL_processBundle(bundle, visibilityMask);
+        }
+    }
+}
+
+void beginPerfEvent(const wchar_t* name)
+{
+    SGFX_CAPTURE(BeginPerfEvent, CaptureWideString{ name });
+    g_profiler.begin(name, true);
+
+    // debug group labels are ASCII
+    if (GLEW_KHR_debug) {
+        char   label[64];
+        size_t length = 0;
+        for (; name[length] != 0 && length < sizeof(label) - 1; ++length)
+            label[length] = (name[length] < 0x80) ? static_cast<char>(name[length]) : '?';
+        label[length] = 0;
+
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, label);
+    }
+}
+
+void endPerfEvent()
+{
+    SGFX_CAPTURE(EndPerfEvent);
+    if (GLEW_KHR_debug)
+        glPopDebugGroup();
+
+    g_profiler.end();
+}
+
+void startProfiler()
+{
+    g_profiler.start();
+}
+
+void stopProfiler()
+{
+    g_profiler.stop();
+}
+
+bool writeProfilerTrace(const char* path)
+{
+    return g_profiler.writeTrace(path);
+}
+
+bool startCapture(const char* path)
+{
+    // the default framebuffer has no size of its own, the viewport is the closest
+    GLint viewport[4] = { 0, 0, 0, 0 };
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    return g_captureWriter.start(path, static_cast<uint32_t>(viewport[2]), static_cast<uint32_t>(viewport[3]));
+}
+
+void stopCapture()
+{
+    g_captureWriter.stop();
+}
+
+const FrameStats& getFrameStats()
+{
+    return g_lastFrameStats;
+}
+
+QueueStats getQueueStats(DrawQueueHandle handle)
+{
+    QueueStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        stats = g_drawQueues.Get(handle.value)->stats;
     }
+    return stats;
 }
 
 }
@@ -0,0 +1,2633 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// Headless backend: every resource lives in host memory and draw/compute queues
+// are walked and resolved exactly like a legacy backend would do it, but no GPU
+// work is ever issued. Useful to profile recording, submission and resource churn
+// on machines without a graphics device.
+
+#include <memory>
+#include <cstring>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifndef SGFX_NULL_INTEROP
+#define SGFX_NULL_INTEROP 1
+#endif
+
+#ifndef SGFX_NS_INTERNAL
+#define SGFX_NS_INTERNAL sgfx_ns_null_internal
+#endif
+
+#ifndef SGFX_INTERNAL_IMPLEMENTATION
+#define SGFX_INTERNAL_IMPLEMENTATION 1
+#endif
+
+#ifdef _MSC_VER
+#   ifndef SGFX_FORCE_INLINE
+#   define SGFX_FORCE_INLINE __forceinline
+#   endif
+#else
+#   ifndef SGFX_FORCE_INLINE
+#   define SGFX_FORCE_INLINE inline __attribute__((always_inline))
+#   endif
+#endif
+
+#include "sigrlinn.hh"
+
+namespace sgfx
+{
+
+using namespace SGFX_NS_INTERNAL;
+
+//=============================================================================
+static inline void* sgfx_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static inline void sgfx_free(void* ptr)
+{
+    return free(ptr);
+}
+
+//=============================================================================
+
+AllocFunc             g_allocFunc = sgfx_malloc;
+FreeFunc              g_freeFunc  = sgfx_free;
+
+uint32_t              g_backBufferWidth  = 0;
+uint32_t              g_backBufferHeight = 0;
+
+null::DeviceStats     g_deviceStats;
+
+static FrameStats     g_frameStats;
+static FrameStats     g_lastFrameStats;
+static Profiler       g_profiler;
+static CaptureWriter  g_captureWriter;
+
+// counts into the device stats and the frame stats
+#define NULL_STAT(counter, n) (g_deviceStats.counter += (n), SGFX_STAT(counter, n))
+
+//=============================================================================
+// frame arenas backing the draw queue storage
+static FrameArena               g_frameArena;
+static FrameArena*              g_userFrameArenas = nullptr;
+static thread_local FrameArena* t_frameArena      = nullptr;
+static uint32_t                 g_frameIndex      = 1;
+
+static ErrorReportFunc          g_bindingValidationFunc = nullptr;
+
+namespace SGFX_NS_INTERNAL
+{
+
+FrameArena* getFrameArena()
+{
+    return (t_frameArena != nullptr) ? t_frameArena : &g_frameArena;
+}
+
+uint32_t getFrameIndex()
+{
+    return g_frameIndex;
+}
+
+FrameStats& getStatCounters()
+{
+    return g_frameStats;
+}
+
+Profiler& getProfiler()
+{
+    return g_profiler;
+}
+
+CaptureWriter& getCaptureWriter()
+{
+    return g_captureWriter;
+}
+
+}
+
+static void resetFrameArenas()
+{
+    g_frameArena.Reset();
+    for (FrameArena* arena = g_userFrameArenas; arena != nullptr; arena = arena->nextArena)
+        arena->Reset();
+
+    g_frameIndex++;
+}
+
+//=============================================================================
+struct NullSharedBuffer final
+{
+    uint8_t*   data       = nullptr;
+    size_t     dataSize   = 0;
+    size_t     dataStride = 0;
+    uint32_t   flags      = 0;
+
+    // texture description, unused for buffers
+    bool       isTexture  = false;
+    DataFormat format     = DataFormat::RGBA8;
+    uint32_t   width      = 0;
+    uint32_t   height     = 0;
+    uint32_t   depth      = 0;
+    uint32_t   numMipmaps = 0;
+
+    SGFX_FORCE_INLINE NullSharedBuffer() {}
+    SGFX_FORCE_INLINE ~NullSharedBuffer()
+    {
+        if (data != nullptr) g_freeFunc(data);
+    }
+
+    SGFX_FORCE_INLINE void createStorage(size_t size, const void* mem)
+    {
+        dataSize = size;
+        data     = static_cast<uint8_t*>(g_allocFunc(size > 0 ? size : 1));
+
+        if (mem != nullptr)
+            std::memcpy(data, mem, size);
+        else
+            std::memset(data, 0, size);
+    }
+};
+
+// storage a WriteDiscard map took away from a buffer, frames in flight may still read it
+struct NullRetiredStorage final
+{
+    uint8_t* data;
+    uint32_t frameIndex;
+};
+
+struct NullShaderImpl final
+{
+    uint8_t* bytecode     = nullptr;
+    size_t   bytecodeSize = 0;
+
+    SGFX_FORCE_INLINE NullShaderImpl(const void* data, size_t dataSize)
+        : bytecodeSize(dataSize)
+    {
+        bytecode = static_cast<uint8_t*>(g_allocFunc(dataSize > 0 ? dataSize : 1));
+        if (data != nullptr)
+            std::memcpy(bytecode, data, dataSize);
+    }
+
+    SGFX_FORCE_INLINE ~NullShaderImpl()
+    {
+        g_freeFunc(bytecode);
+    }
+};
+
+struct NullConstantBuffer final
+{
+    uint8_t* data     = nullptr;
+    size_t   dataSize = 0;
+
+    SGFX_FORCE_INLINE NullConstantBuffer(const void* mem, size_t size)
+        : dataSize(size)
+    {
+        data = static_cast<uint8_t*>(g_allocFunc(size > 0 ? size : 1));
+        if (mem != nullptr)
+            std::memcpy(data, mem, size);
+        else
+            std::memset(data, 0, size);
+    }
+
+    SGFX_FORCE_INLINE ~NullConstantBuffer()
+    {
+        g_freeFunc(data);
+    }
+};
+
+struct SurfaceShaderImpl final
+{
+    NullShaderImpl* vs = nullptr;
+    NullShaderImpl* hs = nullptr;
+    NullShaderImpl* ds = nullptr;
+    NullShaderImpl* gs = nullptr;
+    NullShaderImpl* ps = nullptr;
+
+    SurfaceBindingLayout layout;
+};
+
+struct VertexFormatImpl final
+{
+    enum
+    {
+        kMaxVertexElements = 32
+    };
+
+    size_t                  numElements = 0;
+    VertexElementDescriptor elements[kMaxVertexElements];
+};
+
+//=============================================================================
+// inline constants are streamed into one ring, see StreamRing
+enum
+{
+    kInlineConstantRingSize = 1 << 20
+};
+
+struct NullConstantRing final
+{
+    uint8_t*   data = nullptr;
+    StreamRing ring;
+};
+
+static NullConstantRing g_inlineConstantRing;
+
+// returns the offset the constants were streamed to, wrapped is set if the ring started over
+static size_t nullStreamInlineConstants(const uint32_t* data, uint32_t size, bool& wrapped)
+{
+    if (g_inlineConstantRing.data == nullptr) {
+        g_inlineConstantRing.data          = static_cast<uint8_t*>(g_allocFunc(kInlineConstantRingSize));
+        g_inlineConstantRing.ring.capacity = kInlineConstantRingSize;
+    }
+
+    size_t offset = 0;
+    if (g_inlineConstantRing.ring.allocate(DrawCall::kMaxInlineConstantsSize, DrawCall::kInlineConstantsAlign, offset)) {
+        g_deviceStats.numInlineConstantWraps++;
+        wrapped = true;
+    }
+
+    std::memcpy(g_inlineConstantRing.data + offset, data, size);
+
+    g_deviceStats.numInlineConstantUploads++;
+    NULL_STAT(numBytesUploaded, size);
+    return offset;
+}
+
+// shadow value of a constant buffer slot bound to the ring, never a handle value
+static const uint32_t kNullInlineConstantsBuffer = ~0u;
+
+//=============================================================================
+// counts the range binds a device would receive, see ShadowBindings
+// each stage only receives the part of the range its layout reads
+struct NullBindEmitter final
+{
+    uint64_t&                 numBinds;
+    uint64_t&                 numBindCalls;
+    const StageBindingLayout* stageLayouts;
+    uint32_t                  numStages;
+    BindingClass              bindingClass;
+
+    SGFX_FORCE_INLINE void operator()(uint32_t first, uint32_t count, const uint32_t* values)
+    {
+        (void)values;
+        for (uint32_t i = 0; i < numStages; ++i) {
+            uint32_t stageFirst = 0;
+            uint32_t stageCount = 0;
+            if (trimRange(getLayoutSlots(stageLayouts[i], bindingClass), first, count, stageFirst, stageCount)) {
+                numBinds += stageCount;
+                numBindCalls++;
+            }
+        }
+    }
+};
+
+// emulated device state, mirrors what D3D11 context would track for us
+struct NullStateCache final
+{
+    enum
+    {
+        SC_Draw = 0,
+        SC_Compute = 1
+    };
+
+    uint32_t type;
+
+    // bound objects are identified by their handle values
+    ShadowBindings<uint32_t, DrawQueue::kMaxSamplerStates>  samplerStates;
+    ShadowBindings<uint32_t, DrawCall::kMaxConstantBuffers> constantBuffers;
+    ShadowBindings<uint32_t, DrawCall::kMaxShaderResources> shaderResourceViews;
+    uint32_t shaderUAVs[ComputeQueue::kMaxShaderResourcesRW];
+
+    // layouts of the stages the pipeline uses and their union
+    StageBindingLayout stageLayouts[5];
+    StageBindingLayout layout;
+    uint32_t           numStages = 0;
+
+    // slots bound to a window of their buffer (buffer ranges and inline constants in the ring),
+    // byte offset and size of the window, windows that changed are bound at the next flush
+    uint32_t           constantWindowOffsets[DrawCall::kMaxConstantBuffers];
+    uint32_t           constantWindowSizes[DrawCall::kMaxConstantBuffers];
+    uint32_t           constantWindowMask  = 0;
+    uint32_t           constantWindowBinds = 0;
+
+    // inline constants of every slot, slots that need streaming are flagged until the next flush
+    const uint32_t*    inlineConstants[DrawCall::kMaxConstantBuffers];
+    uint32_t           inlineConstantsSize[DrawCall::kMaxConstantBuffers];
+    uint32_t           inlineConstantMask    = 0;
+    uint32_t           inlineConstantUploads = 0;
+
+    SGFX_FORCE_INLINE NullStateCache(uint32_t newType)
+    {
+        type = newType;
+
+        std::memset(shaderUAVs, 0, sizeof(shaderUAVs));
+        std::memset(inlineConstants, 0, sizeof(inlineConstants));
+    }
+
+    // called once per shader stage when the pipeline is created
+    SGFX_FORCE_INLINE void addStage(const StageBindingLayout& stageLayout)
+    {
+        stageLayouts[numStages++] = stageLayout;
+        mergeBindingLayout(layout, stageLayout);
+
+        samplerStates.setUsedSlots(&layout.samplers);
+        constantBuffers.setUsedSlots(&layout.constantBuffers);
+        shaderResourceViews.setUsedSlots(layout.shaderResources);
+    }
+
+    SGFX_FORCE_INLINE NullBindEmitter getEmitter(uint64_t& numBinds, uint64_t& numBindCalls, BindingClass bindingClass) const
+    {
+        NullBindEmitter emitter = { numBinds, numBindCalls, stageLayouts, numStages, bindingClass };
+        return emitter;
+    }
+
+    // unbinds the shader resources and forgets the rest, the next queue may use another cache
+    SGFX_FORCE_INLINE void clear()
+    {
+        shaderResourceViews.unbindAll();
+
+        NullBindEmitter emitter = getEmitter(g_deviceStats.numResourceBinds, g_deviceStats.numResourceBindCalls, BindingClass::ShaderResources);
+        shaderResourceViews.flush(emitter);
+
+        samplerStates.reset();
+        constantBuffers.reset();
+        std::memset(shaderUAVs, 0, sizeof(shaderUAVs));
+
+        dropConstantWindows(constantWindowMask);
+    }
+
+    SGFX_FORCE_INLINE void setSamplerStates(const SamplerStateHandle* handles)
+    {
+        for (uint32_t i = 0; i < DrawQueue::kMaxSamplerStates; ++i)
+            samplerStates.set(i, handles[i].value);
+
+        NullBindEmitter emitter = getEmitter(g_deviceStats.numSamplerBinds, g_deviceStats.numSamplerBindCalls, BindingClass::Samplers);
+        samplerStates.flush(emitter);
+    }
+
+    SGFX_FORCE_INLINE void dropInlineConstants(uint32_t mask)
+    {
+        inlineConstantMask    &= ~mask;
+        inlineConstantUploads &= ~mask;
+
+        for (; mask != 0; mask &= mask - 1)
+            inlineConstants[bitScanForward(mask)] = nullptr;
+    }
+
+    SGFX_FORCE_INLINE void dropConstantWindows(uint32_t mask)
+    {
+        constantWindowMask  &= ~mask;
+        constantWindowBinds &= ~mask;
+        dropInlineConstants(inlineConstantMask & mask);
+    }
+
+    // the whole buffer, a slot holding a window is bound again even if the buffer stays the same
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t i, uint32_t state)
+    {
+        if ((constantWindowMask | inlineConstantMask) & (1u << i)) {
+            dropConstantWindows(1u << i);
+            constantBuffers.invalidate(i);
+        }
+        constantBuffers.set(i, state);
+    }
+
+    // windows are bound by bindConstantWindows(), the shadow copy only learns about the buffer
+    SGFX_FORCE_INLINE void setConstantWindow(uint32_t i, uint32_t state, uint32_t offset, uint32_t size)
+    {
+        uint32_t bit = 1u << i;
+
+        if ((constantWindowMask & bit) == 0 || constantBuffers.get(i) != state
+            || constantWindowOffsets[i] != offset || constantWindowSizes[i] != size) {
+            constantBuffers.assume(i, state);
+            constantWindowOffsets[i] = offset;
+            constantWindowSizes[i]   = size;
+            constantWindowBinds |= bit;
+        }
+
+        constantWindowMask |= bit;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t i, uint32_t state, uint32_t offset, uint32_t size)
+    {
+        if ((layout.constantBuffers & (1u << i)) == 0)
+            return;
+
+        if (state == 0) {
+            setConstantBuffer(i, 0);
+            return;
+        }
+
+        dropInlineConstants(inlineConstantMask & (1u << i));
+        setConstantWindow(i, state, offset, size);
+    }
+
+    // data must stay put until the next flush, constants at the same address are streamed once
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t i, const uint32_t* data, uint32_t size)
+    {
+        uint32_t bit = 1u << i;
+        if ((layout.constantBuffers & bit) == 0)
+            return;
+
+        if (inlineConstants[i] != data) {
+            inlineConstants[i]     = data;
+            inlineConstantsSize[i] = size;
+            inlineConstantUploads |= bit;
+        }
+
+        inlineConstantMask |= bit;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffers(const DrawCall& call)
+    {
+        uint64_t mask = (call.constantBufferMask | call.inlineConstantMask) & layout.constantBuffers;
+        constantBuffers.unbindExcept(&mask);
+        dropConstantWindows(constantWindowMask & ~static_cast<uint32_t>(mask));
+
+        while (mask != 0) {
+            uint32_t i = bitScanForward(mask);
+            if (call.inlineConstantMask & (1u << i))
+                setInlineConstants(i, call.inlineConstants[i], call.inlineConstantsSize[i]);
+            else if (call.constantBufferSizes[i] != 0)
+                setConstantBufferRange(i, call.constantBuffers[i].value, call.constantBufferOffsets[i], call.constantBufferSizes[i]);
+            else
+                setConstantBuffer(i, call.constantBuffers[i].value);
+            mask &= mask - 1;
+        }
+    }
+
+    SGFX_FORCE_INLINE bool streamInlineConstants(uint32_t mask)
+    {
+        bool wrapped = false;
+        for (; mask != 0; mask &= mask - 1) {
+            uint32_t i = bitScanForward(mask);
+            size_t offset = nullStreamInlineConstants(inlineConstants[i], inlineConstantsSize[i], wrapped);
+            setConstantWindow(i, kNullInlineConstantsBuffer, static_cast<uint32_t>(offset), DrawCall::kMaxInlineConstantsSize);
+        }
+        return wrapped;
+    }
+
+    // ranges streamed before the ring started over are gone, so a wrap restreams every slot
+    inline void uploadInlineConstants()
+    {
+        if (streamInlineConstants(inlineConstantUploads))
+            streamInlineConstants(inlineConstantMask);
+
+        inlineConstantUploads = 0;
+    }
+
+    // a D3D11.1 device binds every window with its offset, once per stage that reads the slot
+    SGFX_FORCE_INLINE void bindConstantWindows()
+    {
+        for (; constantWindowBinds != 0; constantWindowBinds &= constantWindowBinds - 1) {
+            uint32_t i = bitScanForward(constantWindowBinds);
+
+            for (uint32_t stage = 0; stage < numStages; ++stage) {
+                if ((stageLayouts[stage].constantBuffers >> i) & 1) {
+                    g_deviceStats.numConstantBufferBinds++;
+                    g_deviceStats.numConstantBufferBindCalls++;
+                }
+            }
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, 1);
+        }
+    }
+
+    SGFX_FORCE_INLINE void setShaderResource(uint32_t i, uint32_t state)
+    {
+        shaderResourceViews.set(i, state);
+    }
+
+    // table is the call's resource table, resources set on their own take precedence
+    SGFX_FORCE_INLINE void setShaderResources(const DrawCall& call, const ResourceTable* table)
+    {
+        uint32_t tableSlot     = call.resourceTableSlot;
+        uint32_t numTableSlots = (table != nullptr) ? table->getNumSlots(tableSlot) : 0;
+
+        uint64_t masks[2] = { call.shaderResourceMask[0], call.shaderResourceMask[1] };
+        addSlotRange(masks, tableSlot, numTableSlots);
+
+        masks[0] &= layout.shaderResources[0];
+        masks[1] &= layout.shaderResources[1];
+        shaderResourceViews.unbindExcept(masks);
+
+        for (uint32_t word = 0; word < 2; ++word) {
+            uint64_t mask = masks[word];
+            while (mask != 0) {
+                uint32_t i = word * 64 + bitScanForward(mask);
+
+                uint32_t state = call.shaderResources[i].value;
+                if (state == 0 && i - tableSlot < numTableSlots)
+                    state = table->resources[i - tableSlot].value;
+
+                shaderResourceViews.set(i, state);
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // applies the constant buffer and shader resource changes, called before every draw
+    SGFX_FORCE_INLINE void flush()
+    {
+        if (inlineConstantUploads != 0)
+            uploadInlineConstants();
+
+        if (!constantBuffers.isDirty() && !shaderResourceViews.isDirty() && constantWindowBinds == 0)
+            return;
+
+        NullBindEmitter constantBufferEmitter = getEmitter(g_deviceStats.numConstantBufferBinds, g_deviceStats.numConstantBufferBindCalls, BindingClass::ConstantBuffers);
+        constantBuffers.flush(constantBufferEmitter);
+        bindConstantWindows();
+
+        NullBindEmitter resourceEmitter = getEmitter(g_deviceStats.numResourceBinds, g_deviceStats.numResourceBindCalls, BindingClass::ShaderResources);
+        shaderResourceViews.flush(resourceEmitter);
+    }
+
+    SGFX_FORCE_INLINE void setShaderResourcesRW(const ShaderResource* resources)
+    {
+        for (size_t i = 0; i < ComputeQueue::kMaxShaderResourcesRW; ++i) {
+            uint32_t state = resources[i].value;
+            if (state != shaderUAVs[i]) {
+                shaderUAVs[i] = state;
+                g_deviceStats.numResourceBinds += numStages;
+
+                SGFX_STAT(numBindCalls, 1);
+                SGFX_STAT(numBoundSlots, 1);
+            }
+        }
+    }
+};
+
+struct PipelineStateImpl final
+{
+    PipelineStateDescriptor  desc;
+
+    SurfaceShaderImpl*       shader       = nullptr;
+    VertexFormatImpl*        vertexFormat = nullptr;
+
+    // state cache
+    NullStateCache           stateCache = NullStateCache(NullStateCache::SC_Draw);
+};
+
+struct RenderTargetImpl final
+{
+    RenderTargetDescriptor   desc;
+    const NullSharedBuffer*  unorderedAccessViews[RenderTargetSlot::Count];
+
+    SGFX_FORCE_INLINE RenderTargetImpl()
+    {
+        std::memset(unorderedAccessViews, 0, sizeof(unorderedAccessViews));
+    }
+};
+
+//=============================================================================
+// bundle command, binds are resolved to the objects their handles name
+struct NullBundleCommand final
+{
+    DrawCommand::Opcode opcode;
+    uint32_t            slot;   // bind slot, DrawCall::Type for draws
+    uint32_t            handle; // handle the object was resolved from, 0 for unbinds and direct draws
+
+    union
+    {
+        PrimitiveTopology           topology;
+        const NullSharedBuffer*     buffer;         // resources
+
+        struct
+        {
+            const NullSharedBuffer* buffer;
+            uint32_t                offset; // bytes
+            IndexFormat             format; // index buffers only
+        } inputBuffer;                              // vertex and index buffers
+
+        struct
+        {
+            const NullConstantBuffer* buffer;
+            uint32_t                offset; // bytes, size 0 binds the whole buffer
+            uint32_t                size;
+        } constantBuffer;
+
+        struct
+        {
+            uint32_t                count;
+            uint32_t                instanceCount;
+        } draw;
+
+        struct
+        {
+            const NullSharedBuffer* args;
+            size_t                  offset;
+        } indirect;
+
+        struct
+        {
+            uint32_t                offset; // in the bundle's constantData
+            uint32_t                size;
+        } constants;
+    };
+};
+
+typedef DrawBundle<NullBundleCommand> NullBundle;
+
+//=============================================================================
+// object tables, handle values index into them
+static HandleTable<NullShaderImpl>          g_shaders;
+static HandleTable<SurfaceShaderImpl>       g_surfaceShaders;
+static HandleTable<VertexFormatImpl>        g_vertexFormats;
+static HandleTable<PipelineStateImpl>       g_pipelineStates;
+static HandleTable<NullSharedBuffer>        g_sharedBuffers; // buffers and textures
+static HandleTable<NullConstantBuffer>      g_constantBuffers;
+static HandleTable<SamplerStateDescriptor>  g_samplerStates;
+static HandleTable<RenderTargetImpl>        g_renderTargets;
+static HandleTable<DrawQueue>               g_drawQueues;
+static HandleTable<DrawRecorder>            g_drawRecorders;
+static HandleTable<NullBundle>              g_bundles;
+static HandleTable<ComputeQueue>            g_computeQueues;
+static HandleTable<FrameArena>              g_frameArenas;
+static HandleTable<ResourceTable>           g_resourceTables;
+static HandleTable<ConstantBlockAllocator>  g_constantAllocators;
+static HandleTable<BufferHeapAllocator>     g_bufferHeaps;
+
+static TransientRing                        g_transientRing;
+static DynamicArray<NullRetiredStorage>     g_retiredStorage;
+
+//=============================================================================
+static SGFX_FORCE_INLINE size_t nullMipSize(const NullSharedBuffer* texture, uint32_t mip)
+{
+    uint32_t blockSize = getFormatBlockSize(texture->format);
+
+    uint32_t width  = texture->width  >> mip; if (width  == 0) width  = 1;
+    uint32_t height = texture->height >> mip; if (height == 0) height = 1;
+    uint32_t depth  = texture->depth  >> mip; if (depth  == 0) depth  = 1;
+
+    size_t numRows = (height + blockSize - 1) / blockSize;
+    return getFormatRowPitch(texture->format, width) * numRows * depth;
+}
+
+static SGFX_FORCE_INLINE size_t nullMipOffset(const NullSharedBuffer* texture, uint32_t mip)
+{
+    size_t offset = 0;
+    for (uint32_t i = 0; i < mip; ++i)
+        offset += nullMipSize(texture, i);
+    return offset;
+}
+
+static uint32_t nullCreateTexture(uint32_t width, uint32_t height, uint32_t depth, DataFormat format, uint32_t numMipmaps, uint32_t flags)
+{
+    uint32_t handle = g_sharedBuffers.Create();
+    NullSharedBuffer* texture = g_sharedBuffers.Get(handle);
+    texture->isTexture  = true;
+    texture->format     = format;
+    texture->width      = width  > 0 ? width  : 1;
+    texture->height     = height > 0 ? height : 1;
+    texture->depth      = depth  > 0 ? depth  : 1;
+    texture->numMipmaps = numMipmaps > 0 ? numMipmaps : 1;
+    texture->flags      = flags;
+
+    texture->createStorage(nullMipOffset(texture, texture->numMipmaps), nullptr);
+
+    NULL_STAT(numTexturesCreated, 1);
+    return handle;
+}
+
+static void nullSetPipelineState(PipelineStateHandle handle)
+{
+    if (handle != PipelineStateHandle::invalidHandle()) {
+        PipelineStateImpl* impl = g_pipelineStates.Get(handle.value);
+
+        // touch everything D3D11 would have to touch
+        volatile const void* sink = nullptr;
+        sink = impl->vertexFormat;
+        sink = impl->shader->vs;
+        sink = impl->shader->hs;
+        sink = impl->shader->ds;
+        sink = impl->shader->gs;
+        sink = impl->shader->ps;
+        (void)sink;
+
+        NULL_STAT(numPipelineStateChanges, 1);
+    }
+}
+
+static void nullDraw(DrawCall::Type type, uint32_t count, uint32_t instanceCount, const NullSharedBuffer* args, size_t argsOffset)
+{
+    switch (type) {
+    case DrawCall::Draw:
+    case DrawCall::DrawIndexed:          { NULL_STAT(numPrimitives, count); } break;
+    case DrawCall::DrawInstanced:
+    case DrawCall::DrawIndexedInstanced: { NULL_STAT(numPrimitives, static_cast<uint64_t>(count) * instanceCount); } break;
+
+    case DrawCall::DrawInstancedIndirect:
+    case DrawCall::DrawIndexedInstancedIndirect: {
+        // indirect args are uint32_t[4] or uint32_t[5], count and instance count come first
+        if (args != nullptr && argsOffset + 2 * sizeof(uint32_t) <= args->dataSize) {
+            uint32_t params[2];
+            std::memcpy(params, args->data + argsOffset, sizeof(params));
+            g_deviceStats.numPrimitives += static_cast<uint64_t>(params[0]) * params[1];
+        }
+    } break;
+    }
+
+    NULL_STAT(numDrawCalls, 1);
+}
+
+static void nullProcessDrawQueue(DrawQueue* queue, uint32_t flags)
+{
+    PipelineStateImpl* psimpl = g_pipelineStates.Get(queue->getState().value);
+
+    nullSetPipelineState(queue->getState());
+
+    psimpl->stateCache.setSamplerStates(queue->samplerStates);
+
+    const NullSharedBuffer* vertexBuffers[DrawCall::kMaxVertexBuffers] = { nullptr };
+    uint32_t                vertexBufferOffsets[DrawCall::kMaxVertexBuffers] = { 0 };
+    const NullSharedBuffer* indexBuffer       = nullptr;
+    uint32_t                indexBufferOffset = 0;
+    IndexFormat             indexFormat       = IndexFormat::Count;
+    PrimitiveTopology       topology          = PrimitiveTopology::Count;
+
+#if SGFX_VALIDATE_BINDINGS
+    bool foundUnusedBinds = false;
+#endif
+
+    // automatic instancing packs the merged constants into the transient ring
+    DrawInstancing instancing = { psimpl->desc.instanceConstantsSlot, psimpl->desc.instanceVertexSlot, &g_transientRing };
+    bool           isInstanced = instancing.constantsSlot != PipelineStateDescriptor::kNoInstancing;
+
+    // process draw calls
+    for (const DrawCall& call: queue->getDrawCalls(flags, isInstanced ? &instancing : nullptr)) {
+
+#if SGFX_VALIDATE_BINDINGS
+        if (!foundUnusedBinds)
+            foundUnusedBinds = hasUnusedBinds(call, psimpl->stateCache.layout);
+#endif
+
+        if (call.primitiveTopology != topology) {
+            topology = call.primitiveTopology;
+            NULL_STAT(numInputBinds, 1);
+        }
+
+        if (psimpl->vertexFormat != nullptr) {
+            for (size_t i = 0; i < DrawCall::kMaxVertexBuffers; ++i) {
+                const NullSharedBuffer* vertexBuffer = g_sharedBuffers.Get(call.vertexBuffers[i].value);
+
+                if (vertexBuffer != nullptr) {
+                    if (vertexBuffers[i] != vertexBuffer || vertexBufferOffsets[i] != call.vertexBufferOffsets[i]) {
+                        vertexBuffers[i]       = vertexBuffer;
+                        vertexBufferOffsets[i] = call.vertexBufferOffsets[i];
+                        NULL_STAT(numInputBinds, 1);
+                    }
+                } else break;
+            }
+
+            const NullSharedBuffer* ibuffer = g_sharedBuffers.Get(call.indexBuffer.value);
+            if (ibuffer != indexBuffer || indexBufferOffset != call.indexBufferOffset || indexFormat != call.indexFormat) {
+                indexBuffer       = ibuffer;
+                indexBufferOffset = call.indexBufferOffset;
+                indexFormat       = call.indexFormat;
+                NULL_STAT(numInputBinds, 1);
+            }
+        }
+
+        // constant buffers, shader resources and textures
+        psimpl->stateCache.setConstantBuffers(call);
+        psimpl->stateCache.setShaderResources(call, g_resourceTables.Get(call.resourceTable.value));
+        psimpl->stateCache.flush();
+
+        nullDraw(call.type, call.count, call.instanceCount, g_sharedBuffers.Get(call.indirectArgsBuffer.value), call.indirectArgsOffset);
+    }
+
+    psimpl->stateCache.clear();
+
+#if SGFX_VALIDATE_BINDINGS
+    if (foundUnusedBinds && g_bindingValidationFunc != nullptr)
+        g_bindingValidationFunc("draw queue binds slots that the binding layout of its pipeline does not read");
+#endif
+}
+
+//=============================================================================
+// resolves the binds handed out by bakeDrawCalls into bundle commands
+struct NullBundleBaker final
+{
+    NullBundle* bundle;
+
+    SGFX_FORCE_INLINE const ResourceTable* getResourceTable(ResourceTableHandle handle)
+    {
+        return g_resourceTables.Get(handle.value);
+    }
+
+    SGFX_FORCE_INLINE NullBundleCommand& addCommand(DrawCommand::Opcode opcode, uint32_t slot, uint32_t handle)
+    {
+        NullBundleCommand command;
+        std::memset(&command, 0, sizeof(command));
+        command.opcode = opcode;
+        command.slot   = slot;
+        command.handle = handle;
+
+        bundle->commands.Add(command);
+        return bundle->commands[bundle->commands.GetSize() - 1];
+    }
+
+    SGFX_FORCE_INLINE void setPrimitiveTopology(PrimitiveTopology topology)
+    {
+        addCommand(DrawCommand::SetPrimitiveTopology, 0, 0).topology = topology;
+    }
+
+    SGFX_FORCE_INLINE void setVertexBuffer(uint32_t idx, BufferHandle handle, uint32_t offset)
+    {
+        NullBundleCommand& command = addCommand(DrawCommand::SetVertexBuffer, idx, handle.value);
+        command.inputBuffer.buffer = g_sharedBuffers.Get(handle.value);
+        command.inputBuffer.offset = offset;
+    }
+
+    SGFX_FORCE_INLINE void setIndexBuffer(BufferHandle handle, uint32_t offset, IndexFormat format)
+    {
+        NullBundleCommand& command = addCommand(DrawCommand::SetIndexBuffer, 0, handle.value);
+        command.inputBuffer.buffer = g_sharedBuffers.Get(handle.value);
+        command.inputBuffer.offset = offset;
+        command.inputBuffer.format = format;
+    }
+
+    SGFX_FORCE_INLINE void setConstantBuffer(uint32_t idx, ConstantBufferHandle handle)
+    {
+        addCommand(DrawCommand::SetConstantBuffer, idx, handle.value).constantBuffer.buffer = g_constantBuffers.Get(handle.value);
+    }
+
+    SGFX_FORCE_INLINE void setConstantBufferRange(uint32_t idx, ConstantBufferHandle handle, uint32_t offset, uint32_t size)
+    {
+        NullBundleCommand& command = addCommand(DrawCommand::SetConstantBuffer, idx, handle.value);
+        command.constantBuffer.buffer = g_constantBuffers.Get(handle.value);
+        command.constantBuffer.offset = offset;
+        command.constantBuffer.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setInlineConstants(uint32_t idx, const uint32_t* data, uint32_t size)
+    {
+        NullBundleCommand& command = addCommand(DrawCommand::SetInlineConstants, idx, 0);
+        command.constants.offset = bundle->addConstantData(data, size);
+        command.constants.size   = size;
+    }
+
+    SGFX_FORCE_INLINE void setResource(uint32_t idx, const ShaderResource& resource)
+    {
+        addCommand(DrawCommand::SetResource, idx, resource.value).buffer = g_sharedBuffers.Get(resource.value);
+    }
+
+    SGFX_FORCE_INLINE void draw(const DrawCall& call)
+    {
+        bool isIndirect = call.type == DrawCall::DrawInstancedIndirect || call.type == DrawCall::DrawIndexedInstancedIndirect;
+
+        NullBundleCommand& command = addCommand(DrawCommand::Draw, call.type, isIndirect ? call.indirectArgsBuffer.value : 0);
+        if (isIndirect) {
+            command.indirect.args   = g_sharedBuffers.Get(call.indirectArgsBuffer.value);
+            command.indirect.offset = call.indirectArgsOffset;
+        } else {
+            command.draw.count         = call.count;
+            command.draw.instanceCount = call.instanceCount;
+        }
+
+        bundle->numDrawCalls++;
+    }
+};
+
+// releases of every object type a bundle can resolve
+static SGFX_FORCE_INLINE uint32_t nullNumBundleReleases()
+{
+    return g_sharedBuffers.GetNumReleases() + g_constantBuffers.GetNumReleases()
+        + g_samplerStates.GetNumReleases() + g_pipelineStates.GetNumReleases();
+}
+
+static bool nullCheckBundle(const NullBundle* bundle)
+{
+    if (!g_pipelineStates.IsValid(bundle->state.value))
+        return false;
+
+    for (const SamplerStateHandle& sampler : bundle->samplerStates) {
+        if (sampler.value != 0 && !g_samplerStates.IsValid(sampler.value))
+            return false;
+    }
+
+    for (const NullBundleCommand& command : bundle->commands) {
+        if (command.handle == 0)
+            continue;
+
+        bool isValid = (command.opcode == DrawCommand::SetConstantBuffer)
+            ? g_constantBuffers.IsValid(command.handle)
+            : g_sharedBuffers.IsValid(command.handle);
+        if (!isValid)
+            return false;
+    }
+
+    return true;
+}
+
+// only walks the bundle when something was released since the last check
+static SGFX_FORCE_INLINE bool nullValidateBundle(NullBundle* bundle)
+{
+    uint32_t numReleases = nullNumBundleReleases();
+    if (bundle->isValid && bundle->numReleases != numReleases) {
+        bundle->numReleases = numReleases;
+        bundle->isValid     = nullCheckBundle(bundle);
+    }
+    return bundle->isValid;
+}
+
+// executes single bundle commands, see replayBundle
+struct NullBundleExecutor final
+{
+    PipelineStateImpl* psimpl;
+    const uint32_t*    constantData;
+    bool               hasVertexFormat;
+
+    SGFX_FORCE_INLINE void operator()(const NullBundleCommand& command)
+    {
+        switch (command.opcode) {
+        case DrawCommand::SetPrimitiveTopology: { NULL_STAT(numInputBinds, 1); } break;
+        case DrawCommand::SetVertexBuffer:      { if (hasVertexFormat && command.inputBuffer.buffer != nullptr) NULL_STAT(numInputBinds, 1); } break;
+        case DrawCommand::SetIndexBuffer:       { if (hasVertexFormat) NULL_STAT(numInputBinds, 1); } break;
+        case DrawCommand::SetResource:          { psimpl->stateCache.setShaderResource(command.slot, command.handle); } break;
+
+        // bakeDrawCalls expands resource tables into SetResource commands, a bundle never holds one
+        case DrawCommand::SetResourceTable: break;
+
+        case DrawCommand::SetConstantBuffer: {
+            if (command.constantBuffer.size != 0)
+                psimpl->stateCache.setConstantBufferRange(command.slot, command.handle, command.constantBuffer.offset, command.constantBuffer.size);
+            else
+                psimpl->stateCache.setConstantBuffer(command.slot, command.handle);
+        } break;
+
+        case DrawCommand::SetInlineConstants: {
+            psimpl->stateCache.setInlineConstants(command.slot, constantData + command.constants.offset, command.constants.size);
+        } break;
+
+        case DrawCommand::Draw: {
+            psimpl->stateCache.flush();
+
+            DrawCall::Type type = static_cast<DrawCall::Type>(command.slot);
+            if (type == DrawCall::DrawInstancedIndirect || type == DrawCall::DrawIndexedInstancedIndirect)
+                nullDraw(type, 0, 0, command.indirect.args, command.indirect.offset);
+            else
+                nullDraw(type, command.draw.count, command.draw.instanceCount, nullptr, 0);
+        } break;
+        }
+    }
+};
+
+static void nullProcessBundle(const NullBundle* bundle, const uint64_t* visibilityMask)
+{
+    PipelineStateImpl* psimpl = g_pipelineStates.Get(bundle->state.value);
+
+    nullSetPipelineState(bundle->state);
+
+    psimpl->stateCache.setSamplerStates(bundle->samplerStates);
+
+    NullBundleExecutor executor = { psimpl, bundle->constantData.GetData(), psimpl->vertexFormat != nullptr };
+    replayBundle(*bundle, visibilityMask, executor);
+
+    psimpl->stateCache.clear();
+}
+
+//=============================================================================
+bool initNull(uint32_t backBufferWidth, uint32_t backBufferHeight)
+{
+    g_backBufferWidth  = backBufferWidth;
+    g_backBufferHeight = backBufferHeight;
+
+    std::memset(&g_deviceStats, 0, sizeof(g_deviceStats));
+
+    return true;
+}
+
+void shutdown()
+{
+    g_captureWriter.stop();
+
+    // storage recorded before the shutdown must not look current after the next init
+    resetFrameArenas();
+
+    // objects the application did not release, recorders detach from their queues so they go first
+    g_drawRecorders.Purge();
+    g_drawQueues.Purge();
+    g_bundles.Purge();
+    g_computeQueues.Purge();
+    g_renderTargets.Purge();
+    g_resourceTables.Purge();
+    g_constantAllocators.Purge();
+    g_bufferHeaps.Purge();
+    g_constantBuffers.Purge();
+    g_sharedBuffers.Purge();
+    g_samplerStates.Purge();
+    g_pipelineStates.Purge();
+    g_vertexFormats.Purge();
+    g_surfaceShaders.Purge();
+    g_shaders.Purge();
+    g_frameArenas.Purge();
+    g_userFrameArenas = nullptr;
+
+    g_frameArena.Purge();
+
+    if (g_inlineConstantRing.data != nullptr)
+        g_freeFunc(g_inlineConstantRing.data);
+    g_inlineConstantRing = NullConstantRing();
+
+    g_transientRing.release();
+
+    for (const NullRetiredStorage& storage : g_retiredStorage)
+        g_freeFunc(storage.data);
+    g_retiredStorage.Purge();
+
+    g_profiler.release();
+
+    g_backBufferWidth  = 0;
+    g_backBufferHeight = 0;
+}
+
+void setAllocator(AllocFunc nalloc, FreeFunc nfree)
+{
+    g_allocFunc = nalloc;
+    g_freeFunc  = nfree;
+}
+
+void* allocate(size_t size)
+{
+    return g_allocFunc(size);
+}
+
+void deallocate(void* ptr)
+{
+    return g_freeFunc(ptr);
+}
+
+uint64_t getGPUCaps()
+{
+    // CPU emulation can pretend to support everything
+    uint64_t caps = 0;
+
+    caps |= GPUCaps::GeometryShader;
+    caps |= GPUCaps::TessellationShader;
+    caps |= GPUCaps::ComputeShader;
+    caps |= GPUCaps::MultipleRenderTargets;
+    caps |= GPUCaps::TextureArray;
+    caps |= GPUCaps::CubemapArray;
+    caps |= GPUCaps::StreamOutput;
+    caps |= GPUCaps::AlphaToCoverage;
+    caps |= GPUCaps::ConstantBufferOffsets;
+    caps |= GPUCaps::SeparateBlend;
+    caps |= GPUCaps::StructuredBuffer;
+    caps |= GPUCaps::RWStructuredBuffer;
+
+    caps |= GPUCaps::TextureCompressionDXT;
+    caps |= GPUCaps::TextureCompressionPVR;
+    caps |= GPUCaps::TextureCompressionETC;
+
+    caps |= GPUCaps::TextureFormatInteger;
+    caps |= GPUCaps::TextureFormatFloat;
+
+    return caps;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool compileShader(
+    const char*                 sourceCode,
+    size_t                      sourceCodeSize,
+    ShaderCompileVersion        version,
+    ShaderCompileTarget         target,
+    const ShaderCompileMacro*   macros,
+    size_t                      macrosSize,
+    uint64_t                    flags,
+    ErrorReportFunc             errorReport,
+
+    void*&  outData,
+    size_t& outDataSize
+)
+{
+    SGFX_PROFILE_ZONE("sgfx::compileShader");
+    (void)version; (void)target; (void)macros; (void)macrosSize; (void)flags;
+
+    // there is no shader compiler, "bytecode" is the source code itself
+    if (sourceCode == nullptr) {
+        if (errorReport != nullptr) errorReport("No shader source code provided!");
+        return false;
+    }
+
+    outDataSize = sourceCodeSize;
+    outData = allocate(outDataSize > 0 ? outDataSize : 1);
+    std::memcpy(outData, sourceCode, outDataSize);
+
+    return true;
+}
+
+// shaders
+VertexShaderHandle createVertexShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreateVertexShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(VertexShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releaseVertexShader(VertexShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseVertexShader, handle);
+    if (handle != VertexShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+HullShaderHandle createHullShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreateHullShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(HullShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releaseHullShader(HullShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseHullShader, handle);
+    if (handle != HullShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+DomainShaderHandle createDomainShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreateDomainShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(DomainShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releaseDomainShader(DomainShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseDomainShader, handle);
+    if (handle != DomainShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+GeometryShaderHandle createGeometryShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreateGeometryShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(GeometryShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releaseGeometryShader(GeometryShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseGeometryShader, handle);
+    if (handle != GeometryShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+PixelShaderHandle createPixelShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreatePixelShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(PixelShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releasePixelShader(PixelShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleasePixelShader, handle);
+    if (handle != PixelShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+SurfaceShaderHandle linkSurfaceShader(VertexShaderHandle vs, HullShaderHandle hs, DomainShaderHandle ds, GeometryShaderHandle gs, PixelShaderHandle ps, const SurfaceBindingLayout* layout)
+{
+    SGFX_CAPTURE(LinkSurfaceShader, vs, hs, ds, gs, ps, capturePod(layout));
+    uint32_t handle = g_surfaceShaders.Create();
+    SurfaceShaderImpl* impl = g_surfaceShaders.Get(handle);
+    impl->vs = g_shaders.Get(vs.value);
+    impl->hs = g_shaders.Get(hs.value);
+    impl->ds = g_shaders.Get(ds.value);
+    impl->gs = g_shaders.Get(gs.value);
+    impl->ps = g_shaders.Get(ps.value);
+
+    if (layout != nullptr) {
+        impl->layout = *layout;
+    } else {
+        StageBindingLayout fullLayout = getFullBindingLayout();
+        impl->layout.vs = fullLayout;
+        impl->layout.hs = fullLayout;
+        impl->layout.ds = fullLayout;
+        impl->layout.gs = fullLayout;
+        impl->layout.ps = fullLayout;
+    }
+    return SGFX_CAPTURE_RESULT(SurfaceShaderHandle(handle));
+}
+
+void releaseSurfaceShader(SurfaceShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseSurfaceShader, handle);
+    if (handle != SurfaceShaderHandle::invalidHandle()) {
+        g_surfaceShaders.Release(handle.value);
+    }
+}
+
+void setBindingValidationFunc(ErrorReportFunc func)
+{
+    g_bindingValidationFunc = func;
+}
+
+ComputeQueueHandle createComputeQueue(ComputeShaderHandle shader, const StageBindingLayout* layout)
+{
+    SGFX_CAPTURE(CreateComputeQueue, shader, capturePod(layout));
+    uint32_t handle = g_computeQueues.Create();
+    ComputeQueue* queue = g_computeQueues.Get(handle);
+    queue->shader = shader;
+    queue->layout = (layout != nullptr) ? *layout : getFullBindingLayout();
+
+    return SGFX_CAPTURE_RESULT(ComputeQueueHandle(handle));
+}
+
+void releaseComputeQueue(ComputeQueueHandle handle)
+{
+    SGFX_CAPTURE(ReleaseComputeQueue, handle);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        g_computeQueues.Release(handle.value);
+    }
+}
+
+void setConstantBuffer(ComputeQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer)
+{
+    SGFX_CAPTURE(SetConstantBufferCompute, handle, idx, buffer);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+        queue->setConstantBuffer(idx, buffer);
+    }
+}
+
+void setResource(ComputeQueueHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(SetResourceBufferCompute, handle, idx, resource);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+        queue->setResource(idx, resource);
+    }
+}
+
+void setResource(ComputeQueueHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(SetResourceTextureCompute, handle, idx, resource);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+        queue->setResource(idx, resource);
+    }
+}
+
+void setResourceRW(ComputeQueueHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(SetResourceRWBufferCompute, handle, idx, resource);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+        queue->setResourceRW(idx, resource);
+    }
+}
+
+void setResourceRW(ComputeQueueHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(SetResourceRWTextureCompute, handle, idx, resource);
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+        queue->setResourceRW(idx, resource);
+    }
+}
+
+void submit(ComputeQueueHandle handle, uint32_t x, uint32_t y, uint32_t z)
+{
+    SGFX_CAPTURE(SubmitCompute, handle, x, y, z);
+    SGFX_PROFILE_ZONE("sgfx::dispatch");
+
+    if (handle != ComputeQueueHandle::invalidHandle()) {
+        ComputeQueue* queue = g_computeQueues.Get(handle.value);
+
+        // resolve everything exactly as D3D11 would do, just don't bind it anywhere
+        // only the slot ranges the layout reads are resolved
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        const void* constantBuffers[ComputeQueue::kMaxConstantBuffers] = { nullptr };
+        if (trimRange(&queue->layout.constantBuffers, 0, ComputeQueue::kMaxConstantBuffers, first, count)) {
+            for (uint32_t i = first; i < first + count; ++i) {
+                const NullConstantBuffer* buffer = g_constantBuffers.Get(queue->constantBuffers[i].value);
+                if (buffer != nullptr)
+                    constantBuffers[i] = buffer->data;
+            }
+            g_deviceStats.numConstantBufferBinds++;
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, count);
+        }
+
+        const void* shaderResources[ComputeQueue::kMaxShaderResources] = { nullptr };
+        if (trimRange(queue->layout.shaderResources, 0, ComputeQueue::kMaxShaderResources, first, count)) {
+            for (uint32_t i = first; i < first + count; ++i) {
+                const NullSharedBuffer* buffer = g_sharedBuffers.Get(queue->shaderResources[i].value);
+                if (buffer != nullptr)
+                    shaderResources[i] = buffer->data;
+            }
+            g_deviceStats.numResourceBinds++;
+
+            SGFX_STAT(numBindCalls, 1);
+            SGFX_STAT(numBoundSlots, count);
+        }
+
+        const void* shaderUAVs[ComputeQueue::kMaxShaderResourcesRW] = { nullptr };
+        for (size_t i = 0; i < ComputeQueue::kMaxShaderResourcesRW; ++i) {
+            const NullSharedBuffer* buffer = g_sharedBuffers.Get(queue->shaderResourcesRW[i].value);
+            if (buffer != nullptr)
+                shaderUAVs[i] = buffer->data;
+        }
+        g_deviceStats.numResourceBinds++;
+
+        SGFX_STAT(numBindCalls, 1);
+        SGFX_STAT(numBoundSlots, ComputeQueue::kMaxShaderResourcesRW);
+
+        (void)constantBuffers;
+        (void)shaderResources;
+        (void)shaderUAVs;
+
+        NULL_STAT(numDispatches, 1);
+        g_deviceStats.numThreadGroups += static_cast<uint64_t>(x) * y * z;
+    }
+}
+
+ComputeShaderHandle createComputeShader(const void* data, size_t dataSize)
+{
+    SGFX_CAPTURE(CreateComputeShader, CaptureData{ data, dataSize }, dataSize);
+    return SGFX_CAPTURE_RESULT(ComputeShaderHandle(g_shaders.Create(data, dataSize)));
+}
+
+void releaseComputeShader(ComputeShaderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseComputeShader, handle);
+    if (handle != ComputeShaderHandle::invalidHandle()) {
+        g_shaders.Release(handle.value);
+    }
+}
+
+VertexFormatHandle createVertexFormat(
+    VertexElementDescriptor* elements,
+    size_t size,
+    void* shaderBytecode, size_t shaderBytecodeSize,
+    ErrorReportFunc errorReport
+)
+{
+    SGFX_CAPTURE(CreateVertexFormat, CaptureVertexElements{ elements, size }, size, CaptureData{ shaderBytecode, shaderBytecodeSize }, shaderBytecodeSize);
+    if (elements == nullptr || size == 0)
+        return SGFX_CAPTURE_RESULT(VertexFormatHandle::invalidHandle());
+
+    if (size > VertexFormatImpl::kMaxVertexElements) {
+        if (errorReport != nullptr) errorReport("Failed to create vertex format: too many elements!");
+        return SGFX_CAPTURE_RESULT(VertexFormatHandle::invalidHandle());
+    }
+
+    uint32_t handle = g_vertexFormats.Create();
+    VertexFormatImpl* impl = g_vertexFormats.Get(handle);
+    impl->numElements = size;
+    std::memcpy(impl->elements, elements, size * sizeof(VertexElementDescriptor));
+
+    return SGFX_CAPTURE_RESULT(VertexFormatHandle(handle));
+}
+
+void releaseVertexFormat(VertexFormatHandle handle)
+{
+    SGFX_CAPTURE(ReleaseVertexFormat, handle);
+    if (handle != VertexFormatHandle::invalidHandle()) {
+        g_vertexFormats.Release(handle.value);
+    }
+}
+
+PipelineStateHandle createPipelineState(const PipelineStateDescriptor& desc)
+{
+    SGFX_CAPTURE(CreatePipelineState, capturePod(desc));
+    SGFX_PROFILE_ZONE("sgfx::createPipelineState");
+
+    if (desc.shader == SurfaceShaderHandle::invalidHandle())
+        return SGFX_CAPTURE_RESULT(PipelineStateHandle::invalidHandle());
+
+    uint32_t handle = g_pipelineStates.Create();
+    PipelineStateImpl* impl = g_pipelineStates.Get(handle);
+    impl->desc         = desc;
+    impl->shader       = g_surfaceShaders.Get(desc.shader.value);
+    impl->vertexFormat = g_vertexFormats.Get(desc.vertexFormat.value);
+
+    if (impl->shader->vs != nullptr) impl->stateCache.addStage(impl->shader->layout.vs);
+    if (impl->shader->hs != nullptr) impl->stateCache.addStage(impl->shader->layout.hs);
+    if (impl->shader->ds != nullptr) impl->stateCache.addStage(impl->shader->layout.ds);
+    if (impl->shader->gs != nullptr) impl->stateCache.addStage(impl->shader->layout.gs);
+    if (impl->shader->ps != nullptr) impl->stateCache.addStage(impl->shader->layout.ps);
+
+    return SGFX_CAPTURE_RESULT(PipelineStateHandle(handle));
+}
+
+void releasePipelineState(PipelineStateHandle handle)
+{
+    SGFX_CAPTURE(ReleasePipelineState, handle);
+    if (handle != PipelineStateHandle::invalidHandle()) {
+        g_pipelineStates.Release(handle.value);
+    }
+}
+
+BufferHandle createBuffer(uint32_t flags, const void* mem, size_t size, size_t stride)
+{
+    SGFX_CAPTURE(CreateBuffer, flags, CaptureData{ mem, size }, size, stride);
+    uint32_t handle = g_sharedBuffers.Create();
+    NullSharedBuffer* buffer = g_sharedBuffers.Get(handle);
+    buffer->dataStride = stride;
+    buffer->flags      = flags;
+    buffer->createStorage(size, mem);
+
+    NULL_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        NULL_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(BufferHandle(handle));
+}
+
+void releaseBuffer(BufferHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBuffer, handle);
+    if (handle != BufferHandle::invalidHandle()) {
+        g_sharedBuffers.Release(handle.value);
+    }
+}
+
+// renames the storage on a discard like a driver would, the old one lives until its frame is done
+static void* nullMapStorage(NullSharedBuffer* buffer, MapType type)
+{
+    if (type == MapType::WriteDiscard) {
+        NullRetiredStorage storage;
+        storage.data       = buffer->data;
+        storage.frameIndex = g_frameIndex;
+        g_retiredStorage.Add(storage);
+
+        buffer->data = static_cast<uint8_t*>(g_allocFunc(buffer->dataSize > 0 ? buffer->dataSize : 1));
+        g_deviceStats.numBufferRenames++;
+    }
+    return buffer->data;
+}
+
+void* mapBuffer(BufferHandle handle, MapType type)
+{
+    SGFX_CAPTURE(MapBuffer, handle, type);
+    if (handle != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+
+        SGFX_STAT(numBufferMaps, 1);
+        return SGFX_CAPTURE_RESULT(nullMapStorage(buffer, type));
+    }
+    return SGFX_CAPTURE_RESULT(nullptr);
+}
+
+void unmapBuffer(BufferHandle handle)
+{
+    SGFX_CAPTURE(UnmapBuffer, handle);
+}
+
+void copyBufferData(BufferHandle handle, size_t offset, size_t size, const void* mem)
+{
+    SGFX_CAPTURE(CopyBufferData, handle, offset, size, CaptureData{ mem, size });
+    SGFX_PROFILE_ZONE("sgfx::copyBufferData");
+
+    if (handle != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+
+        if (offset + size <= buffer->dataSize) {
+            std::memcpy(buffer->data + offset, mem, size);
+            NULL_STAT(numBytesUploaded, size);
+        }
+    }
+}
+
+void clearBufferRW(BufferHandle handle, uint32_t value)
+{
+    SGFX_CAPTURE(ClearBufferRWUInt, handle, value);
+    if (handle != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+
+        uint32_t* data = reinterpret_cast<uint32_t*>(buffer->data);
+        for (size_t i = 0; i < buffer->dataSize / sizeof(uint32_t); ++i)
+            data[i] = value;
+    }
+}
+
+void clearBufferRW(BufferHandle handle, float value)
+{
+    SGFX_CAPTURE(ClearBufferRWFloat, handle, value);
+    if (handle != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* buffer = g_sharedBuffers.Get(handle.value);
+
+        float* data = reinterpret_cast<float*>(buffer->data);
+        for (size_t i = 0; i < buffer->dataSize / sizeof(float); ++i)
+            data[i] = value;
+    }
+}
+
+ConstantBufferHandle createConstantBuffer(const void* mem, size_t size)
+{
+    SGFX_CAPTURE(CreateConstantBuffer, CaptureData{ mem, size }, size);
+    uint32_t handle = g_constantBuffers.Create(mem, size);
+
+    NULL_STAT(numBuffersCreated, 1);
+    if (mem != nullptr)
+        NULL_STAT(numBytesUploaded, size);
+
+    return SGFX_CAPTURE_RESULT(ConstantBufferHandle(handle));
+}
+
+void updateConstantBuffer(ConstantBufferHandle handle, const void* mem)
+{
+    SGFX_CAPTURE(UpdateConstantBuffer, handle, CaptureConstantData{ mem });
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        NullConstantBuffer* buffer = g_constantBuffers.Get(handle.value);
+
+        std::memcpy(buffer->data, mem, buffer->dataSize);
+        NULL_STAT(numBytesUploaded, buffer->dataSize);
+    }
+}
+
+void updateConstantBuffer(ConstantBufferHandle handle, const void* mem, size_t offset, size_t size)
+{
+    SGFX_CAPTURE(UpdateConstantBufferRange, handle, CaptureData{ mem, size }, offset, size);
+    SGFX_PROFILE_ZONE("sgfx::updateConstantBuffer");
+
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        NullConstantBuffer* buffer = g_constantBuffers.Get(handle.value);
+
+        if (offset < buffer->dataSize) {
+            size = (size < buffer->dataSize - offset) ? size : buffer->dataSize - offset;
+            std::memcpy(buffer->data + offset, mem, size);
+            NULL_STAT(numBytesUploaded, size);
+        }
+    }
+}
+
+void releaseConstantBuffer(ConstantBufferHandle handle)
+{
+    SGFX_CAPTURE(ReleaseConstantBuffer, handle);
+    if (handle != ConstantBufferHandle::invalidHandle()) {
+        g_constantBuffers.Release(handle.value);
+    }
+}
+
+ConstantAllocatorHandle createConstantAllocator(size_t pageSize)
+{
+    SGFX_CAPTURE(CreateConstantAllocator, pageSize);
+    bool packBlocks = (getGPUCaps() & GPUCaps::ConstantBufferOffsets) != 0;
+    return SGFX_CAPTURE_RESULT(ConstantAllocatorHandle(g_constantAllocators.Create(pageSize, packBlocks)));
+}
+
+void releaseConstantAllocator(ConstantAllocatorHandle handle)
+{
+    SGFX_CAPTURE(ReleaseConstantAllocator, handle);
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->releasePages();
+        g_constantAllocators.Release(handle.value);
+    }
+}
+
+ConstantBlock allocateConstantBlock(ConstantAllocatorHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateConstantBlock, handle, CaptureData{ mem, size }, size);
+    ConstantBlock block;
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        block = g_constantAllocators.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != ConstantBufferHandle::invalidHandle())
+            updateConstantBuffer(block.buffer, mem, block.offset, size);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeConstantBlock(ConstantAllocatorHandle handle, const ConstantBlock& block)
+{
+    SGFX_CAPTURE(FreeConstantBlock, handle, capturePod(block));
+    if (handle != ConstantAllocatorHandle::invalidHandle()) {
+        g_constantAllocators.Get(handle.value)->free(block);
+    }
+}
+
+TransientAllocation allocateTransient(size_t size, size_t alignment)
+{
+    SGFX_CAPTURE(AllocateTransient, size, alignment);
+    return SGFX_CAPTURE_RESULT(g_transientRing.allocate(size, alignment));
+}
+
+BufferHeapHandle createBufferHeap(uint32_t flags, size_t size, size_t stride)
+{
+    SGFX_CAPTURE(CreateBufferHeap, flags, size, stride);
+    uint32_t handle = g_bufferHeaps.Create(flags, size, stride);
+    if (!g_bufferHeaps.Get(handle)->init()) {
+        g_bufferHeaps.Get(handle)->releaseBuffers();
+        g_bufferHeaps.Release(handle);
+        return SGFX_CAPTURE_RESULT(BufferHeapHandle::invalidHandle());
+    }
+    return SGFX_CAPTURE_RESULT(BufferHeapHandle(handle));
+}
+
+void releaseBufferHeap(BufferHeapHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBufferHeap, handle);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->releaseBuffers();
+        g_bufferHeaps.Release(handle.value);
+    }
+}
+
+BufferBlock allocateBufferBlock(BufferHeapHandle handle, const void* mem, size_t size)
+{
+    SGFX_CAPTURE(AllocateBufferBlock, handle, CaptureData{ mem, size }, size);
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->allocate(size);
+
+        if (mem != nullptr && block.buffer != BufferHandle::invalidHandle())
+            copyBufferData(block.buffer, block.offset, size, mem);
+    }
+    return SGFX_CAPTURE_RESULT(block);
+}
+
+void freeBufferBlock(BufferHeapHandle handle, const BufferBlock& block)
+{
+    SGFX_CAPTURE(FreeBufferBlock, handle, capturePod(block));
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        g_bufferHeaps.Get(handle.value)->free(block.id);
+    }
+}
+
+BufferBlock getBufferBlock(BufferHeapHandle handle, uint32_t id)
+{
+    BufferBlock block;
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        block = g_bufferHeaps.Get(handle.value)->getBlock(id);
+    }
+    return block;
+}
+
+size_t compactBufferHeap(BufferHeapHandle handle, size_t maxBytes)
+{
+    SGFX_CAPTURE(CompactBufferHeap, handle, maxBytes);
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        return SGFX_CAPTURE_RESULT(g_bufferHeaps.Get(handle.value)->compact(maxBytes));
+    }
+    return SGFX_CAPTURE_RESULT(static_cast<size_t>(0));
+}
+
+BufferHeapStats getBufferHeapStats(BufferHeapHandle handle)
+{
+    BufferHeapStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != BufferHeapHandle::invalidHandle()) {
+        stats = g_bufferHeaps.Get(handle.value)->getStats();
+    }
+    return stats;
+}
+
+SamplerStateHandle createSamplerState(const SamplerStateDescriptor& desc)
+{
+    SGFX_CAPTURE(CreateSamplerState, capturePod(desc));
+    uint32_t handle = g_samplerStates.Create(desc);
+    return SGFX_CAPTURE_RESULT(SamplerStateHandle(handle));
+}
+
+void releaseSamplerState(SamplerStateHandle handle)
+{
+    SGFX_CAPTURE(ReleaseSamplerState, handle);
+    if (handle != SamplerStateHandle::invalidHandle()) {
+        g_samplerStates.Release(handle.value);
+    }
+}
+
+Texture1DHandle createTexture1D(uint32_t width, DataFormat format, uint32_t numMipmaps, uint32_t flags)
+{
+    SGFX_CAPTURE(CreateTexture1D, width, format, numMipmaps, flags);
+    return SGFX_CAPTURE_RESULT(Texture1DHandle(nullCreateTexture(width, 1, 1, format, numMipmaps, flags)));
+}
+
+Texture2DHandle createTexture2D(uint32_t width, uint32_t height, DataFormat format, uint32_t numMipmaps, uint32_t flags)
+{
+    SGFX_CAPTURE(CreateTexture2D, width, height, format, numMipmaps, flags);
+    return SGFX_CAPTURE_RESULT(Texture2DHandle(nullCreateTexture(width, height, 1, format, numMipmaps, flags)));
+}
+
+Texture3DHandle createTexture3D(uint32_t width, uint32_t height, uint32_t depth, DataFormat format, uint32_t numMipmaps, uint32_t flags)
+{
+    SGFX_CAPTURE(CreateTexture3D, width, height, depth, format, numMipmaps, flags);
+    return SGFX_CAPTURE_RESULT(Texture3DHandle(nullCreateTexture(width, height, depth, format, numMipmaps, flags)));
+}
+
+void clearTextureRW(TextureHandle handle, uint32_t value)
+{
+    SGFX_CAPTURE(ClearTextureRWUInt, handle, value);
+    if (handle != TextureHandle::invalidHandle()) {
+        NullSharedBuffer* texture = g_sharedBuffers.Get(handle.value);
+
+        if (texture->flags & TextureFlags::GPUWrite) {
+            uint32_t* data = reinterpret_cast<uint32_t*>(texture->data);
+            for (size_t i = 0; i < nullMipSize(texture, 0) / sizeof(uint32_t); ++i)
+                data[i] = value;
+        }
+    }
+}
+
+void clearTextureRW(TextureHandle handle, float value)
+{
+    SGFX_CAPTURE(ClearTextureRWFloat, handle, value);
+    if (handle != TextureHandle::invalidHandle()) {
+        NullSharedBuffer* texture = g_sharedBuffers.Get(handle.value);
+
+        if (texture->flags & TextureFlags::GPUWrite) {
+            float* data = reinterpret_cast<float*>(texture->data);
+            for (size_t i = 0; i < nullMipSize(texture, 0) / sizeof(float); ++i)
+                data[i] = value;
+        }
+    }
+}
+
+void* mapTexture(TextureHandle handle, MapType type)
+{
+    SGFX_CAPTURE(MapTexture, handle, type);
+    if (handle != TextureHandle::invalidHandle()) {
+        NullSharedBuffer* texture = g_sharedBuffers.Get(handle.value);
+        return SGFX_CAPTURE_RESULT(nullMapStorage(texture, type));
+    }
+    return SGFX_CAPTURE_RESULT(nullptr);
+}
+
+void unmapTexture(TextureHandle handle)
+{
+    SGFX_CAPTURE(UnmapTexture, handle);
+}
+
+void updateTexture(
+    TextureHandle handle, const void* mem,
+    uint32_t mip,
+    size_t offsetX,  size_t sizeX,
+    size_t offsetY,  size_t sizeY,
+    size_t offsetZ,  size_t sizeZ,
+    size_t rowPitch, size_t depthPitch
+)
+{
+    SGFX_CAPTURE(UpdateTexture, handle, CaptureTextureData{ mem, sizeX, sizeY, sizeZ, rowPitch, depthPitch }, mip, offsetX, sizeX, offsetY, sizeY, offsetZ, sizeZ, rowPitch, depthPitch);
+    SGFX_PROFILE_ZONE("sgfx::updateTexture");
+
+    if (handle != TextureHandle::invalidHandle() && mem != nullptr) {
+        NullSharedBuffer* texture = g_sharedBuffers.Get(handle.value);
+
+        if (mip >= texture->numMipmaps)
+            return;
+
+        uint32_t blockSize = getFormatBlockSize(texture->format);
+
+        uint32_t mipWidth  = texture->width  >> mip; if (mipWidth  == 0) mipWidth  = 1;
+        uint32_t mipHeight = texture->height >> mip; if (mipHeight == 0) mipHeight = 1;
+        uint32_t mipDepth  = texture->depth  >> mip; if (mipDepth  == 0) mipDepth  = 1;
+
+        if (offsetX + sizeX > mipWidth || offsetY + sizeY > mipHeight || offsetZ + sizeZ > mipDepth)
+            return;
+
+        size_t dstRowPitch   = getFormatRowPitch(texture->format, mipWidth);
+        size_t dstNumRows    = (mipHeight + blockSize - 1) / blockSize;
+        size_t dstSlicePitch = dstRowPitch * dstNumRows;
+
+        size_t copyOffset  = (offsetX / blockSize) * getFormatRowPitch(texture->format, blockSize);
+        size_t copySize    = getFormatRowPitch(texture->format, static_cast<uint32_t>(sizeX));
+        size_t numCopyRows = (sizeY + blockSize - 1) / blockSize;
+        size_t firstRow    = offsetY / blockSize;
+
+        if (rowPitch == 0)   rowPitch   = copySize;
+        if (depthPitch == 0) depthPitch = rowPitch * numCopyRows;
+
+        uint8_t*       dst = texture->data + nullMipOffset(texture, mip);
+        const uint8_t* src = static_cast<const uint8_t*>(mem);
+
+        for (size_t z = 0; z < sizeZ; ++z) {
+            for (size_t y = 0; y < numCopyRows; ++y) {
+                std::memcpy(
+                    dst + (offsetZ + z) * dstSlicePitch + (firstRow + y) * dstRowPitch + copyOffset,
+                    src + z * depthPitch + y * rowPitch,
+                    copySize
+                );
+            }
+        }
+
+        NULL_STAT(numBytesUploaded, copySize * numCopyRows * sizeZ);
+    }
+}
+
+void releaseTexture(TextureHandle handle)
+{
+    SGFX_CAPTURE(ReleaseTexture, handle);
+    if (handle != TextureHandle::invalidHandle()) {
+        g_sharedBuffers.Release(handle.value);
+    }
+}
+
+ResourceTableHandle createResourceTable(const ResourceTableEntry* entries, uint32_t numEntries)
+{
+    SGFX_CAPTURE(CreateResourceTable, CaptureData{ entries, numEntries * sizeof(ResourceTableEntry) }, numEntries);
+    if (numEntries > ResourceTable::kMaxResources)
+        return SGFX_CAPTURE_RESULT(ResourceTableHandle::invalidHandle());
+
+    // handle values are what the null device binds, nothing else to resolve
+    uint32_t handle = g_resourceTables.Create();
+    ResourceTable* table = g_resourceTables.Get(handle);
+    table->init(entries, numEntries);
+
+    return SGFX_CAPTURE_RESULT(ResourceTableHandle(handle));
+}
+
+void releaseResourceTable(ResourceTableHandle handle)
+{
+    SGFX_CAPTURE(ReleaseResourceTable, handle);
+    if (handle != ResourceTableHandle::invalidHandle()) {
+        g_resourceTables.Release(handle.value);
+    }
+}
+
+void copyResource(TextureHandle src, TextureHandle dst)
+{
+    SGFX_CAPTURE(CopyResourceTexture, src, dst);
+    if (src != dst && src != TextureHandle::invalidHandle() && dst != TextureHandle::invalidHandle()) {
+        NullSharedBuffer* nullSrc = g_sharedBuffers.Get(src.value);
+        NullSharedBuffer* nullDst = g_sharedBuffers.Get(dst.value);
+
+        std::memcpy(nullDst->data, nullSrc->data, nullSrc->dataSize < nullDst->dataSize ? nullSrc->dataSize : nullDst->dataSize);
+    }
+}
+
+void copyResource(BufferHandle src, BufferHandle dst)
+{
+    SGFX_CAPTURE(CopyResourceBuffer, src, dst);
+    if (src != dst && src != BufferHandle::invalidHandle() && dst != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* nullSrc = g_sharedBuffers.Get(src.value);
+        NullSharedBuffer* nullDst = g_sharedBuffers.Get(dst.value);
+
+        std::memcpy(nullDst->data, nullSrc->data, nullSrc->dataSize < nullDst->dataSize ? nullSrc->dataSize : nullDst->dataSize);
+    }
+}
+
+void copyBufferRegion(BufferHandle dst, size_t dstOffset, BufferHandle src, size_t srcOffset, size_t size)
+{
+    SGFX_CAPTURE(CopyBufferRegion, dst, dstOffset, src, srcOffset, size);
+    if (src != dst && src != BufferHandle::invalidHandle() && dst != BufferHandle::invalidHandle()) {
+        NullSharedBuffer* nullSrc = g_sharedBuffers.Get(src.value);
+        NullSharedBuffer* nullDst = g_sharedBuffers.Get(dst.value);
+
+        if (srcOffset + size <= nullSrc->dataSize && dstOffset + size <= nullDst->dataSize) {
+            std::memcpy(nullDst->data + dstOffset, nullSrc->data + srcOffset, size);
+            NULL_STAT(numBytesCopied, size);
+        }
+    }
+}
+
+void copyResource(ConstantBufferHandle src, ConstantBufferHandle dst)
+{
+    SGFX_CAPTURE(CopyResourceConstantBuffer, src, dst);
+    if (src != dst && src != ConstantBufferHandle::invalidHandle() && dst != ConstantBufferHandle::invalidHandle()) {
+        NullConstantBuffer* nullSrc = g_constantBuffers.Get(src.value);
+        NullConstantBuffer* nullDst = g_constantBuffers.Get(dst.value);
+
+        std::memcpy(nullDst->data, nullSrc->data, nullSrc->dataSize < nullDst->dataSize ? nullSrc->dataSize : nullDst->dataSize);
+    }
+}
+
+Texture2DHandle getBackBuffer()
+{
+    SGFX_CAPTURE(GetBackBuffer);
+    return SGFX_CAPTURE_RESULT(Texture2DHandle(nullCreateTexture(g_backBufferWidth, g_backBufferHeight, 1, DataFormat::RGBA8, 1, TextureFlags::RenderTarget)));
+}
+
+RenderTargetHandle createRenderTarget(const RenderTargetDescriptor& desc)
+{
+    SGFX_CAPTURE(CreateRenderTarget, capturePod(desc));
+    if (desc.numColorTextures > RenderTargetSlot::Count)
+        return SGFX_CAPTURE_RESULT(RenderTargetHandle::invalidHandle());
+
+    uint32_t handle = g_renderTargets.Create();
+    RenderTargetImpl* impl = g_renderTargets.Get(handle);
+    impl->desc = desc;
+
+    return SGFX_CAPTURE_RESULT(RenderTargetHandle(handle));
+}
+
+void releaseRenderTarget(RenderTargetHandle handle)
+{
+    SGFX_CAPTURE(ReleaseRenderTarget, handle);
+    if (handle != RenderTargetHandle::invalidHandle()) {
+        g_renderTargets.Release(handle.value);
+    }
+}
+
+void setViewport(uint32_t width, uint32_t height, float minDepth, float maxDepth)
+{
+    SGFX_CAPTURE(SetViewport, width, height, minDepth, maxDepth);
+}
+
+void setResourceRW(RenderTargetHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(SetResourceRWBufferRenderTarget, handle, idx, resource);
+    if (handle != RenderTargetHandle::invalidHandle()) {
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
+        impl->unorderedAccessViews[idx] = g_sharedBuffers.Get(resource.value);
+    }
+}
+
+void setResourceRW(RenderTargetHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(SetResourceRWTextureRenderTarget, handle, idx, resource);
+    if (handle != RenderTargetHandle::invalidHandle()) {
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
+        impl->unorderedAccessViews[idx] = g_sharedBuffers.Get(resource.value);
+    }
+}
+
+void setRenderTarget(RenderTargetHandle handle)
+{
+    SGFX_CAPTURE(SetRenderTarget, handle);
+    NULL_STAT(numRenderTargetChanges, 1);
+}
+
+void clearRenderTarget(RenderTargetHandle handle, uint32_t color)
+{
+    SGFX_CAPTURE(ClearRenderTarget, handle, color);
+    if (handle != RenderTargetHandle::invalidHandle()) {
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
+
+        for (uint32_t i = 0; i < impl->desc.numColorTextures; ++i)
+            clearRenderTarget(handle, i, color);
+    }
+}
+
+void clearRenderTarget(RenderTargetHandle handle, uint32_t slot, uint32_t color)
+{
+    SGFX_CAPTURE(ClearRenderTargetSlot, handle, slot, color);
+    if (handle != RenderTargetHandle::invalidHandle()) {
+        RenderTargetImpl* impl = g_renderTargets.Get(handle.value);
+
+        if (slot < impl->desc.numColorTextures) {
+            NullSharedBuffer* texture = g_sharedBuffers.Get(impl->desc.colorTextures[slot].value);
+
+            // only RGBA8 targets can be cleared with a packed color directly
+            if (texture != nullptr && texture->format == DataFormat::RGBA8) {
+                uint32_t* data = reinterpret_cast<uint32_t*>(texture->data);
+                for (size_t i = 0; i < nullMipSize(texture, 0) / sizeof(uint32_t); ++i)
+                    data[i] = color;
+            }
+        }
+    }
+}
+
+void clearDepthStencil(RenderTargetHandle handle, float depth, uint8_t stencil)
+{
+    SGFX_CAPTURE(ClearDepthStencil, handle, depth, stencil);
+}
+
+void present(uint32_t swapInterval)
+{
+    SGFX_CAPTURE(Present, swapInterval);
+    resetFrameArenas();
+    g_transientRing.endFrame();
+
+    for (size_t i = 0; i < g_retiredStorage.GetSize();) {
+        if (g_frameIndex - g_retiredStorage[i].frameIndex >= TransientRing::kFramesInFlight) {
+            g_freeFunc(g_retiredStorage[i].data);
+            g_retiredStorage.RemoveSwap(i);
+        } else {
+            ++i;
+        }
+    }
+
+    g_deviceStats.numFrames++;
+
+    g_lastFrameStats = g_frameStats;
+    std::memset(&g_frameStats, 0, sizeof(g_frameStats));
+}
+
+// draw queue stuff is similar for all APIs
+
+FrameArenaHandle createFrameArena(size_t blockSize)
+{
+    SGFX_CAPTURE(CreateFrameArena, blockSize);
+    if (blockSize == 0)
+        blockSize = FrameArena::kDefaultBlockSize;
+
+    uint32_t handle = g_frameArenas.Create(blockSize);
+    FrameArena* arena = g_frameArenas.Get(handle);
+    arena->nextArena  = g_userFrameArenas;
+    g_userFrameArenas = arena;
+
+    return SGFX_CAPTURE_RESULT(FrameArenaHandle(handle));
+}
+
+void releaseFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(ReleaseFrameArena, handle);
+    if (handle != FrameArenaHandle::invalidHandle()) {
+        FrameArena* arena = g_frameArenas.Get(handle.value);
+
+        for (FrameArena** link = &g_userFrameArenas; *link != nullptr; link = &(*link)->nextArena) {
+            if (*link == arena) {
+                *link = arena->nextArena;
+                break;
+            }
+        }
+
+        if (t_frameArena == arena)
+            t_frameArena = nullptr;
+
+        g_frameArenas.Release(handle.value);
+    }
+}
+
+void setThreadFrameArena(FrameArenaHandle handle)
+{
+    SGFX_CAPTURE(SetThreadFrameArena, handle);
+    t_frameArena = g_frameArenas.Get(handle.value);
+}
+
+DrawQueueHandle createDrawQueue(PipelineStateHandle state, uint32_t flags)
+{
+    SGFX_CAPTURE(CreateDrawQueue, state, flags);
+    return SGFX_CAPTURE_RESULT(DrawQueueHandle(g_drawQueues.Create(state, flags)));
+}
+
+void releaseDrawQueue(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(ReleaseDrawQueue, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        g_drawQueues.Release(handle.value);
+    }
+}
+
+void setSamplerState(DrawQueueHandle handle, uint32_t idx, SamplerStateHandle sampler)
+{
+    SGFX_CAPTURE(SetSamplerState, handle, idx, sampler);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setSamplerState(idx, sampler);
+    }
+}
+
+void setSortKey(DrawQueueHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(SetSortKey, handle, key);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(ResetBindings, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->resetBindings();
+    }
+}
+
+void setPrimitiveTopology(DrawQueueHandle handle, PrimitiveTopology topology)
+{
+    SGFX_CAPTURE(SetPrimitiveTopology, handle, topology);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setPrimitiveTopology(topology);
+    }
+}
+
+void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx)
+{
+    SGFX_CAPTURE(SetVertexBuffer, handle, vb, idx);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setVertexBuffer(idx, vb);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib)
+{
+    SGFX_CAPTURE(SetIndexBuffer, handle, ib);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib);
+    }
+}
+
+void setVertexBuffer(DrawQueueHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(SetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(SetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawQueueHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(SetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setIndexBuffer(ib, offset, format);
+    }
+}
+
+void setConstantBuffer(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer)
+{
+    SGFX_CAPTURE(SetConstantBuffer, handle, idx, buffer);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setConstantBuffer(idx, buffer);
+    }
+}
+
+void setConstantBufferRange(DrawQueueHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(SetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
+void setResource(DrawQueueHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(SetResourceBuffer, handle, idx, resource);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setResource(idx, resource);
+    }
+}
+
+void setResource(DrawQueueHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(SetResourceTexture, handle, idx, resource);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setResource(idx, resource);
+    }
+}
+
+void setResourceTable(DrawQueueHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(SetResourceTable, handle, firstSlot, table);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawQueueHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(SetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->setInlineConstants(idx, data, size);
+    }
+}
+
+void draw(DrawQueueHandle handle, uint32_t count, uint32_t startVertex)
+{
+    SGFX_CAPTURE(Draw, handle, count, startVertex);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->draw(count, startVertex);
+    }
+}
+
+void drawIndexed(DrawQueueHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
+{
+    SGFX_CAPTURE(DrawIndexed, handle, count, startIndex, startVertex);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->drawIndexed(count, startIndex, startVertex);
+    }
+}
+
+void drawInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(DrawInstanced, handle, instanceCount, count, startVertex, startInstance);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->drawInstanced(instanceCount, count, startVertex, startInstance);
+    }
+}
+
+void drawIndexedInstanced(DrawQueueHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(DrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
+    }
+}
+
+void drawInstancedIndirect(DrawQueueHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(DrawInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->drawInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+void drawIndexedInstancedIndirect(DrawQueueHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(DrawIndexedInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        queue->drawIndexedInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+DrawRecorderHandle createDrawRecorder(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(CreateDrawRecorder, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+
+        uint32_t recorderHandle = g_drawRecorders.Create();
+        queue->attachRecorder(g_drawRecorders.Get(recorderHandle));
+
+        return SGFX_CAPTURE_RESULT(DrawRecorderHandle(recorderHandle));
+    }
+    return SGFX_CAPTURE_RESULT(DrawRecorderHandle::invalidHandle());
+}
+
+void releaseDrawRecorder(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(ReleaseDrawRecorder, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        g_drawRecorders.Release(handle.value);
+    }
+}
+
+void setDrawRecorderKey(DrawRecorderHandle handle, uint32_t key)
+{
+    SGFX_CAPTURE(SetDrawRecorderKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setKey(key);
+    }
+}
+
+void setSortKey(DrawRecorderHandle handle, uint64_t key)
+{
+    SGFX_CAPTURE(RecorderSetSortKey, handle, key);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setSortKey(key);
+    }
+}
+
+void resetBindings(DrawRecorderHandle handle)
+{
+    SGFX_CAPTURE(RecorderResetBindings, handle);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->resetBindings();
+    }
+}
+
+void setPrimitiveTopology(DrawRecorderHandle handle, PrimitiveTopology topology)
+{
+    SGFX_CAPTURE(RecorderSetPrimitiveTopology, handle, topology);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setPrimitiveTopology(topology);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx)
+{
+    SGFX_CAPTURE(RecorderSetVertexBuffer, handle, vb, idx);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib)
+{
+    SGFX_CAPTURE(RecorderSetIndexBuffer, handle, ib);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib);
+    }
+}
+
+void setVertexBuffer(DrawRecorderHandle handle, BufferHandle vb, uint32_t idx, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetVertexBufferOffset, handle, vb, idx, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setVertexBuffer(idx, vb, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferOffset, handle, ib, offset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset);
+    }
+}
+
+void setIndexBuffer(DrawRecorderHandle handle, BufferHandle ib, uint32_t offset, IndexFormat format)
+{
+    SGFX_CAPTURE(RecorderSetIndexBufferFormat, handle, ib, offset, format);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setIndexBuffer(ib, offset, format);
+    }
+}
+
+void setConstantBuffer(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer)
+{
+    SGFX_CAPTURE(RecorderSetConstantBuffer, handle, idx, buffer);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBuffer(idx, buffer);
+    }
+}
+
+void setConstantBufferRange(DrawRecorderHandle handle, uint32_t idx, ConstantBufferHandle buffer, uint32_t offset, uint32_t size)
+{
+    SGFX_CAPTURE(RecorderSetConstantBufferRange, handle, idx, buffer, offset, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setConstantBufferRange(idx, buffer, offset, size);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, BufferHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceBuffer, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResource(DrawRecorderHandle handle, uint32_t idx, TextureHandle resource)
+{
+    SGFX_CAPTURE(RecorderSetResourceTexture, handle, idx, resource);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResource(idx, resource);
+    }
+}
+
+void setResourceTable(DrawRecorderHandle handle, uint32_t firstSlot, ResourceTableHandle table)
+{
+    SGFX_CAPTURE(RecorderSetResourceTable, handle, firstSlot, table);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setResourceTable(firstSlot, table);
+    }
+}
+
+void setInlineConstants(DrawRecorderHandle handle, uint32_t idx, const void* data, size_t size)
+{
+    SGFX_CAPTURE(RecorderSetInlineConstants, handle, idx, CaptureData{ data, size }, size);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->setInlineConstants(idx, data, size);
+    }
+}
+
+void draw(DrawRecorderHandle handle, uint32_t count, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDraw, handle, count, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->draw(count, startVertex);
+    }
+}
+
+void drawIndexed(DrawRecorderHandle handle, uint32_t count, uint32_t startIndex, uint32_t startVertex)
+{
+    SGFX_CAPTURE(RecorderDrawIndexed, handle, count, startIndex, startVertex);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexed(count, startIndex, startVertex);
+    }
+}
+
+void drawInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawInstanced, handle, instanceCount, count, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawInstanced(instanceCount, count, startVertex, startInstance);
+    }
+}
+
+void drawIndexedInstanced(DrawRecorderHandle handle, uint32_t instanceCount, uint32_t count, uint32_t startIndex, uint32_t startVertex, uint32_t startInstance)
+{
+    SGFX_CAPTURE(RecorderDrawIndexedInstanced, handle, instanceCount, count, startIndex, startVertex, startInstance);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexedInstanced(instanceCount, count, startIndex, startVertex, startInstance);
+    }
+}
+
+void drawInstancedIndirect(DrawRecorderHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(RecorderDrawInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+void drawIndexedInstancedIndirect(DrawRecorderHandle handle, BufferHandle indirectArgs, size_t argsOffset)
+{
+    SGFX_CAPTURE(RecorderDrawIndexedInstancedIndirect, handle, indirectArgs, argsOffset);
+    if (handle != DrawRecorderHandle::invalidHandle()) {
+        DrawRecorder* recorder = g_drawRecorders.Get(handle.value);
+        recorder->drawIndexedInstancedIndirect(indirectArgs, argsOffset);
+    }
+}
+
+void submit(DrawQueueHandle handle, uint32_t flags)
+{
+    SGFX_CAPTURE(Submit, handle, flags);
+    SGFX_PROFILE_ZONE("sgfx::submit");
+
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue = g_drawQueues.Get(handle.value);
+        QueueStatsScope statsScope(queue->stats);
+
+        if (queue->getNumDrawCalls() != 0) {
+            g_transientRing.unmap();
+            nullProcessDrawQueue(queue, flags);
+            queue->clear();
+        }
+    }
+}
+
+BundleHandle createBundle(DrawQueueHandle handle)
+{
+    SGFX_CAPTURE(CreateBundle, handle);
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        DrawQueue* queue  = g_drawQueues.Get(handle.value);
+        uint32_t   bundle = g_bundles.Create(*queue);
+
+        if (bundle != 0) {
+            NullBundleBaker baker = { g_bundles.Get(bundle) };
+            bakeDrawCalls(queue, baker);
+            baker.bundle->numReleases = nullNumBundleReleases();
+        }
+
+        queue->clear();
+        return SGFX_CAPTURE_RESULT(BundleHandle(bundle));
+    }
+    return SGFX_CAPTURE_RESULT(BundleHandle::invalidHandle());
+}
+
+void releaseBundle(BundleHandle handle)
+{
+    SGFX_CAPTURE(ReleaseBundle, handle);
+    if (handle != BundleHandle::invalidHandle()) {
+        g_bundles.Release(handle.value);
+    }
+}
+
+bool isBundleValid(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return nullValidateBundle(g_bundles.Get(handle.value));
+    return false;
+}
+
+uint32_t getNumDrawCalls(BundleHandle handle)
+{
+    if (handle != BundleHandle::invalidHandle())
+        return g_bundles.Get(handle.value)->numDrawCalls;
+    return 0;
+}
+
+void submit(BundleHandle handle, const uint64_t* visibilityMask)
+{
+    SGFX_CAPTURE(SubmitBundle, handle, CaptureBundleMask{ handle, visibilityMask });
+    SGFX_PROFILE_ZONE("sgfx::submitBundle");
+
+    if (handle != BundleHandle::invalidHandle()) {
+        NullBundle* bundle = g_bundles.Get(handle.value);
+        if (nullValidateBundle(bundle) && bundle->numDrawCalls != 0) {
+            g_transientRing.unmap();
+            nullProcessBundle(bundle, visibilityMask);
+        }
+    }
+}
+
+void flush()
+{
+    SGFX_CAPTURE(Flush);
+}
+
+void beginPerfEvent(const wchar_t* name)
+{
+    SGFX_CAPTURE(BeginPerfEvent, CaptureWideString{ name });
+    g_profiler.begin(name, true);
+}
+
+void endPerfEvent()
+{
+    SGFX_CAPTURE(EndPerfEvent);
+    g_profiler.end();
+}
+
+void startProfiler()
+{
+    g_profiler.start();
+}
+
+void stopProfiler()
+{
+    g_profiler.stop();
+}
+
+bool writeProfilerTrace(const char* path)
+{
+    return g_profiler.writeTrace(path);
+}
+
+bool startCapture(const char* path)
+{
+    return g_captureWriter.start(path, g_backBufferWidth, g_backBufferHeight);
+}
+
+void stopCapture()
+{
+    g_captureWriter.stop();
+}
+
+const FrameStats& getFrameStats()
+{
+    return g_lastFrameStats;
+}
+
+QueueStats getQueueStats(DrawQueueHandle handle)
+{
+    QueueStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    if (handle != DrawQueueHandle::invalidHandle()) {
+        stats = g_drawQueues.Get(handle.value)->stats;
+    }
+    return stats;
+}
+
+// null backend interop
+namespace null
+{
+
+const DeviceStats& getDeviceStats()
+{
+    return g_deviceStats;
+}
+
+void resetDeviceStats()
+{
+    std::memset(&g_deviceStats, 0, sizeof(g_deviceStats));
+}
+
+}
+
+}
@@ -0,0 +1,1328 @@
+/// The MIT License (MIT)
+///
+/// Copyright (c) 2015 Kirill Bazhenov
+/// Copyright (c) 2015 BitBox, Ltd.
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy
+/// of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights
+/// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is
+/// furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in
+/// all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+/// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+/// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+/// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+
+// sgfx_replay, plays an API capture (see sgfx::startCapture) back on the backend it is linked
+// with and times every frame, a frame ends with its present()
+//
+//   sgfx_replay <trace> [-repeat N] [-frames]
+//
+// the trace is memory-mapped and its calls are made in order on one thread: handles in the
+// arguments are mapped to the objects the replay created, the data the capture wrote into
+// mapped buffers and transient memory is written into the replay's own; -repeat runs the whole
+// trace N times on a fresh device, -frames prints every frame instead of the summary only
+//
+// a trace that is cut short, has no present() or uses a handle it never created (a capture
+// started after the objects were made) is rejected, sgfx_replay exits with 1
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SGFX_CAPTURE_FORMAT 1
+#include "sigrlinn.hh"
+
+static_assert(sizeof(size_t) == 8, "traces are 64-bit only");
+
+using sgfx::capture::Op;
+
+//=============================================================================
+// the backend the tool is linked with, the null one runs anywhere
+static bool initBackend(uint32_t backBufferWidth, uint32_t backBufferHeight)
+{
+    return sgfx::initNull(backBufferWidth, backBufferHeight);
+}
+
+//=============================================================================
+// a read-only view of the whole trace file
+class MappedFile final
+{
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+
+#if defined(_WIN32)
+    HANDLE         file    = INVALID_HANDLE_VALUE;
+    HANDLE         mapping = nullptr;
+#endif
+
+public:
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data != nullptr)
+            munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    bool open(const char* path)
+    {
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            return false;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+            return false;
+
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = static_cast<size_t>(fileSize.QuadPart);
+        return data != nullptr;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        // the records are read front to back once per run
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+        data = static_cast<const uint8_t*>(view);
+        size = static_cast<size_t>(info.st_size);
+        return true;
+#endif
+    }
+
+    const uint8_t* getData() const { return data; }
+    size_t         getSize() const { return size; }
+};
+
+//=============================================================================
+// the arguments of one record, reads past its end return zeros and mark the record broken
+class RecordReader final
+{
+    const uint8_t* position;
+    const uint8_t* end;
+    bool           overrun = false;
+
+public:
+
+    RecordReader(const uint8_t* data, size_t size)
+        : position(data)
+        , end(data + size)
+    {}
+
+    bool isOverrun() const { return overrun; }
+
+    template <typename T>
+    T get()
+    {
+        T value = T();
+        if (static_cast<size_t>(end - position) < sizeof(T)) {
+            overrun = true;
+            return value;
+        }
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    // nullptr for kNullData
+    const void* getData(size_t& size)
+    {
+        uint64_t recordedSize = get<uint64_t>();
+        size = 0;
+        if (recordedSize == sgfx::capture::kNullData)
+            return nullptr;
+
+        if (recordedSize > static_cast<uint64_t>(end - position)) {
+            overrun = true;
+            return nullptr;
+        }
+
+        const void* data = position;
+        position += recordedSize;
+        size = static_cast<size_t>(recordedSize);
+        return data;
+    }
+
+    // a struct passed by pointer, false for nullptr
+    template <typename T>
+    bool getPod(T& pod)
+    {
+        size_t      size = 0;
+        const void* data = getData(size);
+        if (data == nullptr || size != sizeof(T))
+            return false;
+        std::memcpy(&pod, data, sizeof(T));
+        return true;
+    }
+
+    std::string getString()
+    {
+        uint32_t length = get<uint32_t>();
+        if (length > static_cast<size_t>(end - position)) {
+            overrun = true;
+            return std::string();
+        }
+
+        std::string string(reinterpret_cast<const char*>(position), length);
+        position += length;
+        return string;
+    }
+
+    std::wstring getWideString()
+    {
+        uint32_t length = get<uint32_t>();
+        if (length > static_cast<size_t>(end - position) / sizeof(uint32_t)) {
+            overrun = true;
+            return std::wstring();
+        }
+
+        std::wstring string(length, L'\0');
+        for (uint32_t i = 0; i < length; ++i)
+            string[i] = static_cast<wchar_t>(get<uint32_t>());
+        return string;
+    }
+};
+
+//=============================================================================
+// plays a trace back once, created on a fresh device
+class Replay final
+{
+    enum : uint32_t
+    {
+        kNumHandleTags = 23 // see the handle typedefs in sigrlinn.hh
+    };
+
+    // transient memory handed out this frame, the uploads submit() captured are copied into it
+    struct TransientBlock final
+    {
+        uint32_t capturedBuffer;
+        size_t   capturedOffset;
+        size_t   size;
+        uint8_t* memory;
+    };
+
+    std::unordered_map<uint32_t, uint32_t> handles[kNumHandleTags]; // captured value -> replayed value
+    std::unordered_map<uint32_t, void*>    mappedBuffers;           // by captured value
+    std::vector<TransientBlock>            transientBlocks;
+
+    std::vector<double>                    frameTimes; // ms
+    std::chrono::steady_clock::time_point  frameStart;
+
+    uint32_t                               numCalls = 0;
+
+    // the record being replayed, for the errors
+    uint16_t                               recordOp       = 0;
+    size_t                                 recordPosition = 0;
+
+    //=========================================================================
+    template <int tag>
+    void read(RecordReader& in, sgfx::Handle<uint32_t, tag>& handle)
+    {
+        uint32_t value = in.get<uint32_t>();
+        handle = sgfx::Handle<uint32_t, tag>(translate(tag, value));
+    }
+
+    uint32_t translate(int tag, uint32_t value) const
+    {
+        if (value == 0)
+            return 0;
+
+        auto it = handles[tag].find(value);
+        if (it == handles[tag].end()) {
+            // the call would get the invalid handle instead, which the backends don't expect
+            fprintf(stderr, "record 0x%04x at %zu uses handle %u of type %d the trace never created\n", recordOp, recordPosition, value, tag);
+            exit(1);
+        }
+        return it->second;
+    }
+
+    template <int tag>
+    void translate(sgfx::Handle<uint32_t, tag>& handle) const
+    {
+        handle.value = translate(tag, handle.value);
+    }
+
+    template <int tag>
+    void bind(const sgfx::Handle<uint32_t, tag>& captured, const sgfx::Handle<uint32_t, tag>& replayed)
+    {
+        if (captured.value != 0)
+            handles[tag][captured.value] = replayed.value;
+    }
+
+    // reads the handle the captured call returned
+    template <int tag>
+    void bindResult(RecordReader& in, const sgfx::Handle<uint32_t, tag>& replayed)
+    {
+        sgfx::Handle<uint32_t, tag> captured(in.get<uint32_t>());
+        bind(captured, replayed);
+    }
+
+    //=========================================================================
+    // the recording calls, the same on draw queues and draw recorders
+    template <typename QueueHandle>
+    bool replayRecording(Op op, RecordReader& in)
+    {
+        QueueHandle queue;
+        read(in, queue);
+
+        switch (op) {
+        case Op::ResetBindings: {
+            sgfx::resetBindings(queue);
+        } break;
+
+        case Op::SetPrimitiveTopology: {
+            sgfx::PrimitiveTopology topology = in.get<sgfx::PrimitiveTopology>();
+            sgfx::setPrimitiveTopology(queue, topology);
+        } break;
+
+        case Op::SetVertexBuffer: {
+            sgfx::BufferHandle buffer;
+            read(in, buffer);
+            uint32_t idx = in.get<uint32_t>();
+            sgfx::setVertexBuffer(queue, buffer, idx);
+        } break;
+
+        case Op::SetIndexBuffer: {
+            sgfx::BufferHandle buffer;
+            read(in, buffer);
+            sgfx::setIndexBuffer(queue, buffer);
+        } break;
+
+        case Op::SetVertexBufferOffset: {
+            sgfx::BufferHandle buffer;
+            read(in, buffer);
+            uint32_t idx    = in.get<uint32_t>();
+            uint32_t offset = in.get<uint32_t>();
+            sgfx::setVertexBuffer(queue, buffer, idx, offset);
+        } break;
+
+        case Op::SetIndexBufferOffset: {
+            sgfx::BufferHandle buffer;
+            read(in, buffer);
+            uint32_t offset = in.get<uint32_t>();
+            sgfx::setIndexBuffer(queue, buffer, offset);
+        } break;
+
+        case Op::SetIndexBufferFormat: {
+            sgfx::BufferHandle buffer;
+            read(in, buffer);
+            uint32_t          offset = in.get<uint32_t>();
+            sgfx::IndexFormat format = in.get<sgfx::IndexFormat>();
+            sgfx::setIndexBuffer(queue, buffer, offset, format);
+        } break;
+
+        case Op::SetConstantBuffer: {
+            uint32_t idx = in.get<uint32_t>();
+            sgfx::ConstantBufferHandle buffer;
+            read(in, buffer);
+            sgfx::setConstantBuffer(queue, idx, buffer);
+        } break;
+
+        case Op::SetConstantBufferRange: {
+            uint32_t idx = in.get<uint32_t>();
+            sgfx::ConstantBufferHandle buffer;
+            read(in, buffer);
+            uint32_t offset = in.get<uint32_t>();
+            uint32_t size   = in.get<uint32_t>();
+            sgfx::setConstantBufferRange(queue, idx, buffer, offset, size);
+        } break;
+
+        case Op::SetResourceBuffer: {
+            uint32_t idx = in.get<uint32_t>();
+            sgfx::BufferHandle resource;
+            read(in, resource);
+            sgfx::setResource(queue, idx, resource);
+        } break;
+
+        case Op::SetResourceTexture: {
+            uint32_t idx = in.get<uint32_t>();
+            sgfx::TextureHandle resource;
+            read(in, resource);
+            sgfx::setResource(queue, idx, resource);
+        } break;
+
+        case Op::SetResourceTable: {
+            uint32_t firstSlot = in.get<uint32_t>();
+            sgfx::ResourceTableHandle table;
+            read(in, table);
+            sgfx::setResourceTable(queue, firstSlot, table);
+        } break;
+
+        case Op::SetInlineConstants: {
+            uint32_t    idx      = in.get<uint32_t>();
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      size     = in.get<size_t>();
+            if (data != nullptr)
+                sgfx::setInlineConstants(queue, idx, data, size);
+        } break;
+
+        case Op::Draw: {
+            uint32_t count       = in.get<uint32_t>();
+            uint32_t startVertex = in.get<uint32_t>();
+            sgfx::draw(queue, count, startVertex);
+        } break;
+
+        case Op::DrawIndexed: {
+            uint32_t count       = in.get<uint32_t>();
+            uint32_t startIndex  = in.get<uint32_t>();
+            uint32_t startVertex = in.get<uint32_t>();
+            sgfx::drawIndexed(queue, count, startIndex, startVertex);
+        } break;
+
+        case Op::DrawInstanced: {
+            uint32_t instanceCount = in.get<uint32_t>();
+            uint32_t count         = in.get<uint32_t>();
+            uint32_t startVertex   = in.get<uint32_t>();
+            uint32_t startInstance = in.get<uint32_t>();
+            sgfx::drawInstanced(queue, instanceCount, count, startVertex, startInstance);
+        } break;
+
+        case Op::DrawIndexedInstanced: {
+            uint32_t instanceCount = in.get<uint32_t>();
+            uint32_t count         = in.get<uint32_t>();
+            uint32_t startIndex    = in.get<uint32_t>();
+            uint32_t startVertex   = in.get<uint32_t>();
+            uint32_t startInstance = in.get<uint32_t>();
+            sgfx::drawIndexedInstanced(queue, instanceCount, count, startIndex, startVertex, startInstance);
+        } break;
+
+        case Op::DrawInstancedIndirect: {
+            sgfx::BufferHandle args;
+            read(in, args);
+            size_t argsOffset = in.get<size_t>();
+            sgfx::drawInstancedIndirect(queue, args, argsOffset);
+        } break;
+
+        case Op::DrawIndexedInstancedIndirect: {
+            sgfx::BufferHandle args;
+            read(in, args);
+            size_t argsOffset = in.get<size_t>();
+            sgfx::drawIndexedInstancedIndirect(queue, args, argsOffset);
+        } break;
+
+        case Op::SetSortKey: {
+            uint64_t key = in.get<uint64_t>();
+            sgfx::setSortKey(queue, key);
+        } break;
+
+        default: {
+            return false;
+        } break;
+        }
+        return true;
+    }
+
+    //=========================================================================
+    template <typename CreateFunc>
+    void replayCreateShader(RecordReader& in, CreateFunc createFunc)
+    {
+        size_t      dataSize = 0;
+        const void* data     = in.getData(dataSize);
+        in.get<size_t>(); // dataSize
+        bindResult(in, createFunc(data, dataSize));
+    }
+
+    void replayCreateVertexFormat(RecordReader& in)
+    {
+        uint64_t count = in.get<uint64_t>();
+
+        std::vector<std::string>                   names;
+        std::vector<sgfx::VertexElementDescriptor> elements;
+        for (uint64_t i = 0; i < count && !in.isOverrun(); ++i) {
+            sgfx::VertexElementDescriptor element;
+            names.push_back(in.getString());
+            element.semanticName    = nullptr;
+            element.semanticIndex   = in.get<uint32_t>();
+            element.format          = in.get<sgfx::DataFormat>();
+            element.slot            = in.get<uint32_t>();
+            element.offset          = in.get<uint64_t>();
+            element.perInstanceData = in.get<uint8_t>() != 0;
+            elements.push_back(element);
+        }
+        for (size_t i = 0; i < elements.size(); ++i)
+            elements[i].semanticName = names[i].c_str();
+
+        size_t      size         = in.get<size_t>();
+        size_t      bytecodeSize = 0;
+        const void* bytecode     = in.getData(bytecodeSize);
+        in.get<size_t>(); // shaderBytecodeSize
+
+        sgfx::VertexFormatHandle handle = sgfx::createVertexFormat(
+            elements.data(), std::min(size, elements.size()),
+            const_cast<void*>(bytecode), bytecodeSize,
+            nullptr
+        );
+        bindResult(in, handle);
+    }
+
+    // transient memory the capture uploaded, written where the replay's allocations put it
+    void replayTransientData(RecordReader& in)
+    {
+        uint32_t    buffer   = in.get<uint32_t>();
+        size_t      offset   = in.get<size_t>();
+        size_t      dataSize = 0;
+        const void* data     = in.getData(dataSize);
+        if (data == nullptr)
+            return;
+
+        for (const TransientBlock& block : transientBlocks) {
+            if (block.capturedBuffer != buffer || block.memory == nullptr)
+                continue;
+
+            size_t begin = std::max(offset, block.capturedOffset);
+            size_t end   = std::min(offset + dataSize, block.capturedOffset + block.size);
+            if (begin < end)
+                std::memcpy(block.memory + (begin - block.capturedOffset), static_cast<const uint8_t*>(data) + (begin - offset), end - begin);
+        }
+    }
+
+    void endFrame()
+    {
+        auto now = std::chrono::steady_clock::now();
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+        frameStart = now;
+
+        transientBlocks.clear();
+    }
+
+    //=========================================================================
+    bool replayCall(Op op, RecordReader& in)
+    {
+        uint16_t code = static_cast<uint16_t>(op);
+        if (code >= static_cast<uint16_t>(Op::ResetBindings) && code <= static_cast<uint16_t>(Op::LastRecordingOp))
+            return replayRecording<sgfx::DrawQueueHandle>(op, in);
+        if (code >= static_cast<uint16_t>(Op::RecorderResetBindings) && code <= static_cast<uint16_t>(Op::RecorderSetSortKey))
+            return replayRecording<sgfx::DrawRecorderHandle>(static_cast<Op>(code - sgfx::capture::kRecorderOps), in);
+
+        switch (op) {
+        // shaders and pipelines
+        case Op::CreateVertexShader:   { replayCreateShader(in, sgfx::createVertexShader);   } break;
+        case Op::CreateHullShader:     { replayCreateShader(in, sgfx::createHullShader);     } break;
+        case Op::CreateDomainShader:   { replayCreateShader(in, sgfx::createDomainShader);   } break;
+        case Op::CreateGeometryShader: { replayCreateShader(in, sgfx::createGeometryShader); } break;
+        case Op::CreatePixelShader:    { replayCreateShader(in, sgfx::createPixelShader);    } break;
+        case Op::CreateComputeShader:  { replayCreateShader(in, sgfx::createComputeShader);  } break;
+
+        case Op::ReleaseVertexShader:   { sgfx::VertexShaderHandle   handle; read(in, handle); sgfx::releaseVertexShader(handle);   } break;
+        case Op::ReleaseHullShader:     { sgfx::HullShaderHandle     handle; read(in, handle); sgfx::releaseHullShader(handle);     } break;
+        case Op::ReleaseDomainShader:   { sgfx::DomainShaderHandle   handle; read(in, handle); sgfx::releaseDomainShader(handle);   } break;
+        case Op::ReleaseGeometryShader: { sgfx::GeometryShaderHandle handle; read(in, handle); sgfx::releaseGeometryShader(handle); } break;
+        case Op::ReleasePixelShader:    { sgfx::PixelShaderHandle    handle; read(in, handle); sgfx::releasePixelShader(handle);    } break;
+        case Op::ReleaseSurfaceShader:  { sgfx::SurfaceShaderHandle  handle; read(in, handle); sgfx::releaseSurfaceShader(handle);  } break;
+        case Op::ReleaseComputeShader:  { sgfx::ComputeShaderHandle  handle; read(in, handle); sgfx::releaseComputeShader(handle);  } break;
+        case Op::ReleaseVertexFormat:   { sgfx::VertexFormatHandle   handle; read(in, handle); sgfx::releaseVertexFormat(handle);   } break;
+        case Op::ReleasePipelineState:  { sgfx::PipelineStateHandle  handle; read(in, handle); sgfx::releasePipelineState(handle);  } break;
+
+        case Op::LinkSurfaceShader: {
+            sgfx::VertexShaderHandle   vs;
+            sgfx::HullShaderHandle     hs;
+            sgfx::DomainShaderHandle   ds;
+            sgfx::GeometryShaderHandle gs;
+            sgfx::PixelShaderHandle    ps;
+            read(in, vs);
+            read(in, hs);
+            read(in, ds);
+            read(in, gs);
+            read(in, ps);
+
+            sgfx::SurfaceBindingLayout layout;
+            bool hasLayout = in.getPod(layout);
+            bindResult(in, sgfx::linkSurfaceShader(vs, hs, ds, gs, ps, hasLayout ? &layout : nullptr));
+        } break;
+
+        case Op::CreateVertexFormat: {
+            replayCreateVertexFormat(in);
+        } break;
+
+        case Op::CreatePipelineState: {
+            sgfx::PipelineStateDescriptor desc;
+            in.getPod(desc);
+            translate(desc.shader);
+            translate(desc.vertexFormat);
+            bindResult(in, sgfx::createPipelineState(desc));
+        } break;
+
+        // compute
+        case Op::CreateComputeQueue: {
+            sgfx::ComputeShaderHandle shader;
+            read(in, shader);
+
+            sgfx::StageBindingLayout layout;
+            bool hasLayout = in.getPod(layout);
+            bindResult(in, sgfx::createComputeQueue(shader, hasLayout ? &layout : nullptr));
+        } break;
+
+        case Op::ReleaseComputeQueue: {
+            sgfx::ComputeQueueHandle handle;
+            read(in, handle);
+            sgfx::releaseComputeQueue(handle);
+        } break;
+
+        case Op::SetConstantBufferCompute: {
+            sgfx::ComputeQueueHandle   handle;
+            sgfx::ConstantBufferHandle buffer;
+            read(in, handle);
+            uint32_t idx = in.get<uint32_t>();
+            read(in, buffer);
+            sgfx::setConstantBuffer(handle, idx, buffer);
+        } break;
+
+        case Op::SetResourceBufferCompute:
+        case Op::SetResourceRWBufferCompute: {
+            sgfx::ComputeQueueHandle handle;
+            sgfx::BufferHandle       resource;
+            read(in, handle);
+            uint32_t idx = in.get<uint32_t>();
+            read(in, resource);
+            if (op == Op::SetResourceBufferCompute)
+                sgfx::setResource(handle, idx, resource);
+            else
+                sgfx::setResourceRW(handle, idx, resource);
+        } break;
+
+        case Op::SetResourceTextureCompute:
+        case Op::SetResourceRWTextureCompute: {
+            sgfx::ComputeQueueHandle handle;
+            sgfx::TextureHandle      resource;
+            read(in, handle);
+            uint32_t idx = in.get<uint32_t>();
+            read(in, resource);
+            if (op == Op::SetResourceTextureCompute)
+                sgfx::setResource(handle, idx, resource);
+            else
+                sgfx::setResourceRW(handle, idx, resource);
+        } break;
+
+        case Op::SubmitCompute: {
+            sgfx::ComputeQueueHandle handle;
+            read(in, handle);
+            uint32_t x = in.get<uint32_t>();
+            uint32_t y = in.get<uint32_t>();
+            uint32_t z = in.get<uint32_t>();
+            sgfx::submit(handle, x, y, z);
+        } break;
+
+        // buffers
+        case Op::CreateBuffer: {
+            uint32_t    flags    = in.get<uint32_t>();
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      size     = in.get<size_t>();
+            size_t      stride   = in.get<size_t>();
+            bindResult(in, sgfx::createBuffer(flags, data, size, stride));
+        } break;
+
+        case Op::ReleaseBuffer: {
+            sgfx::BufferHandle handle(in.get<uint32_t>());
+            mappedBuffers.erase(handle.value);
+            translate(handle);
+            sgfx::releaseBuffer(handle);
+        } break;
+
+        case Op::MapBuffer: {
+            sgfx::BufferHandle handle(in.get<uint32_t>());
+            sgfx::MapType      type = in.get<sgfx::MapType>();
+            void*&             mapped = mappedBuffers[handle.value];
+            translate(handle);
+            mapped = sgfx::mapBuffer(handle, type);
+        } break;
+
+        case Op::UnmapBuffer: {
+            sgfx::BufferHandle handle(in.get<uint32_t>());
+            size_t             dataSize = 0;
+            const void*        data     = in.getData(dataSize);
+
+            // what the capture wrote through the map, read maps have nothing
+            auto it = mappedBuffers.find(handle.value);
+            if (it != mappedBuffers.end()) {
+                if (it->second != nullptr && data != nullptr)
+                    std::memcpy(it->second, data, dataSize);
+                mappedBuffers.erase(it);
+            }
+            translate(handle);
+            sgfx::unmapBuffer(handle);
+        } break;
+
+        case Op::CopyBufferData: {
+            sgfx::BufferHandle handle;
+            read(in, handle);
+            size_t      offset   = in.get<size_t>();
+            size_t      size     = in.get<size_t>();
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            if (data != nullptr)
+                sgfx::copyBufferData(handle, offset, std::min(size, dataSize), data);
+        } break;
+
+        case Op::ClearBufferRWUInt: {
+            sgfx::BufferHandle handle;
+            read(in, handle);
+            sgfx::clearBufferRW(handle, in.get<uint32_t>());
+        } break;
+
+        case Op::ClearBufferRWFloat: {
+            sgfx::BufferHandle handle;
+            read(in, handle);
+            sgfx::clearBufferRW(handle, in.get<float>());
+        } break;
+
+        case Op::CreateConstantBuffer: {
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      size     = in.get<size_t>();
+            bindResult(in, sgfx::createConstantBuffer(data, size));
+        } break;
+
+        case Op::UpdateConstantBuffer: {
+            sgfx::ConstantBufferHandle handle;
+            read(in, handle);
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            if (data != nullptr) // buffers created before the capture started have no data
+                sgfx::updateConstantBuffer(handle, data);
+        } break;
+
+        case Op::UpdateConstantBufferRange: {
+            sgfx::ConstantBufferHandle handle;
+            read(in, handle);
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      offset   = in.get<size_t>();
+            size_t      size     = in.get<size_t>();
+            if (data != nullptr)
+                sgfx::updateConstantBuffer(handle, data, offset, std::min(size, dataSize));
+        } break;
+
+        case Op::ReleaseConstantBuffer: {
+            sgfx::ConstantBufferHandle handle;
+            read(in, handle);
+            sgfx::releaseConstantBuffer(handle);
+        } break;
+
+        case Op::CreateConstantAllocator: {
+            size_t pageSize = in.get<size_t>();
+            bindResult(in, sgfx::createConstantAllocator(pageSize));
+        } break;
+
+        case Op::ReleaseConstantAllocator: {
+            sgfx::ConstantAllocatorHandle handle;
+            read(in, handle);
+            sgfx::releaseConstantAllocator(handle);
+        } break;
+
+        case Op::AllocateConstantBlock: {
+            sgfx::ConstantAllocatorHandle handle;
+            read(in, handle);
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      size     = in.get<size_t>();
+
+            sgfx::ConstantBlock block = sgfx::allocateConstantBlock(handle, data, size);
+            bind(in.get<sgfx::ConstantBlock>().buffer, block.buffer);
+        } break;
+
+        case Op::FreeConstantBlock: {
+            sgfx::ConstantAllocatorHandle handle;
+            read(in, handle);
+            sgfx::ConstantBlock block;
+            if (in.getPod(block)) {
+                translate(block.buffer);
+                sgfx::freeConstantBlock(handle, block);
+            }
+        } break;
+
+        case Op::AllocateTransient: {
+            size_t size      = in.get<size_t>();
+            size_t alignment = in.get<size_t>();
+
+            sgfx::TransientAllocation allocation = sgfx::allocateTransient(size, alignment);
+            sgfx::TransientAllocation captured   = in.get<sgfx::TransientAllocation>();
+            bind(captured.buffer, allocation.buffer);
+
+            TransientBlock block = { captured.buffer.value, captured.offset, size, static_cast<uint8_t*>(allocation.cpuPtr) };
+            transientBlocks.push_back(block);
+        } break;
+
+        case Op::TransientData: {
+            replayTransientData(in);
+        } break;
+
+        case Op::CreateBufferHeap: {
+            uint32_t flags  = in.get<uint32_t>();
+            size_t   size   = in.get<size_t>();
+            size_t   stride = in.get<size_t>();
+            bindResult(in, sgfx::createBufferHeap(flags, size, stride));
+        } break;
+
+        case Op::ReleaseBufferHeap: {
+            sgfx::BufferHeapHandle handle;
+            read(in, handle);
+            sgfx::releaseBufferHeap(handle);
+        } break;
+
+        case Op::AllocateBufferBlock: {
+            sgfx::BufferHeapHandle handle;
+            read(in, handle);
+            size_t      dataSize = 0;
+            const void* data     = in.getData(dataSize);
+            size_t      size     = in.get<size_t>();
+
+            sgfx::BufferBlock block = sgfx::allocateBufferBlock(handle, data, size);
+            bind(in.get<sgfx::BufferBlock>().buffer, block.buffer);
+        } break;
+
+        case Op::FreeBufferBlock: {
+            sgfx::BufferHeapHandle handle;
+            read(in, handle);
+            sgfx::BufferBlock block;
+            if (in.getPod(block)) {
+                translate(block.buffer);
+                sgfx::freeBufferBlock(handle, block);
+            }
+        } break;
+
+        case Op::CompactBufferHeap: {
+            sgfx::BufferHeapHandle handle;
+            read(in, handle);
+            sgfx::compactBufferHeap(handle, in.get<size_t>());
+        } break;
+
+        case Op::CopyBufferRegion: {
+            sgfx::BufferHandle dst, src;
+            read(in, dst);
+            size_t dstOffset = in.get<size_t>();
+            read(in, src);
+            size_t srcOffset = in.get<size_t>();
+            size_t size      = in.get<size_t>();
+            sgfx::copyBufferRegion(dst, dstOffset, src, srcOffset, size);
+        } break;
+
+        case Op::CopyResourceBuffer: {
+            sgfx::BufferHandle src, dst;
+            read(in, src);
+            read(in, dst);
+            sgfx::copyResource(src, dst);
+        } break;
+
+        case Op::CopyResourceConstantBuffer: {
+            sgfx::ConstantBufferHandle src, dst;
+            read(in, src);
+            read(in, dst);
+            sgfx::copyResource(src, dst);
+        } break;
+
+        // textures
+        case Op::CreateSamplerState: {
+            sgfx::SamplerStateDescriptor desc;
+            in.getPod(desc);
+            bindResult(in, sgfx::createSamplerState(desc));
+        } break;
+
+        case Op::ReleaseSamplerState: {
+            sgfx::SamplerStateHandle handle;
+            read(in, handle);
+            sgfx::releaseSamplerState(handle);
+        } break;
+
+        case Op::CreateTexture1D: {
+            uint32_t         width      = in.get<uint32_t>();
+            sgfx::DataFormat format     = in.get<sgfx::DataFormat>();
+            uint32_t         numMipmaps = in.get<uint32_t>();
+            uint32_t         flags      = in.get<uint32_t>();
+            bindResult(in, sgfx::createTexture1D(width, format, numMipmaps, flags));
+        } break;
+
+        case Op::CreateTexture2D: {
+            uint32_t         width      = in.get<uint32_t>();
+            uint32_t         height     = in.get<uint32_t>();
+            sgfx::DataFormat format     = in.get<sgfx::DataFormat>();
+            uint32_t         numMipmaps = in.get<uint32_t>();
+            uint32_t         flags      = in.get<uint32_t>();
+            bindResult(in, sgfx::createTexture2D(width, height, format, numMipmaps, flags));
+        } break;
+
+        case Op::CreateTexture3D: {
+            uint32_t         width      = in.get<uint32_t>();
+            uint32_t         height     = in.get<uint32_t>();
+            uint32_t         depth      = in.get<uint32_t>();
+            sgfx::DataFormat format     = in.get<sgfx::DataFormat>();
+            uint32_t         numMipmaps = in.get<uint32_t>();
+            uint32_t         flags      = in.get<uint32_t>();
+            bindResult(in, sgfx::createTexture3D(width, height, depth, format, numMipmaps, flags));
+        } break;
+
+        case Op::ClearTextureRWUInt: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            sgfx::clearTextureRW(handle, in.get<uint32_t>());
+        } break;
+
+        case Op::ClearTextureRWFloat: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            sgfx::clearTextureRW(handle, in.get<float>());
+        } break;
+
+        case Op::MapTexture: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            sgfx::mapTexture(handle, in.get<sgfx::MapType>());
+        } break;
+
+        case Op::UnmapTexture: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            sgfx::unmapTexture(handle);
+        } break;
+
+        case Op::UpdateTexture: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            size_t      dataSize   = 0;
+            const void* data       = in.getData(dataSize);
+            uint32_t    mip        = in.get<uint32_t>();
+            size_t      offsetX    = in.get<size_t>();
+            size_t      sizeX      = in.get<size_t>();
+            size_t      offsetY    = in.get<size_t>();
+            size_t      sizeY      = in.get<size_t>();
+            size_t      offsetZ    = in.get<size_t>();
+            size_t      sizeZ      = in.get<size_t>();
+            size_t      rowPitch   = in.get<size_t>();
+            size_t      depthPitch = in.get<size_t>();
+            if (data != nullptr)
+                sgfx::updateTexture(handle, data, mip, offsetX, sizeX, offsetY, sizeY, offsetZ, sizeZ, rowPitch, depthPitch);
+        } break;
+
+        case Op::ReleaseTexture: {
+            sgfx::TextureHandle handle;
+            read(in, handle);
+            sgfx::releaseTexture(handle);
+        } break;
+
+        case Op::CopyResourceTexture: {
+            sgfx::TextureHandle src, dst;
+            read(in, src);
+            read(in, dst);
+            sgfx::copyResource(src, dst);
+        } break;
+
+        case Op::CreateResourceTable: {
+            size_t      dataSize   = 0;
+            const void* data       = in.getData(dataSize);
+            uint32_t    numEntries = in.get<uint32_t>();
+
+            std::vector<sgfx::ResourceTableEntry> entries(dataSize / sizeof(sgfx::ResourceTableEntry));
+            if (!entries.empty())
+                std::memcpy(entries.data(), data, entries.size() * sizeof(sgfx::ResourceTableEntry));
+            for (sgfx::ResourceTableEntry& entry : entries) {
+                translate(entry.buffer);
+                translate(entry.texture);
+            }
+
+            numEntries = std::min(numEntries, static_cast<uint32_t>(entries.size()));
+            bindResult(in, sgfx::createResourceTable(entries.data(), numEntries));
+        } break;
+
+        case Op::ReleaseResourceTable: {
+            sgfx::ResourceTableHandle handle;
+            read(in, handle);
+            sgfx::releaseResourceTable(handle);
+        } break;
+
+        // render targets and frames
+        case Op::GetBackBuffer: {
+            bindResult(in, sgfx::getBackBuffer());
+        } break;
+
+        case Op::CreateRenderTarget: {
+            sgfx::RenderTargetDescriptor desc;
+            in.getPod(desc);
+            for (sgfx::TextureHandle& texture : desc.colorTextures)
+                translate(texture);
+            translate(desc.depthStencilTexture);
+            bindResult(in, sgfx::createRenderTarget(desc));
+        } break;
+
+        case Op::ReleaseRenderTarget: {
+            sgfx::RenderTargetHandle handle;
+            read(in, handle);
+            sgfx::releaseRenderTarget(handle);
+        } break;
+
+        case Op::SetViewport: {
+            uint32_t width    = in.get<uint32_t>();
+            uint32_t height   = in.get<uint32_t>();
+            float    minDepth = in.get<float>();
+            float    maxDepth = in.get<float>();
+            sgfx::setViewport(width, height, minDepth, maxDepth);
+        } break;
+
+        case Op::SetResourceRWBufferRenderTarget: {
+            sgfx::RenderTargetHandle handle;
+            sgfx::BufferHandle       resource;
+            read(in, handle);
+            uint32_t slot = in.get<uint32_t>();
+            read(in, resource);
+            sgfx::setResourceRW(handle, slot, resource);
+        } break;
+
+        case Op::SetResourceRWTextureRenderTarget: {
+            sgfx::RenderTargetHandle handle;
+            sgfx::TextureHandle      resource;
+            read(in, handle);
+            uint32_t slot = in.get<uint32_t>();
+            read(in, resource);
+            sgfx::setResourceRW(handle, slot, resource);
+        } break;
+
+        case Op::SetRenderTarget: {
+            sgfx::RenderTargetHandle handle;
+            read(in, handle);
+            sgfx::setRenderTarget(handle);
+        } break;
+
+        case Op::ClearRenderTarget: {
+            sgfx::RenderTargetHandle handle;
+            read(in, handle);
+            sgfx::clearRenderTarget(handle, in.get<uint32_t>());
+        } break;
+
+        case Op::ClearRenderTargetSlot: {
+            sgfx::RenderTargetHandle handle;
+            read(in, handle);
+            uint32_t slot  = in.get<uint32_t>();
+            uint32_t color = in.get<uint32_t>();
+            sgfx::clearRenderTarget(handle, slot, color);
+        } break;
+
+        case Op::ClearDepthStencil: {
+            sgfx::RenderTargetHandle handle;
+            read(in, handle);
+            float   depth   = in.get<float>();
+            uint8_t stencil = in.get<uint8_t>();
+            sgfx::clearDepthStencil(handle, depth, stencil);
+        } break;
+
+        case Op::Present: {
+            sgfx::present(in.get<uint32_t>());
+            endFrame();
+        } break;
+
+        case Op::CreateFrameArena: {
+            size_t blockSize = in.get<size_t>();
+            bindResult(in, sgfx::createFrameArena(blockSize));
+        } break;
+
+        case Op::ReleaseFrameArena: {
+            sgfx::FrameArenaHandle handle;
+            read(in, handle);
+            sgfx::releaseFrameArena(handle);
+        } break;
+
+        case Op::SetThreadFrameArena: {
+            sgfx::FrameArenaHandle handle;
+            read(in, handle);
+            sgfx::setThreadFrameArena(handle);
+        } break;
+
+        case Op::BeginPerfEvent: {
+            std::wstring name = in.getWideString();
+            sgfx::beginPerfEvent(name.c_str());
+        } break;
+
+        case Op::EndPerfEvent: {
+            sgfx::endPerfEvent();
+        } break;
+
+        // draw queues
+        case Op::CreateDrawQueue: {
+            sgfx::PipelineStateHandle state;
+            read(in, state);
+            uint32_t flags = in.get<uint32_t>();
+            bindResult(in, sgfx::createDrawQueue(state, flags));
+        } break;
+
+        case Op::ReleaseDrawQueue: {
+            sgfx::DrawQueueHandle handle;
+            read(in, handle);
+            sgfx::releaseDrawQueue(handle);
+        } break;
+
+        case Op::SetSamplerState: {
+            sgfx::DrawQueueHandle    handle;
+            sgfx::SamplerStateHandle sampler;
+            read(in, handle);
+            uint32_t idx = in.get<uint32_t>();
+            read(in, sampler);
+            sgfx::setSamplerState(handle, idx, sampler);
+        } break;
+
+        case Op::Submit: {
+            sgfx::DrawQueueHandle handle;
+            read(in, handle);
+            sgfx::submit(handle, in.get<uint32_t>());
+        } break;
+
+        case Op::CreateDrawRecorder: {
+            sgfx::DrawQueueHandle queue;
+            read(in, queue);
+            bindResult(in, sgfx::createDrawRecorder(queue));
+        } break;
+
+        case Op::ReleaseDrawRecorder: {
+            sgfx::DrawRecorderHandle handle;
+            read(in, handle);
+            sgfx::releaseDrawRecorder(handle);
+        } break;
+
+        case Op::SetDrawRecorderKey: {
+            sgfx::DrawRecorderHandle handle;
+            read(in, handle);
+            sgfx::setDrawRecorderKey(handle, in.get<uint32_t>());
+        } break;
+
+        case Op::CreateBundle: {
+            sgfx::DrawQueueHandle queue;
+            read(in, queue);
+            bindResult(in, sgfx::createBundle(queue));
+        } break;
+
+        case Op::ReleaseBundle: {
+            sgfx::BundleHandle handle;
+            read(in, handle);
+            sgfx::releaseBundle(handle);
+        } break;
+
+        case Op::SubmitBundle: {
+            sgfx::BundleHandle handle;
+            read(in, handle);
+            size_t      maskSize = 0;
+            const void* mask     = in.getData(maskSize);
+
+            // the mask may sit at any offset of the trace
+            std::vector<uint64_t> visibilityMask((maskSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            if (mask != nullptr && maskSize != 0)
+                std::memcpy(visibilityMask.data(), mask, maskSize);
+            sgfx::submit(handle, (mask != nullptr) ? visibilityMask.data() : nullptr);
+        } break;
+
+        case Op::Flush: {
+            sgfx::flush();
+        } break;
+
+        default: {
+            return false;
+        } break;
+        }
+        return true;
+    }
+
+public:
+
+    // false if the trace is broken, the calls before the broken record were made
+    bool run(const uint8_t* records, size_t size)
+    {
+        frameStart = std::chrono::steady_clock::now();
+
+        size_t position = 0;
+        while (position < size) {
+            if (size - position < sizeof(sgfx::capture::RecordHeader)) {
+                fprintf(stderr, "truncated record header at %zu\n", position);
+                return false;
+            }
+
+            sgfx::capture::RecordHeader header;
+            std::memcpy(&header, records + position, sizeof(header));
+            position += sizeof(header);
+
+            if (header.size > size - position) {
+                fprintf(stderr, "truncated record 0x%04x at %zu\n", header.op, position - sizeof(header));
+                return false;
+            }
+
+            recordOp       = header.op;
+            recordPosition = position - sizeof(header);
+
+            RecordReader in(records + position, header.size);
+            if (!replayCall(static_cast<Op>(header.op), in)) {
+                fprintf(stderr, "unknown record 0x%04x at %zu\n", header.op, position - sizeof(header));
+                return false;
+            }
+            if (in.isOverrun()) {
+                fprintf(stderr, "broken record 0x%04x at %zu\n", header.op, position - sizeof(header));
+                return false;
+            }
+
+            position += header.size;
+            numCalls++;
+        }
+        return true;
+    }
+
+    const std::vector<double>& getFrameTimes() const { return frameTimes; }
+    uint32_t                   getNumCalls()   const { return numCalls;   }
+};
+
+//=============================================================================
+static double getPercentile(std::vector<double> times, double percentile)
+{
+    std::sort(times.begin(), times.end());
+    size_t index = static_cast<size_t>(percentile * static_cast<double>(times.size() - 1) + 0.5);
+    return times[index];
+}
+
+static void printUsage()
+{
+    printf("usage: sgfx_replay <trace> [-repeat N] [-frames]\n");
+}
+
+//=============================================================================
+int main(int argc, char** argv)
+{
+    const char* path        = nullptr;
+    uint32_t    numRepeats  = 1;
+    bool        printFrames = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-repeat") == 0 && i + 1 < argc) {
+            numRepeats = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "-frames") == 0) {
+            printFrames = true;
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (path == nullptr) {
+        printUsage();
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        fprintf(stderr, "can't map %s\n", path);
+        return 1;
+    }
+
+    sgfx::capture::FileHeader header;
+    if (file.getSize() < sizeof(header)) {
+        fprintf(stderr, "%s is not an sgfx trace\n", path);
+        return 1;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+
+    if (std::memcmp(header.magic, sgfx::capture::kMagic, sizeof(header.magic)) != 0 || header.headerSize < sizeof(header) || header.headerSize > file.getSize()) {
+        fprintf(stderr, "%s is not an sgfx trace\n", path);
+        return 1;
+    }
+    if (header.version != sgfx::capture::kVersion) {
+        fprintf(stderr, "%s is a version %u trace, this replay reads version %u\n", path, header.version, static_cast<uint32_t>(sgfx::capture::kVersion));
+        return 1;
+    }
+
+    const uint8_t* records     = file.getData() + header.headerSize;
+    size_t         recordsSize = file.getSize() - header.headerSize;
+
+    printf("%s: %zu bytes, back buffer %ux%u\n", path, file.getSize(), header.backBufferWidth, header.backBufferHeight);
+
+    bool                complete = true;
+    std::vector<double> frameTimes;
+    for (uint32_t repeat = 0; repeat < numRepeats; ++repeat) {
+        if (!initBackend(header.backBufferWidth, header.backBufferHeight)) {
+            fprintf(stderr, "can't initialize the backend\n");
+            return 1;
+        }
+
+        // a replay holds a handle map per object type, tens of MB for large traces
+        Replay* replay = new Replay();
+        complete = replay->run(records, recordsSize);
+
+        if (repeat == 0)
+            printf("%u calls\n", replay->getNumCalls());
+        frameTimes.insert(frameTimes.end(), replay->getFrameTimes().begin(), replay->getFrameTimes().end());
+
+        delete replay;
+        sgfx::shutdown();
+
+        if (!complete)
+            break;
+    }
+
+    if (printFrames) {
+        printf("\n%8s %10s\n", "frame", "ms");
+        for (size_t i = 0; i < frameTimes.size(); ++i)
+            printf("%8zu %10.3f\n", i, frameTimes[i]);
+    }
+
+    if (!frameTimes.empty()) {
+        double total = 0.0;
+        for (double time : frameTimes)
+            total += time;
+
+        printf("\n%zu frames over %u runs, ms per frame\n", frameTimes.size(), numRepeats);
+        printf("%10s %10s %10s %10s %10s\n", "min", "avg", "median", "p99", "max");
+        printf("%10.3f %10.3f %10.3f %10.3f %10.3f\n",
+            getPercentile(frameTimes, 0.0),
+            total / static_cast<double>(frameTimes.size()),
+            getPercentile(frameTimes, 0.5),
+            getPercentile(frameTimes, 0.99),
+            getPercentile(frameTimes, 1.0)
+        );
+    } else {
+        fprintf(stderr, "no present() in the trace\n");
+        complete = false;
+    }
+
+    return complete ? 0 : 1;
+}